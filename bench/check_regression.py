@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""Runs the microbenchmarks and compares them with a stored baseline.
+
+usage: check_regression.py [--threshold PCT] [--repetitions N] [--update]
+                           BINARY [BASELINE]
+
+Each benchmark is repeated and its fastest CPU time compared with the
+baseline (the minimum is far less sensitive to a busy machine than the
+mean); the check fails if any benchmark got slower by more than PCT
+percent (default: the baseline's threshold_pct). --update rewrites the
+baseline from this run instead. Baselines are machine specific: refresh
+the file on the machine that runs the check.
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+
+DEFAULT_BASELINE = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                "micro", "baseline.json")
+DEFAULT_THRESHOLD_PCT = 10.0
+
+
+def run_benchmarks(binary, repetitions, bench_filter):
+    cmd = [binary, "--benchmark_format=json",
+           "--benchmark_repetitions=%d" % repetitions]
+    if bench_filter:
+        cmd.append("--benchmark_filter=" + bench_filter)
+    out = subprocess.run(cmd, check=True, stdout=subprocess.PIPE).stdout
+    fastest = {}
+    for bench in json.loads(out)["benchmarks"]:
+        if bench.get("run_type") != "iteration":
+            continue
+        if bench.get("error_occurred"):
+            raise SystemExit("%s: %s" % (bench["run_name"],
+                                         bench.get("error_message", "")))
+        ns = bench["cpu_time"] * to_ns(bench)
+        name = bench["run_name"]
+        fastest[name] = min(ns, fastest.get(name, ns))
+    return fastest
+
+
+def to_ns(bench):
+    return {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}[bench["time_unit"]]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("binary")
+    parser.add_argument("baseline", nargs="?", default=DEFAULT_BASELINE)
+    parser.add_argument("--threshold", type=float,
+                        help="allowed slowdown in percent")
+    parser.add_argument("--repetitions", type=int, default=5)
+    parser.add_argument("--filter", help="--benchmark_filter regex")
+    parser.add_argument("--update", action="store_true",
+                        help="write this run as the new baseline")
+    args = parser.parse_args()
+
+    current = run_benchmarks(args.binary, args.repetitions, args.filter)
+
+    if args.update:
+        threshold = args.threshold
+        if threshold is None:
+            threshold = DEFAULT_THRESHOLD_PCT
+        with open(args.baseline, "w") as f:
+            json.dump({"threshold_pct": threshold,
+                       "cpu_time_ns": {k: round(v, 1) for k, v in
+                                       sorted(current.items())}},
+                      f, indent=2)
+            f.write("\n")
+        print("baseline written to %s (%d benchmarks)" %
+              (args.baseline, len(current)))
+        return 0
+
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    threshold = args.threshold
+    if threshold is None:
+        threshold = baseline.get("threshold_pct", DEFAULT_THRESHOLD_PCT)
+    stored = baseline["cpu_time_ns"]
+
+    regressions = 0
+    width = max(len(name) for name in current)
+    for name in sorted(current):
+        now = current[name]
+        if name not in stored:
+            print("%-*s %12.1f ns  (new, no baseline)" % (width, name, now))
+            continue
+        change = (now / stored[name] - 1.0) * 100.0
+        verdict = ""
+        if change > threshold:
+            verdict = "  REGRESSION"
+            regressions += 1
+        print("%-*s %12.1f ns  %+7.1f%%%s" % (width, name, now, change,
+                                              verdict))
+    if not args.filter:
+        for name in sorted(set(stored) - set(current)):
+            print("%-*s  missing from this run" % (width, name))
+
+    if regressions:
+        print("%d benchmark(s) slower than the baseline by more than %g%%" %
+              (regressions, threshold))
+        return 1
+    print("no benchmark slower than the baseline by more than %g%%" %
+          threshold)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
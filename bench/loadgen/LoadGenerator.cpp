@@ -0,0 +1,445 @@
+#include "LoadGenerator.hpp"
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include "Request.hpp"
+
+namespace loadgen {
+
+namespace {
+
+const size_t kReadSize = 64 * 1024;
+const int kMaxEvents = 256;
+const uint64_t kTimeoutCheckUs = 100 * 1000;
+const uint64_t kMaxLatencyUs = 0xffffffffu;
+
+uint64_t NowUs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+uint64_t Seconds(double sec) {
+  return static_cast<uint64_t>(sec * 1e6);
+}
+
+}  // namespace
+
+LoadGenerator::LoadGenerator(const Options& options)
+    : options_(options),
+      request_(BuildRequest(options)),
+      slow_prefix_(BuildSlowPrefix(options)),
+      addr_(NULL),
+      epoll_fd_(-1),
+      conns_(),
+      dead_(),
+      pending_(),
+      regular_count_(0),
+      slow_count_(0),
+      measure_start_us_(0),
+      end_us_(0),
+      next_arrival_us_(0),
+      arrival_interval_us_(0),
+      next_timeout_check_us_(0),
+      measuring_(false),
+      measured_(0),
+      results_() {
+}
+
+LoadGenerator::~LoadGenerator() {
+  while (!conns_.empty()) Close(conns_.back());
+  for (size_t i = 0; i < dead_.size(); ++i) delete dead_[i];
+  if (addr_) freeaddrinfo(addr_);
+  if (epoll_fd_ != -1) close(epoll_fd_);
+}
+
+Results LoadGenerator::Run() {
+  struct addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  const int rc = getaddrinfo(options_.host.c_str(), options_.port.c_str(),
+                             &hints, &addr_);
+  if (rc != 0) {
+    throw std::runtime_error("cannot resolve " + options_.host + ": " +
+                             gai_strerror(rc));
+  }
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd_ == -1) {
+    throw std::runtime_error(std::string("epoll_create1: ") +
+                             std::strerror(errno));
+  }
+
+  const uint64_t start = NowUs();
+  measure_start_us_ = start + Seconds(options_.warmup_sec);
+  end_us_ = measure_start_us_ + Seconds(options_.duration_sec);
+  if (options_.rate > 0) arrival_interval_us_ = 1e6 / options_.rate;
+  next_arrival_us_ = start;
+  next_timeout_check_us_ = start + kTimeoutCheckUs;
+
+  epoll_event events[kMaxEvents];
+  double arrivals = 0;  // fractional schedule for rates above 1 MHz
+  while (!Done()) {
+    const uint64_t now = NowUs();
+    if (!measuring_ && now >= measure_start_us_) StartMeasuring();
+    if (now >= end_us_) break;
+    if (options_.rate > 0) {
+      while (next_arrival_us_ <= now) {
+        pending_.push_back(next_arrival_us_);
+        arrivals += arrival_interval_us_;
+        next_arrival_us_ = start + static_cast<uint64_t>(arrivals);
+      }
+    }
+    Replenish();
+    Assign();
+    TickSlow(now);
+    if (now >= next_timeout_check_us_) {
+      CheckTimeouts(now);
+      next_timeout_check_us_ = now + kTimeoutCheckUs;
+    }
+
+    const int n = epoll_wait(epoll_fd_, events, kMaxEvents, WaitTimeoutMs(now));
+    if (n == -1) {
+      if (errno == EINTR) continue;
+      throw std::runtime_error(std::string("epoll_wait: ") +
+                               std::strerror(errno));
+    }
+    for (int i = 0; i < n; ++i) {
+      Connection* conn = static_cast<Connection*>(events[i].data.ptr);
+      const uint32_t ev = events[i].events;
+      if (conn->fd != -1 && (ev & (EPOLLOUT | EPOLLERR | EPOLLHUP)) &&
+          conn->writing) {
+        OnWritable(conn);
+      }
+      if (conn->fd != -1 && (ev & (EPOLLIN | EPOLLERR | EPOLLHUP))) {
+        OnReadable(conn);
+      }
+    }
+    for (size_t i = 0; i < dead_.size(); ++i) delete dead_[i];
+    dead_.clear();
+  }
+
+  if (!measuring_) StartMeasuring();
+  uint64_t stop = NowUs();
+  if (stop > end_us_) stop = end_us_;
+  results_.elapsed_sec =
+      stop > measure_start_us_ ? (stop - measure_start_us_) / 1e6 : 0;
+  if (options_.server_pid != 0) {
+    results_.server_after = ReadProcessStats(options_.server_pid);
+  }
+  results_.client_after = ReadSelfStats();
+  results_.slow_held = slow_count_;
+  return results_;
+}
+
+void LoadGenerator::StartMeasuring() {
+  measuring_ = true;
+  if (options_.server_pid != 0) {
+    results_.server_before = ReadProcessStats(options_.server_pid);
+  }
+  results_.client_before = ReadSelfStats();
+}
+
+bool LoadGenerator::Done() const {
+  return options_.max_requests != 0 && measured_ >= options_.max_requests;
+}
+
+LoadGenerator::Connection* LoadGenerator::Open(bool slow) {
+  const int fd = socket(addr_->ai_family,
+                        SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd == -1) {
+    ++results_.connect_errors;
+    return NULL;
+  }
+  const int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  if (connect(fd, addr_->ai_addr, addr_->ai_addrlen) == -1 &&
+      errno != EINPROGRESS) {
+    ++results_.connect_errors;
+    close(fd);
+    return NULL;
+  }
+  Connection* conn = new Connection();
+  conn->fd = fd;
+  conn->connecting = true;
+  conn->slow = slow;
+  conn->draining = false;
+  conn->writing = true;
+  conn->out_pos = 0;
+  conn->last_activity_us = NowUs();
+  conn->next_slow_us =
+      conn->last_activity_us + options_.slow_interval_ms * 1000;
+  conn->sent = 0;
+  conn->index = conns_.size();
+  if (slow) conn->out = slow_prefix_;
+
+  epoll_event ev;
+  ev.events = EPOLLIN | EPOLLOUT;
+  ev.data.ptr = conn;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == -1) {
+    ++results_.connect_errors;
+    close(fd);
+    delete conn;
+    return NULL;
+  }
+  conns_.push_back(conn);
+  ++(slow ? slow_count_ : regular_count_);
+  ++results_.connections_opened;
+  return conn;
+}
+
+void LoadGenerator::Close(Connection* conn) {
+  if (conn->fd == -1) return;
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, conn->fd, NULL);
+  close(conn->fd);
+  conn->fd = -1;
+  --(conn->slow ? slow_count_ : regular_count_);
+  Connection* last = conns_.back();
+  conns_[conn->index] = last;
+  last->index = conn->index;
+  conns_.pop_back();
+  dead_.push_back(conn);
+}
+
+// requests the server did not answer are sent again; with lost_head the
+// response in progress is counted as an error instead
+void LoadGenerator::HandleClosed(Connection* conn, bool lost_head) {
+  if (lost_head && !conn->inflight.empty()) {
+    ++results_.read_errors;
+    conn->inflight.pop_front();
+  }
+  results_.retried += conn->inflight.size();
+  while (!conn->inflight.empty()) {
+    pending_.push_front(conn->inflight.back());
+    conn->inflight.pop_back();
+  }
+  Close(conn);
+}
+
+// closed loop: keep `connections` open; both loops: keep the slow ones
+void LoadGenerator::Replenish() {
+  while (slow_count_ < options_.slowloris) {
+    if (!Open(true)) break;
+  }
+  if (options_.rate > 0) return;
+  while (regular_count_ < options_.connections) {
+    Connection* conn = Open(false);
+    if (!conn) break;
+    FillPipeline(conn);
+  }
+}
+
+void LoadGenerator::Assign() {
+  for (size_t i = 0; i < conns_.size(); ++i) {
+    FillPipeline(conns_[i]);
+  }
+  while (!pending_.empty() && regular_count_ < options_.connections) {
+    Connection* conn = Open(false);
+    if (!conn) break;
+    FillPipeline(conn);
+  }
+}
+
+void LoadGenerator::Issue(Connection* conn, uint64_t start_us) {
+  conn->out += request_;
+  conn->inflight.push_back(start_us);
+  ++conn->sent;
+}
+
+void LoadGenerator::FillPipeline(Connection* conn) {
+  if (conn->slow || conn->draining || conn->fd == -1) return;
+  if (!options_.keep_alive && conn->sent != 0) return;
+  const size_t depth = options_.keep_alive ? options_.pipeline : 1;
+  const size_t before = conn->inflight.size();
+  while (conn->inflight.size() < depth) {
+    if (!pending_.empty()) {
+      Issue(conn, pending_.front());
+      pending_.pop_front();
+    } else if (options_.rate == 0) {
+      Issue(conn, NowUs());
+    } else {
+      break;
+    }
+  }
+  if (conn->inflight.size() != before && !conn->connecting) Flush(conn);
+}
+
+void LoadGenerator::Flush(Connection* conn) {
+  while (conn->out_pos < conn->out.size()) {
+    const ssize_t n =
+        send(conn->fd, conn->out.data() + conn->out_pos,
+             conn->out.size() - conn->out_pos, MSG_NOSIGNAL);
+    if (n > 0) {
+      conn->out_pos += n;
+      conn->last_activity_us = NowUs();
+      continue;
+    }
+    if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+    if (conn->slow) {
+      ++results_.slow_closed;
+      Close(conn);
+    } else {
+      HandleClosed(conn, false);
+    }
+    return;
+  }
+  if (conn->out_pos == conn->out.size()) {
+    conn->out.clear();
+    conn->out_pos = 0;
+  }
+  UpdateEvents(conn);
+}
+
+void LoadGenerator::UpdateEvents(Connection* conn) {
+  const bool want_write = conn->connecting || !conn->out.empty();
+  if (want_write == conn->writing) return;
+  epoll_event ev;
+  ev.events = want_write ? EPOLLIN | EPOLLOUT : EPOLLIN;
+  ev.data.ptr = conn;
+  epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, conn->fd, &ev);
+  conn->writing = want_write;
+}
+
+void LoadGenerator::OnWritable(Connection* conn) {
+  if (conn->connecting) {
+    int err = 0;
+    socklen_t len = sizeof(err);
+    getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &err, &len);
+    if (err != 0) {
+      ++results_.connect_errors;
+      if (conn->slow) {
+        Close(conn);
+      } else {
+        HandleClosed(conn, false);
+      }
+      return;
+    }
+    conn->connecting = false;
+  }
+  Flush(conn);
+}
+
+void LoadGenerator::OnReadable(Connection* conn) {
+  char buf[kReadSize];
+  const ssize_t n = recv(conn->fd, buf, sizeof(buf), 0);
+  if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+  if (conn->slow) {
+    // anything the server says to a slow connection precedes its close
+    if (n <= 0) {
+      ++results_.slow_closed;
+      Close(conn);
+    }
+    return;
+  }
+  if (n <= 0) {
+    // a reset before any response byte only means the server closed an
+    // idle keep-alive connection: the request is retried, not failed
+    bool lost_head = false;
+    if (!conn->draining && !conn->inflight.empty() &&
+        conn->reader.Started()) {
+      if (n == 0 &&
+          conn->reader.OnEof() == ResponseReader::kComplete) {
+        CompleteResponse(conn);
+      } else {
+        lost_head = true;
+      }
+    }
+    if (conn->fd != -1) HandleClosed(conn, lost_head);
+    return;
+  }
+  conn->last_activity_us = NowUs();
+  if (measuring_) results_.bytes_received += n;
+
+  size_t pos = 0;
+  while (pos < static_cast<size_t>(n) && !conn->inflight.empty() &&
+         !conn->draining) {
+    size_t used = 0;
+    const ResponseReader::Result r =
+        conn->reader.Feed(buf + pos, n - pos, &used);
+    pos += used;
+    if (r == ResponseReader::kError) {
+      HandleClosed(conn, true);
+      return;
+    }
+    if (r == ResponseReader::kNeedMore) break;
+    CompleteResponse(conn);
+    if (conn->fd == -1) return;
+  }
+}
+
+void LoadGenerator::CompleteResponse(Connection* conn) {
+  const uint64_t now = NowUs();
+  const uint64_t start = conn->inflight.front();
+  conn->inflight.pop_front();
+  if (measuring_ && now <= end_us_) {
+    const uint64_t latency = now > start ? now - start : 0;
+    results_.latencies_us.push_back(static_cast<uint32_t>(
+        latency < kMaxLatencyUs ? latency : kMaxLatencyUs));
+    ++results_.statuses[conn->reader.Status()];
+    ++measured_;
+  }
+  const bool reuse = options_.keep_alive && conn->reader.KeepAlive();
+  conn->reader.Reset();
+  if (reuse) {
+    FillPipeline(conn);
+  } else {
+    // let the server close first so TIME_WAIT stays on its side
+    conn->draining = true;
+  }
+}
+
+void LoadGenerator::TickSlow(uint64_t now) {
+  for (size_t i = 0; i < conns_.size(); ++i) {
+    Connection* conn = conns_[i];
+    if (!conn->slow || conn->connecting || now < conn->next_slow_us) continue;
+    conn->out += 'a';
+    conn->next_slow_us = now + options_.slow_interval_ms * 1000;
+    Flush(conn);
+    if (conn->fd == -1) --i;  // Close() moved the last connection here
+  }
+}
+
+void LoadGenerator::CheckTimeouts(uint64_t now) {
+  const uint64_t timeout = static_cast<uint64_t>(options_.timeout_ms) * 1000;
+  for (size_t i = 0; i < conns_.size(); ++i) {
+    Connection* conn = conns_[i];
+    if (conn->slow || now < conn->last_activity_us + timeout) continue;
+    if (conn->connecting) {
+      ++results_.connect_errors;
+    } else if (!conn->inflight.empty() && !conn->draining) {
+      ++results_.timeouts;
+      conn->inflight.pop_front();
+    }
+    HandleClosed(conn, false);
+    --i;
+  }
+}
+
+int LoadGenerator::WaitTimeoutMs(uint64_t now) const {
+  uint64_t deadline = end_us_;
+  if (!measuring_ && measure_start_us_ < deadline) {
+    deadline = measure_start_us_;
+  }
+  if (options_.rate > 0 && next_arrival_us_ < deadline) {
+    deadline = next_arrival_us_;
+  }
+  if (next_timeout_check_us_ < deadline) deadline = next_timeout_check_us_;
+  for (size_t i = 0; i < conns_.size() && options_.slowloris != 0; ++i) {
+    if (conns_[i]->slow && conns_[i]->next_slow_us < deadline) {
+      deadline = conns_[i]->next_slow_us;
+    }
+  }
+  if (deadline <= now) return 0;
+  return static_cast<int>((deadline - now + 999) / 1000);
+}
+
+}  // namespace loadgen
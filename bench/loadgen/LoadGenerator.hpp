@@ -0,0 +1,105 @@
+#ifndef BENCH_LOADGEN_LOAD_GENERATOR_HPP_
+#define BENCH_LOADGEN_LOAD_GENERATOR_HPP_
+
+#include <netdb.h>
+#include <stdint.h>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "Options.hpp"
+#include "Report.hpp"
+#include "ResponseReader.hpp"
+
+namespace loadgen {
+
+/*
+Single-threaded epoll HTTP client.
+
+Closed loop (default): every connection keeps `pipeline` requests in flight
+and sends the next one as soon as a response completes, so the offered load
+follows the server's speed.
+
+Open loop (-r): requests are scheduled at a fixed rate whatever the server
+does, and a request's latency counts from its scheduled time, so queueing
+behind a slow server shows up in the percentiles instead of lowering the
+offered load (no coordinated omission).
+
+Without keep-alive, a connection is closed after its response once the
+server has closed its side, so TIME_WAIT stays on the server as with real
+clients. Requests still unanswered when a keep-alive connection closes are
+sent again on a new connection and counted as retried.
+*/
+class LoadGenerator {
+ public:
+  explicit LoadGenerator(const Options& options);
+  ~LoadGenerator();
+
+  // throws std::runtime_error when the target cannot be resolved
+  Results Run();
+
+ private:
+  struct Connection {
+    int fd;
+    bool connecting;
+    bool slow;
+    bool draining;  // response done, waiting for the server to close
+    bool writing;   // EPOLLOUT registered
+    std::string out;
+    size_t out_pos;
+    std::deque<uint64_t> inflight;  // start time of each request sent
+    ResponseReader reader;
+    uint64_t last_activity_us;
+    uint64_t next_slow_us;
+    size_t sent;   // requests written on this connection
+    size_t index;  // position in conns_
+  };
+
+  LoadGenerator();
+  LoadGenerator(const LoadGenerator&);
+  LoadGenerator& operator=(const LoadGenerator&);
+
+  Connection* Open(bool slow);
+  void Close(Connection* conn);
+  void HandleClosed(Connection* conn, bool lost_head);
+  void Replenish();
+  void Assign();
+  void Issue(Connection* conn, uint64_t start_us);
+  void FillPipeline(Connection* conn);
+  void Flush(Connection* conn);
+  void UpdateEvents(Connection* conn);
+  void OnReadable(Connection* conn);
+  void OnWritable(Connection* conn);
+  void CompleteResponse(Connection* conn);
+  void TickSlow(uint64_t now);
+  void CheckTimeouts(uint64_t now);
+  void StartMeasuring();
+  int WaitTimeoutMs(uint64_t now) const;
+  bool Done() const;
+
+  const Options& options_;
+  std::string request_;
+  std::string slow_prefix_;
+  addrinfo* addr_;
+  int epoll_fd_;
+  std::vector<Connection*> conns_;
+  // closed during the current epoll batch; deleted after it
+  std::vector<Connection*> dead_;
+  // open loop: scheduled requests not sent yet; both loops: retries first
+  std::deque<uint64_t> pending_;
+  size_t regular_count_;
+  size_t slow_count_;
+  uint64_t measure_start_us_;
+  uint64_t end_us_;
+  uint64_t next_arrival_us_;
+  double arrival_interval_us_;
+  uint64_t next_timeout_check_us_;
+  bool measuring_;
+  uint64_t measured_;
+  Results results_;
+};
+
+}  // namespace loadgen
+
+#endif  // BENCH_LOADGEN_LOAD_GENERATOR_HPP_
@@ -0,0 +1,173 @@
+#include "Options.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace loadgen {
+
+namespace {
+
+const char* const kUsage =
+    "usage: loadgen [options] http://host:port/path\n"
+    "  -c N               connections (open loop: the most it may open)"
+    " [16]\n"
+    "  -d SEC             measured duration [10]\n"
+    "  -w SEC             warmup before measuring [0]\n"
+    "  -n N               stop after N measured responses\n"
+    "  -r RATE            open loop at RATE requests/s (default: closed"
+    " loop)\n"
+    "  -k                 keep-alive: reuse connections the server keeps"
+    " open\n"
+    "  -p DEPTH           pipeline DEPTH requests per connection"
+    " (implies -k) [1]\n"
+    "  -m METHOD          request method [GET]\n"
+    "  -H 'Name: value'   extra request header (repeatable)\n"
+    "  -b BYTES           send a body of BYTES bytes\n"
+    "  --chunked SIZE     send the body chunked, SIZE bytes per chunk\n"
+    "  --slowloris N      hold N more connections that never finish"
+    " their headers\n"
+    "  --slow-interval MS one header byte per slow connection every MS"
+    " [1000]\n"
+    "  --timeout MS       give up on a response after MS [5000]\n"
+    "  --server-pid PID   report server CPU per request and RSS\n"
+    "  --label NAME       scenario name in the report\n"
+    "  --json             print one JSON object instead of text\n";
+
+double ToDouble(const std::string& flag, const char* value) {
+  char* end = NULL;
+  const double d = std::strtod(value, &end);
+  if (*value == '\0' || *end != '\0' || d < 0) {
+    throw std::runtime_error("invalid value for " + flag + ": " + value);
+  }
+  return d;
+}
+
+size_t ToSize(const std::string& flag, const char* value) {
+  char* end = NULL;
+  const unsigned long n = std::strtoul(value, &end, 10);
+  if (*value == '\0' || *end != '\0' || *value == '-') {
+    throw std::runtime_error("invalid value for " + flag + ": " + value);
+  }
+  return static_cast<size_t>(n);
+}
+
+// http://host[:port][/path]
+void ParseUrl(const std::string& url, Options* options) {
+  const std::string scheme = "http://";
+  if (url.compare(0, scheme.size(), scheme) != 0) {
+    throw std::runtime_error("only http:// URLs are supported: " + url);
+  }
+  const std::string rest = url.substr(scheme.size());
+  const size_t slash = rest.find('/');
+  const std::string authority = rest.substr(0, slash);
+  options->path = slash == std::string::npos ? "/" : rest.substr(slash);
+  const size_t colon = authority.rfind(':');
+  if (colon == std::string::npos) {
+    options->host = authority;
+    options->port = "80";
+  } else {
+    options->host = authority.substr(0, colon);
+    options->port = authority.substr(colon + 1);
+  }
+  if (options->host.empty() || options->port.empty()) {
+    throw std::runtime_error("invalid URL: " + url);
+  }
+}
+
+}  // namespace
+
+Options::Options()
+    : host(),
+      port(),
+      path(),
+      connections(16),
+      duration_sec(10),
+      warmup_sec(0),
+      max_requests(0),
+      rate(0),
+      keep_alive(false),
+      pipeline(1),
+      method("GET"),
+      headers(),
+      body_size(0),
+      chunk_size(0),
+      slowloris(0),
+      slow_interval_ms(1000),
+      timeout_ms(5000),
+      server_pid(0),
+      label(),
+      json(false) {
+}
+
+Options ParseOptions(int argc, char** argv) {
+  Options options;
+  std::string url;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "-k") {
+      options.keep_alive = true;
+      continue;
+    }
+    if (arg == "--json") {
+      options.json = true;
+      continue;
+    }
+    if (arg[0] != '-') {
+      if (!url.empty()) throw std::runtime_error("more than one URL given");
+      url = arg;
+      continue;
+    }
+    if (i + 1 >= argc) throw std::runtime_error(arg + " needs a value");
+    const char* value = argv[++i];
+    if (arg == "-c") {
+      options.connections = ToSize(arg, value);
+    } else if (arg == "-d") {
+      options.duration_sec = ToDouble(arg, value);
+    } else if (arg == "-w") {
+      options.warmup_sec = ToDouble(arg, value);
+    } else if (arg == "-n") {
+      options.max_requests = ToSize(arg, value);
+    } else if (arg == "-r") {
+      options.rate = ToDouble(arg, value);
+    } else if (arg == "-p") {
+      options.pipeline = ToSize(arg, value);
+    } else if (arg == "-m") {
+      options.method = value;
+    } else if (arg == "-H") {
+      options.headers.push_back(value);
+    } else if (arg == "-b") {
+      options.body_size = ToSize(arg, value);
+    } else if (arg == "--chunked") {
+      options.chunk_size = ToSize(arg, value);
+    } else if (arg == "--slowloris") {
+      options.slowloris = ToSize(arg, value);
+    } else if (arg == "--slow-interval") {
+      options.slow_interval_ms = static_cast<int>(ToSize(arg, value));
+    } else if (arg == "--timeout") {
+      options.timeout_ms = static_cast<int>(ToSize(arg, value));
+    } else if (arg == "--server-pid") {
+      options.server_pid = static_cast<pid_t>(ToSize(arg, value));
+    } else if (arg == "--label") {
+      options.label = value;
+    } else {
+      throw std::runtime_error("unknown option: " + arg);
+    }
+  }
+  if (url.empty()) throw std::runtime_error("no URL given");
+  ParseUrl(url, &options);
+  if (options.connections == 0 || options.pipeline == 0) {
+    throw std::runtime_error("-c and -p must be at least 1");
+  }
+  if (options.pipeline > 1) options.keep_alive = true;
+  if (options.chunk_size != 0 && options.body_size == 0) {
+    throw std::runtime_error("--chunked needs a body (-b)");
+  }
+  return options;
+}
+
+const char* Usage() {
+  return kUsage;
+}
+
+}  // namespace loadgen
@@ -0,0 +1,43 @@
+#ifndef BENCH_LOADGEN_OPTIONS_HPP_
+#define BENCH_LOADGEN_OPTIONS_HPP_
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace loadgen {
+
+struct Options {
+  std::string host;
+  std::string port;
+  std::string path;
+  size_t connections;  // closed loop: connections; open loop: the cap
+  double duration_sec;
+  double warmup_sec;  // responses before this are not recorded
+  size_t max_requests;  // 0: until the duration ends
+  double rate;  // open loop requests per second (0: closed loop)
+  bool keep_alive;
+  size_t pipeline;  // requests in flight per connection
+  std::string method;
+  std::vector<std::string> headers;
+  size_t body_size;
+  size_t chunk_size;  // 0: Content-Length body
+  size_t slowloris;   // extra connections trickling headers
+  int slow_interval_ms;
+  int timeout_ms;
+  pid_t server_pid;  // 0: no server CPU/RSS report
+  std::string label;
+  bool json;
+
+  Options();
+};
+
+// throws std::runtime_error with a message suitable for the usage line
+Options ParseOptions(int argc, char** argv);
+const char* Usage();
+
+}  // namespace loadgen
+
+#endif  // BENCH_LOADGEN_OPTIONS_HPP_
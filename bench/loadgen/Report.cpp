@@ -0,0 +1,199 @@
+#include "Report.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace loadgen {
+
+namespace {
+
+struct Summary {
+  uint64_t requests;
+  uint64_t errors;  // non-2xx/3xx responses
+  double rps;
+  double mbps;
+  uint32_t p50;
+  uint32_t p90;
+  uint32_t p99;
+  uint32_t p999;
+  uint32_t max;
+  double mean;
+  double server_cpu_us;  // per request, -1 when unknown
+  double client_cpu_us;
+};
+
+// nearest-rank percentile of sorted values
+uint32_t Percentile(const std::vector<uint32_t>& sorted, double q) {
+  if (sorted.empty()) return 0;
+  size_t rank = static_cast<size_t>(q * sorted.size() + 0.5);
+  if (rank == 0) rank = 1;
+  if (rank > sorted.size()) rank = sorted.size();
+  return sorted[rank - 1];
+}
+
+double CpuPerRequestUs(const ProcessStats& before, const ProcessStats& after,
+                       uint64_t requests) {
+  if (!before.valid || !after.valid || requests == 0) return -1;
+  return (after.cpu_sec - before.cpu_sec) * 1e6 / requests;
+}
+
+Summary Summarize(Results* r) {
+  std::sort(r->latencies_us.begin(), r->latencies_us.end());
+  const std::vector<uint32_t>& lat = r->latencies_us;
+  Summary s;
+  s.requests = lat.size();
+  s.errors = 0;
+  for (std::map<int, uint64_t>::const_iterator it = r->statuses.begin();
+       it != r->statuses.end(); ++it) {
+    if (it->first >= 400) s.errors += it->second;
+  }
+  const double elapsed = r->elapsed_sec > 0 ? r->elapsed_sec : 1;
+  s.rps = s.requests / elapsed;
+  s.mbps = r->bytes_received / elapsed / (1024.0 * 1024.0);
+  s.p50 = Percentile(lat, 0.50);
+  s.p90 = Percentile(lat, 0.90);
+  s.p99 = Percentile(lat, 0.99);
+  s.p999 = Percentile(lat, 0.999);
+  s.max = lat.empty() ? 0 : lat.back();
+  double sum = 0;
+  for (size_t i = 0; i < lat.size(); ++i) sum += lat[i];
+  s.mean = lat.empty() ? 0 : sum / lat.size();
+  s.server_cpu_us =
+      CpuPerRequestUs(r->server_before, r->server_after, s.requests);
+  s.client_cpu_us =
+      CpuPerRequestUs(r->client_before, r->client_after, s.requests);
+  return s;
+}
+
+ProcessStats ReadStats(const std::string& proc_dir) {
+  ProcessStats stats;
+  std::ifstream stat_file((proc_dir + "/stat").c_str());
+  std::string line;
+  if (!std::getline(stat_file, line)) return stats;
+  // the command name may contain spaces; fields restart after ')'
+  const size_t paren = line.rfind(')');
+  if (paren == std::string::npos) return stats;
+  std::istringstream fields(line.substr(paren + 2));
+  std::string field;
+  unsigned long utime = 0;
+  unsigned long stime = 0;
+  // state is field 3; utime and stime are fields 14 and 15
+  for (int n = 3; n <= 15 && fields >> field; ++n) {
+    if (n == 14) utime = std::strtoul(field.c_str(), NULL, 10);
+    if (n == 15) stime = std::strtoul(field.c_str(), NULL, 10);
+  }
+  stats.cpu_sec = static_cast<double>(utime + stime) / sysconf(_SC_CLK_TCK);
+
+  std::ifstream status_file((proc_dir + "/status").c_str());
+  while (std::getline(status_file, line)) {
+    if (line.compare(0, 6, "VmRSS:") == 0) {
+      stats.rss_kb = std::atol(line.c_str() + 6);
+    } else if (line.compare(0, 6, "VmHWM:") == 0) {
+      stats.peak_rss_kb = std::atol(line.c_str() + 6);
+    }
+  }
+  stats.valid = true;
+  return stats;
+}
+
+}  // namespace
+
+ProcessStats::ProcessStats()
+    : valid(false), cpu_sec(0), rss_kb(0), peak_rss_kb(0) {
+}
+
+ProcessStats ReadProcessStats(pid_t pid) {
+  std::ostringstream dir;
+  dir << "/proc/" << pid;
+  return ReadStats(dir.str());
+}
+
+ProcessStats ReadSelfStats() {
+  return ReadStats("/proc/self");
+}
+
+Results::Results()
+    : elapsed_sec(0),
+      latencies_us(),
+      statuses(),
+      bytes_received(0),
+      connections_opened(0),
+      connect_errors(0),
+      read_errors(0),
+      timeouts(0),
+      retried(0),
+      slow_held(0),
+      slow_closed(0) {
+}
+
+std::string RenderText(const Options& options, Results* results) {
+  const Summary s = Summarize(results);
+  std::ostringstream oss;
+  oss.setf(std::ios::fixed);
+  oss.precision(1);
+  if (!options.label.empty()) oss << "scenario: " << options.label << '\n';
+  oss << "requests:   " << s.requests << " in " << results->elapsed_sec
+      << "s, " << s.rps << " req/s, " << s.mbps << " MiB/s\n";
+  oss << "latency us: p50 " << s.p50 << "  p90 " << s.p90 << "  p99 "
+      << s.p99 << "  p999 " << s.p999 << "  max " << s.max << "  mean "
+      << s.mean << '\n';
+  oss << "statuses:  ";
+  for (std::map<int, uint64_t>::const_iterator it = results->statuses.begin();
+       it != results->statuses.end(); ++it) {
+    oss << ' ' << it->first << '=' << it->second;
+  }
+  oss << '\n';
+  oss << "errors:     connect " << results->connect_errors << ", read "
+      << results->read_errors << ", timeout " << results->timeouts
+      << ", retried " << results->retried << ", connections "
+      << results->connections_opened << '\n';
+  if (options.slowloris != 0) {
+    oss << "slowloris:  " << results->slow_held << " held, "
+        << results->slow_closed << " closed by the server\n";
+  }
+  if (s.server_cpu_us >= 0) {
+    oss << "server:     " << s.server_cpu_us << " us CPU/request, rss "
+        << results->server_after.rss_kb << " kB (peak "
+        << results->server_after.peak_rss_kb << " kB)\n";
+  }
+  if (s.client_cpu_us >= 0) {
+    oss << "client:     " << s.client_cpu_us << " us CPU/request\n";
+  }
+  return oss.str();
+}
+
+std::string RenderJson(const Options& options, Results* results) {
+  const Summary s = Summarize(results);
+  std::ostringstream oss;
+  oss << "{\"label\":\"" << options.label << "\",\"requests\":" << s.requests
+      << ",\"elapsed_sec\":" << results->elapsed_sec << ",\"rps\":" << s.rps
+      << ",\"mib_per_sec\":" << s.mbps << ",\"p50_us\":" << s.p50
+      << ",\"p90_us\":" << s.p90 << ",\"p99_us\":" << s.p99
+      << ",\"p999_us\":" << s.p999 << ",\"max_us\":" << s.max
+      << ",\"mean_us\":" << s.mean << ",\"error_responses\":" << s.errors
+      << ",\"connect_errors\":" << results->connect_errors
+      << ",\"read_errors\":" << results->read_errors
+      << ",\"timeouts\":" << results->timeouts
+      << ",\"retried\":" << results->retried
+      << ",\"connections\":" << results->connections_opened;
+  if (options.slowloris != 0) {
+    oss << ",\"slowloris_held\":" << results->slow_held
+        << ",\"slowloris_closed\":" << results->slow_closed;
+  }
+  if (s.server_cpu_us >= 0) {
+    oss << ",\"server_cpu_us_per_request\":" << s.server_cpu_us
+        << ",\"server_rss_kb\":" << results->server_after.rss_kb
+        << ",\"server_peak_rss_kb\":" << results->server_after.peak_rss_kb;
+  }
+  if (s.client_cpu_us >= 0) {
+    oss << ",\"client_cpu_us_per_request\":" << s.client_cpu_us;
+  }
+  oss << "}\n";
+  return oss.str();
+}
+
+}  // namespace loadgen
@@ -0,0 +1,55 @@
+#ifndef BENCH_LOADGEN_REPORT_HPP_
+#define BENCH_LOADGEN_REPORT_HPP_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Options.hpp"
+
+namespace loadgen {
+
+// CPU seconds (user + system) and memory of a process
+struct ProcessStats {
+  bool valid;
+  double cpu_sec;
+  long rss_kb;
+  long peak_rss_kb;
+
+  ProcessStats();
+};
+
+// /proc/<pid>; valid is false when the process cannot be read
+ProcessStats ReadProcessStats(pid_t pid);
+ProcessStats ReadSelfStats();
+
+struct Results {
+  double elapsed_sec;  // measured window
+  std::vector<uint32_t> latencies_us;
+  std::map<int, uint64_t> statuses;
+  uint64_t bytes_received;
+  uint64_t connections_opened;
+  uint64_t connect_errors;
+  uint64_t read_errors;  // reset or malformed response
+  uint64_t timeouts;
+  uint64_t retried;  // pipelined requests re-sent after the server closed
+  uint64_t slow_held;  // slowloris connections open at the end
+  uint64_t slow_closed;  // slowloris connections the server closed
+  ProcessStats server_before;
+  ProcessStats server_after;
+  ProcessStats client_before;
+  ProcessStats client_after;
+
+  Results();
+};
+
+// sorts latencies_us
+std::string RenderText(const Options& options, Results* results);
+std::string RenderJson(const Options& options, Results* results);
+
+}  // namespace loadgen
+
+#endif  // BENCH_LOADGEN_REPORT_HPP_
@@ -0,0 +1,51 @@
+#include "Request.hpp"
+
+#include <sstream>
+
+namespace loadgen {
+
+namespace {
+
+std::string Head(const Options& options) {
+  std::string head = options.method + " " + options.path + " HTTP/1.1\r\n";
+  head += "Host: " + options.host + ":" + options.port + "\r\n";
+  head += "User-Agent: webserv-loadgen\r\n";
+  for (size_t i = 0; i < options.headers.size(); ++i) {
+    head += options.headers[i] + "\r\n";
+  }
+  return head;
+}
+
+}  // namespace
+
+std::string BuildRequest(const Options& options) {
+  std::ostringstream oss;
+  oss << Head(options);
+  oss << "Connection: " << (options.keep_alive ? "keep-alive" : "close")
+      << "\r\n";
+  if (options.body_size == 0) {
+    oss << "\r\n";
+    return oss.str();
+  }
+  if (options.chunk_size == 0) {
+    oss << "Content-Length: " << options.body_size << "\r\n\r\n"
+        << std::string(options.body_size, 'x');
+    return oss.str();
+  }
+  oss << "Transfer-Encoding: chunked\r\n\r\n";
+  size_t left = options.body_size;
+  while (left > 0) {
+    const size_t n = left < options.chunk_size ? left : options.chunk_size;
+    oss << std::hex << n << std::dec << "\r\n"
+        << std::string(n, 'x') << "\r\n";
+    left -= n;
+  }
+  oss << "0\r\n\r\n";
+  return oss.str();
+}
+
+std::string BuildSlowPrefix(const Options& options) {
+  return Head(options) + "X-Slow: ";
+}
+
+}  // namespace loadgen
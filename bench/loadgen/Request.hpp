@@ -0,0 +1,19 @@
+#ifndef BENCH_LOADGEN_REQUEST_HPP_
+#define BENCH_LOADGEN_REQUEST_HPP_
+
+#include <string>
+
+#include "Options.hpp"
+
+namespace loadgen {
+
+// the bytes of one request, sent unchanged for every request of a run
+std::string BuildRequest(const Options& options);
+
+// a request line and headers without the terminating empty line; slowloris
+// connections send it, then keep adding header bytes
+std::string BuildSlowPrefix(const Options& options);
+
+}  // namespace loadgen
+
+#endif  // BENCH_LOADGEN_REQUEST_HPP_
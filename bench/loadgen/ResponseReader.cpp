@@ -0,0 +1,186 @@
+#include "ResponseReader.hpp"
+
+#include <cctype>
+#include <cstdlib>
+
+namespace loadgen {
+
+namespace {
+
+std::string Lower(std::string s) {
+  for (size_t i = 0; i < s.size(); ++i) {
+    s[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(s[i])));
+  }
+  return s;
+}
+
+std::string Trim(const std::string& s) {
+  const size_t begin = s.find_first_not_of(" \t");
+  if (begin == std::string::npos) return "";
+  const size_t end = s.find_last_not_of(" \t\r");
+  return s.substr(begin, end - begin + 1);
+}
+
+}  // namespace
+
+const size_t ResponseReader::kMaxHeadSize;
+
+ResponseReader::ResponseReader() {
+  Reset();
+}
+
+void ResponseReader::Reset() {
+  state_ = kHead;
+  head_.clear();
+  line_.clear();
+  content_left_ = 0;
+  status_ = 0;
+  keep_alive_ = true;
+  started_ = false;
+}
+
+int ResponseReader::Status() const {
+  return status_;
+}
+
+bool ResponseReader::KeepAlive() const {
+  return keep_alive_;
+}
+
+bool ResponseReader::Started() const {
+  return started_;
+}
+
+ResponseReader::Result ResponseReader::Feed(const char* data, size_t len,
+                                            size_t* used) {
+  size_t pos = 0;
+  if (len > 0) started_ = true;
+  while (pos < len && state_ != kDone) {
+    switch (state_) {
+      case kHead: {
+        const size_t old = head_.size();
+        head_.append(data + pos, len - pos);
+        const size_t end = head_.find("\r\n\r\n");
+        if (end == std::string::npos) {
+          if (head_.size() > kMaxHeadSize) return kError;
+          pos = len;
+          break;
+        }
+        pos += end + 4 - old;
+        head_.resize(end + 4);
+        if (ParseHead() == kError) return kError;
+        break;
+      }
+      case kBody:
+      case kChunkData: {
+        const size_t n = len - pos < content_left_ ? len - pos : content_left_;
+        pos += n;
+        content_left_ -= n;
+        if (content_left_ == 0) {
+          state_ = state_ == kBody ? kDone : kChunkCrlf;
+        }
+        break;
+      }
+      case kChunkCrlf:
+      case kChunkSize:
+      case kTrailer: {
+        std::string line;
+        if (!ReadLine(data, len, &pos, &line)) break;
+        if (state_ == kChunkCrlf) {
+          if (!line.empty()) return kError;
+          state_ = kChunkSize;
+        } else if (state_ == kChunkSize) {
+          char* end = NULL;
+          content_left_ = std::strtoul(line.c_str(), &end, 16);
+          if (end == line.c_str()) return kError;
+          state_ = content_left_ == 0 ? kTrailer : kChunkData;
+        } else if (line.empty()) {
+          state_ = kDone;
+        }
+        break;
+      }
+      case kUntilClose:
+        pos = len;
+        break;
+      case kDone:
+        break;
+    }
+  }
+  *used = pos;
+  return state_ == kDone ? kComplete : kNeedMore;
+}
+
+ResponseReader::Result ResponseReader::OnEof() {
+  if (state_ == kUntilClose) {
+    state_ = kDone;
+    keep_alive_ = false;
+    return kComplete;
+  }
+  return state_ == kDone ? kComplete : kError;
+}
+
+// "HTTP/1.1 200 OK" and the framing headers
+ResponseReader::Result ResponseReader::ParseHead() {
+  if (head_.compare(0, 5, "HTTP/") != 0) return kError;
+  const size_t sp = head_.find(' ');
+  if (sp == std::string::npos) return kError;
+  status_ = std::atoi(head_.c_str() + sp + 1);
+  if (status_ < 100 || status_ > 599) return kError;
+  keep_alive_ = head_.compare(0, 8, "HTTP/1.0") != 0;
+
+  bool has_length = false;
+  bool chunked = false;
+  size_t line_start = head_.find("\r\n") + 2;
+  while (line_start + 2 < head_.size()) {
+    const size_t line_end = head_.find("\r\n", line_start);
+    const std::string line = head_.substr(line_start, line_end - line_start);
+    line_start = line_end + 2;
+    const size_t colon = line.find(':');
+    if (colon == std::string::npos) continue;
+    const std::string name = Lower(line.substr(0, colon));
+    const std::string value = Lower(Trim(line.substr(colon + 1)));
+    if (name == "content-length") {
+      content_left_ = std::strtoul(value.c_str(), NULL, 10);
+      has_length = true;
+    } else if (name == "transfer-encoding") {
+      chunked = value.find("chunked") != std::string::npos;
+    } else if (name == "connection") {
+      if (value == "close") keep_alive_ = false;
+      if (value == "keep-alive") keep_alive_ = true;
+    }
+  }
+  if (status_ / 100 == 1 || status_ == 204 || status_ == 304) {
+    state_ = kDone;
+  } else if (chunked) {
+    state_ = kChunkSize;
+  } else if (has_length) {
+    state_ = content_left_ == 0 ? kDone : kBody;
+  } else {
+    state_ = kUntilClose;
+  }
+  return kNeedMore;
+}
+
+// a CRLF-terminated line, possibly split across reads
+bool ResponseReader::ReadLine(const char* data, size_t len, size_t* pos,
+                              std::string* line) {
+  while (*pos < len) {
+    const char c = data[(*pos)++];
+    if (c == '\n') {
+      if (!line_.empty() && line_[line_.size() - 1] == '\r') {
+        line_.erase(line_.size() - 1);
+      }
+      line->swap(line_);
+      line_.clear();
+      return true;
+    }
+    line_.push_back(c);
+    if (line_.size() > kMaxHeadSize) {
+      line_.clear();
+      return false;
+    }
+  }
+  return false;
+}
+
+}  // namespace loadgen
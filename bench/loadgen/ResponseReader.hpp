@@ -0,0 +1,61 @@
+#ifndef BENCH_LOADGEN_RESPONSE_READER_HPP_
+#define BENCH_LOADGEN_RESPONSE_READER_HPP_
+
+#include <cstddef>
+#include <string>
+
+namespace loadgen {
+
+/*
+Incremental HTTP/1.1 response parser: just enough framing to find where a
+response ends (Content-Length, chunked, or until the server closes) and
+whether the server will keep the connection open.
+*/
+class ResponseReader {
+ public:
+  enum Result { kNeedMore, kComplete, kError };
+
+  ResponseReader();
+
+  // consumes bytes of the current response from data; *used is how many
+  // (the rest belongs to the next pipelined response)
+  Result Feed(const char* data, size_t len, size_t* used);
+  // the server closed: completes a response delimited by the close
+  Result OnEof();
+  // ready for the next response on the same connection
+  void Reset();
+
+  int Status() const;
+  bool KeepAlive() const;
+  bool Started() const;  // some bytes of this response arrived
+
+ private:
+  enum State {
+    kHead,
+    kBody,        // content_left_ bytes
+    kChunkSize,   // reading a chunk-size line
+    kChunkData,   // content_left_ bytes, then CRLF
+    kChunkCrlf,
+    kTrailer,     // lines until an empty one
+    kUntilClose,
+    kDone
+  };
+
+  Result ParseHead();
+  bool ReadLine(const char* data, size_t len, size_t* pos,
+                std::string* line);
+
+  State state_;
+  std::string head_;
+  std::string line_;
+  size_t content_left_;
+  int status_;
+  bool keep_alive_;
+  bool started_;
+
+  static const size_t kMaxHeadSize = 64 * 1024;
+};
+
+}  // namespace loadgen
+
+#endif  // BENCH_LOADGEN_RESPONSE_READER_HPP_
@@ -0,0 +1,28 @@
+#include <csignal>
+#include <exception>
+#include <iostream>
+
+#include "LoadGenerator.hpp"
+#include "Options.hpp"
+#include "Report.hpp"
+
+int main(int argc, char** argv) {
+  loadgen::Options options;
+  try {
+    options = loadgen::ParseOptions(argc, argv);
+  } catch (const std::exception& e) {
+    std::cerr << "loadgen: " << e.what() << "\n" << loadgen::Usage();
+    return 2;
+  }
+  std::signal(SIGPIPE, SIG_IGN);
+  try {
+    loadgen::LoadGenerator generator(options);
+    loadgen::Results results = generator.Run();
+    std::cout << (options.json ? loadgen::RenderJson(options, &results)
+                               : loadgen::RenderText(options, &results));
+    return results.latencies_us.empty() ? 1 : 0;
+  } catch (const std::exception& e) {
+    std::cerr << "loadgen: " << e.what() << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,25 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "CgiResponseParser.hpp"
+#include "HttpResponse.hpp"
+
+// CGI output with a handful of headers and a range(0)-byte body
+static void BM_CgiResponseParser_Parse(benchmark::State& state) {
+  const std::string output =
+      "Status: 200 OK\r\n"
+      "Content-Type: text/html; charset=utf-8\r\n"
+      "Cache-Control: no-store\r\n"
+      "X-Powered-By: Python/3.11\r\n"
+      "Set-Cookie: sid=0123456789abcdef; Path=/; HttpOnly\r\n"
+      "\r\n" +
+      std::string(static_cast<size_t>(state.range(0)), 'x');
+  for (auto _ : state) {
+    HttpResponse res = cgi::ParseCgiResponse(output);
+    benchmark::DoNotOptimize(res.GetBodySize());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(output.size()));
+}
+BENCHMARK(BM_CgiResponseParser_Parse)->Arg(64)->Arg(4096)->Arg(65536);
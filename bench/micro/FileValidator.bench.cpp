@@ -0,0 +1,39 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "FileValidator.hpp"
+
+static void BM_FileValidator_ValidateAndNormalizePath(
+    benchmark::State& state) {
+  const std::string root = "/var/www/html";
+  const std::string path = state.range(0) == 0
+                               ? root + "/index.html"
+                               : root + "//static/./css/../css//v2/./site.css";
+  for (auto _ : state) {
+    try {
+      std::string normalized =
+          FileValidator::ValidateAndNormalizePath(path, root);
+      benchmark::DoNotOptimize(normalized.data());
+    } catch (...) {
+      // ".." segments are rejected: that path is the error path
+    }
+  }
+}
+// 0: clean path, 1: redundant slashes, "." and a rejected ".." segment
+BENCHMARK(BM_FileValidator_ValidateAndNormalizePath)->Arg(0)->Arg(1);
+
+static void BM_FileValidator_DeepPath(benchmark::State& state) {
+  const std::string root = "/srv/data";
+  std::string path = root;
+  for (int i = 0; i < state.range(0); ++i) {
+    path += "/segment";
+    path += static_cast<char>('a' + i % 26);
+  }
+  for (auto _ : state) {
+    std::string normalized =
+        FileValidator::ValidateAndNormalizePath(path, root);
+    benchmark::DoNotOptimize(normalized.data());
+  }
+}
+BENCHMARK(BM_FileValidator_DeepPath)->Arg(4)->Arg(32);
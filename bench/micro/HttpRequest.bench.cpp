@@ -0,0 +1,102 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "HttpRequest.hpp"
+
+// Browser-like GET: request line plus the headers a real client sends.
+static std::string MakeGetRequest() {
+  return "GET /static/css/site.min.css?v=20240101 HTTP/1.1\r\n"
+         "Host: www.example.com\r\n"
+         "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:120.0) "
+         "Gecko/20100101 Firefox/120.0\r\n"
+         "Accept: text/css,*/*;q=0.1\r\n"
+         "Accept-Language: en-US,en;q=0.5\r\n"
+         "Accept-Encoding: gzip, deflate, br\r\n"
+         "Referer: http://www.example.com/index.html\r\n"
+         "Cookie: session=0123456789abcdef0123456789abcdef; theme=dark\r\n"
+         "Cache-Control: no-cache\r\n"
+         "Connection: keep-alive\r\n"
+         "\r\n";
+}
+
+// ~4 KB: headers plus a Content-Length body, so 1 KB fragments split it.
+static std::string MakePostRequest() {
+  const std::string body(3072, 'x');
+  return "POST /upload/form HTTP/1.1\r\n"
+         "Host: www.example.com\r\n"
+         "User-Agent: curl/8.5.0\r\n"
+         "Accept: */*\r\n"
+         "Content-Type: application/octet-stream\r\n"
+         "Content-Length: 3072\r\n"
+         "\r\n" +
+         body;
+}
+
+// chunked POST whose body is total bytes in chunks of chunk bytes
+static std::string MakeChunkedRequest(size_t total, size_t chunk) {
+  std::string req =
+      "POST /upload/stream HTTP/1.1\r\n"
+      "Host: www.example.com\r\n"
+      "Transfer-Encoding: chunked\r\n"
+      "\r\n";
+  char size_line[32];
+  for (size_t sent = 0; sent < total; sent += chunk) {
+    const size_t n = total - sent < chunk ? total - sent : chunk;
+    const int len = snprintf(size_line, sizeof(size_line), "%zx\r\n", n);
+    req.append(size_line, len);
+    req.append(n, 'x');
+    req.append("\r\n");
+  }
+  req.append("0\r\n\r\n");
+  return req;
+}
+
+// feeds raw to a fresh parser in fragment-byte pieces (0: all at once)
+static void ParseFragmented(benchmark::State& state, const std::string& raw) {
+  const size_t fragment =
+      state.range(0) == 0 ? raw.size() : static_cast<size_t>(state.range(0));
+  for (auto _ : state) {
+    HttpRequest req;
+    for (size_t pos = 0; pos < raw.size(); pos += fragment) {
+      const size_t n = raw.size() - pos < fragment ? raw.size() - pos
+                                                   : fragment;
+      req.Parse(raw.data() + pos, n);
+    }
+    if (!req.IsDone()) state.SkipWithError("request not complete");
+    benchmark::DoNotOptimize(req.GetBody().data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(raw.size()));
+}
+
+static void BM_HttpRequest_ParseGet(benchmark::State& state) {
+  ParseFragmented(state, MakeGetRequest());
+}
+BENCHMARK(BM_HttpRequest_ParseGet)->Arg(1)->Arg(1024)->Arg(0);
+
+static void BM_HttpRequest_ParsePost(benchmark::State& state) {
+  ParseFragmented(state, MakePostRequest());
+}
+BENCHMARK(BM_HttpRequest_ParsePost)->Arg(1)->Arg(1024)->Arg(0);
+
+// AdvanceChunkedBody: 64 KB body in chunks of range(0) bytes, fed in 1 KB
+// reads the way a socket delivers it
+static void BM_HttpRequest_ParseChunkedBody(benchmark::State& state) {
+  const std::string raw =
+      MakeChunkedRequest(64 * 1024, static_cast<size_t>(state.range(0)));
+  const size_t fragment = 1024;
+  for (auto _ : state) {
+    HttpRequest req;
+    for (size_t pos = 0; pos < raw.size(); pos += fragment) {
+      const size_t n = raw.size() - pos < fragment ? raw.size() - pos
+                                                   : fragment;
+      req.Parse(raw.data() + pos, n);
+    }
+    if (!req.IsDone()) state.SkipWithError("request not complete");
+    benchmark::DoNotOptimize(req.GetBody().data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(raw.size()));
+}
+BENCHMARK(BM_HttpRequest_ParseChunkedBody)->Arg(64)->Arg(1024)->Arg(16384);
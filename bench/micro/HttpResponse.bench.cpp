@@ -0,0 +1,32 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "HttpResponse.hpp"
+#include "lib/http/Status.hpp"
+
+// typical static-file response with a range(0)-byte body
+static void BM_HttpResponse_ToHttpString(benchmark::State& state) {
+  HttpResponse res(lib::http::kOk);
+  res.AddHeader("Content-Type", "text/html");
+  res.AddHeader("Last-Modified", "Mon, 01 Jan 2024 00:00:00 GMT");
+  res.AddHeader("ETag", "\"65920080-400\"");
+  res.AddHeader("Accept-Ranges", "bytes");
+  res.AddHeader("Cache-Control", "max-age=3600");
+  res.SetBody(std::string(static_cast<size_t>(state.range(0)), 'x'));
+  for (auto _ : state) {
+    std::string wire = res.ToHttpString();
+    benchmark::DoNotOptimize(wire.data());
+  }
+}
+BENCHMARK(BM_HttpResponse_ToHttpString)->Arg(0)->Arg(1024)->Arg(65536);
+
+static void BM_HttpResponse_DefaultErrorPage(benchmark::State& state) {
+  for (auto _ : state) {
+    HttpResponse res(lib::http::kNotFound);
+    res.EnsureDefaultErrorContent();
+    std::string wire = res.ToHttpString();
+    benchmark::DoNotOptimize(wire.data());
+  }
+}
+BENCHMARK(BM_HttpResponse_DefaultErrorPage);
@@ -0,0 +1,50 @@
+#include <benchmark/benchmark.h>
+
+#include <sstream>
+#include <string>
+
+#include "ConfigParser.hpp"
+#include "LocationMatch.hpp"
+#include "ServerConfig.hpp"
+
+// server with "/" plus count locations /api/v<i>/svc<i>, half of them with
+// a nested /api/v<i>/svc<i>/admin
+static ServerConfig MakeServer(long count) {
+  std::ostringstream conf;
+  conf << "{ listen 8080; location / { root /www; } ";
+  for (long i = 0; i < count; ++i) {
+    conf << "location /api/v" << i % 8 << "/svc" << i << " { root /srv; } ";
+    if (i % 2 == 0) {
+      conf << "location /api/v" << i % 8 << "/svc" << i
+           << "/admin { root /adm; } ";
+    }
+  }
+  conf << "}";
+  ConfigParser parser;
+  parser.content = conf.str();
+  parser.ParseServer();
+  return parser.GetServerConfigs()[0];
+}
+
+static void FindLocation(benchmark::State& state, const std::string& uri) {
+  const ServerConfig server = MakeServer(state.range(0));
+  for (auto _ : state) {
+    LocationMatch m = server.FindLocationForUri(uri);
+    benchmark::DoNotOptimize(m.loc);
+  }
+}
+
+// longest match is a nested location near the end of the table
+static void BM_ServerConfig_FindLocationDeep(benchmark::State& state) {
+  std::ostringstream uri;
+  const long last = (state.range(0) - 1) & ~1L;
+  uri << "/api/v" << last % 8 << "/svc" << last << "/admin/users/42";
+  FindLocation(state, uri.str());
+}
+BENCHMARK(BM_ServerConfig_FindLocationDeep)->Arg(8)->Arg(256)->Arg(4096);
+
+// nothing but "/" matches
+static void BM_ServerConfig_FindLocationFallback(benchmark::State& state) {
+  FindLocation(state, "/assets/img/logo.png");
+}
+BENCHMARK(BM_ServerConfig_FindLocationFallback)->Arg(8)->Arg(256)->Arg(4096);
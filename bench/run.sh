@@ -0,0 +1,78 @@
+#!/bin/sh
+# Builds the optimized server and the load generator, then runs every
+# scenario against demo/conf/bench.conf.
+#
+# usage: bench/run.sh [-d SEC] [-c CONNECTIONS] [--json] [scenario...]
+# scenarios: small_static large_static not_found chunked_upload cgi_get
+#            cgi_post slowloris (default: all)
+set -e
+
+cd "$(dirname "$0")/.."
+
+DURATION=10
+WARMUP=2
+CONNECTIONS=32
+FORMAT=
+while [ $# -gt 0 ]; do
+  case "$1" in
+    -d) DURATION="$2"; shift 2 ;;
+    -c) CONNECTIONS="$2"; shift 2 ;;
+    --json) FORMAT=--json; shift ;;
+    *) break ;;
+  esac
+done
+SCENARIOS="${*:-small_static large_static not_found chunked_upload cgi_get \
+cgi_post slowloris}"
+
+CONF=demo/conf/bench.conf
+SITE=demo/static_sites/bench_site
+URL=http://127.0.0.1:8090
+LOADGEN=bench/build/loadgen
+
+make bench >/dev/null
+
+mkdir -p "$SITE/upload"
+if [ ! -f "$SITE/large.bin" ]; then
+  head -c 8388608 /dev/urandom > "$SITE/large.bin"
+fi
+
+bench/build/webserv "$CONF" >/dev/null 2>&1 &
+SERVER_PID=$!
+trap 'kill "$SERVER_PID" 2>/dev/null; wait "$SERVER_PID" 2>/dev/null' EXIT
+sleep 0.5
+if ! kill -0 "$SERVER_PID" 2>/dev/null; then
+  echo "bench: webserv did not start" >&2
+  exit 1
+fi
+
+run() {
+  label="$1"
+  shift
+  "$LOADGEN" -d "$DURATION" -w "$WARMUP" --server-pid "$SERVER_PID" \
+    --label "$label" $FORMAT "$@" || true
+  [ -n "$FORMAT" ] || echo
+}
+
+for scenario in $SCENARIOS; do
+  case "$scenario" in
+    small_static)
+      run small_static -c "$CONNECTIONS" "$URL/small.html" ;;
+    large_static)
+      run large_static -c 4 "$URL/large.bin" ;;
+    not_found)
+      run not_found -c "$CONNECTIONS" "$URL/missing.html" ;;
+    chunked_upload)
+      run chunked_upload -c 8 -m POST -b 262144 --chunked 16384 \
+        "$URL/upload/sink.bin" ;;
+    cgi_get)
+      run cgi_get -c 8 "$URL/cgi/hello.py" ;;
+    cgi_post)
+      run cgi_post -c 8 -m POST -b 4096 "$URL/cgi/hello_post.py" ;;
+    slowloris)
+      run slowloris -c "$CONNECTIONS" --slowloris 512 --slow-interval 1000 \
+        "$URL/small.html" ;;
+    *)
+      echo "bench: unknown scenario $scenario" >&2
+      exit 2 ;;
+  esac
+done
@@ -0,0 +1,131 @@
+#ifndef CGI_CACHE_HPP_
+#define CGI_CACHE_HPP_
+
+#include <cstddef>
+#include <ctime>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "HttpResponse.hpp"
+#include "event/Poller.hpp"
+#include "lib/type/SharedPtr.hpp"
+
+namespace cgi {
+
+/*
+Micro-cache of one CGI location (cgi_cache): whole GET responses kept for
+their TTL under a key rendered from the request (cgi_cache_key). Only one
+request per key runs the script at a time (a fill); misses meanwhile wait
+for its result instead of starting the script again. An entry past its
+TTL may still be served for stale seconds, while a single request
+refreshes it. Oldest entries go first beyond max_entries. Loop thread only.
+*/
+class CgiCache {
+ public:
+  struct Entry {
+    HttpResponse head;  // status and headers
+    lib::type::SharedPtr<const std::string> body;
+    time_t stored_at;
+    time_t expires_at;
+
+    Entry();
+  };
+
+  // a request waiting for another one's fill
+  class Waiter {
+   public:
+    virtual ~Waiter() {
+    }
+    // the fill ended, stored or not; look the key up again
+    virtual void OnCacheFilled(event::Poller& poller) = 0;
+  };
+
+  enum Freshness { kFresh, kStale, kAbsent };
+
+  CgiCache(size_t max_entries, int stale_seconds);
+
+  // kFresh / kStale copy the entry out; entries too old even to be served
+  // stale are dropped
+  Freshness Find(const std::string& key, time_t now, Entry* entry);
+  bool IsFilling(const std::string& key) const;
+  void BeginFill(const std::string& key);
+  // waits for the key's fill, which must be running
+  void Wait(const std::string& key, Waiter* waiter);
+  void Cancel(Waiter* waiter);
+  // entry NULL: nothing to store (script failed, response not cacheable);
+  // wakes the fill's waiters either way
+  void EndFill(event::Poller& poller, const std::string& key,
+               const Entry* entry);
+  // without a poller (shutdown): the waiters are dropped
+  void AbandonFill(const std::string& key);
+
+  size_t Size() const;
+
+ private:
+  CgiCache();
+  CgiCache(const CgiCache& other);
+  CgiCache& operator=(const CgiCache& other);
+
+  struct Slot {
+    Entry entry;
+    std::list<std::string>::iterator order;
+  };
+  typedef std::map<std::string, Slot> EntryMap;
+  typedef std::map<std::string, std::vector<Waiter*> > FillMap;
+
+  void Erase(EntryMap::iterator it);
+
+  size_t max_entries_;
+  int stale_seconds_;
+  EntryMap entries_;
+  std::list<std::string> order_;  // oldest store first
+  FillMap fills_;
+};
+
+/*
+Collects one script's output for the cache: the header block parsed by
+CgiResponseParser, then the body. The response is stored only if the
+script exited cleanly and ResponseTtl() allows it; a body larger than
+kMaxBodyBytes is not kept.
+*/
+class CacheFill {
+ public:
+  static const size_t kMaxBodyBytes = 1024 * 1024;
+
+  CacheFill(const lib::type::SharedPtr<CgiCache>& cache,
+            const std::string& key, int default_ttl);
+  // abandons a fill that never ended
+  ~CacheFill();
+
+  void OnHeaders(const HttpResponse& res);
+  void OnBody(const char* data, size_t len);
+  // complete: the whole output arrived and the script exited 0
+  void End(event::Poller& poller, bool complete);
+
+ private:
+  CacheFill();
+  CacheFill(const CacheFill& other);
+  CacheFill& operator=(const CacheFill& other);
+
+  lib::type::SharedPtr<CgiCache> cache_;
+  std::string key_;
+  int default_ttl_;
+  HttpResponse head_;
+  std::string body_;
+  bool has_headers_;
+  bool too_large_;
+  bool ended_;
+};
+
+/*
+Seconds a CGI response may be cached, 0 for not at all. Only 200, 301 and
+302 are kept, never with Set-Cookie or Cache-Control no-store, no-cache or
+private. s-maxage, then max-age, override default_ttl.
+*/
+int ResponseTtl(HttpResponse& res, int default_ttl);
+
+}  // namespace cgi
+
+#endif  // CGI_CACHE_HPP_
@@ -0,0 +1,57 @@
+#ifndef CGI_ENVIRONMENT_HPP_
+#define CGI_ENVIRONMENT_HPP_
+
+#include <string>
+#include <vector>
+
+namespace cgi {
+
+// RFC 3875 4.1 meta-variables (and REQUEST_URI), in the order passed
+enum MetaVar {
+  kAuthType,
+  kContentLength,
+  kContentType,
+  kGatewayInterface,
+  kPathInfo,
+  kPathTranslated,
+  kQueryString,
+  kRemoteAddr,
+  kRemoteHost,
+  kRemoteIdent,
+  kRemoteUser,
+  kRequestMethod,
+  kRequestUri,
+  kScriptName,
+  kServerName,
+  kServerPort,
+  kServerProtocol,
+  kServerSoftware,
+  kNumMetaVars
+};
+
+/*
+A script's environment as "NAME=value" strings, one slot per meta-variable.
+The names and the values that never change (GATEWAY_INTERFACE,
+SERVER_SOFTWARE) are rendered once per process; a request only fills in
+its own slots, with no lookups by name. Unset slots are left out.
+*/
+class Environment {
+ public:
+  Environment();
+
+  void Set(MetaVar var, const std::string& value);
+  void Unset(MetaVar var);
+  bool IsSet(MetaVar var) const;
+  // the value part of a set slot
+  std::string Get(MetaVar var) const;
+  // NULL-terminated, valid until the next Set() / Unset()
+  char* const* Envp();
+
+ private:
+  std::string entries_[kNumMetaVars];  // empty: unset
+  std::vector<char*> envp_;
+};
+
+}  // namespace cgi
+
+#endif  // CGI_ENVIRONMENT_HPP_
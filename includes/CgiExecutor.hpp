@@ -3,14 +3,14 @@
 
 #include <unistd.h>
 
-#include <map>
 #include <string>
-#include <vector>
 
+#include "CgiEnvironment.hpp"
 #include "ExecResult.hpp"
 #include "HttpRequest.hpp"
 #include "HttpResponse.hpp"
 #include "Location.hpp"
+#include "lib/io/SpillBuffer.hpp"
 #include "lib/type/Optional.hpp"
 
 class CgiExecutor {
@@ -20,14 +20,15 @@ class CgiExecutor {
 
   enum { kReadEnd = 0, kWriteEnd = 1 };
 
-  std::map<std::string, lib::type::Optional<std::string> > meta_vars_;
-  std::string GetMetaVar(const std::string&) const;
-  std::vector<std::string> GetMetaVars() const;
+  cgi::Environment env_;
+  void SetMetaVar(cgi::MetaVar var,
+                  const lib::type::Optional<std::string>& value);
   void InitializeMetaVars(const HttpRequest&);
 
   const Location& loc_;
   std::string script_path_;
-  std::string body_;
+  lib::io::SpillBuffer body_;  // shares a spilled request body's file
+  bool is_post_;
 
  public:
   CgiExecutor(const HttpRequest&, const Location&, const std::string&);
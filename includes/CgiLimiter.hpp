@@ -0,0 +1,79 @@
+#ifndef CGI_LIMITER_HPP_
+#define CGI_LIMITER_HPP_
+
+#include <cstddef>
+#include <deque>
+#include <string>
+
+#include "event/Poller.hpp"
+#include "lib/type/SharedPtr.hpp"
+
+namespace cgi {
+
+/*
+Admission control for one CGI location (cgi_max_concurrent): at most
+max_running scripts run at once, up to max_queued requests wait for a slot
+in arrival order and anything beyond that is turned away. A freed slot
+passes straight to the longest waiting request, which is woken through the
+poller, so waiting never blocks the loop. A slot freed without a poller
+goes to the waiters on the next Admit() or Release(poller), so they never
+wait behind a slot nobody holds. Loop thread only.
+
+A reload keeps the limiter of a location (see Share()): the scripts still
+running from before count against the new limits.
+*/
+class CgiLimiter {
+ public:
+  // a request queued for a slot
+  class Waiter {
+   public:
+    virtual ~Waiter() {
+    }
+    // the waiter now holds a slot and must Release() it
+    virtual void OnAdmitted(event::Poller& poller) = 0;
+  };
+
+  enum Admission { kAdmitted, kQueued, kRejected };
+
+  CgiLimiter(size_t max_running, size_t max_queued);
+
+  // the limiter registered for key (a server's location), which takes the
+  // limits of limiter but keeps its slots and queue; limiter itself when
+  // none is. Limiters nothing else refers to anymore are dropped.
+  static lib::type::SharedPtr<CgiLimiter> Share(
+      const std::string& key, const lib::type::SharedPtr<CgiLimiter>& limiter);
+
+  // kAdmitted: the caller holds a slot; kQueued: waiter->OnAdmitted()
+  // follows unless it is Cancel()ed first
+  Admission Admit(event::Poller& poller, Waiter* waiter);
+  // a slot if one is free right now, never a queue place (work nobody
+  // waits for, such as refreshing a cgi_cache entry)
+  bool TryAcquire();
+  // a queued waiter gives up (client gone, queue timeout); no-op otherwise
+  void Cancel(Waiter* waiter);
+  // hands the slot to the next waiter, if any
+  void Release(event::Poller& poller);
+  // for holders going away without a poller (destructors): nobody is woken
+  // now, see Dispatch()
+  void Release();
+
+  size_t Running() const;
+  size_t Queued() const;
+
+ private:
+  CgiLimiter();
+  CgiLimiter(const CgiLimiter& other);
+  CgiLimiter& operator=(const CgiLimiter& other);
+
+  // hands free slots to the longest waiting requests
+  void Dispatch(event::Poller& poller);
+
+  size_t max_running_;
+  size_t max_queued_;
+  size_t running_;
+  std::deque<Waiter*> queue_;
+};
+
+}  // namespace cgi
+
+#endif  // CGI_LIMITER_HPP_
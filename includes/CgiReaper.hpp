@@ -0,0 +1,35 @@
+#ifndef CGI_REAPER_HPP_
+#define CGI_REAPER_HPP_
+
+#include <sys/types.h>
+
+#include <cstddef>
+
+namespace cgi {
+
+/*
+CGI children nobody waits for any more: the client went away, the script
+timed out or the server is stopping. Adopt() sends SIGTERM; a child still
+running kKillGraceSeconds later gets SIGKILL. Reap() collects the exit
+statuses with WNOHANG, so a script that ignores SIGTERM holds a process
+table slot for a few seconds, never the event loop. Loop thread only.
+*/
+class CgiReaper {
+ public:
+  static const int kKillGraceSeconds = 5;
+
+  static void Adopt(pid_t pid);
+  // reaps the children that exited and SIGKILLs the ones past their grace
+  // period; called once per event loop iteration
+  static void Reap();
+  // SIGKILLs and reaps every adopted child (process exit)
+  static void KillAll();
+  static size_t Size();
+
+ private:
+  CgiReaper();
+};
+
+}  // namespace cgi
+
+#endif  // CGI_REAPER_HPP_
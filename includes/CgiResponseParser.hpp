@@ -5,6 +5,7 @@
 
 #include "HttpResponse.hpp"
 #include "lib/parser/StreamParser.hpp"
+#include "lib/type/Optional.hpp"
 
 namespace cgi {
 
@@ -16,6 +17,13 @@ class CgiResponseParser : public lib::parser::StreamParser {
   static const size_t kMaxHeaderSize = 8192;
 
   const HttpResponse& GetResponse() const;
+  // the header block is parsed; the body received so far is in the response
+  bool IsDone() const;
+  // X-Accel-Redirect (a URI) or X-Sendfile (an absolute filesystem path):
+  // the script leaves the body to an internal location. Neither header is
+  // kept in the response.
+  const lib::type::Optional<std::string>& GetInternalRedirect() const;
+  bool IsSendfile() const;
 
  protected:
   virtual bool AdvanceHeader();
@@ -26,9 +34,13 @@ class CgiResponseParser : public lib::parser::StreamParser {
 
  private:
   HttpResponse res_;
+  lib::type::Optional<std::string> internal_redirect_;
+  bool is_sendfile_;
   void StoreHeader(const std::string& key, const std::string& value);
 };
 
+// throws ResponseStatusException(502) unless res is a usable CGI response
+void ValidateCgiResponse(HttpResponse& res);
 HttpResponse ParseCgiResponse(const std::string& cgi_output);
 
 }  // namespace cgi
@@ -21,15 +21,37 @@ const std::string kServerName = "server_name";
 const std::string kMaxBody = "client_max_body_size";
 const std::string kErrorPage = "error_page";
 const std::string kLocation = "location";
+const std::string kGzip = "gzip";
+const std::string kGzipTypes = "gzip_types";
+const std::string kGzipMinLength = "gzip_min_length";
+const std::string kGzipCompLevel = "gzip_comp_level";
+const std::string kShutdownTimeout = "shutdown_timeout";
+const std::string kAccessLog = "access_log";
+const std::string kSlowLog = "slow_log";
+const std::string kLogLevel = "log_level";
+const std::string kEventBackend = "event_backend";
+const std::string kAioThreads = "aio_threads";
 const std::string kAllowedMethods = "allowed_methods";
 const std::string kRoot = "root";
 const std::string kAutoIndex = "autoindex";
+const std::string kAutoIndexFormat = "autoindex_format";
 const std::string kIndex = "index";
 const std::string kUploadPath = "upload_path";
 const std::string kServer = "server";
 const std::string kRedirect = "redirect";
 const std::string kCgi = "cgi";
 const std::string kCgiAllowedExtensions = "cgi_allowed_extensions";
+const std::string kCgiReadTimeout = "cgi_read_timeout";
+const std::string kCgiTotalTimeout = "cgi_total_timeout";
+const std::string kCgiMaxConcurrent = "cgi_max_concurrent";
+const std::string kCgiQueueSize = "cgi_queue_size";
+const std::string kCgiQueueTimeout = "cgi_queue_timeout";
+const std::string kCgiCache = "cgi_cache";
+const std::string kCgiCacheKey = "cgi_cache_key";
+const std::string kGzipStatic = "gzip_static";
+const std::string kInternal = "internal";
+const std::string kBrotliStatic = "brotli_static";
+const std::string kStubStatus = "stub_status";
 }  // namespace config_tokens
 
 namespace url_constants {
@@ -65,16 +87,38 @@ class ConfigParser {
   void ParseServerName(ServerConfig* server_config);
   void ParseMaxBody(ServerConfig* server_config);
   void ParseErrorPage(ServerConfig* server_config);
+  void ParseGzip(ServerConfig* server_config);
+  void ParseGzipTypes(ServerConfig* server_config);
+  void ParseGzipMinLength(ServerConfig* server_config);
+  void ParseGzipCompLevel(ServerConfig* server_config);
+  void ParseShutdownTimeout(ServerConfig* server_config);
+  void ParseAccessLog(ServerConfig* server_config);
+  void ParseSlowLog(ServerConfig* server_config);
+  void ParseLogLevel(ServerConfig* server_config);
+  void ParseEventBackend(ServerConfig* server_config);
+  void ParseAioThreads(ServerConfig* server_config);
 
   void ParseLocation(ServerConfig* server_config);
   void ParseMethods(Location* location);
   void ParseRoot(Location* location);
   void ParseAutoIndex(Location* location);
+  void ParseAutoIndexFormat(Location* location);
   void ParseIndex(Location* location);
   void ParseUploadPath(Location* location);
   void ParseRedirect(Location* location);
   void ParseCgi(Location* location);
   void ParseCgiAllowedExtensions(Location* location);
+  void ParseCgiReadTimeout(Location* location);
+  void ParseCgiTotalTimeout(Location* location);
+  void ParseCgiMaxConcurrent(Location* location);
+  void ParseCgiQueueSize(Location* location);
+  void ParseCgiQueueTimeout(Location* location);
+  void ParseCgiCache(Location* location);
+  void ParseCgiCacheKey(Location* location);
+  void ParseGzipStatic(Location* location);
+  void ParseInternal(Location* location);
+  void ParseBrotliStatic(Location* location);
+  void ParseStubStatus(Location* location);
   template <typename T, typename Setter>
   void ParseSimpleDirective(T* obj, Setter setter,
                             const std::string& error_msg);
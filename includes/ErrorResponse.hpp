@@ -0,0 +1,22 @@
+#ifndef ERROR_RESPONSE_HPP_
+#define ERROR_RESPONSE_HPP_
+
+#include "HttpResponse.hpp"
+#include "ServerConfig.hpp"
+
+namespace error_response {
+
+/*
+Fills in the body of an error response generated by the server (status
+400 and above; CGI output is not passed through here).
+
+A page loaded by ServerConfig::LoadErrorPages() replaces whatever body the
+response carries, and an external error_page URL turns the response into a
+302 to it. Otherwise an empty body gets the shared prebuilt default page.
+Nothing is formatted or read from disk on this path.
+*/
+void ApplyErrorPage(const ServerConfig& config, HttpResponse& res);
+
+}  // namespace error_response
+
+#endif  // ERROR_RESPONSE_HPP_
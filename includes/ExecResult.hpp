@@ -1,27 +1,44 @@
 #ifndef EXECRESULT_HPP_
 #define EXECRESULT_HPP_
 
+#include <stdint.h>
+
 #include "HttpResponse.hpp"
 
 class ASocket;
+class Location;
 
 struct ExecResult {
   HttpResponse response;
   ASocket* new_socket;
   bool is_async;
+  // matched location (NULL when routing failed); owned by the config
+  const Location* location;
+  // monotonic time routing finished (0 when it did not)
+  uint64_t routed_us;
 
   ExecResult()
       : response(lib::http::kInternalServerError),
         new_socket(NULL),
-        is_async(false) {
+        is_async(false),
+        location(NULL),
+        routed_us(0) {
   }
 
   explicit ExecResult(const HttpResponse& res)
-      : response(res), new_socket(NULL), is_async(false) {
+      : response(res),
+        new_socket(NULL),
+        is_async(false),
+        location(NULL),
+        routed_us(0) {
   }
 
   explicit ExecResult(ASocket* sock)
-      : response(lib::http::kOk), new_socket(sock), is_async(true) {
+      : response(lib::http::kOk),
+        new_socket(sock),
+        is_async(true),
+        location(NULL),
+        routed_us(0) {
   }
 };
 
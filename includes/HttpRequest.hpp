@@ -8,6 +8,7 @@
 #include "lib/exception/ResponseStatusException.hpp"
 #include "lib/http/Method.hpp"
 #include "lib/http/Status.hpp"
+#include "lib/io/SpillBuffer.hpp"
 #include "lib/parser/StreamParser.hpp"
 #include "lib/type/Optional.hpp"
 
@@ -15,6 +16,14 @@ typedef std::map<std::string, std::string> Dict;
 
 class HttpRequest : public lib::parser::StreamParser {
  private:
+  // position inside a chunked body
+  enum ChunkState {
+    kChunkSize,     // waiting for a "<hex>\r\n" line
+    kChunkData,     // chunk_remaining_ payload bytes still to come
+    kChunkDataEnd,  // CRLF after the payload
+    kChunkLastEnd   // final CRLF after the "0" chunk
+  };
+
   lib::http::Method method_;
   std::string uri_;
   std::string query_string_;
@@ -22,9 +31,12 @@ class HttpRequest : public lib::parser::StreamParser {
   unsigned short host_port_;
   std::string version_;
   Dict headers_;
-  std::string body_;
+  // decoded payload, handed over as it is validated; large bodies spill to
+  // a temporary file
+  lib::io::SpillBuffer body_;
   long content_length_;
-  std::ptrdiff_t next_chunk_size_;  // -1: waiting for chunk size line
+  ChunkState chunk_state_;
+  size_t chunk_remaining_;
   bool keep_alive_;
   std::string client_ip_;
   size_t max_body_size_limit_;  // default: kMaxPayloadSize
@@ -51,7 +63,7 @@ class HttpRequest : public lib::parser::StreamParser {
   bool AdvanceChunkedBody();
   bool ParseChunkSize(size_t& pos, size_t& chunk_size);
   bool ValidateFinalCRLF(size_t& pos);
-  bool AppendChunkData(size_t& pos, size_t chunk_size);
+  void AppendBody(size_t len);
   void OnInternalStateError();
   void OnExtraDataAfterDone();
   virtual bool IsStrictCrlf() const;
@@ -66,6 +78,9 @@ class HttpRequest : public lib::parser::StreamParser {
   // the maximum size of request URI is 8192 bytes (8KB) in nginx but we set
   // smaller limit (1KB) for simplicity
   static const size_t kMaxUriSize = 1024;
+  // method, version, separators and the blank line around the URI and the
+  // header fields
+  static const size_t kMaxRequestLineSlack = 64;
   static const unsigned short kDefaultPort;
 
   HttpRequest();
@@ -90,14 +105,16 @@ class HttpRequest : public lib::parser::StreamParser {
   const Dict& GetHeader() const;
   lib::type::Optional<std::string> GetHeader(const std::string& key) const;
   const std::string& GetQuery() const;
-  const std::string& GetBody() const;
+  // copies the whole body; prefer GetBodyBuffer() outside tests
+  std::string GetBody() const;
+  const lib::io::SpillBuffer& GetBodyBuffer() const;
 
   long GetContentLength() const {
     return content_length_;
   }
 
-  const std::string& GetBufferForTest() const {  // for test purposes
-    return buffer_;
+  std::string GetBufferForTest() const {  // for test purposes: unread bytes
+    return buffer_.substr(buffer_read_pos_);
   }
 
   bool IsKeepAlive() const {
@@ -122,6 +139,7 @@ class HttpRequest : public lib::parser::StreamParser {
 
   void SetBufferForTest(const std::string& s) {
     buffer_ = s;
+    buffer_read_pos_ = 0;
   }
 
   void AppendToBufferForTest(const std::string& s) {
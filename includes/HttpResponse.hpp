@@ -5,7 +5,11 @@
 #include <string>
 
 #include "lib/http/Status.hpp"
+#include "lib/io/BodyProducer.hpp"
+#include "lib/io/MappedFile.hpp"
+#include "lib/io/OutputQueue.hpp"
 #include "lib/type/Optional.hpp"
+#include "lib/type/SharedPtr.hpp"
 
 class HttpResponse {
  public:
@@ -21,21 +25,44 @@ class HttpResponse {
   void AddHeader(const std::string& key, const std::string& value);
   lib::type::Optional<std::string> GetHeader(const std::string& key);
   bool HasHeader(const std::string& key);
+  void RemoveHeader(const std::string& key);
+  // names are lower case
+  const std::map<std::string, std::string>& GetHeaders() const;
   void SetBody(const std::string& body);
+  void SetBody(const lib::io::MappedFile& file);  // whole file, zero-copy
+  void SetBody(const lib::type::SharedPtr<const std::string>& body);
+  void AppendBody(const std::string& data);
+  void AppendBody(const lib::io::MappedFile& file, size_t offset,
+                  size_t length);
   std::string GetBody() const;
+  size_t GetBodySize() const;
+  // moves the body segments into out (replacing its contents)
+  void TakeBody(lib::io::OutputQueue& out);
+  // body generated after the headers are sent (framing is the producer's
+  // job: set Transfer-Encoding accordingly; no Content-Length is derived)
+  void SetBodyProducer(const lib::type::SharedPtr<lib::io::BodyProducer>& p);
+  const lib::type::SharedPtr<lib::io::BodyProducer>& GetBodyProducer() const;
   std::string ToHttpString() const;
+  // appends status line, headers and body segments without copying the body
+  void WriteTo(lib::io::OutputQueue& out) const;
 
   void EnsureDefaultErrorContent();  // sugar
   static std::string MakeDefaultErrorPage(int status_code,
                                           const std::string& reason_phrase);
+  // MakeDefaultErrorPage() with the standard reason phrase, built once per
+  // status and shared by every response that sends it
+  static lib::type::SharedPtr<const std::string> DefaultErrorPage(
+      lib::http::Status status);
 
  private:
   int status_code_;
   std::string reason_phrase_;
   std::map<std::string, std::string> headers_;
-  std::string body_;
+  lib::io::OutputQueue body_;
+  lib::type::SharedPtr<lib::io::BodyProducer> body_producer_;
   std::string version_;
   void SetCurrentDateHeader();
+  std::string HeaderString() const;
 };
 
 #endif  // HTTPRESPONSE_HPP_
@@ -6,8 +6,12 @@
 #include <string>
 #include <vector>
 
+#include "CgiCache.hpp"
+#include "CgiLimiter.hpp"
+#include "access_log/LogFormat.hpp"
 #include "lib/http/Method.hpp"
 #include "lib/http/Status.hpp"
+#include "lib/type/SharedPtr.hpp"
 
 class Location {
  private:
@@ -16,20 +20,60 @@ class Location {
   std::string name_;
   std::string root_;
   bool autoindex_;
+  std::string autoindex_format_;  // "html" or "json"
   std::string index_file_;
   std::string upload_path_;
   std::string redirect_;
   lib::http::Status redirect_status_;
   bool cgi_enabled_;
   std::vector<std::string> cgi_allowed_extensions_;
+  // seconds a script may stay silent / run in total (0: no limit)
+  int cgi_read_timeout_;
+  int cgi_total_timeout_;
+  // cgi_max_concurrent (0: no limit) and its queue; the limiter is shared
+  // by the copies of the location and made by ServerConfig::AddLocation()
+  size_t cgi_max_concurrent_;
+  size_t cgi_queue_size_;
+  int cgi_queue_timeout_;
+  lib::type::SharedPtr<cgi::CgiLimiter> cgi_limiter_;
+  // cgi_cache (ttl 0: off) and cgi_cache_key; the cache is shared and made
+  // like the limiter
+  int cgi_cache_ttl_;
+  int cgi_cache_stale_;
+  size_t cgi_cache_max_entries_;
+  access_log::LogFormat cgi_cache_key_;
+  lib::type::SharedPtr<cgi::CgiCache> cgi_cache_;
+  bool gzip_static_;    // serve file.gz when the client accepts gzip
+  bool brotli_static_;  // serve file.br when the client accepts br
+  // "text" or "prometheus"; empty when the location serves files
+  std::string stub_status_;
+  // only reachable through X-Accel-Redirect / X-Sendfile from a CGI script
+  bool internal_;
+  // request_duration series, assigned by ServerConfig::AddLocation()
+  size_t metrics_id_;
   bool has_allowed_methods_;  // method directive should appear only once
   bool has_root_;
   bool has_autoindex_;
+  bool has_autoindex_format_;
   bool has_index_directive_;  // index directive should appear only once
   bool has_upload_path_;
   bool has_redirect_;
   bool has_cgi_enabled_;
   bool has_cgi_allowed_extensions_;
+  bool has_cgi_read_timeout_;
+  bool has_cgi_total_timeout_;
+  bool has_cgi_max_concurrent_;
+  bool has_cgi_queue_size_;
+  bool has_cgi_queue_timeout_;
+  bool has_cgi_cache_;
+  bool has_cgi_cache_key_;
+  bool has_gzip_static_;
+  bool has_brotli_static_;
+  bool has_stub_status_;
+  bool has_internal_;
+
+  static bool ParseOnOff(const std::string& directive,
+                         const std::string& value);
 
  public:
   Location();
@@ -102,6 +146,21 @@ class Location {
     return autoindex_;
   }
 
+  void SetAutoIndexFormat(const std::string& format) {
+    if (has_autoindex_format_) {
+      throw std::runtime_error("Duplicate autoindex_format directive");
+    }
+    if (format != "html" && format != "json") {
+      throw std::runtime_error("Invalid autoindex_format value: " + format);
+    }
+    autoindex_format_ = format;
+    has_autoindex_format_ = true;
+  }
+
+  const std::string& GetAutoIndexFormat() const {
+    return autoindex_format_;
+  }
+
   void SetIndexFile(const std::string& index) {
     if (has_index_directive_) {
       throw std::runtime_error("Duplicate index directive");
@@ -162,6 +221,197 @@ class Location {
     return cgi_enabled_;
   }
 
+  static const int kDefaultCgiReadTimeout = 10;
+
+  void SetCgiReadTimeout(int seconds) {
+    if (has_cgi_read_timeout_) {
+      throw std::runtime_error("Duplicate cgi_read_timeout directive");
+    }
+    cgi_read_timeout_ = seconds;
+    has_cgi_read_timeout_ = true;
+  }
+
+  int GetCgiReadTimeout() const {
+    return cgi_read_timeout_;
+  }
+
+  void SetCgiTotalTimeout(int seconds) {
+    if (has_cgi_total_timeout_) {
+      throw std::runtime_error("Duplicate cgi_total_timeout directive");
+    }
+    cgi_total_timeout_ = seconds;
+    has_cgi_total_timeout_ = true;
+  }
+
+  int GetCgiTotalTimeout() const {
+    return cgi_total_timeout_;
+  }
+
+  static const size_t kDefaultCgiQueueSize = 64;
+  static const int kDefaultCgiQueueTimeout = 10;
+
+  void SetCgiMaxConcurrent(size_t max) {
+    if (has_cgi_max_concurrent_) {
+      throw std::runtime_error("Duplicate cgi_max_concurrent directive");
+    }
+    cgi_max_concurrent_ = max;
+    has_cgi_max_concurrent_ = true;
+  }
+
+  size_t GetCgiMaxConcurrent() const {
+    return cgi_max_concurrent_;
+  }
+
+  void SetCgiQueueSize(size_t size) {
+    if (has_cgi_queue_size_) {
+      throw std::runtime_error("Duplicate cgi_queue_size directive");
+    }
+    cgi_queue_size_ = size;
+    has_cgi_queue_size_ = true;
+  }
+
+  size_t GetCgiQueueSize() const {
+    return cgi_queue_size_;
+  }
+
+  void SetCgiQueueTimeout(int seconds) {
+    if (has_cgi_queue_timeout_) {
+      throw std::runtime_error("Duplicate cgi_queue_timeout directive");
+    }
+    cgi_queue_timeout_ = seconds;
+    has_cgi_queue_timeout_ = true;
+  }
+
+  int GetCgiQueueTimeout() const {
+    return cgi_queue_timeout_;
+  }
+
+  // no-op without cgi_max_concurrent
+  void CreateCgiLimiter() {
+    if (cgi_max_concurrent_ == 0) return;
+    cgi_limiter_ = lib::type::SharedPtr<cgi::CgiLimiter>(
+        new cgi::CgiLimiter(cgi_max_concurrent_, cgi_queue_size_));
+  }
+
+  // loop thread: the limiter a previous configuration registered for key
+  // (see CgiLimiter::Share()); no-op without cgi_max_concurrent
+  void ShareCgiLimiter(const std::string& key) {
+    if (cgi_limiter_.IsNull()) return;
+    cgi_limiter_ = cgi::CgiLimiter::Share(key, cgi_limiter_);
+  }
+
+  // null without cgi_max_concurrent
+  const lib::type::SharedPtr<cgi::CgiLimiter>& GetCgiLimiter() const {
+    return cgi_limiter_;
+  }
+
+  static const size_t kDefaultCgiCacheMaxEntries = 1024;
+  static const char* const kDefaultCgiCacheKey;
+
+  void SetCgiCache(int ttl, int stale, size_t max_entries) {
+    if (has_cgi_cache_) {
+      throw std::runtime_error("Duplicate cgi_cache directive");
+    }
+    cgi_cache_ttl_ = ttl;
+    cgi_cache_stale_ = stale;
+    cgi_cache_max_entries_ = max_entries;
+    has_cgi_cache_ = true;
+  }
+
+  int GetCgiCacheTtl() const {
+    return cgi_cache_ttl_;
+  }
+
+  int GetCgiCacheStale() const {
+    return cgi_cache_stale_;
+  }
+
+  size_t GetCgiCacheMaxEntries() const {
+    return cgi_cache_max_entries_;
+  }
+
+  // access_log variables; throws std::runtime_error on an unknown one
+  void SetCgiCacheKey(const std::string& format);
+
+  const access_log::LogFormat& GetCgiCacheKey() const {
+    return cgi_cache_key_;
+  }
+
+  // no-op without cgi_cache
+  void CreateCgiCache() {
+    if (cgi_cache_ttl_ == 0) return;
+    cgi_cache_ = lib::type::SharedPtr<cgi::CgiCache>(
+        new cgi::CgiCache(cgi_cache_max_entries_, cgi_cache_stale_));
+  }
+
+  // null without cgi_cache
+  const lib::type::SharedPtr<cgi::CgiCache>& GetCgiCache() const {
+    return cgi_cache_;
+  }
+
+  void SetGzipStatic(const std::string& value) {
+    if (has_gzip_static_) {
+      throw std::runtime_error("Duplicate gzip_static directive");
+    }
+    gzip_static_ = ParseOnOff("gzip_static", value);
+    has_gzip_static_ = true;
+  }
+
+  bool GetGzipStatic() const {
+    return gzip_static_;
+  }
+
+  void SetBrotliStatic(const std::string& value) {
+    if (has_brotli_static_) {
+      throw std::runtime_error("Duplicate brotli_static directive");
+    }
+    brotli_static_ = ParseOnOff("brotli_static", value);
+    has_brotli_static_ = true;
+  }
+
+  bool GetBrotliStatic() const {
+    return brotli_static_;
+  }
+
+  void SetStubStatus(const std::string& format) {
+    if (has_stub_status_) {
+      throw std::runtime_error("Duplicate stub_status directive");
+    }
+    if (format != "text" && format != "prometheus") {
+      throw std::runtime_error("Invalid stub_status value: " + format);
+    }
+    stub_status_ = format;
+    has_stub_status_ = true;
+  }
+
+  bool HasStubStatus() const {
+    return has_stub_status_;
+  }
+
+  const std::string& GetStubStatus() const {
+    return stub_status_;
+  }
+
+  void SetInternal() {
+    if (has_internal_) {
+      throw std::runtime_error("Duplicate internal directive");
+    }
+    internal_ = true;
+    has_internal_ = true;
+  }
+
+  bool IsInternal() const {
+    return internal_;
+  }
+
+  void SetMetricsId(size_t id) {
+    metrics_id_ = id;
+  }
+
+  size_t GetMetricsId() const {
+    return metrics_id_;
+  }
+
   std::string GetAllowedMethodsString() const {
     std::string result;
     for (std::set<lib::http::Method>::const_iterator it = methods_.begin();
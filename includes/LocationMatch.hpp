@@ -1,6 +1,7 @@
 #ifndef LOCATIONMATCH_HPP_
 #define LOCATIONMATCH_HPP_
 
+#include <cstddef>
 #include <string>
 
 class Location;  // Forward declaration
@@ -10,6 +11,9 @@ class Location;  // Forward declaration
 struct LocationMatch {
   const Location* loc;    // pointer to the best matched location
   std::string remainder;  // always starts with '/'
+
+  LocationMatch() : loc(NULL), remainder() {
+  }
 };
 
 /*
@@ -1,23 +1,32 @@
 #ifndef REQUESTHANDLER_HPP_
 #define REQUESTHANDLER_HPP_
 
+#include <sys/stat.h>
+
 #include <cstdio>     // for std::remove()
-#include <fstream>    // for std::ofstream
 #include <iostream>   // for debug
 #include <stdexcept>  // std::runtime_error
+#include <string>
 
 #include "ExecResult.hpp"
 #include "HttpRequest.hpp"
 #include "HttpResponse.hpp"
 #include "LocationMatch.hpp"
 #include "ServerConfig.hpp"
+#include "lib/http/ContentCoding.hpp"
 
 class RequestHandler {
  public:
-  RequestHandler(ServerConfig conf, HttpRequest req);
+  // conf must outlive the handler (connections hold a config snapshot);
+  // so must req, whose body is not copied
+  RequestHandler(const ServerConfig& conf, const HttpRequest& req);
   ~RequestHandler();
 
   ExecResult Run();
+  // X-Accel-Redirect / X-Sendfile of a CGI script: Run() serves uri from
+  // an internal location instead of the request URI
+  void SetInternalRedirect(const std::string& uri,
+                           const HttpResponse& script_res);
   void PrepareRoutingContext();
   std::string ResolveFilesystemPath() const;  // for testing purpose
   std::string AppendIndexFileIfDirectoryOrThrow(
@@ -25,13 +34,45 @@ class RequestHandler {
 
  private:
   RequestHandler();  // shouldn't use default constructor
-  ServerConfig conf_;
-  HttpRequest req_;
+  const ServerConfig& conf_;
+  const HttpRequest& req_;
   ExecResult result_;
 
   LocationMatch location_match_;
   std::string filesystem_path_;
+  uint64_t routed_us_;
+  std::string internal_uri_;  // empty: no internal redirect
+  HttpResponse script_res_;
+
+  // regular files at least this large are served from a shared mmap()
+  // instead of being read into a string
+  static const off_t kMmapThreshold = 64 * 1024;
+
+  ExecResult Dispatch();
   void HandleGet();
+  void ServeStaticFile(const std::string& path, const struct stat& st);
+  void SetStaticFileBody(HttpResponse& res, const std::string& path,
+                         const struct stat& st) const;
+  // validators / conditional GET (RequestHandler_evaluateConditional.cpp)
+  void AddValidatorHeaders(HttpResponse& res, const struct stat& st) const;
+  bool IsNotModified(const struct stat& st) const;
+  // Range / If-Range (RequestHandler_serveRange.cpp)
+  // res carries the representation headers shared with the 200 response
+  bool IfRangeMatches(const struct stat& st) const;
+  bool TryServeRange(HttpResponse res, const std::string& path,
+                     const struct stat& st, const std::string& mime_type);
+  // gzip_static / brotli_static (RequestHandler_selectStaticVariant.cpp)
+  lib::http::ContentCoding SelectStaticVariant(const std::string& path,
+                                               std::string* variant_path,
+                                               struct stat* variant_st) const;
+  // directory listings (RequestHandler_serveAutoindex.cpp)
+  bool TryServeAutoindex();
+  void ServeAutoindex(const std::string& dir_path, const struct stat& dir_st);
+  // stub_status locations (RequestHandler_serveStubStatus.cpp)
+  ExecResult ServeStubStatus() const;
+  // CGI internal redirects (RequestHandler_serveInternalRedirect.cpp)
+  ExecResult ServeInternalRedirect();
+  void KeepScriptHeaders(HttpResponse& res) const;
   void HandlePost();
   void HandleDelete();
 };
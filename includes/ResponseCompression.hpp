@@ -0,0 +1,45 @@
+#ifndef RESPONSE_COMPRESSION_HPP_
+#define RESPONSE_COMPRESSION_HPP_
+
+#include <cstddef>
+
+#include "HttpRequest.hpp"
+#include "HttpResponse.hpp"
+#include "ServerConfig.hpp"
+#include "lib/http/ContentCoding.hpp"
+#include "lib/io/BodyProducer.hpp"
+
+namespace compression {
+
+// input bytes deflated per call (and per writable event when streaming)
+const size_t kDeflateBudget = 64 * 1024;
+
+/*
+Content-Encoding filter between the handler and the output queue.
+
+Applies when the server has `gzip on`, the response has a body of at least
+gzip_min_length bytes with a type listed in gzip_types, is not a 206 and not
+already encoded, and Accept-Encoding accepts gzip or deflate.
+
+A body that fits in one budget is encoded in place and keeps a
+Content-Length. A larger one is moved out of res into the returned producer
+(owned by the caller) that emits it chunked, and res is left with headers
+only; HTTP/1.0 peers cannot take chunked bodies, so larger bodies stay
+identity for them. Returns NULL whenever the body stays in res.
+*/
+lib::io::BodyProducer* EncodeResponse(const ServerConfig& config,
+                                      const HttpRequest& req,
+                                      HttpResponse& res);
+
+// The same filter for a body that is still being generated (CGI output),
+// decided on the headers alone: gzip_min_length is checked against a
+// declared Content-Length only. When it applies, res gets the encoding
+// headers and chunked framing (HTTP/1.1 peers only) and the coding the
+// caller's producer has to apply is returned; otherwise kCodingIdentity.
+lib::http::ContentCoding EncodeStreamedResponse(const ServerConfig& config,
+                                                const HttpRequest& req,
+                                                HttpResponse& res);
+
+}  // namespace compression
+
+#endif  // RESPONSE_COMPRESSION_HPP_
@@ -1,21 +1,38 @@
 #ifndef SERVER_CONFIG_HPP_
 #define SERVER_CONFIG_HPP_
 
+#include <stdint.h>
 #include <sys/stat.h>
 
 #include <cstdlib>
 #include <cstring>
 #include <iostream>  // debug
 #include <map>
+#include <set>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "Location.hpp"
 #include "LocationMatch.hpp"
+#include "access_log/AccessLog.hpp"
+#include "access_log/LogFormat.hpp"
+#include "event/Poller.hpp"
 #include "lib/exception/ResponseStatusException.hpp"
 #include "lib/http/Status.hpp"
+#include "lib/logging/Logging.hpp"
+#include "lib/type/Optional.hpp"
+#include "lib/type/SharedPtr.hpp"
+#include "metrics/Metrics.hpp"
+
+// an error_page target prepared by ServerConfig::LoadErrorPages()
+struct ErrorPage {
+  std::string redirect;  // absolute URL, answered with a 302
+  lib::type::SharedPtr<const std::string> body;
+  std::string content_type;
+};
 
 class ServerConfig {
  private:
@@ -24,10 +41,42 @@ class ServerConfig {
   std::string server_name_;
   int max_body_size_;
   std::map<lib::http::Status, std::string> errors_;
+  std::map<lib::http::Status, ErrorPage> error_pages_;  // loaded errors_
   std::vector<Location> locations_;
+  // routing table compiled by AddLocation(): (trimmed location name, index
+  // in locations_), longest name first so the first prefix match wins
+  typedef std::pair<std::string, size_t> Route;
+  std::vector<Route> routes_;
+  // response compression (gzip* directives)
+  bool gzip_;
+  std::set<std::string> gzip_types_;  // text/html is always included
+  size_t gzip_min_length_;
+  int gzip_comp_level_;
+  int shutdown_timeout_;  // seconds a graceful shutdown may take
+  std::string access_log_path_;  // empty: no access log
+  access_log::LogFormat access_log_format_;
+  access_log::AccessLog::Handle access_log_;  // opened by OpenLogs()
+  std::string slow_log_path_;  // empty: no slow log
+  uint64_t slow_log_threshold_us_;
+  size_t slow_log_sample_;  // 1 in N requests logged in full (0: none)
+  access_log::AccessLog::Handle slow_log_;  // opened by OpenLogs()
+  lib::logging::Level log_level_;
+  event::Backend event_backend_;  // process-wide, see Webserv
+  size_t aio_threads_;             // 0: handlers run on the event loop
+  size_t aio_max_queue_;
   bool has_listen_;
   bool has_server_name_;
   bool has_max_body_;
+  bool has_gzip_;
+  bool has_gzip_types_;
+  bool has_gzip_min_length_;
+  bool has_gzip_comp_level_;
+  bool has_shutdown_timeout_;
+  bool has_access_log_;
+  bool has_slow_log_;
+  bool has_log_level_;
+  bool has_event_backend_;
+  bool has_aio_threads_;
   static std::string TrimTrailingSlashExceptRoot(const std::string& s);
   bool IsPathPrefix(const std::string& uri, const std::string& prefix) const;
 
@@ -38,10 +87,45 @@ class ServerConfig {
   void SetPort(const unsigned short& port);
   void SetServerName(const std::string& server_name);
   void SetMaxBodySize(int size);
+  void SetGzip(const std::string& value);
+  void SetGzipTypes(const std::vector<std::string>& types);
+  void SetGzipMinLength(size_t length);
+  void SetGzipCompLevel(int level);
+  void SetShutdownTimeout(int seconds);
+  // empty path: access_log off; empty format: "combined"
+  void SetAccessLog(const std::string& path, const std::string& format);
+  void SetSlowLog(const std::string& path, uint64_t threshold_ms,
+                  size_t sample);
+  void SetLogLevel(const std::string& level);
+  void SetEventBackend(const std::string& backend);
+  // threads == 0: aio_threads off
+  void SetAioThreads(size_t threads, size_t max_queue);
+  // media type without parameters, matched case-insensitively ("*" = any)
+  bool IsGzipType(const std::string& content_type) const;
   LocationMatch FindLocationForUri(const std::string& uri) const;
+  // X-Sendfile: the URI an internal location serves the absolute
+  // filesystem path under (the deepest root containing it), if any
+  lib::type::Optional<std::string> FindInternalUriForPath(
+      const std::string& path) const;
+  /*
+  Reads every error_page target through the locations once (startup and
+  reload), so error responses are answered from memory.
+  Throws std::runtime_error naming the first page that cannot be served.
+  */
+  void LoadErrorPages();
+  // NULL when no page was loaded for status
+  const ErrorPage* FindErrorPage(lib::http::Status status) const;
+  // opens the access_log and slow_log files (startup and reload); throws
+  // std::runtime_error when one cannot be opened
+  void OpenLogs();
+  // loop thread (startup and reload): each location with
+  // cgi_max_concurrent keeps the limiter it had in the previous
+  // configuration for this port, so a reload does not reset the count
+  void ShareCgiLimiters();
 
   void SetErrorPage(lib::http::Status status, const std::string& path) {
     errors_[status] = path;
+    error_pages_.erase(status);
   }
 
   const std::string& GetHost() const {
@@ -60,6 +144,80 @@ class ServerConfig {
     return max_body_size_;
   }
 
+  bool GetGzip() const {
+    return gzip_;
+  }
+
+  size_t GetGzipMinLength() const {
+    return gzip_min_length_;
+  }
+
+  int GetGzipCompLevel() const {
+    return gzip_comp_level_;
+  }
+
+  int GetShutdownTimeout() const {
+    return shutdown_timeout_;
+  }
+
+  static const int kDefaultShutdownTimeout = 30;
+
+  const std::string& GetAccessLogPath() const {
+    return access_log_path_;
+  }
+
+  // null until OpenLogs() and when access_log is off
+  const access_log::AccessLog::Handle& GetAccessLog() const {
+    return access_log_;
+  }
+
+  const access_log::LogFormat& GetAccessLogFormat() const {
+    return access_log_format_;
+  }
+
+  const std::string& GetSlowLogPath() const {
+    return slow_log_path_;
+  }
+
+  // null until OpenLogs() and when slow_log is off
+  const access_log::AccessLog::Handle& GetSlowLog() const {
+    return slow_log_;
+  }
+
+  uint64_t GetSlowLogThresholdMicros() const {
+    return slow_log_threshold_us_;
+  }
+
+  size_t GetSlowLogSample() const {
+    return slow_log_sample_;
+  }
+
+  bool HasLogLevel() const {
+    return has_log_level_;
+  }
+
+  lib::logging::Level GetLogLevel() const {
+    return log_level_;
+  }
+
+  bool HasEventBackend() const {
+    return has_event_backend_;
+  }
+
+  event::Backend GetEventBackend() const {
+    return event_backend_;
+  }
+
+  size_t GetAioThreads() const {
+    return aio_threads_;
+  }
+
+  size_t GetAioMaxQueue() const {
+    return aio_max_queue_;
+  }
+
+  static const size_t kDefaultAioMaxQueue = 1024;
+
   const std::map<lib::http::Status, std::string>& GetErrorPages() const {
     return errors_;
   }
@@ -91,6 +249,16 @@ class ServerConfig {
       }
     }
     locations_.push_back(location);
+    locations_.back().SetMetricsId(
+        metrics::RegisterLocation(normalized_name));
+    locations_.back().CreateCgiLimiter();
+    locations_.back().CreateCgiCache();
+    std::vector<Route>::iterator pos = routes_.begin();
+    while (pos != routes_.end() &&
+           pos->first.size() >= normalized_name.size()) {
+      ++pos;
+    }
+    routes_.insert(pos, Route(normalized_name, locations_.size() - 1));
   }
 
   const std::vector<Location>& GetLocations() const {
@@ -98,4 +266,9 @@ class ServerConfig {
   }
 };
 
+// immutable configuration shared by a listener and the connections it
+// accepted; a reload swaps in a new one while in-flight connections keep
+// the snapshot they started with
+typedef lib::type::SharedPtr<const ServerConfig> ServerConfigSnapshot;
+
 #endif
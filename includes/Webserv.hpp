@@ -1,39 +1,118 @@
 #ifndef WEBSERV_HPP
 #define WEBSERV_HPP
 
-#include <sys/epoll.h>
+#include <pthread.h>
 
 #include <map>
+#include <string>
 #include <vector>
 
 #include "ServerConfig.hpp"
+#include "event/Poller.hpp"
+#include "lib/type/Fd.hpp"
 #include "socket/ASocket.hpp"
+#include "socket/ServerSocket.hpp"
 
 class Webserv {
  private:
-  std::map<unsigned short, ServerConfig> port_to_server_configs_;
-  lib::type::Fd epoll_fd_;
+  struct ReloadJob;  // defined in Webserv.cpp
+
+  std::string config_file_;
+  std::string executable_;  // re-executed by Upgrade()
+  bool draining_;           // listeners closed, finishing connections
+  time_t drain_deadline_;
+  size_t drain_reported_;  // connections left at the last progress line
+  std::map<unsigned short, ServerConfigSnapshot> port_to_server_configs_;
+  std::map<unsigned short, ServerSocket*> listeners_;  // owned by sockets_
+  event::Poller* poller_;  // owned
   std::map<int, ASocket*> sockets_;
+  ReloadJob* reload_job_;  // parsing on reload_thread_, see StartReload()
+  pthread_t reload_thread_;
+  pid_t upgrade_pid_;  // new binary that has not reported readiness, or 0
+  lib::type::Fd upgrade_ready_fd_;  // its ready pipe, watched by poller_
+  time_t upgrade_deadline_;
   void ClearResources();
-
+  void RegisterListener(unsigned short port, ServerSocket* listener);
+  void CloseListener(unsigned short port, ServerSocket* listener);
+  static std::map<unsigned short, ServerConfigSnapshot> MapConfigsByPort(
+      const std::vector<ServerConfig>& server_configs);
+  static void OpenSharedResources(
+      const std::map<unsigned short, ServerConfigSnapshot>& configs);
+  static void* ReloadThreadMain(void* arg);  // arg is the ReloadJob
+  void ApplyReload(ReloadJob& job);
+  static std::map<unsigned short, int> TakeInheritedListeners();
+  static void NotifyUpgradeReady();
+  int SpawnUpgradedBinary(int ready_fd, pid_t* pid) const;
+  void OnUpgradeReadable();
+  void CheckUpgradeTimeout();
+  void AbandonUpgrade(const char* reason);
+  void StartDraining(time_t timeout);
+  void ReportDrainProgress();
+  bool IsDrained() const;
+  void ApplyLogLevel() const;
+  event::Backend SelectEventBackend() const;
+  void StartAioThreads();
   static const int kMaxEvents = 10;
   static const int kRequestTimeout = 10;
-  static const int kEpollWaitTimeout = 500;
+  static const int kWaitTimeout = 500;
+  // seconds the new binary may take to come up
+  static const int kUpgradeStartTimeout = 10;
   void CheckTimeout();
 
  public:
   Webserv();  // should be private but made public for testing
-  Webserv(const std::string& config_file);
+  // executable is the path Upgrade() runs again (usually argv[0])
+  Webserv(const std::string& config_file,
+          const std::string& executable = std::string());
   ~Webserv();
 
+  // serves until a drain started by Shutdown() or Upgrade() has finished
   void Run();
+  /*
+  Re-reads the config file. The new configuration is parsed and validated
+  completely before anything changes; on error the running one is kept.
+  Listeners for new ports are opened, listeners whose port is gone are
+  closed and the others stay open and hand the new snapshot to the
+  connections they accept from now on. In-flight connections finish with
+  the snapshot they started with.
+  */
+  void Reload();
+  /*
+  Reload() for SIGHUP, without stalling the connections: parsing and the
+  loading of error pages run on a helper thread. PollReload() applies the
+  result on the loop thread (Run() asks on every iteration) and returns
+  true once it has. Parses inline when no thread can be started.
+  */
+  void StartReload();
+  bool PollReload();
+  /*
+  Binary upgrade (SIGUSR2): starts executable with the same config file and
+  the listening sockets, passed by number in WEBSERV_LISTEN_FDS
+  ("port:fd,..."). The new process adopts them without binding and reports
+  readiness over the pipe in WEBSERV_READY_FD, which the loop watches while
+  it keeps serving. Only then does this process close its listeners and
+  drain. A new binary that exits first or is not ready within
+  kUpgradeStartTimeout seconds is killed, so it never accepts next to this
+  one, and this process keeps serving as before.
+  */
+  void Upgrade();
+  /*
+  Graceful shutdown (SIGTERM / SIGQUIT): closes the listeners and the
+  connections that have not sent a byte yet, then lets requests in flight
+  and their CGI children finish. Run() returns when none are left or after
+  shutdown_timeout seconds, whichever comes first. Asking again while
+  draining gives up waiting.
+  */
+  void Shutdown();
 
   // InitServersFromConfigs should be private but made public for testing
   void InitServersFromConfigs(const std::vector<ServerConfig>& server_configs);
 
   // utility methods for accessing server configurations
-  const std::map<unsigned short, ServerConfig>& GetPortConfigs() const;
+  const std::map<unsigned short, ServerConfigSnapshot>& GetPortConfigs() const;
   const ServerConfig* FindServerConfigByPort(const unsigned short& port) const;
+  // largest shutdown_timeout among the served configurations
+  int GetShutdownTimeout() const;
 };
 
 #endif  // WEBSERV_HPP
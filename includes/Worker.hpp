@@ -0,0 +1,21 @@
+#ifndef WORKER_HPP_
+#define WORKER_HPP_
+
+#include <cstddef>
+
+/*
+Identity of the calling thread for per-worker state (metrics slots, access
+log buffers). The event loop is worker 0; a thread started to take work off
+the loop binds itself to its own index first.
+*/
+namespace worker {
+
+const size_t kMaxWorkers = 16;
+
+// index >= kMaxWorkers is clamped to the last worker
+void Bind(size_t index);
+size_t Current();
+
+}  // namespace worker
+
+#endif  // WORKER_HPP_
@@ -0,0 +1,87 @@
+#ifndef ACCESS_LOG_ACCESS_LOG_HPP_
+#define ACCESS_LOG_ACCESS_LOG_HPP_
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "lib/io/RingBuffer.hpp"
+#include "lib/type/Fd.hpp"
+#include "lib/type/SharedPtr.hpp"
+
+namespace access_log {
+
+/*
+An access_log file, shared by every server block (and every configuration
+generation) naming the same path.
+
+Write() only copies the line into the calling worker's ring buffer. The
+event loop calls FlushPending() once per iteration, which hands a buffer to
+the log writer thread when it holds kFlushThreshold bytes or its oldest
+line is kFlushInterval old. The writer puts each buffer out in one O_APPEND
+write, so a slow disk delays the log but never the loop. A line that does
+not fit hands the buffer over early. While kMaxQueuedBytes wait for the
+writer, further buffers are dropped with a warning instead of piling up.
+
+The file is opened O_CLOEXEC: CGI children and an upgraded binary do not
+inherit it.
+*/
+class AccessLog {
+ public:
+  typedef lib::type::SharedPtr<AccessLog> Handle;
+
+  static const size_t kBufferSize = 64 * 1024;
+  static const size_t kFlushThreshold = 32 * 1024;
+  static const time_t kFlushInterval = 1;
+  static const size_t kMaxQueuedBytes = 8 * 1024 * 1024;
+
+  ~AccessLog();  // flushes
+
+  // the open log for path, opened on first use
+  // throws std::runtime_error when the file cannot be opened
+  static Handle Open(const std::string& path);
+
+  // line includes its '\n'
+  void Write(const std::string& line);
+  // hands the calling worker's buffer to the writer
+  void Flush();
+  // the writer opens path again (after logrotate moved the file away) once
+  // the lines handed over before are written; on failure it keeps the
+  // current file
+  void Reopen();
+  const std::string& GetPath() const;
+
+  // hands due buffers of every open log to the writer (all buffers when
+  // force, which also waits until they are written); logs no configuration
+  // refers to anymore are closed
+  static void FlushPending(bool force);
+  // SIGUSR1: flush and reopen every log
+  static void ReopenAll();
+  // waits for the writer to put out everything handed to it, then joins
+  // the thread (shutdown); the next handoff starts it again
+  static void StopWriter();
+
+ private:
+  AccessLog(const std::string& path, int fd);
+  AccessLog(const AccessLog&);
+  AccessLog& operator=(const AccessLog&);
+
+  lib::io::RingBuffer& Buffer();
+  // queues data (swapped out) or a reopen for the writer thread
+  void Submit(std::string* data, bool reopen);
+  static void* WriterMain(void* arg);
+  // on the writer thread
+  void Perform(const std::string& data, bool reopen);
+  void WriteOut(const char* data, size_t len);
+  void ReopenNow();
+
+  std::string path_;
+  lib::type::Fd fd_;
+  // per worker, allocated on its first line
+  std::vector<lib::io::RingBuffer*> buffers_;
+  std::vector<time_t> pending_since_;
+};
+
+}  // namespace access_log
+
+#endif  // ACCESS_LOG_ACCESS_LOG_HPP_
@@ -0,0 +1,86 @@
+#ifndef ACCESS_LOG_LOG_FORMAT_HPP_
+#define ACCESS_LOG_LOG_FORMAT_HPP_
+
+#include <stdint.h>
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+class HttpRequest;
+class Location;
+
+namespace access_log {
+
+// what a log line can refer to, gathered when the connection closes
+struct Entry {
+  const HttpRequest* request;
+  const Location* location;  // NULL when routing failed
+  int status;
+  uint64_t bytes_received;
+  uint64_t bytes_sent;
+  uint64_t body_bytes_sent;
+  uint64_t request_time_us;
+  time_t time;  // wall clock at completion
+
+  Entry();
+};
+
+/*
+Compiled access_log format: literal text with $variables.
+
+  $remote_addr $time_local $time_iso8601 $request $request_method
+  $request_uri $uri $args $server_protocol $status $bytes_sent
+  $body_bytes_sent $request_length $request_time $location $http_<name>
+
+$http_<name> is a request header, with '_' standing for '-'. Values taken
+from the request are escaped like nginx does (", \ and non-printable bytes
+become \xHH); an empty value is written as "-".
+*/
+class LogFormat {
+ public:
+  // the "combined" preset
+  LogFormat();
+  // a preset name ("combined", "common") or a format string
+  // throws std::runtime_error on an unknown variable
+  explicit LogFormat(const std::string& spec);
+
+  // appends one line, including the trailing '\n'
+  void Render(const Entry& entry, std::string* out) const;
+
+ private:
+  enum Variable {
+    kLiteral,
+    kRemoteAddr,
+    kTimeLocal,
+    kTimeIso8601,
+    kRequest,
+    kRequestMethod,
+    kRequestUri,
+    kUri,
+    kArgs,
+    kServerProtocol,
+    kStatus,
+    kBytesSent,
+    kBodyBytesSent,
+    kRequestLength,
+    kRequestTime,
+    kLocation,
+    kHttpHeader
+  };
+
+  struct Part {
+    Variable variable;
+    std::string text;  // literal text, or the header name for kHttpHeader
+  };
+
+  void Compile(const std::string& format);
+  void RenderPart(const Part& part, const Entry& entry,
+                  std::string* out) const;
+
+  std::vector<Part> parts_;
+};
+
+}  // namespace access_log
+
+#endif  // ACCESS_LOG_LOG_FORMAT_HPP_
@@ -0,0 +1,43 @@
+#ifndef AIO_TASK_HPP_
+#define AIO_TASK_HPP_
+
+#include <stdint.h>
+
+#include "event/Poller.hpp"
+
+namespace aio {
+
+// kind of blocking work, for the per-op metrics
+enum Op { kOpRead, kOpWrite, kOpUnlink, kOpSpawn, kOpCount };
+
+// "read", "write", "unlink", "spawn"
+const char* OpName(Op op);
+
+/*
+Blocking work taken off the event loop: Run() is called on a pool thread,
+then Complete() back on the loop thread. Whatever Run() reads must stay
+untouched by the loop until Complete(). Submitted tasks belong to the pool.
+*/
+class Task {
+ public:
+  explicit Task(Op op);
+  virtual ~Task();
+
+  virtual void Run() = 0;
+  virtual void Complete(event::Poller& poller) = 0;
+
+  Op GetOp() const;
+
+ private:
+  friend class ThreadPool;
+
+  Task(const Task& other);
+  Task& operator=(const Task& other);
+
+  Op op_;
+  uint64_t queued_us_;  // set by ThreadPool::Submit()
+};
+
+}  // namespace aio
+
+#endif  // AIO_TASK_HPP_
@@ -0,0 +1,48 @@
+#ifndef AIO_THREAD_POOL_HPP_
+#define AIO_THREAD_POOL_HPP_
+
+#include <cstddef>
+
+#include "Worker.hpp"
+#include "aio/Task.hpp"
+#include "event/Poller.hpp"
+
+namespace aio {
+
+/*
+Process-wide pool of threads for blocking filesystem work, in the spirit
+of nginx's "aio threads". The loop submits a Task; a pool thread runs it,
+queues it as done and bumps an eventfd the loop polls. DispatchCompletions()
+drains that fd and completes the tasks on the loop thread.
+
+The queue is bounded: Submit() refuses a task while max_queue tasks wait
+for a thread. Pool threads are workers 1..N (see Worker.hpp) and record the
+queue wait and run time of every task in their own metrics slot.
+*/
+class ThreadPool {
+ public:
+  static const size_t kMaxThreads = worker::kMaxWorkers - 1;
+
+  // threads in [1, kMaxThreads], max_queue > 0; throws std::runtime_error
+  // when already running or a thread cannot be started
+  static void Start(size_t threads, size_t max_queue);
+  // joins the threads once their current task returns; tasks still queued
+  // or not yet dispatched are deleted without Complete()
+  static void Stop();
+  static bool IsRunning();
+  // false (task not taken) when the queue is full or the pool is stopped
+  static bool Submit(Task* task);
+  // readable while completed tasks wait for dispatch; -1 when stopped
+  static int CompletionFd();
+  static void DispatchCompletions(event::Poller& poller);
+  static size_t QueueLength();
+
+ private:
+  ThreadPool();
+  // a pool thread; arg is its worker index
+  static void* ThreadMain(void* arg);
+};
+
+}  // namespace aio
+
+#endif  // AIO_THREAD_POOL_HPP_
@@ -0,0 +1,46 @@
+#ifndef AUTOINDEX_AUTOINDEX_HPP_
+#define AUTOINDEX_AUTOINDEX_HPP_
+
+#include <string>
+#include <vector>
+
+#include "lib/io/DirectoryReader.hpp"
+
+namespace autoindex {
+
+enum Format { kHtml, kJson };
+
+enum SortKey {
+  kSortByType,  // directories first, then by name (default)
+  kSortByName
+};
+
+struct ListingOptions {
+  Format format;
+  SortKey sort;
+  bool descending;
+
+  ListingOptions();
+  // ?sort=type|name&order=asc|desc; unknown values keep the defaults
+  static ListingOptions FromQuery(Format format, const std::string& query);
+  std::string CacheKey() const;
+};
+
+// "html" / "json" as written in autoindex_format
+Format FormatFromString(const std::string& value);
+std::string ContentType(Format format);
+
+void SortEntries(std::vector<lib::io::DirEntry>* entries,
+                 const ListingOptions& options);
+
+// a listing is RenderHead + RenderEntry for each entry + RenderTail
+// dir_uri is the request path of the directory and ends with '/'
+std::string RenderHead(const std::string& dir_uri,
+                       const ListingOptions& options);
+void RenderEntry(const std::string& dir_uri, const lib::io::DirEntry& entry,
+                 bool first, const ListingOptions& options, std::string* out);
+std::string RenderTail(const ListingOptions& options);
+
+}  // namespace autoindex
+
+#endif  // AUTOINDEX_AUTOINDEX_HPP_
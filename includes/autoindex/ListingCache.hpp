@@ -0,0 +1,44 @@
+#ifndef AUTOINDEX_LISTING_CACHE_HPP_
+#define AUTOINDEX_LISTING_CACHE_HPP_
+
+#include <sys/stat.h>
+
+#include <string>
+
+#include "lib/io/CacheStats.hpp"
+#include "lib/type/SharedPtr.hpp"
+
+namespace autoindex {
+
+/*
+Rendered listings keyed by directory path, request path and listing
+options. An entry is valid while the directory's mtime is unchanged, since
+creating, removing or renaming an entry updates it.
+
+A directory modified within the last second is not cached: its mtime could
+still change within the same timestamp tick without looking different.
+Bodies are shared with the responses that send them, so a hit costs no copy.
+All members are thread-safe.
+*/
+class ListingCache {
+ public:
+  typedef lib::type::SharedPtr<const std::string> Body;
+
+  static const size_t kMaxBytes = 64 * 1024 * 1024;
+  static const size_t kMaxBodyBytes = 16 * 1024 * 1024;
+
+  // null when absent or stale
+  static Body Find(const std::string& key, const struct stat& dir_st);
+  static void Store(const std::string& key, const struct stat& dir_st,
+                    const Body& body);
+  static void Clear();
+  static size_t Size();
+  static lib::io::CacheStats Stats();
+
+ private:
+  ListingCache();
+};
+
+}  // namespace autoindex
+
+#endif  // AUTOINDEX_LISTING_CACHE_HPP_
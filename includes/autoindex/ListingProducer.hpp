@@ -0,0 +1,52 @@
+#ifndef AUTOINDEX_LISTING_PRODUCER_HPP_
+#define AUTOINDEX_LISTING_PRODUCER_HPP_
+
+#include <sys/stat.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "autoindex/Autoindex.hpp"
+#include "lib/io/BodyProducer.hpp"
+#include "lib/io/DirectoryReader.hpp"
+
+namespace autoindex {
+
+// Renders a sorted listing kEntriesPerProduce entries at a time as chunked
+// body pieces, so a directory with 100k entries neither blocks the event
+// loop nor sits fully rendered in memory next to the socket queue.
+// The rendered text is kept (up to ListingCache::kMaxBodyBytes) and stored
+// in ListingCache once the last chunk is produced.
+class ListingProducer : public lib::io::BodyProducer {
+ public:
+  static const size_t kEntriesPerProduce = 1024;
+
+  // entries are taken over (swapped out) and must already be sorted
+  ListingProducer(std::vector<lib::io::DirEntry>& entries,
+                  const std::string& dir_uri, const ListingOptions& options,
+                  const std::string& cache_key, const struct stat& dir_st);
+  virtual ~ListingProducer();
+
+  virtual bool Produce(lib::io::OutputQueue& out);
+
+ private:
+  ListingProducer();
+  ListingProducer(const ListingProducer& other);
+  ListingProducer& operator=(const ListingProducer& other);
+
+  std::vector<lib::io::DirEntry> entries_;
+  std::string dir_uri_;
+  ListingOptions options_;
+  std::string cache_key_;
+  struct stat dir_st_;
+  size_t next_;
+  bool started_;
+  bool finished_;
+  bool cacheable_;
+  std::string rendered_;
+};
+
+}  // namespace autoindex
+
+#endif  // AUTOINDEX_LISTING_PRODUCER_HPP_
@@ -8,15 +8,37 @@ enum TokenType {
   kTokenMaxBody,
   kTokenErrorPage,
   kTokenLocation,
+  kTokenGzip,
+  kTokenGzipTypes,
+  kTokenGzipMinLength,
+  kTokenGzipCompLevel,
+  kTokenShutdownTimeout,
+  kTokenAccessLog,
+  kTokenSlowLog,
+  kTokenLogLevel,
+  kTokenEventBackend,
+  kTokenAioThreads,
   // Location directives
   kTokenAllowedMethods,
   kTokenRoot,
   kTokenAutoindex,
+  kTokenAutoindexFormat,
   kTokenIndex,
   kTokenUploadPath,
   kTokenRedirect,
   kTokenCgi,
-  kTokenCgiAllowedExtensions
+  kTokenCgiAllowedExtensions,
+  kTokenCgiReadTimeout,
+  kTokenCgiTotalTimeout,
+  kTokenCgiMaxConcurrent,
+  kTokenCgiQueueSize,
+  kTokenCgiQueueTimeout,
+  kTokenCgiCache,
+  kTokenCgiCacheKey,
+  kTokenGzipStatic,
+  kTokenInternal,
+  kTokenBrotliStatic,
+  kTokenStubStatus
 };
 
 #endif  // ENUMS_HPP_
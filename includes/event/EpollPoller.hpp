@@ -0,0 +1,36 @@
+#ifndef EVENT_EPOLL_POLLER_HPP_
+#define EVENT_EPOLL_POLLER_HPP_
+
+#include <vector>
+
+#include "event/Poller.hpp"
+#include "lib/type/Fd.hpp"
+
+namespace event {
+
+// one epoll_ctl() per change and one epoll_wait() per Wait()
+class EpollPoller : public Poller {
+ public:
+  // throws std::runtime_error when epoll_create() fails
+  EpollPoller();
+  virtual ~EpollPoller();
+
+  virtual int Add(int fd, uint32_t events, void* data);
+  virtual int Modify(int fd, uint32_t events, void* data);
+  virtual int Remove(int fd);
+  virtual int Wait(Event* events, int max_events, int timeout_ms);
+  virtual Backend GetBackend() const;
+
+ private:
+  EpollPoller(const EpollPoller& other);
+  EpollPoller& operator=(const EpollPoller& other);
+
+  int Control(int op, int fd, uint32_t events, void* data);
+
+  lib::type::Fd epoll_fd_;
+  std::vector<epoll_event> ready_;
+};
+
+}  // namespace event
+
+#endif  // EVENT_EPOLL_POLLER_HPP_
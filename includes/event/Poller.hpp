@@ -0,0 +1,72 @@
+#ifndef EVENT_POLLER_HPP_
+#define EVENT_POLLER_HPP_
+
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#include <string>
+
+namespace event {
+
+// interest / readiness bits; the epoll(7) values, which poll(2) shares
+const uint32_t kReadable = EPOLLIN;
+const uint32_t kWritable = EPOLLOUT;
+const uint32_t kPeerClosed = EPOLLRDHUP;
+const uint32_t kError = EPOLLERR;  // always reported
+const uint32_t kHangup = EPOLLHUP;  // always reported
+
+enum Backend { kBackendEpoll, kBackendIoUring };
+
+// "epoll" / "io_uring"; throws std::runtime_error on anything else
+Backend ParseBackend(const std::string& name);
+const char* BackendToString(Backend backend);
+
+struct Event {
+  void* data;
+  uint32_t events;
+};
+
+/*
+Readiness notification for the event loop, level-triggered: a descriptor is
+reported by every Wait() while it is ready for something it is watched for.
+Sockets only see this interface, so they run unchanged on either backend.
+
+Add(), Modify() and Remove() return 0, or -1 with errno set, like
+epoll_ctl(); a backend that batches them may report a failure later as
+kError | kHangup on the descriptor instead. Remove() must come before the
+descriptor is closed.
+*/
+class Poller {
+ public:
+  virtual ~Poller() {
+  }
+
+  virtual int Add(int fd, uint32_t events, void* data) = 0;
+  virtual int Modify(int fd, uint32_t events, void* data) = 0;
+  virtual int Remove(int fd) = 0;
+  // fills at most max_events, waiting up to timeout_ms when nothing is
+  // ready; returns the number filled, or -1 with errno set. An interrupted
+  // wait goes on for the time left (io_uring task work interrupts
+  // epoll_wait() without any signal), so a signal handler's flag is seen
+  // within timeout_ms
+  virtual int Wait(Event* events, int max_events, int timeout_ms) = 0;
+  virtual Backend GetBackend() const = 0;
+
+  // what a socket does on kReadable, through the poller so that a backend
+  // can do it in the kernel ahead of time (io_uring's multishot accept and
+  // recv). Accept() is accept4(SOCK_CLOEXEC) and Receive() is recv(): the
+  // same results, -1 with EAGAIN when there is nothing yet
+  virtual int Accept(int fd, sockaddr* addr, socklen_t* addr_len);
+  virtual ssize_t Receive(int fd, char* buf, size_t len);
+
+  // io_uring falls back to epoll (with a warning) when the kernel
+  // does not offer what the backend needs; throws std::runtime_error when
+  // no backend can be created
+  static Poller* Create(Backend backend);
+};
+
+}  // namespace event
+
+#endif  // EVENT_POLLER_HPP_
@@ -0,0 +1,149 @@
+#ifndef EVENT_URING_POLLER_HPP_
+#define EVENT_URING_POLLER_HPP_
+
+#include <linux/io_uring.h>
+#include <stdint.h>
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "event/Poller.hpp"
+#include "lib/type/Fd.hpp"
+
+namespace event {
+
+/*
+io_uring backend. Every watched descriptor has one one-shot
+IORING_OP_POLL_ADD in flight. Add/Modify only queue requests; Wait()
+submits them together with the wait in a single io_uring_enter(), and skips
+the syscall altogether while earlier completions are still unread. A
+completed poll is re-armed by the next Wait(), after the socket has acted
+on it, which keeps epoll's level-triggered behaviour (arming reports a
+descriptor that is still ready right away). Remove() submits its
+cancellation at once: an armed request holds a reference to the file, and
+the descriptor is closed right after.
+
+Once a socket calls Accept() or Receive(), its kReadable interest is served
+by a multishot IORING_OP_ACCEPT, or a multishot IORING_OP_RECV picking
+buffers from a ring registered with the kernel (IORING_REGISTER_PBUF_RING);
+the first call is the plain syscall. Completions are copied into the
+watch, each buffer goes straight back to the ring, and kReadable is
+reported while anything is left to take. A watch holding kMaxReceived bytes
+or kMaxAccepted connections cancels its request until the socket catches
+up; what the cancelled request still delivers is kept. Remove() drops
+what was not taken, closing accepted connections. Kernels without these
+(before 6.0) leave the descriptor on readiness.
+
+Requests carry (generation << 32 | kind << 30 | fd): a completion for a
+descriptor that was removed or re-armed since is recognised by its
+generation and dropped, after its buffer is recycled or its connection
+closed. Generation 0 marks cancellations, whose results are not needed.
+Writes (writev()/splice()) are still the sockets' own syscalls.
+*/
+class UringPoller : public Poller {
+ public:
+  // throws std::runtime_error when the ring cannot be set up or the kernel
+  // lacks IORING_FEAT_EXT_ARG (5.11) or IORING_FEAT_NODROP
+  UringPoller();
+  virtual ~UringPoller();
+
+  virtual int Add(int fd, uint32_t events, void* data);
+  virtual int Modify(int fd, uint32_t events, void* data);
+  virtual int Remove(int fd);
+  virtual int Wait(Event* events, int max_events, int timeout_ms);
+  virtual Backend GetBackend() const;
+  virtual int Accept(int fd, sockaddr* addr, socklen_t* addr_len);
+  virtual ssize_t Receive(int fd, char* buf, size_t len);
+
+  static const unsigned kRingEntries = 1024;
+  static const unsigned kRecvBuffers = 128;  // a power of two
+  static const size_t kRecvBufferSize = 16 * 1024;
+  static const size_t kMaxReceived = 64 * 1024;
+  static const size_t kMaxAccepted = 64;
+
+ private:
+  enum Kind { kPoll, kAccept, kRecv };
+
+  struct Watch {
+    void* data;
+    uint32_t events;
+    uint32_t generation;  // of the poll request
+    bool used;
+    bool armed;  // a poll request of this generation is in the kernel
+    // what serves kReadable: kPoll, or the multishot request's kind
+    Kind input;
+    uint32_t owner;  // generation of the Add(), tags the multishot request
+    bool input_armed;  // until its last completion (no IORING_CQE_F_MORE)
+    bool cancel_queued;  // not submitted yet; one that missed is sent again
+    bool input_eof;
+    int input_error;
+    std::string received;
+    size_t received_offset;  // taken so far
+    std::deque<int> accepted;
+    bool listed;  // in ready_
+    uint32_t batch;  // Harvest() that reported it last, at slot
+    int slot;
+
+    Watch();
+  };
+
+  UringPoller(const UringPoller& other);
+  UringPoller& operator=(const UringPoller& other);
+
+  void MapRings(const io_uring_params& params);
+  void UnmapRings();
+  void SetUpBufferRing();
+  void RecycleBuffer(uint16_t bid);
+  Watch* FindWatch(int fd);
+  void Disarm(int fd, Watch* watch);
+  void CancelInput(int fd, Watch* watch);
+  void ResetInput(Watch* watch);
+  bool WantsInput(const Watch& watch) const;
+  bool HasInput(const Watch& watch) const;
+  void InputTaken(int fd, Watch* watch);
+  void Flush();
+  bool Arm(int fd);
+  io_uring_sqe* NextSqe();
+  int Enter(unsigned min_complete, unsigned flags, void* arg, size_t size);
+  bool HasCompletions() const;
+  bool HasReadyInput() const;
+  int Harvest(Event* events, int max_events);
+  void Complete(const io_uring_cqe& cqe);
+  void CompleteInput(int fd, Watch* watch, const io_uring_cqe& cqe);
+  void Report(int fd, uint32_t bits, Event* events, int max_events, int* n);
+
+  lib::type::Fd ring_fd_;
+  void* sq_ring_;
+  size_t sq_ring_size_;
+  void* cq_ring_;
+  size_t cq_ring_size_;
+  io_uring_sqe* sqes_;
+  size_t sqes_size_;
+  unsigned* sq_head_;
+  unsigned* sq_tail_;
+  unsigned sq_mask_;
+  unsigned sq_entries_;
+  unsigned* cq_head_;
+  unsigned* cq_tail_;
+  unsigned cq_mask_;
+  io_uring_cqe* cqes_;
+  unsigned local_sq_tail_;  // SQEs written, published on Enter()
+  io_uring_buf_ring* buf_ring_;
+  char* recv_buffers_;
+  // cleared when the kernel rejects them; recv also needs the buffer ring
+  bool multishot_accept_;
+  bool multishot_recv_;
+
+  std::vector<Watch> watches_;  // indexed by fd
+  std::vector<int> to_arm_;  // fds whose requests have to be (re)queued
+  std::vector<uint64_t> to_cancel_;  // user_data of requests to cancel
+  std::vector<int> ready_;  // fds that may hold input to report
+  uint32_t next_generation_;
+  uint32_t batch_;
+};
+
+}  // namespace event
+
+#endif  // EVENT_URING_POLLER_HPP_
@@ -0,0 +1,22 @@
+#ifndef LIB_HTTP_CHUNKED_HPP_
+#define LIB_HTTP_CHUNKED_HPP_
+
+#include <cstddef>
+
+#include "lib/io/OutputQueue.hpp"
+
+namespace lib {
+namespace http {
+
+// RFC 9112 7.1 chunked transfer coding
+// an empty slice is skipped: a zero-size chunk would end the body
+void AppendChunk(lib::io::OutputQueue& out, const char* data, size_t len);
+// chunk-size line of a chunk whose data and CRLF are written separately
+void AppendChunkSize(lib::io::OutputQueue& out, size_t len);
+// last-chunk without trailers
+void AppendLastChunk(lib::io::OutputQueue& out);
+
+}  // namespace http
+}  // namespace lib
+
+#endif  // LIB_HTTP_CHUNKED_HPP_
@@ -0,0 +1,50 @@
+#ifndef LIB_HTTP_COMPRESSED_BODY_PRODUCER_HPP_
+#define LIB_HTTP_COMPRESSED_BODY_PRODUCER_HPP_
+
+#include <cstddef>
+
+#include "lib/http/ContentCoding.hpp"
+#include "lib/io/BodyProducer.hpp"
+#include "lib/io/Deflater.hpp"
+#include "lib/io/OutputQueue.hpp"
+
+namespace lib {
+namespace http {
+
+// Streams a gzip/deflate encoded copy of a buffered body.
+// Each Produce() deflates at most `budget` input bytes, which bounds the CPU
+// spent per writable event. Input is copied out of the source in kCopySize
+// pieces: mapped file segments are pread(), never touched in place, so a
+// file rewritten meanwhile makes Produce() throw std::runtime_error (the
+// connection is dropped) instead of crashing the server with SIGBUS.
+// With `chunked` every non-empty piece of output becomes one chunk and the
+// last call appends the last-chunk; without it the output is raw (the
+// caller delimits the body, e.g. by closing the connection).
+class CompressedBodyProducer : public lib::io::BodyProducer {
+ public:
+  // takes over the contents of source (it is left empty)
+  CompressedBodyProducer(lib::io::OutputQueue& source, ContentCoding coding,
+                         int level, bool chunked, size_t budget);
+  virtual ~CompressedBodyProducer();
+
+  virtual bool Produce(lib::io::OutputQueue& out);
+  virtual const lib::io::OutputQueue* PendingInput() const;
+
+  static const size_t kCopySize = 16384;
+
+ private:
+  CompressedBodyProducer();
+  CompressedBodyProducer(const CompressedBodyProducer& other);
+  CompressedBodyProducer& operator=(const CompressedBodyProducer& other);
+
+  lib::io::OutputQueue source_;
+  lib::io::Deflater deflater_;
+  bool chunked_;
+  size_t budget_;
+  bool finished_;
+};
+
+}  // namespace http
+}  // namespace lib
+
+#endif  // LIB_HTTP_COMPRESSED_BODY_PRODUCER_HPP_
@@ -0,0 +1,32 @@
+#ifndef LIB_HTTP_CONTENT_CODING_HPP_
+#define LIB_HTTP_CONTENT_CODING_HPP_
+
+#include <string>
+
+namespace lib {
+namespace http {
+
+enum ContentCoding {
+  kCodingIdentity,
+  kCodingGzip,
+  kCodingDeflate,  // zlib format (RFC 1950), as HTTP "deflate" is defined
+  kCodingBrotli    // only ever served precompressed (brotli_static)
+};
+
+// RFC 9110 12.5.3 Accept-Encoding
+// weight (0..1000) the header gives coding, "*" covering codings not listed
+// explicitly; 0 means not acceptable (also when the header is absent)
+int AcceptEncodingQvalue(const std::string& accept_encoding,
+                         ContentCoding coding);
+
+// coding for on-the-fly compression: the acceptable one with the highest
+// qvalue among gzip and deflate (gzip wins ties), identity when neither is
+ContentCoding SelectContentCoding(const std::string& accept_encoding);
+
+// value of the Content-Encoding header ("" for identity)
+std::string ContentCodingToString(ContentCoding coding);
+
+}  // namespace http
+}  // namespace lib
+
+#endif  // LIB_HTTP_CONTENT_CODING_HPP_
@@ -0,0 +1,23 @@
+#ifndef LIB_HTTP_ETAG_HPP_
+#define LIB_HTTP_ETAG_HPP_
+
+#include <sys/stat.h>
+
+#include <string>
+
+namespace lib {
+namespace http {
+
+// W/"<inode>-<size>-<mtime sec>.<mtime nsec>" in hex
+// weak because the mtime granularity cannot prove byte-for-byte identity
+std::string MakeWeakETag(const struct stat& st);
+
+// RFC 9110 13.1.2 If-None-Match: "*" or a list of entity-tags compared with
+// the weak comparison (8.8.3.2), i.e. the W/ prefix is ignored on both sides
+bool IfNoneMatchMatches(const std::string& header_value,
+                        const std::string& etag);
+
+}  // namespace http
+}  // namespace lib
+
+#endif  // LIB_HTTP_ETAG_HPP_
@@ -0,0 +1,24 @@
+#ifndef LIB_HTTP_HTTP_DATE_HPP_
+#define LIB_HTTP_HTTP_DATE_HPP_
+
+#include <ctime>
+#include <string>
+
+#include "lib/type/Optional.hpp"
+
+namespace lib {
+namespace http {
+
+// IMF-fixdate (RFC 9110 5.6.7), e.g. "Sun, 06 Nov 1994 08:49:37 GMT"
+std::string FormatHttpDate(time_t t);
+// FormatHttpDate(time(NULL)), formatted at most once per second
+const std::string& CurrentHttpDate();
+
+// only IMF-fixdate is accepted; the obsolete RFC 850 and asctime forms are
+// treated as invalid, which makes conditional headers using them ignored
+lib::type::Optional<time_t> ParseHttpDate(const std::string& s);
+
+}  // namespace http
+}  // namespace lib
+
+#endif  // LIB_HTTP_HTTP_DATE_HPP_
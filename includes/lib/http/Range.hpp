@@ -0,0 +1,41 @@
+#ifndef LIB_HTTP_RANGE_HPP_
+#define LIB_HTTP_RANGE_HPP_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace lib {
+namespace http {
+
+// inclusive byte positions, already clamped to the representation size
+struct ByteRange {
+  size_t first;
+  size_t last;
+
+  size_t Length() const {
+    return last - first + 1;
+  }
+};
+
+enum RangeResult {
+  kRangeIgnored,       // not a valid bytes range-set: serve the full 200
+  kRangeSatisfiable,   // ranges holds at least one range: serve 206
+  kRangeUnsatisfiable  // valid but no range overlaps the file: 416
+};
+
+// more ranges than this are ignored instead of answered piecewise
+const size_t kMaxRanges = 16;
+
+// RFC 9110 14.1.2 byte-range-spec / suffix-byte-range-spec
+// overlapping and adjacent ranges are coalesced (14.1.2 allows it) so a
+// client cannot make us send the same bytes many times
+RangeResult ParseRangeHeader(const std::string& value, size_t size,
+                             std::vector<ByteRange>* ranges);
+
+std::string ContentRangeValue(const ByteRange& range, size_t size);
+
+}  // namespace http
+}  // namespace lib
+
+#endif  // LIB_HTTP_RANGE_HPP_
@@ -0,0 +1,58 @@
+#ifndef LIB_HTTP_SPLICED_BODY_HPP_
+#define LIB_HTTP_SPLICED_BODY_HPP_
+
+#include <sys/types.h>
+
+#include <cstddef>
+
+#include "lib/io/OutputQueue.hpp"
+#include "lib/io/SplicePipe.hpp"
+
+namespace lib {
+namespace http {
+
+// Counterpart of StreamedBodyProducer for an identity-coded body that goes
+// from the source's descriptor to the peer's through a SplicePipe: the
+// source Fill()s the pipe and ends the body with Finish() or Abort(), the
+// peer's side alternates Produce() and SpliceTo(). Only the framing (chunk
+// size lines, CRLFs, last-chunk) is written from user space.
+class SplicedBody {
+ public:
+  // throws std::runtime_error when no pipe can be made
+  explicit SplicedBody(bool chunked);
+  ~SplicedBody();
+
+  // see SplicePipe::FillFrom()
+  ssize_t Fill(int in);
+  void Finish();
+  void Abort();
+
+  size_t Pending() const;  // in the pipe
+  bool IsFull() const;
+
+  // appends the framing due before the next SpliceTo(); call only once out
+  // has been written. true: the body is complete, out carries its end
+  bool Produce(lib::io::OutputQueue& out);
+  // pipe bytes of the current chunk to fd; 0 when there are none yet, -1
+  // with errno set
+  ssize_t SpliceTo(int fd);
+
+ private:
+  enum SourceState { kOpen, kFinished, kAborted };
+
+  SplicedBody();
+  SplicedBody(const SplicedBody& other);
+  SplicedBody& operator=(const SplicedBody& other);
+
+  lib::io::SplicePipe pipe_;
+  bool chunked_;
+  SourceState source_state_;
+  size_t chunk_left_;  // bytes of the announced chunk still in the pipe
+  bool chunk_open_;    // a chunk awaits its CRLF
+  bool finished_;
+};
+
+}  // namespace http
+}  // namespace lib
+
+#endif  // LIB_HTTP_SPLICED_BODY_HPP_
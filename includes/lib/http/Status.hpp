@@ -12,7 +12,9 @@ enum Status {
   kAccepted = 202,
   kNoContent = 204,
   kResetContent = 205,
+  kPartialContent = 206,
   kFound = 302,
+  kNotModified = 304,
   kTemporaryRedirect = 307,
   kBadRequest = 400,
   kUnauthorized = 401,
@@ -23,10 +25,13 @@ enum Status {
   kLengthRequired = 411,
   kPayloadTooLarge = 413,
   kUriTooLong = 414,
+  kRangeNotSatisfiable = 416,
   kRequestHeaderFieldsTooLarge = 431,
   kInternalServerError = 500,
   kNotImplemented = 501,
-  kBadGateway = 502
+  kBadGateway = 502,
+  kServiceUnavailable = 503,
+  kGatewayTimeout = 504
 };
 
 std::string StatusToString(Status status);
@@ -0,0 +1,64 @@
+#ifndef LIB_HTTP_STREAMED_BODY_PRODUCER_HPP_
+#define LIB_HTTP_STREAMED_BODY_PRODUCER_HPP_
+
+#include <cstddef>
+#include <string>
+
+#include "lib/http/ContentCoding.hpp"
+#include "lib/io/BodyProducer.hpp"
+#include "lib/io/Deflater.hpp"
+#include "lib/io/OutputQueue.hpp"
+
+namespace lib {
+namespace http {
+
+// Body whose bytes arrive while the response is already being sent (CGI
+// output). The source Feed()s what it reads and ends the body with Finish(),
+// or with Abort() when it failed: what was fed still goes out, but an
+// aborted chunked body lacks the last-chunk, so the peer sees it truncated
+// instead of complete.
+// Each Produce() moves at most `chunk_limit` fed bytes into one chunk (or
+// raw piece without `chunked`), optionally gzip/deflate encoded; encoded
+// output is flushed whenever the fed bytes run out so a slow source is not
+// held back by the compressor.
+class StreamedBodyProducer : public lib::io::BodyProducer {
+ public:
+  StreamedBodyProducer(bool chunked, size_t chunk_limit);
+  StreamedBodyProducer(bool chunked, size_t chunk_limit, ContentCoding coding,
+                       int level);
+  virtual ~StreamedBodyProducer();
+
+  void Feed(const char* data, size_t len);
+  void Feed(const lib::io::OutputQueue& data);
+  void Finish();
+  void Abort();
+
+  // fed bytes not produced yet
+  size_t Pending() const;
+  // Produce() has nothing to add until the source feeds or ends the body
+  bool IsStarved() const;
+  void SetChunkLimit(size_t chunk_limit);
+
+  virtual bool Produce(lib::io::OutputQueue& out);
+
+ private:
+  enum SourceState { kOpen, kFinished, kAborted };
+
+  StreamedBodyProducer();
+  StreamedBodyProducer(const StreamedBodyProducer& other);
+  StreamedBodyProducer& operator=(const StreamedBodyProducer& other);
+
+  void Emit(lib::io::OutputQueue& out, const std::string& piece) const;
+
+  lib::io::OutputQueue source_;
+  lib::io::Deflater* deflater_;  // NULL: identity
+  bool chunked_;
+  size_t chunk_limit_;
+  SourceState source_state_;
+  bool finished_;
+};
+
+}  // namespace http
+}  // namespace lib
+
+#endif  // LIB_HTTP_STREAMED_BODY_PRODUCER_HPP_
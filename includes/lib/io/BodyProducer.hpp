@@ -0,0 +1,31 @@
+#ifndef LIB_IO_BODY_PRODUCER_HPP_
+#define LIB_IO_BODY_PRODUCER_HPP_
+
+#include "lib/io/OutputQueue.hpp"
+
+namespace lib {
+namespace io {
+
+// Response body generated while the connection drains instead of up front.
+// The owning socket calls Produce() on writable events once its queue runs
+// low; each call does a bounded amount of work so one large body cannot
+// stall the event loop.
+class BodyProducer {
+ public:
+  virtual ~BodyProducer() {
+  }
+
+  // appends the next piece of the body (may append nothing)
+  // returns true once the body, including any framing, is fully queued
+  virtual bool Produce(OutputQueue& out) = 0;
+  // buffered input the next Produce() reads, so mapped slices in it can
+  // be paged in ahead of time; NULL when the producer has none
+  virtual const OutputQueue* PendingInput() const {
+    return NULL;
+  }
+};
+
+}  // namespace io
+}  // namespace lib
+
+#endif  // LIB_IO_BODY_PRODUCER_HPP_
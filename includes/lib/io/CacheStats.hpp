@@ -0,0 +1,21 @@
+#ifndef LIB_IO_CACHE_STATS_HPP_
+#define LIB_IO_CACHE_STATS_HPP_
+
+#include <stdint.h>
+
+namespace lib {
+namespace io {
+
+// lookups answered from / missed by a process-wide cache (metrics page)
+struct CacheStats {
+  uint64_t hits;
+  uint64_t misses;
+
+  CacheStats() : hits(0), misses(0) {
+  }
+};
+
+}  // namespace io
+}  // namespace lib
+
+#endif  // LIB_IO_CACHE_STATS_HPP_
@@ -0,0 +1,42 @@
+#ifndef LIB_IO_DEFLATER_HPP_
+#define LIB_IO_DEFLATER_HPP_
+
+#include <zlib.h>
+
+#include <cstddef>
+#include <string>
+
+namespace lib {
+namespace io {
+
+// Incremental zlib deflate stream producing gzip (RFC 1952) or zlib
+// (RFC 1950) framed output. Input can be fed in arbitrary slices; output
+// is appended to the caller's string as zlib releases it.
+class Deflater {
+ public:
+  enum Format { kGzip, kZlib };
+
+  // level: 1 (fastest) .. 9 (smallest); throws std::runtime_error
+  Deflater(Format format, int level);
+  ~Deflater();
+
+  void Update(const char* data, size_t len, std::string* out);
+  // Z_SYNC_FLUSH: everything fed so far becomes decodable output
+  void Flush(std::string* out);
+  // flushes pending output and the stream trailer; no Update() afterwards
+  void Finish(std::string* out);
+
+ private:
+  Deflater();
+  Deflater(const Deflater& other);
+  Deflater& operator=(const Deflater& other);
+
+  void Run(int flush, std::string* out);
+
+  z_stream stream_;
+};
+
+}  // namespace io
+}  // namespace lib
+
+#endif  // LIB_IO_DEFLATER_HPP_
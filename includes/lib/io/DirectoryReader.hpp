@@ -0,0 +1,29 @@
+#ifndef LIB_IO_DIRECTORY_READER_HPP_
+#define LIB_IO_DIRECTORY_READER_HPP_
+
+#include <string>
+#include <vector>
+
+namespace lib {
+namespace io {
+
+struct DirEntry {
+  std::string name;
+  bool is_dir;
+};
+
+/*
+Lists a directory with raw getdents64(2) into a large buffer: one syscall
+returns hundreds of entries, and d_type gives the file type without a
+stat() per entry. Only filesystems that report DT_UNKNOWN pay an
+fstatat() for those entries.
+".", ".." and hidden (dot) entries are skipped; order is the kernel's.
+throws lib::exception::ResponseStatusException when path cannot be listed
+*/
+void ReadDirectoryOrThrow(const std::string& path,
+                          std::vector<DirEntry>* entries);
+
+}  // namespace io
+}  // namespace lib
+
+#endif  // LIB_IO_DIRECTORY_READER_HPP_
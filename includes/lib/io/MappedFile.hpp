@@ -0,0 +1,78 @@
+#ifndef LIB_IO_MAPPED_FILE_HPP_
+#define LIB_IO_MAPPED_FILE_HPP_
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <cstddef>
+#include <string>
+
+#include "lib/io/CacheStats.hpp"
+
+namespace lib {
+namespace io {
+
+/*
+Refcounted handle to a read-only mapping of a whole file.
+
+Mappings are shared through a process-wide cache keyed by (st_dev, st_ino).
+A cached mapping is reused only while the size and mtime reported by stat()
+still match; otherwise a fresh mapping replaces it in the cache and the old
+one stays alive until its last handle is released.
+Handles may be copied and released on different threads; the cache and
+the refcounts share one lock.
+
+Mappings only get MADV_SEQUENTIAL; readahead is requested per queued slice
+(see OutputQueue::Append) so range requests do not prefetch the file head.
+
+NOTE: a file truncated while it is mapped makes the tail pages unbackable.
+writev() then fails with EFAULT (the connection is dropped), but touching
+those pages from user space raises SIGBUS, so callers must not materialize
+mapped bodies of files that may be rewritten in place. Code that needs the
+bytes in user space (body filters) copies them with Read(), which sees the
+file shrink as a short count instead.
+*/
+class MappedFile {
+ public:
+  MappedFile();
+  MappedFile(const MappedFile& other);
+  MappedFile& operator=(const MappedFile& other);
+  ~MappedFile();
+
+  // st must be the stat() result of path (regular file, non-empty)
+  // throws lib::exception::ResponseStatusException on failure
+  static MappedFile Open(const std::string& path, const struct stat& st);
+
+  const char* Data() const;
+  size_t Size() const;
+  bool IsValid() const;
+  // pread()s up to len bytes at offset from the mapped file; fewer than
+  // asked (within Size()) when the file has shrunk, -1 with errno set
+  ssize_t Read(size_t offset, char* buf, size_t len) const;
+  // MADV_WILLNEED for the head of [offset, offset + length)
+  void AdviseWillNeed(size_t offset, size_t length) const;
+  // mincore(): every page of [offset, offset + length) is in the page
+  // cache, so touching it does not wait for the disk
+  bool IsResident(size_t offset, size_t length) const;
+  // blocks until [offset, offset + length) is in the page cache (aio pool
+  // threads); false when the file has shrunk or cannot be read
+  bool Populate(size_t offset, size_t length) const;
+
+  // number of mappings currently alive (cached or still referenced)
+  static size_t LiveMappingCount();
+  // Open() calls that reused a cached mapping / had to mmap()
+  static CacheStats CacheCounters();
+
+  struct Mapping;  // opaque, defined in MappedFile.cpp
+
+ private:
+  explicit MappedFile(Mapping* mapping);  // adopts one reference
+  void Release();
+
+  Mapping* mapping_;
+};
+
+}  // namespace io
+}  // namespace lib
+
+#endif  // LIB_IO_MAPPED_FILE_HPP_
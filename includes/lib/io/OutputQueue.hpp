@@ -0,0 +1,80 @@
+#ifndef LIB_IO_OUTPUT_QUEUE_HPP_
+#define LIB_IO_OUTPUT_QUEUE_HPP_
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <deque>
+#include <string>
+
+#include "lib/io/MappedFile.hpp"
+#include "lib/type/SharedPtr.hpp"
+
+namespace lib {
+namespace io {
+
+// Ordered list of byte segments waiting to be written to a socket.
+// A segment is an owned string, a slice of a shared file mapping or a shared
+// immutable buffer (cached generated bodies), so the latter two reach
+// writev() without being copied.
+class OutputQueue {
+ public:
+  OutputQueue();
+  ~OutputQueue();
+
+  void Append(const std::string& data);
+  void Append(const char* data, size_t len);
+  void Append(const MappedFile& file, size_t offset, size_t length);
+  void Append(const lib::type::SharedPtr<const std::string>& buffer);
+  void Append(const OutputQueue& other);
+
+  bool Empty() const;
+  size_t Size() const;  // pending bytes
+  void Clear();
+  void Swap(OutputQueue& other);
+
+  // in-process readers (body filters): *data points at the contiguous head
+  // of the queue, valid until the next modification; returns its length
+  size_t Peek(const char** data) const;
+  // drops n pending bytes from the front (n <= Size())
+  void Consume(size_t n);
+  // copies up to len pending bytes from the front without dropping them;
+  // mapped slices are read with MappedFile::Read(), so a file truncated
+  // meanwhile throws std::runtime_error instead of raising SIGBUS
+  size_t CopyOut(char* buf, size_t len) const;
+  // the first pending mapped slice, whose pages writev() or CopyOut() reach
+  // next (read ahead on the aio pool); false when none is queued
+  bool FirstMappedSlice(MappedFile* file, size_t* offset,
+                        size_t* length) const;
+
+  // copies every pending byte (tests, CGI, debug logging)
+  std::string ToString() const;
+
+  // writev() as many pending bytes as the kernel accepts and drop them
+  // returns the writev() result (-1 with errno set on failure)
+  ssize_t WriteTo(int fd);
+
+  static const size_t kMaxIovecs = 64;
+  // small strings are coalesced into the previous string segment
+  static const size_t kCoalesceLimit = 16384;
+
+ private:
+  struct Segment {
+    std::string data;
+    MappedFile file;
+    lib::type::SharedPtr<const std::string> shared;
+    size_t offset;
+    size_t length;
+
+    const char* Begin() const;
+    bool IsOwned() const;  // data holds the bytes
+  };
+
+  std::deque<Segment> segments_;
+  size_t size_;
+};
+
+}  // namespace io
+}  // namespace lib
+
+#endif  // LIB_IO_OUTPUT_QUEUE_HPP_
@@ -0,0 +1,46 @@
+#ifndef LIB_IO_RING_BUFFER_HPP_
+#define LIB_IO_RING_BUFFER_HPP_
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace lib {
+namespace io {
+
+/*
+Fixed-capacity byte FIFO. Appending copies into the ring without allocating;
+WriteTo() hands the pending bytes to the kernel with a single writev() of at
+most two pieces (before and after the wrap point).
+*/
+class RingBuffer {
+ public:
+  explicit RingBuffer(size_t capacity);  // capacity > 0
+
+  // all or nothing: false (and nothing copied) when len > Available()
+  bool Append(const char* data, size_t len);
+  // writev() pending bytes to fd and drop what was written
+  // returns the writev() result (-1 with errno set on failure)
+  ssize_t WriteTo(int fd);
+  // appends every pending byte to out and drops them
+  void MoveTo(std::string* out);
+  void Clear();
+
+  size_t Size() const;
+  size_t Capacity() const;
+  size_t Available() const;
+  bool Empty() const;
+
+ private:
+  RingBuffer();
+  std::vector<char> data_;
+  size_t head_;  // first pending byte
+  size_t size_;
+};
+
+}  // namespace io
+}  // namespace lib
+
+#endif  // LIB_IO_RING_BUFFER_HPP_
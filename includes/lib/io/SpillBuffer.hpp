@@ -0,0 +1,63 @@
+#ifndef LIB_IO_SPILL_BUFFER_HPP_
+#define LIB_IO_SPILL_BUFFER_HPP_
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+#include "lib/type/Fd.hpp"
+#include "lib/type/SharedPtr.hpp"
+
+namespace lib {
+namespace io {
+
+/*
+Append-only byte sink for request bodies. The first memory_limit bytes stay
+in memory; once the body grows past that, everything moves to an unlinked
+temporary file, so a large upload costs disk space instead of heap.
+
+Copies share the temporary file; a copy that is appended to clones the file
+first, so each instance still sees only its own bytes.
+*/
+class SpillBuffer {
+ public:
+  static const size_t kDefaultMemoryLimit = 64 * 1024;
+  static const char* const kTempTemplate;
+
+  SpillBuffer();
+  explicit SpillBuffer(size_t memory_limit);
+
+  // throws lib::exception::ResponseStatusException (500) on I/O errors
+  void Append(const char* data, size_t len);
+  void Append(const std::string& data);
+  void Clear();
+
+  size_t Size() const;
+  bool Empty() const;
+  bool IsSpilled() const;
+  // the temporary file (read with pread(), offsets from 0); -1 in memory
+  int FileFd() const;
+
+  // materializes every byte (tests, small bodies)
+  std::string ToString() const;
+  // copies every byte to out, reading the file in blocks
+  void WriteTo(std::ostream& out) const;
+  // the same into a descriptor; throws lib::exception::ResponseStatusException
+  // (500) when a write fails
+  void WriteTo(int fd) const;
+
+ private:
+  void Spill();
+  void Unshare();
+  void WriteFile(const char* data, size_t len);
+
+  size_t memory_limit_;
+  std::string memory_;
+  lib::type::SharedPtr<lib::type::Fd> file_;
+  size_t size_;
+};
+
+}  // namespace io
+}  // namespace lib
+
+#endif  // LIB_IO_SPILL_BUFFER_HPP_
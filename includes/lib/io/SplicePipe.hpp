@@ -0,0 +1,52 @@
+#ifndef LIB_IO_SPLICE_PIPE_HPP_
+#define LIB_IO_SPLICE_PIPE_HPP_
+
+#include <sys/types.h>
+
+#include <cstddef>
+
+#include "lib/type/Fd.hpp"
+
+namespace lib {
+namespace io {
+
+/*
+Kernel pipe that moves bytes between two descriptors with splice(2), so
+they never enter user space: FillFrom() takes what a socket has and
+DrainTo() passes it on. Neither blocks. The pipe may fill up before Size()
+reaches its nominal capacity (socket pages are moved partly used), so
+IsFull() reports the last FillFrom() finding no room rather than a count.
+*/
+class SplicePipe {
+ public:
+  // throws std::runtime_error when no pipe can be made
+  SplicePipe();
+  ~SplicePipe();
+
+  // bytes moved in; 0 at EOF of in; -1 with errno set (EAGAIN: in has
+  // nothing now or the pipe is full)
+  ssize_t FillFrom(int in);
+  // at most max held bytes; -1 with errno set (EAGAIN: out is full)
+  ssize_t DrainTo(int out, size_t max);
+
+  size_t Size() const;  // held bytes
+  bool IsFull() const;
+
+  // asked for; the kernel may round it or refuse it (pipe-max-size)
+  static const int kCapacity = 256 * 1024;
+
+ private:
+  SplicePipe(const SplicePipe& other);
+  SplicePipe& operator=(const SplicePipe& other);
+
+  lib::type::Fd read_end_;
+  lib::type::Fd write_end_;
+  size_t capacity_;
+  size_t size_;
+  bool full_;
+};
+
+}  // namespace io
+}  // namespace lib
+
+#endif  // LIB_IO_SPLICE_PIPE_HPP_
@@ -0,0 +1,42 @@
+#ifndef LIB_IO_STAT_CACHE_HPP_
+#define LIB_IO_STAT_CACHE_HPP_
+
+#include <sys/stat.h>
+
+#include <ctime>
+#include <string>
+
+#include "lib/io/CacheStats.hpp"
+
+namespace lib {
+namespace io {
+
+/*
+Process-wide cache of stat() results for paths that are probed on every
+request but rarely change, e.g. precompressed siblings of static files.
+
+Misses are cached too, so probing for files that do not exist costs a map
+lookup instead of a syscall. Entries are trusted for kValidSeconds; a file
+created or removed within that window may be reported stale once.
+Thread-safe; the stat() of a miss runs without the lock held.
+*/
+class StatCache {
+ public:
+  static const time_t kValidSeconds = 1;
+  static const size_t kMaxEntries = 4096;
+
+  // true and *st filled when path exists; any stat() error is a miss
+  static bool Lookup(const std::string& path, struct stat* st);
+  // drops every entry (tests, reloads)
+  static void Clear();
+  static size_t Size();
+  static CacheStats Stats();
+
+ private:
+  StatCache();
+};
+
+}  // namespace io
+}  // namespace lib
+
+#endif  // LIB_IO_STAT_CACHE_HPP_
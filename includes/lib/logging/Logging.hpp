@@ -0,0 +1,33 @@
+#ifndef LIB_LOGGING_LOGGING_HPP_
+#define LIB_LOGGING_LOGGING_HPP_
+
+#include <iostream>
+#include <string>
+
+namespace lib {
+namespace logging {
+
+enum Level { kDebug, kInfo, kWarn, kError };
+
+// process-wide threshold; messages below it are dropped (default kInfo)
+void SetLevel(Level level);
+Level GetLevel();
+bool IsEnabled(Level level);
+// "debug", "info", "warn" or "error"; throws std::runtime_error otherwise
+Level ParseLevel(const std::string& name);
+
+}  // namespace logging
+}  // namespace lib
+
+/*
+WEBSERV_LOG(kDebug) << "Best match: " << name << std::endl;
+
+Streams to std::cerr only when the level is enabled. Otherwise the message
+is not formatted at all: the operands after the macro are never evaluated.
+*/
+#define WEBSERV_LOG(level)                                    \
+  if (!lib::logging::IsEnabled(lib::logging::level)) {        \
+  } else                                                      \
+    std::cerr
+
+#endif  // LIB_LOGGING_LOGGING_HPP_
@@ -14,6 +14,9 @@ namespace parser {
 //   - return false if it needs more data (no state change)
 //   - or consume from buffer_ and update state_
 // - When state becomes kDone, Parse() returns.
+// Consumers move buffer_read_pos_ past what they used (Consume()) instead of
+// erasing the front; Parse() compacts before appending, so buffer_ holds
+// roughly the unread bytes plus one read however much passes through it.
 class StreamParser {
  public:
   enum State { kHeader = 0, kBody = 1, kDone = 2 };
@@ -37,6 +40,10 @@ class StreamParser {
   virtual void OnInternalStateError() = 0;
   virtual void OnExtraDataAfterDone() = 0;
 
+  // marks n more bytes as read (n <= UnreadSize())
+  void Consume(size_t n);
+  size_t UnreadSize() const;
+
   bool IsCRLF(const char* p) const;
   bool IsLF(const char* p) const;
   std::string::size_type FindEndOfHeader(const std::string& payload);
@@ -48,6 +55,9 @@ class StreamParser {
   const char* ReadHeaderLine(const char* req, std::string& key,
                              std::string& value, size_t& total_len,
                              size_t max_size);
+
+ private:
+  void Compact();
 };
 
 }  // namespace parser
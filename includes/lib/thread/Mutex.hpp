@@ -0,0 +1,65 @@
+#ifndef LIB_THREAD_MUTEX_HPP_
+#define LIB_THREAD_MUTEX_HPP_
+
+#include <pthread.h>
+
+namespace lib {
+namespace thread {
+
+// pthread mutex; guards the process-wide caches shared with the aio pool
+class Mutex {
+ public:
+  Mutex();
+  ~Mutex();
+
+  void Lock();
+  void Unlock();
+
+ private:
+  friend class Condition;
+
+  Mutex(const Mutex& other);
+  Mutex& operator=(const Mutex& other);
+
+  pthread_mutex_t mutex_;
+};
+
+// holds mutex for the enclosing scope
+class ScopedLock {
+ public:
+  explicit ScopedLock(Mutex& mutex) : mutex_(mutex) {
+    mutex_.Lock();
+  }
+
+  ~ScopedLock() {
+    mutex_.Unlock();
+  }
+
+ private:
+  ScopedLock(const ScopedLock& other);
+  ScopedLock& operator=(const ScopedLock& other);
+
+  Mutex& mutex_;
+};
+
+class Condition {
+ public:
+  Condition();
+  ~Condition();
+
+  // mutex must be locked; it is again when Wait() returns
+  void Wait(Mutex& mutex);
+  void Signal();
+  void Broadcast();
+
+ private:
+  Condition(const Condition& other);
+  Condition& operator=(const Condition& other);
+
+  pthread_cond_t cond_;
+};
+
+}  // namespace thread
+}  // namespace lib
+
+#endif  // LIB_THREAD_MUTEX_HPP_
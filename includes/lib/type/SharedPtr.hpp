@@ -0,0 +1,101 @@
+#ifndef LIB_TYPE_SHARED_PTR_HPP_
+#define LIB_TYPE_SHARED_PTR_HPP_
+
+#include <cstddef>
+
+namespace lib {
+namespace type {
+
+// Reference-counted owner of a heap object (C++98 stand-in for
+// std::shared_ptr). The count is atomic, so copies may live on different
+// threads (aio pool); the object itself is not synchronized.
+// GCC 12+ takes the refcount reads after another owner's delete for a
+// use-after-free once everything is inlined; the warning is off for this
+// class only.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 12
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuse-after-free"
+#endif
+template <typename T>
+class SharedPtr {
+ public:
+  SharedPtr() : ptr_(NULL), count_(NULL) {
+  }
+
+  // takes ownership of ptr (may be NULL)
+  explicit SharedPtr(T* ptr) : ptr_(ptr), count_(ptr ? new long(1) : NULL) {
+  }
+
+  SharedPtr(const SharedPtr& other) : ptr_(other.ptr_), count_(other.count_) {
+    if (count_) __sync_add_and_fetch(count_, 1);
+  }
+
+  // SharedPtr<const T> from SharedPtr<T>
+  template <typename U>
+  SharedPtr(const SharedPtr<U>& other)
+      : ptr_(other.ptr_), count_(other.count_) {
+    if (count_) __sync_add_and_fetch(count_, 1);
+  }
+
+  ~SharedPtr() {
+    Release();
+  }
+
+  SharedPtr& operator=(const SharedPtr& rhs) {
+    if (count_ != rhs.count_) {
+      Release();
+      ptr_ = rhs.ptr_;
+      count_ = rhs.count_;
+      if (count_) __sync_add_and_fetch(count_, 1);
+    }
+    return *this;
+  }
+
+  void Reset() {
+    Release();
+  }
+
+  T* Get() const {
+    return ptr_;
+  }
+
+  T& operator*() const {
+    return *ptr_;
+  }
+
+  T* operator->() const {
+    return ptr_;
+  }
+
+  bool IsNull() const {
+    return ptr_ == NULL;
+  }
+
+  long UseCount() const {
+    return count_ ? *count_ : 0;
+  }
+
+ private:
+  template <typename U>
+  friend class SharedPtr;
+
+  void Release() {
+    if (count_ && __sync_sub_and_fetch(count_, 1) == 0) {
+      delete ptr_;
+      delete count_;
+    }
+    ptr_ = NULL;
+    count_ = NULL;
+  }
+
+  T* ptr_;
+  long* count_;
+};
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 12
+#pragma GCC diagnostic pop
+#endif
+
+}  // namespace type
+}  // namespace lib
+
+#endif  // LIB_TYPE_SHARED_PTR_HPP_
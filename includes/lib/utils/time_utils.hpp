@@ -0,0 +1,15 @@
+#ifndef LIB_UTILS_TIME_UTILS_HPP_
+#define LIB_UTILS_TIME_UTILS_HPP_
+
+#include <stdint.h>
+
+namespace lib {
+namespace utils {
+
+// CLOCK_MONOTONIC in microseconds; only differences are meaningful
+uint64_t MonotonicMicros();
+
+}  // namespace utils
+}  // namespace lib
+
+#endif  // LIB_UTILS_TIME_UTILS_HPP_
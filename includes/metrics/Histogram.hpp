@@ -0,0 +1,51 @@
+#ifndef METRICS_HISTOGRAM_HPP_
+#define METRICS_HISTOGRAM_HPP_
+
+#include <stdint.h>
+
+#include <cstddef>
+
+namespace metrics {
+
+/*
+Fixed-size histogram with log-linear buckets in the spirit of HdrHistogram:
+every power of two is split into kSubBuckets equal sub-buckets, so a bucket
+is never wider than 1/kSubBuckets of the values it holds. Recording is an
+index computation and an increment; merging is element-wise addition.
+
+Values are unit-less (the metrics module records microseconds). Values past
+the last bucket boundary are counted in the last bucket.
+*/
+class Histogram {
+ public:
+  static const size_t kSubBucketBits = 1;
+  static const size_t kSubBuckets = 1 << kSubBucketBits;
+  // boundaries up to 2^27; in microseconds about 134 seconds
+  static const size_t kBucketCount = 54;
+
+  Histogram();
+
+  void Record(uint64_t value);
+  void Merge(const Histogram& other);
+  void Clear();
+
+  uint64_t Count() const;
+  uint64_t Sum() const;
+  uint64_t BucketValue(size_t index) const;  // count in bucket index
+  // upper boundary of the bucket holding the value at quantile fraction
+  // (0..1], i.e. an over-estimate by at most one bucket width; 0 when empty
+  uint64_t ValueAtQuantile(double fraction) const;
+
+  static size_t BucketIndex(uint64_t value);
+  // exclusive upper boundary of bucket index
+  static uint64_t BucketUpperBound(size_t index);
+
+ private:
+  uint64_t buckets_[kBucketCount];
+  uint64_t count_;
+  uint64_t sum_;
+};
+
+}  // namespace metrics
+
+#endif  // METRICS_HISTOGRAM_HPP_
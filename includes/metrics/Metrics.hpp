@@ -0,0 +1,98 @@
+#ifndef METRICS_METRICS_HPP_
+#define METRICS_METRICS_HPP_
+
+#include <stdint.h>
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "aio/Task.hpp"
+#include "lib/io/CacheStats.hpp"
+#include "metrics/Histogram.hpp"
+#include "trace/Trace.hpp"
+
+/*
+Process-wide counters behind the stub_status page.
+
+Every worker thread writes only its own slot (see Worker.hpp), and slots
+are cache-line aligned, so recording is a plain increment without locks or
+shared cache lines. Collect() sums the slots when the status page is
+requested.
+*/
+namespace metrics {
+
+enum Counter {
+  kConnectionsAccepted,
+  kConnectionsHandled,  // accepted and given a ClientSocket
+  kConnectionsClosed,
+  kBytesReceived,
+  kBytesSent,
+  kCgiSpawned,
+  kCgiTimeouts,  // cgi_read_timeout / cgi_total_timeout hit
+  kCgiQueued,    // requests that waited for a cgi_max_concurrent slot
+  kCgiDequeued,  // ... and left the queue (admitted or gave up)
+  kCgiRejected,  // turned away with the queue full
+  kCgiCacheHits,       // cgi_cache lookups answered by a fresh entry
+  kCgiCacheStale,      // ... by a stale entry (stale=)
+  kCgiCacheMisses,     // ... that ran the script to fill the entry
+  kCgiCacheCollapsed,  // ... that waited for another request's fill
+  kCgiBytesSpliced,    // CGI body bytes relayed with splice()
+  kAioRejected,  // aio pool queue full
+  kCounterCount
+};
+
+typedef size_t LocationId;
+
+// request_duration series; later names share the last one ("other")
+const size_t kMaxLocations = 64;
+// requests that matched no location (404 before routing)
+const LocationId kUnmatchedLocation = 0;
+
+void Add(Counter counter, uint64_t n);
+void Increment(Counter counter);
+// status and time from the first request byte until the connection closes
+void RecordRequest(LocationId location, int status, uint64_t micros);
+// time from fork() until the CGI script exited
+void RecordCgiDuration(uint64_t micros);
+// time a request waited for a cgi_max_concurrent slot
+void RecordCgiQueueWait(uint64_t micros);
+// every span the finished request's trace reached
+void RecordTrace(const trace::Trace& trace);
+// an aio task: time queued before a thread took it, then time running
+void RecordAio(aio::Op op, uint64_t wait_micros, uint64_t run_micros);
+
+// interns a location name at config load; the same name maps to the same id
+LocationId RegisterLocation(const std::string& name);
+
+struct Snapshot {
+  uint64_t counters[kCounterCount];
+  std::map<int, uint64_t> requests_by_status;
+  // locations with at least one request
+  std::vector<std::pair<std::string, Histogram> > request_duration;
+  Histogram cgi_duration;
+  Histogram cgi_queue_wait;
+  Histogram phase_duration[trace::kSpanCount];
+  Histogram aio_wait[aio::kOpCount];
+  Histogram aio_run[aio::kOpCount];
+  std::vector<std::pair<std::string, lib::io::CacheStats> > caches;
+
+  Snapshot();
+  uint64_t Requests() const;
+  uint64_t ActiveConnections() const;
+};
+
+Snapshot Collect();
+// zeroes every slot (tests); registered locations are kept
+void Reset();
+
+// nginx stub_status text
+std::string RenderStubStatus(const Snapshot& snapshot);
+// Prometheus text exposition format 0.0.4
+std::string RenderPrometheus(const Snapshot& snapshot);
+
+}  // namespace metrics
+
+#endif  // METRICS_METRICS_HPP_
@@ -7,6 +7,8 @@
 #include <ctime>
 #include <string>
 
+#include "event/Poller.hpp"
+#include "lib/io/OutputQueue.hpp"
 #include "lib/type/Fd.hpp"
 
 class ASocket;
@@ -33,23 +35,33 @@ class ASocket {
     return last_activity_time_ < threshold_time;
   }
 
-  virtual SocketResult HandleEvent(int epoll_fd, uint32_t events) = 0;
+  virtual SocketResult HandleEvent(event::Poller& poller, uint32_t events) = 0;
 
-  virtual void HandleTimeout(int epoll_fd) {
-    (void)epoll_fd;
+  virtual void HandleTimeout(event::Poller& poller) {
+    (void)poller;
   }
 
   virtual void OnSetOwner(ClientSocket* owner) {
     (void)owner;
   }
 
+  // the loop could not watch the new socket and is about to delete it
+  virtual void OnPollerAddFailed(event::Poller& poller) {
+    (void)poller;
+  }
+
+  // true when closing the socket loses no work (graceful shutdown)
+  virtual bool IsIdle() const {
+    return false;
+  }
+
   int GetFd() const;
 
  protected:
   lib::type::Fd fd_;
   time_t last_activity_time_;
   std::string read_buffer_;
-  std::string write_buffer_;
+  lib::io::OutputQueue write_queue_;
   void SetNonBlocking() const;
 };
 
@@ -1,27 +1,96 @@
 #ifndef CGISOCKET_HPP
 #define CGISOCKET_HPP
 
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <ctime>
 #include <string>
 
+#include "CgiCache.hpp"
+#include "CgiLimiter.hpp"
+#include "CgiResponseParser.hpp"
+#include "lib/http/SplicedBody.hpp"
+#include "lib/http/Status.hpp"
+#include "lib/type/SharedPtr.hpp"
 #include "socket/ASocket.hpp"
 
 class ClientSocket;
 
+// Reads a CGI script's output and hands it to the owning client as it
+// arrives: the parsed header block once (OnCgiHeaders), then every body
+// read (OnCgiBody) and finally the end of the body. The owner pauses the
+// pipe while its client falls behind.
+//
+// At EOF the socket swaps the pipe for a pidfd of the script in the poller
+// and ends the body once the exit status is in; nothing waits in
+// waitpid(). A script it gives up on (timeout, client gone) is handed to
+// cgi::CgiReaper.
+//
+// With a cgi::CacheFill the output is also collected for the location's
+// cgi_cache; a fill keeps the socket reading after its client has gone, or
+// without one at all (background refresh of a stale entry).
+//
+// A header block with X-Accel-Redirect or X-Sendfile goes to the owner as
+// an internal redirect instead; the owner detaches and the rest of the
+// output is drained.
+//
+// Once the owner relays the body through a pipe (GetCgiSplice()), reads
+// splice the output into it instead and only announce it (OnCgiBodySpliced);
+// a full pipe pauses the script like a client that falls behind.
 class CgiSocket : public ASocket {
  public:
-  CgiSocket(lib::type::Fd fd, int pid);
+  // timeouts in seconds, see Location::GetCgiReadTimeout()
+  CgiSocket(lib::type::Fd fd, pid_t pid, int read_timeout, int total_timeout);
   virtual ~CgiSocket();
 
-  virtual SocketResult HandleEvent(int epoll_fd, uint32_t events);
+  virtual SocketResult HandleEvent(event::Poller& poller, uint32_t events);
   ssize_t Send(const std::string& data);
   virtual void OnSetOwner(ClientSocket* owner);
+  // cgi_read_timeout / cgi_total_timeout; while paused only the latter,
+  // since the owner's pace governs
+  virtual bool IsTimeout(time_t threshold_time) const;
+  virtual void HandleTimeout(event::Poller& poller);
+  virtual void OnPollerAddFailed(event::Poller& poller);
+
+  // stop / restart reading (the script blocks once the pipe fills)
+  void PauseOutput(event::Poller& poller);
+  void ResumeOutput(event::Poller& poller);
+  bool IsPaused() const;
+  // takes over the client's cgi_max_concurrent slot until the script is
+  // done with (exit, timeout)
+  void HoldSlot(const lib::type::SharedPtr<cgi::CgiLimiter>& limiter);
+  // the output also fills the cache; ended when the script is done with
+  void SetCacheFill(const lib::type::SharedPtr<cgi::CacheFill>& fill);
+  // the output goes to a cache fill too, so it cannot bypass user space
+  bool IsCaching() const;
 
  private:
   CgiSocket();
-  int pid_;
+  void OnOutput(event::Poller& poller, const char* data, size_t len);
+  void SpliceOutput(event::Poller& poller, lib::http::SplicedBody* body,
+                    SocketResult* result);
+  void OnOutputEnd(event::Poller& poller, SocketResult* result);
+  void OnExit(event::Poller& poller, int status);
+  void NotifyFailure(event::Poller& poller, lib::http::Status status);
+  void ReleaseSlot(event::Poller& poller);
+  void EndCacheFill(event::Poller& poller, bool complete);
+
+  pid_t pid_;  // -1 once reaped or handed to the reaper
+  lib::type::Fd pidfd_;  // -1 when pidfd_open() is unavailable
+  bool awaiting_exit_;   // EOF seen, pidfd_ is in the poller
+  int read_timeout_;
+  int total_timeout_;
+  time_t started_;
   ClientSocket* owner_;
+  uint64_t started_us_;
+  cgi::CgiResponseParser parser_;
+  bool headers_sent_;
+  bool paused_;
+  lib::type::SharedPtr<cgi::CgiLimiter> limiter_;  // null: no slot held
+  lib::type::SharedPtr<cgi::CacheFill> cache_fill_;  // null: not cached
 
-  static const size_t kBufferSize = 1024;
+  static const size_t kBufferSize = 16384;
 };
 
 #endif
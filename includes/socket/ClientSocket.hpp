@@ -1,36 +1,176 @@
 #ifndef CLIENTSOCKET_HPP
 #define CLIENTSOCKET_HPP
 
+#include <stdint.h>
+
 #include <string>
 
+#include "CgiCache.hpp"
+#include "CgiLimiter.hpp"
+#include "ExecResult.hpp"
 #include "HttpRequest.hpp"
 #include "HttpResponse.hpp"
 #include "ServerConfig.hpp"
+#include "lib/http/SplicedBody.hpp"
+#include "lib/http/StreamedBodyProducer.hpp"
+#include "lib/io/BodyProducer.hpp"
 #include "lib/type/Fd.hpp"
+#include "lib/type/SharedPtr.hpp"
 #include "socket/ASocket.hpp"
+#include "trace/Trace.hpp"
+
+class CgiSocket;
 
-class ClientSocket : public ASocket {
+class ClientSocket : public ASocket,
+                     public cgi::CgiLimiter::Waiter,
+                     public cgi::CgiCache::Waiter {
  public:
-  ClientSocket(lib::type::Fd fd, const ServerConfig& config,
+  ClientSocket(lib::type::Fd fd, const ServerConfigSnapshot& config,
                const std::string& client_ip);
   virtual ~ClientSocket();
 
-  virtual SocketResult HandleEvent(int epoll_fd, uint32_t events);
-  virtual void HandleTimeout(int epoll_fd);
-  void OnCgiExecutionFinished(int epoll_fd, const std::string& cgi_output);
-  void OnCgiExecutionError(int epoll_fd);
+  virtual SocketResult HandleEvent(event::Poller& poller, uint32_t events);
+  virtual void HandleTimeout(event::Poller& poller);
+  // CGI output is relayed as it arrives: the header block, body pieces,
+  // then the end of the body (complete false: the script failed)
+  void OnCgiHeaders(event::Poller& poller, const HttpResponse& res);
+  void OnCgiBody(event::Poller& poller, const char* data, size_t len);
+  void OnCgiBodyEnd(event::Poller& poller, bool complete);
+  // the pipe the CGI body is spliced through (NULL: none) and its news
+  lib::http::SplicedBody* GetCgiSplice();
+  void OnCgiBodySpliced(event::Poller& poller);
+  // X-Accel-Redirect / X-Sendfile: target is a URI, or an absolute path
+  // when is_path; detaches from the CGI socket
+  void OnCgiInternalRedirect(event::Poller& poller, const HttpResponse& res,
+                             const std::string& target, bool is_path);
+  // the script failed or timed out before its headers were complete
+  void OnCgiExecutionError(event::Poller& poller, lib::http::Status status);
   void RemoveCgiSocket(ASocket* sock);
+  // the handler submitted to the aio pool has returned
+  void OnHandlerDone(event::Poller& poller, const ExecResult& result);
+  // the pool has paged in the body window the socket waits for
+  void OnPrefetchDone(event::Poller& poller);
+  // a CGI slot freed up for the queued request (cgi_max_concurrent)
+  virtual void OnAdmitted(event::Poller& poller);
+  // the cgi_cache fill the request waits for has ended
+  virtual void OnCacheFilled(event::Poller& poller);
+  // the CGI socket marks its phases here
+  trace::Trace& GetTrace();
+  // accepted but no request byte received yet
+  virtual bool IsIdle() const;
+  // never while the handler runs on the aio pool, a CGI script it waits
+  // for is still within its own timeouts or a cgi_cache fill it waits for
+  // runs; cgi_queue_timeout while queued
+  virtual bool IsTimeout(time_t threshold_time) const;
 
  private:
   ClientSocket();
-  const ServerConfig& config_;
+  ServerConfigSnapshot config_;  // kept across a reload
   HttpRequest req_;
   HttpResponse res_;
-  ASocket* cgi_socket_;
-  SocketResult HandleEpollIn(int epoll_fd);
-  void HandleEpollOut();
+  CgiSocket* cgi_socket_;
+  bool request_started_;
+  // for metrics and the logs: request phases, status and header size of
+  // the queued response (status 0: none yet), the location that answered
+  // it and the bytes moved on this connection
+  trace::Trace trace_;
+  int response_status_;
+  size_t response_header_bytes_;
+  const Location* location_;
+  uint64_t bytes_received_;
+  uint64_t bytes_sent_;
+  lib::type::SharedPtr<lib::io::BodyProducer> body_producer_;
+  // the CGI body being relayed (also body_producer_) and whether the socket
+  // stopped polling until the script writes more
+  lib::type::SharedPtr<lib::http::StreamedBodyProducer> cgi_body_;
+  bool awaiting_cgi_body_;
+  // instead of cgi_body_, an identity-coded CGI body without a cache fill
+  // is relayed with splice() (body_producer_ stays null)
+  lib::type::SharedPtr<lib::http::SplicedBody> cgi_splice_;
+  // the handler runs on the aio pool (the fd is out of the poller) / has
+  // returned handled_, which the next event turns into the response
+  bool handler_in_flight_;
+  bool handler_done_;
+  ExecResult handled_;
+  // a window of a mapped body is being paged in on the aio pool (the fd is
+  // out of the poller) / has been, so the next write goes ahead unchecked
+  bool prefetch_in_flight_;
+  bool prefetched_;
+  // the limiter of the CGI location the request waits in (cgi_queued_) or
+  // holds a slot of until the CGI socket takes it over; admitted while
+  // queued, the handler runs on the next event (cgi_admitted_)
+  lib::type::SharedPtr<cgi::CgiLimiter> cgi_limiter_;
+  bool cgi_queued_;
+  bool cgi_slot_held_;
+  bool cgi_admitted_;
+  int cgi_queue_timeout_;
+  time_t cgi_queued_at_;
+  uint64_t cgi_queued_us_;
+  // cgi_cache: the key of the request, the fill its script's output goes to
+  // until the CGI socket takes it over, and the wait for another request's
+  // fill (cache_waiting_); woken, the request is looked up again on the
+  // next event (cache_woken_), but never waits twice (cache_collapsed_)
+  lib::type::SharedPtr<cgi::CgiCache> cgi_cache_;
+  std::string cache_key_;
+  lib::type::SharedPtr<cgi::CacheFill> cache_fill_;
+  bool cache_waiting_;
+  bool cache_woken_;
+  bool cache_collapsed_;
+  // refresh of a stale entry: its fill and cgi_max_concurrent slot until
+  // the script's socket takes them over, and the entry served meanwhile
+  // (also while the handler spawns the script on the aio pool)
+  lib::type::SharedPtr<cgi::CacheFill> refresh_fill_;
+  lib::type::SharedPtr<cgi::CgiLimiter> refresh_limiter_;
+  cgi::CgiCache::Entry refresh_entry_;
+  const Location* refresh_location_;
+  // internal redirect of a CGI response: the URI the handler serves next
+  // instead of the request's and the script's header block
+  std::string internal_uri_;
+  HttpResponse cgi_head_;
+  SocketResult HandleEpollIn(event::Poller& poller);
+  SocketResult DispatchRequest(event::Poller& poller);
+  const Location* FindCgiLocation() const;
+  bool LookupCgiCache(event::Poller& poller, const Location* loc,
+                      SocketResult* result);
+  SocketResult ServeCachedResponse(event::Poller& poller, const Location* loc,
+                                   const cgi::CgiCache::Entry& entry,
+                                   const char* cache_status);
+  bool BeginCgiRefresh(const Location* loc,
+                       const cgi::CgiCache::Entry& entry);
+  SocketResult EndCgiRefresh(event::Poller& poller, ASocket* new_socket);
+  void AbandonCgiCache(event::Poller& poller);
+  bool AdmitCgi(event::Poller& poller, const Location* loc);
+  void ReleaseCgiSlot(event::Poller& poller);
+  SocketResult RunHandler(event::Poller& poller);
+  bool SubmitHandler(event::Poller& poller);
+  void RejectRequest(event::Poller& poller);
+  SocketResult OnRequestHandled(event::Poller& poller,
+                                const ExecResult& result);
+  void HandleEpollOut(event::Poller& poller);
+  bool StartCgiSplice(bool chunked);
+  bool SpliceCgiBody(event::Poller& poller);
+  bool PrefetchMappedBody(event::Poller& poller,
+                          const lib::io::OutputQueue& queue);
+  void QueueResponse();
+  void WriteResponseHead();
+  void RecordRequest() const;
+  void ResetBodyProducer();
+  void WatchEvents(event::Poller& poller, uint32_t events);
+  void WakeForCgiBody(event::Poller& poller);
 
   static const size_t kBufferSize = 1024;
+  // the producer is asked for more only once the queue drains below this
+  static const size_t kProducerLowWatermark = 64 * 1024;
+  // CGI body chunks are sized to the free send buffer within these bounds
+  static const size_t kMinChunkSize = 4 * 1024;
+  static const size_t kMaxChunkSize = kProducerLowWatermark;
+  // unsent CGI output at which the pipe is paused / resumed
+  static const size_t kCgiPauseBytes = 256 * 1024;
+  static const size_t kCgiResumeBytes = 64 * 1024;
+  // a CGI body announced shorter than this is not worth a pipe
+  static const long kCgiSpliceMinBytes = 64 * 1024;
+  // mapped body bytes paged in ahead of the loop per aio task
+  static const size_t kPrefetchWindow = 1024 * 1024;
 };
 
 #endif
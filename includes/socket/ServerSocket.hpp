@@ -6,15 +6,20 @@
 
 class ServerSocket : public ASocket {
  public:
-  explicit ServerSocket(const ServerConfig& config);
+  explicit ServerSocket(const ServerConfigSnapshot& config);
+  // takes over a socket that is already listening (inherited across exec()
+  // by a binary upgrade); throws std::runtime_error if it is not one
+  ServerSocket(const ServerConfigSnapshot& config, lib::type::Fd listening_fd);
   virtual ~ServerSocket();
 
-  virtual SocketResult HandleEvent(int epoll_fd, uint32_t events);
+  virtual SocketResult HandleEvent(event::Poller& poller, uint32_t events);
   virtual bool IsTimeout(time_t threshold_time) const;
+  // connections accepted from now on get config; earlier ones keep theirs
+  void SetConfig(const ServerConfigSnapshot& config);
 
  private:
   ServerSocket();
-  const ServerConfig& config_;
+  ServerConfigSnapshot config_;
 };
 
 #endif
@@ -0,0 +1,83 @@
+#ifndef TRACE_TRACE_HPP_
+#define TRACE_TRACE_HPP_
+
+#include <stdint.h>
+
+#include <cstddef>
+#include <string>
+
+namespace access_log {
+struct Entry;
+}
+
+/*
+Per-request phase timestamps.
+
+Each ClientSocket carries a Trace and marks the phases it passes with the
+monotonic clock (a vDSO call, so tracing is always on). When the connection
+closes the spans between phases go into the metrics phase histograms, and
+requests slower than the server's slow_log threshold (or picked by its
+sampling rate) are written to the slow log as one JSON object per line.
+*/
+namespace trace {
+
+enum Phase {
+  kAccept,
+  kFirstByte,      // first request byte read
+  kHeadersParsed,  // HttpRequest::AdvanceHeader() finished
+  kBodyComplete,
+  kRouted,  // RequestHandler::PrepareRoutingContext() finished
+  kHandled,
+  kCgiSpawned,
+  kCgiFirstOutput,
+  kCgiExited,
+  kFirstByteSent,
+  kLastByteSent,
+  kPhaseCount
+};
+
+// intervals exported as histograms and in slow log entries
+enum Span {
+  kSpanWait,             // accept -> first byte
+  kSpanHeaders,          // first byte -> headers parsed
+  kSpanBody,             // headers parsed -> body complete
+  kSpanRouting,          // body complete -> routed
+  kSpanHandler,          // routed -> handled (CGI: until spawned)
+  kSpanCgiStartup,       // CGI spawned -> first output
+  kSpanCgi,              // CGI spawned -> exited
+  kSpanTimeToFirstByte,  // first byte -> first byte sent
+  kSpanSend,             // first byte sent -> last byte sent
+  kSpanTotal,            // first byte -> last byte sent
+  kSpanCount
+};
+
+const char* PhaseName(Phase phase);
+const char* SpanName(Span span);
+
+class Trace {
+ public:
+  Trace();
+
+  // the first mark of a phase wins
+  void Mark(Phase phase);
+  void MarkAt(Phase phase, uint64_t micros);
+  bool Has(Phase phase) const;
+  uint64_t At(Phase phase) const;  // 0 when not reached
+  // false when the request did not reach both ends of span
+  bool Duration(Span span, uint64_t* micros) const;
+
+ private:
+  uint64_t at_[kPhaseCount];
+};
+
+// true for every rate-th call on the calling worker (rate 0: never)
+bool Sample(size_t rate);
+
+// one JSON object and '\n'; sampled entries also carry every phase offset
+// from accept
+void RenderJson(const Trace& trace, const access_log::Entry& entry,
+                bool sampled, std::string* out);
+
+}  // namespace trace
+
+#endif  // TRACE_TRACE_HPP_
@@ -0,0 +1,204 @@
+#include "CgiCache.hpp"
+
+#include <cstdlib>
+
+#include "lib/utils/string_utils.hpp"
+
+namespace cgi {
+
+namespace {
+
+const int kMaxTtl = 86400 * 365;
+
+std::string TrimOws(const std::string& s) {
+  size_t begin = s.find_first_not_of(" \t");
+  if (begin == std::string::npos) return "";
+  size_t end = s.find_last_not_of(" \t");
+  return s.substr(begin, end - begin + 1);
+}
+
+// the value of a "name=N" Cache-Control directive, -1 when absent
+int DirectiveSeconds(const std::string& directive, const std::string& name) {
+  if (directive.compare(0, name.size() + 1, name + "=") != 0) return -1;
+  const std::string value = directive.substr(name.size() + 1);
+  if (value.empty() ||
+      value.find_first_not_of("0123456789") != std::string::npos) {
+    return -1;
+  }
+  if (value.size() > 9) return kMaxTtl;
+  const long seconds = std::atol(value.c_str());
+  return seconds > kMaxTtl ? kMaxTtl : static_cast<int>(seconds);
+}
+
+}  // namespace
+
+CgiCache::Entry::Entry() : head(), body(), stored_at(0), expires_at(0) {
+}
+
+CgiCache::CgiCache(size_t max_entries, int stale_seconds)
+    : max_entries_(max_entries), stale_seconds_(stale_seconds) {
+}
+
+CgiCache::Freshness CgiCache::Find(const std::string& key, time_t now,
+                                   Entry* entry) {
+  EntryMap::iterator it = entries_.find(key);
+  if (it == entries_.end()) return kAbsent;
+  const Entry& found = it->second.entry;
+  if (now < found.expires_at) {
+    *entry = found;
+    return kFresh;
+  }
+  if (now < found.expires_at + stale_seconds_) {
+    *entry = found;
+    return kStale;
+  }
+  Erase(it);
+  return kAbsent;
+}
+
+bool CgiCache::IsFilling(const std::string& key) const {
+  return fills_.count(key) != 0;
+}
+
+void CgiCache::BeginFill(const std::string& key) {
+  fills_[key];
+}
+
+void CgiCache::Wait(const std::string& key, Waiter* waiter) {
+  fills_[key].push_back(waiter);
+}
+
+void CgiCache::Cancel(Waiter* waiter) {
+  for (FillMap::iterator it = fills_.begin(); it != fills_.end(); ++it) {
+    std::vector<Waiter*>& waiters = it->second;
+    for (size_t i = 0; i < waiters.size(); ++i) {
+      if (waiters[i] == waiter) {
+        waiters.erase(waiters.begin() + i);
+        return;
+      }
+    }
+  }
+}
+
+void CgiCache::EndFill(event::Poller& poller, const std::string& key,
+                       const Entry* entry) {
+  if (entry != NULL && max_entries_ > 0) {
+    EntryMap::iterator it = entries_.find(key);
+    if (it != entries_.end()) Erase(it);
+    while (entries_.size() >= max_entries_) {
+      Erase(entries_.find(order_.front()));
+    }
+    Slot& slot = entries_[key];
+    slot.entry = *entry;
+    slot.order = order_.insert(order_.end(), key);
+  }
+  FillMap::iterator fill = fills_.find(key);
+  if (fill == fills_.end()) return;
+  std::vector<Waiter*> waiters;
+  waiters.swap(fill->second);
+  fills_.erase(fill);
+  for (size_t i = 0; i < waiters.size(); ++i) {
+    waiters[i]->OnCacheFilled(poller);
+  }
+}
+
+void CgiCache::AbandonFill(const std::string& key) {
+  fills_.erase(key);
+}
+
+size_t CgiCache::Size() const {
+  return entries_.size();
+}
+
+void CgiCache::Erase(EntryMap::iterator it) {
+  order_.erase(it->second.order);
+  entries_.erase(it);
+}
+
+CacheFill::CacheFill(const lib::type::SharedPtr<CgiCache>& cache,
+                     const std::string& key, int default_ttl)
+    : cache_(cache),
+      key_(key),
+      default_ttl_(default_ttl),
+      head_(),
+      body_(),
+      has_headers_(false),
+      too_large_(false),
+      ended_(false) {
+}
+
+CacheFill::~CacheFill() {
+  if (!ended_) cache_->AbandonFill(key_);
+}
+
+void CacheFill::OnHeaders(const HttpResponse& res) {
+  head_ = res;
+  has_headers_ = true;
+  const std::string initial = head_.GetBody();
+  head_.SetBody(std::string());
+  // framing is redone for every client that gets the entry
+  head_.RemoveHeader("content-length");
+  head_.RemoveHeader("transfer-encoding");
+  OnBody(initial.data(), initial.size());
+}
+
+void CacheFill::OnBody(const char* data, size_t len) {
+  if (too_large_) return;
+  if (body_.size() + len > kMaxBodyBytes) {
+    too_large_ = true;
+    std::string().swap(body_);
+    return;
+  }
+  body_.append(data, len);
+}
+
+void CacheFill::End(event::Poller& poller, bool complete) {
+  if (ended_) return;
+  ended_ = true;
+  const int ttl = complete && has_headers_ && !too_large_
+                      ? ResponseTtl(head_, default_ttl_)
+                      : 0;
+  if (ttl <= 0) {
+    cache_->EndFill(poller, key_, NULL);
+    return;
+  }
+  CgiCache::Entry entry;
+  entry.head = head_;
+  std::string* body = new std::string();
+  body->swap(body_);
+  entry.body = lib::type::SharedPtr<const std::string>(body);
+  entry.stored_at = std::time(NULL);
+  entry.expires_at = entry.stored_at + ttl;
+  cache_->EndFill(poller, key_, &entry);
+}
+
+int ResponseTtl(HttpResponse& res, int default_ttl) {
+  const int status = res.GetStatus();
+  if (status != 200 && status != 301 && status != 302) return 0;
+  if (res.HasHeader("set-cookie")) return 0;
+  lib::type::Optional<std::string> header = res.GetHeader("cache-control");
+  if (!header.HasValue()) return default_ttl;
+  const std::string value = lib::utils::ToLowerAscii(header.Value());
+  int max_age = -1;
+  int s_maxage = -1;
+  size_t pos = 0;
+  while (pos <= value.size()) {
+    size_t comma = value.find(',', pos);
+    if (comma == std::string::npos) comma = value.size();
+    const std::string directive = TrimOws(value.substr(pos, comma - pos));
+    pos = comma + 1;
+    if (directive == "no-store" || directive == "no-cache" ||
+        directive == "private") {
+      return 0;
+    }
+    const int seconds = DirectiveSeconds(directive, "max-age");
+    if (seconds >= 0) max_age = seconds;
+    const int shared_seconds = DirectiveSeconds(directive, "s-maxage");
+    if (shared_seconds >= 0) s_maxage = shared_seconds;
+  }
+  if (s_maxage >= 0) return s_maxage;
+  if (max_age >= 0) return max_age;
+  return default_ttl;
+}
+
+}  // namespace cgi
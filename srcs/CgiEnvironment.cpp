@@ -0,0 +1,87 @@
+#include "CgiEnvironment.hpp"
+
+namespace cgi {
+
+namespace {
+
+const char* const kNames[kNumMetaVars] = {
+    "AUTH_TYPE",
+    "CONTENT_LENGTH",
+    "CONTENT_TYPE",
+    "GATEWAY_INTERFACE",
+    "PATH_INFO",
+    "PATH_TRANSLATED",
+    "QUERY_STRING",
+    "REMOTE_ADDR",
+    "REMOTE_HOST",
+    "REMOTE_IDENT",
+    "REMOTE_USER",
+    "REQUEST_METHOD",
+    "REQUEST_URI",
+    "SCRIPT_NAME",
+    "SERVER_NAME",
+    "SERVER_PORT",
+    "SERVER_PROTOCOL",
+    "SERVER_SOFTWARE"};
+
+// "NAME=" for every slot and the fixed entries, built on first use
+struct Template {
+  std::string prefixes[kNumMetaVars];
+  std::string gateway_interface;
+  std::string server_software;
+
+  Template() {
+    for (int i = 0; i < kNumMetaVars; ++i) {
+      prefixes[i] = std::string(kNames[i]) + "=";
+    }
+    gateway_interface = prefixes[kGatewayInterface] + "CGI/1.1";
+    server_software = prefixes[kServerSoftware] + "webserv/1.0";
+  }
+};
+
+const Template& GetTemplate() {
+  static const Template tmpl;
+  return tmpl;
+}
+
+}  // namespace
+
+Environment::Environment() {
+  const Template& tmpl = GetTemplate();
+  entries_[kGatewayInterface] = tmpl.gateway_interface;
+  entries_[kServerSoftware] = tmpl.server_software;
+}
+
+void Environment::Set(MetaVar var, const std::string& value) {
+  const std::string& prefix = GetTemplate().prefixes[var];
+  std::string& entry = entries_[var];
+  entry.reserve(prefix.size() + value.size());
+  entry.assign(prefix);
+  entry.append(value);
+}
+
+void Environment::Unset(MetaVar var) {
+  entries_[var].clear();
+}
+
+bool Environment::IsSet(MetaVar var) const {
+  return !entries_[var].empty();
+}
+
+std::string Environment::Get(MetaVar var) const {
+  if (!IsSet(var)) return std::string();
+  return entries_[var].substr(GetTemplate().prefixes[var].size());
+}
+
+char* const* Environment::Envp() {
+  envp_.clear();
+  for (int i = 0; i < kNumMetaVars; ++i) {
+    if (!entries_[i].empty()) {
+      envp_.push_back(const_cast<char*>(entries_[i].c_str()));
+    }
+  }
+  envp_.push_back(NULL);
+  return &envp_[0];
+}
+
+}  // namespace cgi
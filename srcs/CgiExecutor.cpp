@@ -1,33 +1,59 @@
 #include "CgiExecutor.hpp"
 
-#include <sys/epoll.h>
+#include <spawn.h>
 #include <sys/socket.h>
-#include <sys/wait.h>
 #include <unistd.h>
 
-#include <cctype>
 #include <cerrno>
-#include <cstdlib>
+#include <csignal>
 #include <cstring>
-#include <stdexcept>
 
 #include "CgiResponseParser.hpp"
 #include "HttpResponse.hpp"
 #include "lib/exception/ResponseStatusException.hpp"
 #include "lib/http/Status.hpp"
+#include "lib/logging/Logging.hpp"
 #include "lib/type/Fd.hpp"
 #include "lib/type/Optional.hpp"
 #include "lib/utils/string_utils.hpp"
+#include "metrics/Metrics.hpp"
 #include "socket/CgiSocket.hpp"
 
 namespace {
-std::vector<char*> CreateEnvp(const std::vector<std::string>& envs) {
-  std::vector<char*> envp;
-  for (size_t i = 0; i < envs.size(); ++i) {
-    envp.push_back(const_cast<char*>(envs[i].c_str()));
+/*
+posix_spawn() instead of fork(): glibc starts the child with CLONE_VFORK on
+the parent's memory, so nothing of the server's address space is copied and
+spawning costs the same however large the caches grow. Everything the child
+must not see is close-on-exec, so the file actions only wire up stdin and
+stdout. SIGPIPE, ignored by the server, is the default again for the script.
+Returns an errno value, 0 on success.
+*/
+int SpawnScript(const std::string& path, char* const envp[], int stdin_fd,
+                int stdout_fd, pid_t* pid) {
+  posix_spawn_file_actions_t actions;
+  posix_spawnattr_t attr;
+  int err = posix_spawn_file_actions_init(&actions);
+  if (err != 0) return err;
+  err = posix_spawnattr_init(&attr);
+  if (err != 0) {
+    posix_spawn_file_actions_destroy(&actions);
+    return err;
   }
-  envp.push_back(NULL);
-  return envp;
+  sigset_t defaults;
+  sigemptyset(&defaults);
+  sigaddset(&defaults, SIGPIPE);
+  if ((err = posix_spawn_file_actions_adddup2(&actions, stdin_fd,
+                                              STDIN_FILENO)) == 0 &&
+      (err = posix_spawn_file_actions_adddup2(&actions, stdout_fd,
+                                              STDOUT_FILENO)) == 0 &&
+      (err = posix_spawnattr_setsigdefault(&attr, &defaults)) == 0 &&
+      (err = posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGDEF)) == 0) {
+    char* argv[] = {const_cast<char*>(path.c_str()), NULL};
+    err = posix_spawn(pid, path.c_str(), &actions, &attr, argv, envp);
+  }
+  posix_spawnattr_destroy(&attr);
+  posix_spawn_file_actions_destroy(&actions);
+  return err;
 }
 
 lib::type::Optional<std::string> CreatePathInfo(
@@ -80,38 +106,23 @@ bool IsScriptExtensionAllowed(const std::string& script_path,
   return false;
 }
 
-// void PrintEnvp(const std::vector<char*>& envp) {
-//   for (size_t i = 0; envp[i] != NULL; ++i) {
-//     std::cout << "envp[" << i << "]: " << envp[i] << std::endl;
-//   }
-// }
 }  // namespace
 
 CgiExecutor::CgiExecutor(const HttpRequest& req, const Location& loc,
                          const std::string& script_path)
-    : loc_(loc), script_path_(script_path), body_(req.GetBody()) {
+    : loc_(loc),
+      script_path_(script_path),
+      body_(req.GetBodyBuffer()),
+      is_post_(req.GetMethod() == lib::http::kPost) {
   InitializeMetaVars(req);
 }
 
 CgiExecutor::~CgiExecutor() {
 }
 
-std::string CgiExecutor::GetMetaVar(const std::string& key) const {
-  return meta_vars_.at(key).Value();
-}
-
-std::vector<std::string> CgiExecutor::GetMetaVars() const {
-  // store as vector of "key=value" string
-  std::vector<std::string> ret_vars;
-
-  for (std::map<std::string, lib::type::Optional<std::string> >::const_iterator
-           it = meta_vars_.begin();
-       it != meta_vars_.end(); ++it) {
-    if (it->second.HasValue()) {
-      ret_vars.push_back(it->first + "=" + it->second.Value());
-    }
-  }
-  return ret_vars;
+void CgiExecutor::SetMetaVar(cgi::MetaVar var,
+                             const lib::type::Optional<std::string>& value) {
+  if (value.HasValue()) env_.Set(var, value.Value());
 }
 
 void CgiExecutor::InitializeMetaVars(const HttpRequest& req) {
@@ -124,108 +135,93 @@ void CgiExecutor::InitializeMetaVars(const HttpRequest& req) {
           : script_path_;
   // RFC 3875 4.1.1.
   lib::type::Optional<std::string> auth = req.GetHeader("authorization");
-  meta_vars_["AUTH_TYPE"] = auth.HasValue()
-                                ? lib::utils::GetFirstToken(auth.Value(), " ")
-                                : lib::type::Optional<std::string>();
+  if (auth.HasValue()) {
+    SetMetaVar(cgi::kAuthType, lib::utils::GetFirstToken(auth.Value(), " "));
+  }
   // RFC 3875 4.1.2.
-  meta_vars_["CONTENT_LENGTH"] = req.GetHeader("content-length");
+  SetMetaVar(cgi::kContentLength, req.GetHeader("content-length"));
   // RFC 3875 4.1.3.
-  meta_vars_["CONTENT_TYPE"] = req.GetHeader("content-type");
-  // RFC 3875 4.1.4.
-  meta_vars_["GATEWAY_INTERFACE"] = lib::type::Optional<std::string>("CGI/1.1");
+  SetMetaVar(cgi::kContentType, req.GetHeader("content-type"));
+  // RFC 3875 4.1.4. GATEWAY_INTERFACE is fixed (cgi::Environment).
   // RFC 3875 4.1.5.
-  meta_vars_["PATH_INFO"] = path_info;
-  // RFC 3875 4.1.6.
-  meta_vars_["PATH_TRANSLATED"] =
-      path_info.HasValue()
-          ? lib::type::Optional<std::string>(loc_.GetRoot() + path_info.Value())
-          : lib::type::Optional<std::string>();
-  // RFC 3875 4.1.7.
-  meta_vars_["QUERY_STRING"] = lib::type::Optional<std::string>(req.GetQuery());
+  SetMetaVar(cgi::kPathInfo, path_info);
   // REQUEST_URI is not defined as a CGI meta-variable by RFC 3875, but the
   // project’s CGI test tool (`cgi_tester`) expects REQUEST_URI to be present
   // and to have the same value as PATH_INFO when invoking CGI scripts.
-  meta_vars_["REQUEST_URI"] = lib::type::Optional<std::string>(path_info);
+  SetMetaVar(cgi::kRequestUri, path_info);
+  // RFC 3875 4.1.6.
+  if (path_info.HasValue()) {
+    env_.Set(cgi::kPathTranslated, loc_.GetRoot() + path_info.Value());
+  }
+  // RFC 3875 4.1.7.
+  env_.Set(cgi::kQueryString, req.GetQuery());
   // RFC 3875 4.1.8.
-  meta_vars_["REMOTE_ADDR"] =
-      lib::type::Optional<std::string>(req.GetClientIp());
+  env_.Set(cgi::kRemoteAddr, req.GetClientIp());
   // RFC 3875 4.1.9.
-  meta_vars_["REMOTE_HOST"] =
-      lib::type::Optional<std::string>(req.GetClientIp());
-  // RFC 3875 4.1.10.
+  env_.Set(cgi::kRemoteHost, req.GetClientIp());
+  // RFC 3875 4.1.10. REMOTE_IDENT is not set:
   // The server may choose not to support this feature, or not to request the
   // data for efficiency reasons, or not to return available identity data.
-  meta_vars_["REMOTE_IDENT"] = lib::type::Optional<std::string>();
-  // RFC 3875 4.1.11.
+  // RFC 3875 4.1.11. REMOTE_USER is not set:
   // The server doesn't support authentication yet.
-  meta_vars_["REMOTE_USER"] = lib::type::Optional<std::string>();
   // RFC 3875 4.1.12.
-  meta_vars_["REQUEST_METHOD"] = lib::type::Optional<std::string>(
-      lib::http::MethodToString(req.GetMethod()));
+  env_.Set(cgi::kRequestMethod, lib::http::MethodToString(req.GetMethod()));
   // RFC 3875 4.1.13.
-  std::string uri = req.GetUri();
-  meta_vars_["SCRIPT_NAME"] =
-      path_info.HasValue() ? lib::type::Optional<std::string>(uri.substr(
-                                 0, uri.length() - path_info.Value().length()))
-                           : lib::type::Optional<std::string>(uri);
+  const std::string& uri = req.GetUri();
+  env_.Set(cgi::kScriptName,
+           path_info.HasValue()
+               ? uri.substr(0, uri.length() - path_info.Value().length())
+               : uri);
   // RFC 3875 4.1.14.
-  meta_vars_["SERVER_NAME"] =
-      lib::type::Optional<std::string>(req.GetHostName());
+  env_.Set(cgi::kServerName, req.GetHostName());
   // RFC 3875 4.1.15.
-  meta_vars_["SERVER_PORT"] =
-      lib::type::Optional<std::string>(lib::utils::ToString(req.GetHostPort()));
+  env_.Set(cgi::kServerPort, lib::utils::ToString(req.GetHostPort()));
   // RFC 3875 4.1.16.
-  meta_vars_["SERVER_PROTOCOL"] =
-      lib::type::Optional<std::string>(req.GetVersion());
-  // RFC 3875 4.1.17.
-  meta_vars_["SERVER_SOFTWARE"] =
-      lib::type::Optional<std::string>("webserv/1.0");
+  env_.Set(cgi::kServerProtocol, req.GetVersion());
+  // RFC 3875 4.1.17. SERVER_SOFTWARE is fixed (cgi::Environment).
 
   script_path_ = executable_path;
 }
 
 // GET and DELETE methods are handled same. POST method requires the body to be
-// passed to STDIN of the CGI script.
+// passed to STDIN of the CGI script: small bodies are written to the socket,
+// a body spilled to a temporary file becomes the script's STDIN directly.
 ExecResult CgiExecutor::Run() {
   if (!IsScriptExtensionAllowed(script_path_, loc_.GetCgiAllowedExtensions()))
     return ExecResult(HttpResponse(lib::http::kForbidden));
 
   int sv[2];
-  if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+  if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) < 0) {
     throw lib::exception::ResponseStatusException(
         lib::http::kInternalServerError);
   }
   lib::type::Fd sv0(sv[0]);
   lib::type::Fd sv1(sv[1]);
 
-  std::vector<std::string> meta_vars = GetMetaVars();
-  std::vector<char*> envp = CreateEnvp(meta_vars);
-
-  int pid = fork();
-  if (pid < 0) {
+  int stdin_fd = sv1.GetFd();
+  if (body_.IsSpilled()) {
+    // the server only uses pread(), so rewinding the shared offset is safe
+    lseek(body_.FileFd(), 0, SEEK_SET);
+    stdin_fd = body_.FileFd();
+  }
+  pid_t pid;
+  const int err =
+      SpawnScript(script_path_, env_.Envp(), stdin_fd, sv1.GetFd(), &pid);
+  if (err != 0) {
+    WEBSERV_LOG(kWarn) << "CGI " << script_path_
+                       << " failed to start: " << std::strerror(err)
+                       << std::endl;
     throw lib::exception::ResponseStatusException(
         lib::http::kInternalServerError);
   }
+  sv1.Reset();
+  metrics::Increment(metrics::kCgiSpawned);
+  CgiSocket* cgi_socket = new CgiSocket(sv0, pid, loc_.GetCgiReadTimeout(),
+                                        loc_.GetCgiTotalTimeout());
 
-  std::string req_method = GetMetaVar("REQUEST_METHOD");
-
-  if (pid == 0) {  // Child process
-    sv0.Reset();
-    dup2(sv1.GetFd(), STDIN_FILENO);
-    dup2(sv1.GetFd(), STDOUT_FILENO);
-    sv1.Reset();
-
-    char* argv[] = {const_cast<char*>(script_path_.c_str()), NULL};
-    execve(script_path_.c_str(), argv, envp.data());
-    exit(1);
-  } else {  // Parent process
-    sv1.Reset();
-    CgiSocket* cgi_socket = new CgiSocket(sv0, pid);
-
-    if (req_method == "POST") {
-      cgi_socket->Send(body_);
-    }
-
-    return ExecResult(cgi_socket);
+  if (is_post_ && !body_.IsSpilled()) {
+    cgi_socket->Send(body_.ToString());
   }
+
+  return ExecResult(cgi_socket);
 }
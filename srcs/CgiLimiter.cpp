@@ -0,0 +1,106 @@
+#include "CgiLimiter.hpp"
+
+#include <algorithm>
+#include <map>
+
+#include "metrics/Metrics.hpp"
+
+namespace cgi {
+
+namespace {
+
+typedef std::map<std::string, lib::type::SharedPtr<CgiLimiter> > Registry;
+
+Registry& SharedLimiters() {
+  static Registry limiters;
+  return limiters;
+}
+
+}  // namespace
+
+CgiLimiter::CgiLimiter(size_t max_running, size_t max_queued)
+    : max_running_(max_running), max_queued_(max_queued), running_(0) {
+}
+
+/*
+A raised max_running reaches the waiters on the next Admit() or
+Release(poller); a lowered one admits nobody until enough scripts exit.
+*/
+lib::type::SharedPtr<CgiLimiter> CgiLimiter::Share(
+    const std::string& key, const lib::type::SharedPtr<CgiLimiter>& limiter) {
+  Registry& limiters = SharedLimiters();
+  for (Registry::iterator it = limiters.begin(); it != limiters.end();) {
+    if (it->second.UseCount() == 1) {
+      limiters.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  Registry::iterator it = limiters.find(key);
+  if (it == limiters.end()) {
+    limiters[key] = limiter;
+    return limiter;
+  }
+  it->second->max_running_ = limiter->max_running_;
+  it->second->max_queued_ = limiter->max_queued_;
+  return it->second;
+}
+
+CgiLimiter::Admission CgiLimiter::Admit(event::Poller& poller,
+                                        Waiter* waiter) {
+  Dispatch(poller);
+  if (running_ < max_running_ && queue_.empty()) {
+    ++running_;
+    return kAdmitted;
+  }
+  if (queue_.size() >= max_queued_) {
+    metrics::Increment(metrics::kCgiRejected);
+    return kRejected;
+  }
+  queue_.push_back(waiter);
+  metrics::Increment(metrics::kCgiQueued);
+  return kQueued;
+}
+
+bool CgiLimiter::TryAcquire() {
+  if (running_ >= max_running_ || !queue_.empty()) return false;
+  ++running_;
+  return true;
+}
+
+void CgiLimiter::Cancel(Waiter* waiter) {
+  std::deque<Waiter*>::iterator it =
+      std::find(queue_.begin(), queue_.end(), waiter);
+  if (it == queue_.end()) return;
+  queue_.erase(it);
+  metrics::Increment(metrics::kCgiDequeued);
+}
+
+void CgiLimiter::Release(event::Poller& poller) {
+  Release();
+  Dispatch(poller);
+}
+
+void CgiLimiter::Release() {
+  if (running_ > 0) --running_;
+}
+
+void CgiLimiter::Dispatch(event::Poller& poller) {
+  while (running_ < max_running_ && !queue_.empty()) {
+    Waiter* next = queue_.front();
+    queue_.pop_front();
+    ++running_;
+    metrics::Increment(metrics::kCgiDequeued);
+    next->OnAdmitted(poller);
+  }
+}
+
+size_t CgiLimiter::Running() const {
+  return running_;
+}
+
+size_t CgiLimiter::Queued() const {
+  return queue_.size();
+}
+
+}  // namespace cgi
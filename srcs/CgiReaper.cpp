@@ -0,0 +1,77 @@
+#include "CgiReaper.hpp"
+
+#include <sys/wait.h>
+
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <map>
+
+namespace cgi {
+
+const int CgiReaper::kKillGraceSeconds;
+
+namespace {
+
+struct Child {
+  time_t kill_at;
+  bool killed;
+};
+
+typedef std::map<pid_t, Child> ChildMap;
+
+ChildMap& Children() {
+  static ChildMap children;
+  return children;
+}
+
+// true once pid is gone: reaped now or by someone else before
+bool TryReap(pid_t pid) {
+  const pid_t r = waitpid(pid, NULL, WNOHANG);
+  return r == pid || (r == -1 && errno == ECHILD);
+}
+
+}  // namespace
+
+void CgiReaper::Adopt(pid_t pid) {
+  if (pid <= 0) return;
+  kill(pid, SIGTERM);
+  if (TryReap(pid)) return;
+  Child child;
+  child.kill_at = std::time(NULL) + kKillGraceSeconds;
+  child.killed = false;
+  Children()[pid] = child;
+}
+
+void CgiReaper::Reap() {
+  ChildMap& children = Children();
+  if (children.empty()) return;
+  const time_t now = std::time(NULL);
+  for (ChildMap::iterator it = children.begin(); it != children.end();) {
+    if (TryReap(it->first)) {
+      children.erase(it++);
+      continue;
+    }
+    if (!it->second.killed && now >= it->second.kill_at) {
+      kill(it->first, SIGKILL);
+      it->second.killed = true;
+    }
+    ++it;
+  }
+}
+
+void CgiReaper::KillAll() {
+  ChildMap& children = Children();
+  for (ChildMap::iterator it = children.begin(); it != children.end(); ++it) {
+    kill(it->first, SIGKILL);
+    while (waitpid(it->first, NULL, 0) == -1 && errno == EINTR) {
+    }
+  }
+  children.clear();
+}
+
+size_t CgiReaper::Size() {
+  return Children().size();
+}
+
+}  // namespace cgi
@@ -12,7 +12,8 @@
 
 namespace cgi {
 
-CgiResponseParser::CgiResponseParser() : res_(lib::http::kOk) {
+CgiResponseParser::CgiResponseParser()
+    : res_(lib::http::kOk), internal_redirect_(), is_sendfile_(false) {
 }
 
 CgiResponseParser::~CgiResponseParser() {
@@ -22,9 +23,26 @@ const HttpResponse& CgiResponseParser::GetResponse() const {
   return res_;
 }
 
+bool CgiResponseParser::IsDone() const {
+  return state_ == kDone;
+}
+
+const lib::type::Optional<std::string>&
+CgiResponseParser::GetInternalRedirect() const {
+  return internal_redirect_;
+}
+
+bool CgiResponseParser::IsSendfile() const {
+  return is_sendfile_;
+}
+
 bool CgiResponseParser::AdvanceHeader() {
   std::string::size_type end_of_header = FindEndOfHeader(buffer_);
   if (end_of_header == std::string::npos) {
+    // output arrives in pieces now; do not wait forever for the blank line
+    if (buffer_.size() > kMaxHeaderSize) {
+      throw lib::exception::ResponseStatusException(lib::http::kBadGateway);
+    }
     return false;
   }
 
@@ -45,9 +63,16 @@ bool CgiResponseParser::AdvanceHeader() {
   return true;
 }
 
+// the last X-Accel-Redirect / X-Sendfile wins; an empty one is ignored
 void CgiResponseParser::StoreHeader(const std::string& key,
                                     const std::string& value) {
-  if (key == "Status") {
+  const std::string name = lib::utils::ToLowerAscii(key);
+  if (name == "x-accel-redirect" || name == "x-sendfile") {
+    if (!value.empty()) {
+      internal_redirect_ = lib::type::Optional<std::string>(value);
+      is_sendfile_ = name == "x-sendfile";
+    }
+  } else if (key == "Status") {
     size_t space_pos = value.find(' ');
     std::string status_str;
     std::string reason_phrase;
@@ -99,14 +124,18 @@ bool CgiResponseParser::IsStrictCrlf() const {
   return false;
 }
 
+void ValidateCgiResponse(HttpResponse& res) {
+  if (!res.HasHeader("content-type")) {
+    throw lib::exception::ResponseStatusException(lib::http::kBadGateway);
+  }
+}
+
 HttpResponse ParseCgiResponse(const std::string& cgi_output) {
   CgiResponseParser parser;
   parser.Parse(cgi_output.c_str(), cgi_output.length());
 
   HttpResponse res = parser.GetResponse();
-  if (!res.HasHeader("content-type")) {
-    throw lib::exception::ResponseStatusException(lib::http::kBadGateway);
-  }
+  ValidateCgiResponse(res);
   return res;
 }
 
@@ -1,5 +1,6 @@
 #include "ConfigParser.hpp"
 
+#include "lib/exception/ResponseStatusException.hpp"
 #include "lib/utils/file_utils.hpp"
 
 ConfigParser::ConfigParser() : current_pos_(0), server_configs_(), content("") {
@@ -20,13 +21,12 @@ void ConfigParser::LoadFileOrThrowRuntime(const std::string& filename) {
   if (S_ISDIR(s.st_mode)) {
     throw std::runtime_error(filename + " is a directory");
   }
-  std::ifstream file(filename.c_str());
-  if (!file.is_open()) {
+  // close-on-exec: the reload thread parses while scripts are spawned
+  try {
+    content = lib::utils::ReadFileToStringOrThrow(filename);
+  } catch (const lib::exception::ResponseStatusException& e) {
     throw std::runtime_error("Failed to open file: " + filename);
   }
-  content = std::string((std::istreambuf_iterator<char>(file)),
-                        std::istreambuf_iterator<char>());
-  file.close();
 }
 
 void ConfigParser::RequireAbsoluteSafePathOrThrow(const std::string& path,
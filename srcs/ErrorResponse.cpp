@@ -0,0 +1,36 @@
+#include "ErrorResponse.hpp"
+
+#include "lib/http/Status.hpp"
+#include "lib/type/Optional.hpp"
+
+namespace error_response {
+
+void ApplyErrorPage(const ServerConfig& config, HttpResponse& res) {
+  const lib::http::Status status = res.GetStatus();
+  if (status < lib::http::kBadRequest) return;
+
+  const ErrorPage* page = config.FindErrorPage(status);
+  if (page == NULL) {
+    if (res.GetBodySize() == 0) {
+      res.EnsureDefaultErrorContent();
+      if (!res.HasHeader("content-type")) {
+        res.AddHeader("Content-Type", "text/html");
+      }
+    }
+    return;
+  }
+  if (!page->redirect.empty()) {
+    HttpResponse redirect(lib::http::kFound);
+    redirect.AddHeader("Location", page->redirect);
+    lib::type::Optional<std::string> connection = res.GetHeader("connection");
+    if (connection.HasValue()) {
+      redirect.AddHeader("Connection", connection.Value());
+    }
+    res = redirect;
+    return;
+  }
+  res.SetBody(page->body);
+  res.AddHeader("Content-Type", page->content_type);
+}
+
+}  // namespace error_response
@@ -7,6 +7,7 @@
 const size_t HttpRequest::kMaxHeaderSize;
 const size_t HttpRequest::kMaxPayloadSize;
 const size_t HttpRequest::kMaxUriSize;
+const size_t HttpRequest::kMaxRequestLineSlack;
 const unsigned short HttpRequest::kDefaultPort = 8080;
 
 HttpRequest::HttpRequest()
@@ -19,7 +20,8 @@ HttpRequest::HttpRequest()
       headers_(),
       body_(),
       content_length_(-1),  // default: unknown length, chunked possible
-      next_chunk_size_(-1),
+      chunk_state_(kChunkSize),
+      chunk_remaining_(0),
       keep_alive_(false),
       client_ip_(),
       max_body_size_limit_(kMaxPayloadSize) {
@@ -36,9 +38,11 @@ HttpRequest::HttpRequest(const HttpRequest& src)
       headers_(src.headers_),
       body_(src.body_),
       content_length_(src.content_length_),
-      next_chunk_size_(src.next_chunk_size_),
+      chunk_state_(src.chunk_state_),
+      chunk_remaining_(src.chunk_remaining_),
       keep_alive_(src.keep_alive_),
-      client_ip_(src.client_ip_) {
+      client_ip_(src.client_ip_),
+      max_body_size_limit_(src.max_body_size_limit_) {
 }
 
 HttpRequest& HttpRequest::operator=(const HttpRequest& src) {
@@ -53,7 +57,8 @@ HttpRequest& HttpRequest::operator=(const HttpRequest& src) {
     headers_ = src.headers_;
     body_ = src.body_;
     content_length_ = src.content_length_;
-    next_chunk_size_ = src.next_chunk_size_;
+    chunk_state_ = src.chunk_state_;
+    chunk_remaining_ = src.chunk_remaining_;
     keep_alive_ = src.keep_alive_;
     client_ip_ = src.client_ip_;
     max_body_size_limit_ = src.max_body_size_limit_;
@@ -109,7 +114,11 @@ lib::type::Optional<std::string> HttpRequest::GetHeader(
   return lib::type::Optional<std::string>(it->second);
 }
 
-const std::string& HttpRequest::GetBody() const {
+std::string HttpRequest::GetBody() const {
+  return body_.ToString();
+}
+
+const lib::io::SpillBuffer& HttpRequest::GetBodyBuffer() const {
   return body_;
 }
 
@@ -1,10 +1,12 @@
 #include "HttpResponse.hpp"
 
-#include <ctime>
 #include <sstream>
+#include <utility>
 
 #include "lib/exception/InvalidHeader.hpp"
+#include "lib/http/HttpDate.hpp"
 #include "lib/http/Status.hpp"
+#include "lib/thread/Mutex.hpp"
 #include "lib/type/Optional.hpp"
 #include "lib/utils/string_utils.hpp"
 
@@ -26,6 +28,7 @@ HttpResponse::HttpResponse(const HttpResponse& other)
       reason_phrase_(other.reason_phrase_),
       headers_(other.headers_),
       body_(other.body_),
+      body_producer_(other.body_producer_),
       version_(other.version_) {
 }
 
@@ -35,6 +38,7 @@ HttpResponse& HttpResponse::operator=(const HttpResponse& other) {
     reason_phrase_ = other.reason_phrase_;
     headers_ = other.headers_;
     body_ = other.body_;
+    body_producer_ = other.body_producer_;
     version_ = other.version_;
   }
   return *this;
@@ -82,18 +86,84 @@ bool HttpResponse::HasHeader(const std::string& key) {
     return false;
 }
 
+void HttpResponse::RemoveHeader(const std::string& key) {
+  headers_.erase(lib::utils::ToLowerAscii(key));
+}
+
+const std::map<std::string, std::string>& HttpResponse::GetHeaders() const {
+  return headers_;
+}
+
 void HttpResponse::SetBody(const std::string& body) {
-  body_ = body;
+  body_.Clear();
+  body_.Append(body);
+}
+
+void HttpResponse::SetBody(const lib::io::MappedFile& file) {
+  body_.Clear();
+  body_.Append(file, 0, file.Size());
+}
+
+void HttpResponse::SetBody(
+    const lib::type::SharedPtr<const std::string>& body) {
+  body_.Clear();
+  body_.Append(body);
+}
+
+void HttpResponse::AppendBody(const std::string& data) {
+  body_.Append(data);
+}
+
+void HttpResponse::AppendBody(const lib::io::MappedFile& file, size_t offset,
+                              size_t length) {
+  body_.Append(file, offset, length);
 }
 
 std::string HttpResponse::GetBody() const {
-  return body_;
+  return body_.ToString();
+}
+
+size_t HttpResponse::GetBodySize() const {
+  return body_.Size();
+}
+
+void HttpResponse::TakeBody(lib::io::OutputQueue& out) {
+  out.Clear();
+  out.Swap(body_);
+}
+
+void HttpResponse::SetBodyProducer(
+    const lib::type::SharedPtr<lib::io::BodyProducer>& producer) {
+  body_producer_ = producer;
+}
+
+const lib::type::SharedPtr<lib::io::BodyProducer>&
+HttpResponse::GetBodyProducer() const {
+  return body_producer_;
 }
 
 void HttpResponse::EnsureDefaultErrorContent() {
-  if (!body_.empty()) return;
+  if (!body_.Empty()) return;
   if (status_code_ < 400) return;
-  body_ = MakeDefaultErrorPage(status_code_, reason_phrase_);
+  if (reason_phrase_ != lib::http::StatusToString(GetStatus())) {
+    SetBody(MakeDefaultErrorPage(status_code_, reason_phrase_));
+    return;
+  }
+  SetBody(DefaultErrorPage(GetStatus()));
+}
+
+lib::type::SharedPtr<const std::string> HttpResponse::DefaultErrorPage(
+    lib::http::Status status) {
+  typedef std::map<int, lib::type::SharedPtr<const std::string> > PageMap;
+  static PageMap pages;
+  static lib::thread::Mutex mutex;  // handlers may run on aio threads
+  lib::thread::ScopedLock lock(mutex);
+  PageMap::iterator it = pages.find(status);
+  if (it != pages.end()) return it->second;
+  lib::type::SharedPtr<const std::string> page(new std::string(
+      MakeDefaultErrorPage(status, lib::http::StatusToString(status))));
+  pages.insert(std::make_pair(static_cast<int>(status), page));
+  return page;
 }
 
 std::string HttpResponse::MakeDefaultErrorPage(
@@ -120,10 +190,28 @@ std::string HttpResponse::MakeDefaultErrorPage(
 }
 
 std::string HttpResponse::ToHttpString() const {
-  std::stringstream ss;
+  return HeaderString() + body_.ToString();
+}
+
+void HttpResponse::WriteTo(lib::io::OutputQueue& out) const {
+  out.Append(HeaderString());
+  out.Append(body_);
+}
+
+// status line and header block, terminated by the empty line
+std::string HttpResponse::HeaderString() const {
+  std::string out;
+  out.reserve(256);
 
   // Status Line
-  ss << version_ << " " << status_code_ << " " << reason_phrase_ << "\r\n";
+  out += version_;
+  out += ' ';
+  out += static_cast<char>('0' + status_code_ / 100 % 10);  // 3-digit code
+  out += static_cast<char>('0' + status_code_ / 10 % 10);
+  out += static_cast<char>('0' + status_code_ % 10);
+  out += ' ';
+  out += reason_phrase_;
+  out += "\r\n";
 
   // Headers
   std::map<std::string, std::string> final_headers = headers_;
@@ -131,12 +219,7 @@ std::string HttpResponse::ToHttpString() const {
   // Date Header
   bool has_date = final_headers.count("date");
   if (!has_date) {
-    std::time_t now = std::time(NULL);
-    std::tm* tm = std::gmtime(&now);
-    char buf[100];
-    if (std::strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", tm)) {
-      final_headers["date"] = std::string(buf);
-    }
+    final_headers["date"] = lib::http::CurrentHttpDate();
   }
 
   // Content-Length
@@ -144,22 +227,30 @@ std::string HttpResponse::ToHttpString() const {
   // RFC 7230 Section 3.3.2: A sender MUST NOT send a Content-Length header
   // field in any message that contains a Transfer-Encoding header field.
   bool has_transfer_encoding = final_headers.count("transfer-encoding");
-  if (!has_content_length && !has_transfer_encoding) {
-    final_headers["content-length"] = lib::utils::ToString(body_.length());
+  // RFC 9110 8.6: no Content-Length in 204; a 304 would have to repeat the
+  // length of the 200 it stands for, so leave it out there as well
+  bool is_bodiless_status = status_code_ == lib::http::kNoContent ||
+                            status_code_ == lib::http::kNotModified;
+  // a producer's body has no length yet: unless the handler declared one
+  // it is delimited by chunked framing or by closing the connection
+  bool is_produced = !body_producer_.IsNull();
+  if (!has_content_length && !has_transfer_encoding && !is_bodiless_status &&
+      !is_produced) {
+    final_headers["content-length"] = lib::utils::ToString(body_.Size());
   }
 
   // Output Headers
   for (std::map<std::string, std::string>::const_iterator it =
            final_headers.begin();
        it != final_headers.end(); ++it) {
-    ss << it->first << ": " << it->second << "\r\n";
+    out += it->first;
+    out += ": ";
+    out += it->second;
+    out += "\r\n";
   }
 
   // End of Headers
-  ss << "\r\n";
-
-  // Body
-  ss << body_;
+  out += "\r\n";
 
-  return ss.str();
+  return out;
 }
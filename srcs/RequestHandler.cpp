@@ -1,8 +1,11 @@
 #include "RequestHandler.hpp"
 
+#include <fcntl.h>
+
 #include <stdexcept>
 
 #include "CgiExecutor.hpp"
+#include "ErrorResponse.hpp"
 #include "FileValidator.hpp"
 #include "HttpRequest.hpp"
 #include "ServerConfig.hpp"
@@ -10,18 +13,46 @@
 #include "lib/http/Method.hpp"
 #include "lib/http/MimeType.hpp"
 #include "lib/http/Status.hpp"
+#include "lib/io/MappedFile.hpp"
+#include "lib/logging/Logging.hpp"
+#include "lib/type/Fd.hpp"
 #include "lib/utils/file_utils.hpp"
+#include "lib/utils/time_utils.hpp"
+
+const off_t RequestHandler::kMmapThreshold;
+
+RequestHandler::RequestHandler(const ServerConfig& conf,
+                               const HttpRequest& req)
+    : conf_(conf), req_(req), routed_us_(0), internal_uri_(), script_res_() {
+}
 
-RequestHandler::RequestHandler(ServerConfig conf, HttpRequest req)
-    : conf_(conf), req_(req) {
+void RequestHandler::SetInternalRedirect(const std::string& uri,
+                                         const HttpResponse& script_res) {
+  internal_uri_ = uri;
+  script_res_ = script_res;
 }
 
 RequestHandler::~RequestHandler() {
 }
 
+// every response built here is server-generated; CGI output (async) is not
 ExecResult RequestHandler::Run() {
+  ExecResult result =
+      internal_uri_.empty() ? Dispatch() : ServeInternalRedirect();
+  result.location = location_match_.loc;
+  result.routed_us = routed_us_;
+  if (!result.is_async) {
+    error_response::ApplyErrorPage(conf_, result.response);
+  }
+  return result;
+}
+
+ExecResult RequestHandler::Dispatch() {
   try {
     PrepareRoutingContext();
+    if (location_match_.loc->IsInternal()) {
+      throw lib::exception::ResponseStatusException(lib::http::kNotFound);
+    }
 
     if (location_match_.loc->HasRedirect()) {
       HttpResponse res;
@@ -31,14 +62,15 @@ ExecResult RequestHandler::Run() {
     }
 
     lib::http::Method method = req_.GetMethod();
+    if (location_match_.loc->HasStubStatus()) {
+      return ServeStubStatus();
+    }
     if (location_match_.loc->HasAllowedMethods()) {
       if (!location_match_.loc->IsMethodAllowed(method)) {
         HttpResponse res;
         res.SetStatus(lib::http::kMethodNotAllowed);  // 405
         res.AddHeader("Allow", location_match_.loc->GetAllowedMethodsString());
         res.AddHeader("Connection", "close");
-        res.AddHeader("Content-Type", "text/html");
-        res.EnsureDefaultErrorContent();
         return ExecResult(res);
       }
     }
@@ -54,13 +86,9 @@ ExecResult RequestHandler::Run() {
     }
     return result_;
   } catch (const lib::exception::ResponseStatusException& e) {
-    HttpResponse res(e.GetStatus());
-    res.SetBody(lib::http::StatusToString(e.GetStatus()));
-    return ExecResult(res);
+    return ExecResult(HttpResponse(e.GetStatus()));
   } catch (const std::exception& e) {
-    HttpResponse res(lib::http::kInternalServerError);
-    res.SetBody("Internal Server Error");
-    return ExecResult(res);
+    return ExecResult(HttpResponse(lib::http::kInternalServerError));
   }
 }
 
@@ -68,6 +96,7 @@ void RequestHandler::PrepareRoutingContext() {
   const std::string req_uri = req_.GetUri();
   location_match_ = conf_.FindLocationForUri(req_uri);
   filesystem_path_ = ResolveFilesystemPath();
+  routed_us_ = lib::utils::MonotonicMicros();
 }
 
 /*
@@ -88,14 +117,16 @@ std::string RequestHandler::ResolveFilesystemPath() const {
                // FindLocationForUri() throws on not found.
     throw lib::exception::ResponseStatusException(lib::http::kNotFound);
   }
-  if (location_match_.loc->HasRedirect()) {
+  if (location_match_.loc->HasRedirect() ||
+      location_match_.loc->HasStubStatus()) {
     return "";
   }
   std::string path = location_match_.loc->GetRoot() + location_match_.remainder;
-  std::cerr << "[DEBUG] location root: " << location_match_.loc->GetRoot()
-            << ", request URI: " << req_.GetUri()
-            << ", remainder: " << location_match_.remainder
-            << ", combined path: " << path << std::endl;
+  WEBSERV_LOG(kDebug) << "location root: "
+                      << location_match_.loc->GetRoot()
+                      << ", request URI: " << req_.GetUri()
+                      << ", remainder: " << location_match_.remainder
+                      << ", combined path: " << path << std::endl;
   // Validate/normalize (security)
   path = FileValidator::ValidateAndNormalizePath(
       path, location_match_.loc->GetRoot());
@@ -134,19 +165,64 @@ std::string RequestHandler::AppendIndexFileIfDirectoryOrThrow(
 }
 
 void RequestHandler::HandleGet() {
+  if (TryServeAutoindex()) return;
   std::string path_with_index =
       AppendIndexFileIfDirectoryOrThrow(filesystem_path_);
   if (location_match_.loc->GetCgiEnabled()) {
     CgiExecutor cgi(req_, *location_match_.loc, path_with_index);
     result_ = cgi.Run();
   } else {
-    std::string body = lib::utils::ReadFileToStringOrThrow(path_with_index);
-    HttpResponse res;
-    res.AddHeader("Content-Type",
-                  lib::http::DetectMimeTypeFromPath(path_with_index));
-    res.SetBody(body);
-    res.SetStatus(lib::http::kOk);
+    struct stat st = lib::utils::StatOrThrow(path_with_index);
+    lib::utils::EnsureRegularFileOrThrowForbidden(st);
+    lib::utils::EnsureAccessOrThrow(path_with_index, R_OK);
+    ServeStaticFile(path_with_index, st);
+  }
+}
+
+// a precompressed variant is served as its own representation: validators
+// and ranges refer to the encoded file, the type to the original one
+void RequestHandler::ServeStaticFile(const std::string& path,
+                                     const struct stat& st) {
+  std::string served_path = path;
+  struct stat served_st = st;
+  lib::http::ContentCoding coding =
+      SelectStaticVariant(path, &served_path, &served_st);
+
+  HttpResponse res;
+  res.AddHeader("Accept-Ranges", "bytes");
+  AddValidatorHeaders(res, served_st);
+  if (location_match_.loc->GetGzipStatic() ||
+      location_match_.loc->GetBrotliStatic()) {
+    res.AddHeader("Vary", "Accept-Encoding");
+  }
+  if (coding != lib::http::kCodingIdentity) {
+    res.AddHeader("Content-Encoding", lib::http::ContentCodingToString(coding));
+  }
+
+  // decided from the stat() result alone: the file is never opened for a 304
+  if (IsNotModified(served_st)) {
+    res.SetStatus(lib::http::kNotModified);
     result_ = ExecResult(res);
+    return;
+  }
+  const std::string mime_type = lib::http::DetectMimeTypeFromPath(path);
+  if (TryServeRange(res, served_path, served_st, mime_type)) return;
+
+  res.AddHeader("Content-Type", mime_type);
+  SetStaticFileBody(res, served_path, served_st);
+  res.SetStatus(lib::http::kOk);
+  result_ = ExecResult(res);
+}
+
+// small files are cheaper to copy than to map; large ones share one mapping
+// across concurrent requests and go to writev() without a user-space copy
+void RequestHandler::SetStaticFileBody(HttpResponse& res,
+                                       const std::string& path,
+                                       const struct stat& st) const {
+  if (st.st_size >= kMmapThreshold) {
+    res.SetBody(lib::io::MappedFile::Open(path, st));
+  } else {
+    res.SetBody(lib::utils::ReadFileToStringOrThrow(path));
   }
 }
 
@@ -156,26 +232,23 @@ void RequestHandler::HandleGet() {
 void RequestHandler::HandlePost() {
   const std::string req_uri = req_.GetUri();
   if (!req_uri.empty() && req_uri[req_uri.size() - 1] == '/') {
-    std::cerr
-        << "[DEBUG] POST request URI ends with '/', rejecting as directory"
+    WEBSERV_LOG(kDebug)
+        << "POST request URI ends with '/', rejecting as directory"
         << std::endl;
     HttpResponse res;
     res.SetStatus(lib::http::kMethodNotAllowed);
     res.AddHeader("Connection", "close");
-    res.AddHeader("Content-Type", "text/html");
-    res.EnsureDefaultErrorContent();
     result_ = ExecResult(res);
     return;
   }
   const std::string path = filesystem_path_;
   if (lib::utils::IsDirectory(path)) {
-    std::cerr << "[DEBUG] POST request resolved to a directory, rejecting"
-              << std::endl;
+    WEBSERV_LOG(kDebug)
+        << "POST request resolved to a directory, rejecting"
+        << std::endl;
     HttpResponse res;
     res.SetStatus(lib::http::kMethodNotAllowed);  // 405
     res.AddHeader("Connection", "close");
-    res.AddHeader("Content-Type", "text/html");
-    res.EnsureDefaultErrorContent();
     result_ = ExecResult(res);
     return;
   }
@@ -183,20 +256,15 @@ void RequestHandler::HandlePost() {
     CgiExecutor cgi(req_, *location_match_.loc, path);
     result_ = cgi.Run();
   } else {
-    std::ofstream ofs(path.c_str(), std::ios::binary);
-    if (!ofs) {
+    // close-on-exec: an aio thread may spawn a script meanwhile
+    lib::type::Fd ofd(
+        open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+    if (ofd.GetFd() == -1) {
       throw lib::exception::ResponseStatusException(lib::http::kForbidden);
       // response_->setStatus(kForbidden); // shoud we check errno and return
       // 403/404/500 accordingly? return;
     }
-    const std::string& req_body = req_.GetBody();
-    ofs.write(req_body.data(), static_cast<std::streamsize>(req_body.size()));
-    if (!ofs) {
-      throw lib::exception::ResponseStatusException(
-          lib::http::kInternalServerError);
-      // response_->setStatus(kInternalServerError);
-      // return;
-    }
+    req_.GetBodyBuffer().WriteTo(ofd.GetFd());
     HttpResponse res(lib::http::kCreated);  // 201 Created
     res.AddHeader("Location", req_uri);  // TODO: should this be absolute URI?
     result_ = ExecResult(res);
@@ -0,0 +1,113 @@
+#include "ResponseCompression.hpp"
+
+#include <string>
+
+#include "lib/http/CompressedBodyProducer.hpp"
+#include "lib/http/ContentCoding.hpp"
+#include "lib/http/Status.hpp"
+#include "lib/io/OutputQueue.hpp"
+#include "lib/type/Optional.hpp"
+#include "lib/utils/string_utils.hpp"
+
+namespace compression {
+
+namespace {
+
+bool IsCompressible(const ServerConfig& config, HttpResponse& res) {
+  if (res.GetStatus() == lib::http::kPartialContent) return false;
+  if (res.HasHeader("content-encoding") || res.HasHeader("content-range")) {
+    return false;
+  }
+  lib::type::Optional<std::string> type = res.GetHeader("content-type");
+  return type.HasValue() && config.IsGzipType(type.Value());
+}
+
+void AddVary(HttpResponse& res) {
+  lib::type::Optional<std::string> vary = res.GetHeader("vary");
+  if (!vary.HasValue()) {
+    res.AddHeader("Vary", "Accept-Encoding");
+  } else if (vary.Value() != "*" &&
+             lib::utils::ToLowerAscii(vary.Value()).find("accept-encoding") ==
+                 std::string::npos) {
+    res.AddHeader("Vary", vary.Value() + ", Accept-Encoding");
+  }
+}
+
+// the encoded bytes differ from the identity ones: a strong validator
+// must not be reused for them (RFC 9110 8.8.3)
+void WeakenETag(HttpResponse& res) {
+  lib::type::Optional<std::string> etag = res.GetHeader("etag");
+  if (etag.HasValue() && etag.Value().compare(0, 2, "W/") != 0) {
+    res.AddHeader("ETag", "W/" + etag.Value());
+  }
+}
+
+void SetEncodingHeaders(HttpResponse& res, lib::http::ContentCoding coding) {
+  res.AddHeader("Content-Encoding", lib::http::ContentCodingToString(coding));
+  res.RemoveHeader("content-length");
+  res.RemoveHeader("accept-ranges");
+  WeakenETag(res);
+}
+
+}  // namespace
+
+lib::io::BodyProducer* EncodeResponse(const ServerConfig& config,
+                                      const HttpRequest& req,
+                                      HttpResponse& res) {
+  if (!config.GetGzip() || !IsCompressible(config, res)) return NULL;
+  // the representation depends on Accept-Encoding even when we do not encode
+  AddVary(res);
+  if (res.GetBodySize() == 0 ||
+      res.GetBodySize() < config.GetGzipMinLength()) {
+    return NULL;
+  }
+  lib::http::ContentCoding coding = lib::http::SelectContentCoding(
+      req.GetHeader("accept-encoding").ValueOr(""));
+  if (coding == lib::http::kCodingIdentity) return NULL;
+  const bool fits_budget = res.GetBodySize() <= kDeflateBudget;
+  // streaming needs chunked framing; HTTP/1.0 peers get such bodies as is
+  if (!fits_budget && req.GetVersion() != "HTTP/1.1") return NULL;
+
+  SetEncodingHeaders(res, coding);
+
+  lib::io::OutputQueue body;
+  res.TakeBody(body);
+  if (fits_budget) {
+    lib::http::CompressedBodyProducer encoder(
+        body, coding, config.GetGzipCompLevel(), false, kDeflateBudget);
+    lib::io::OutputQueue encoded;
+    encoder.Produce(encoded);
+    res.SetBody(encoded.ToString());
+    return NULL;
+  }
+  res.AddHeader("Transfer-Encoding", "chunked");
+  return new lib::http::CompressedBodyProducer(
+      body, coding, config.GetGzipCompLevel(), true, kDeflateBudget);
+}
+
+lib::http::ContentCoding EncodeStreamedResponse(const ServerConfig& config,
+                                                const HttpRequest& req,
+                                                HttpResponse& res) {
+  if (!config.GetGzip() || !IsCompressible(config, res)) {
+    return lib::http::kCodingIdentity;
+  }
+  AddVary(res);
+  lib::type::Optional<std::string> length = res.GetHeader("content-length");
+  if (length.HasValue()) {
+    lib::type::Optional<long> n = lib::utils::StrToLong(length.Value());
+    if (n.HasValue() && (n.Value() == 0 || static_cast<size_t>(n.Value()) <
+                                               config.GetGzipMinLength())) {
+      return lib::http::kCodingIdentity;
+    }
+  }
+  if (req.GetVersion() != "HTTP/1.1") return lib::http::kCodingIdentity;
+  lib::http::ContentCoding coding = lib::http::SelectContentCoding(
+      req.GetHeader("accept-encoding").ValueOr(""));
+  if (coding == lib::http::kCodingIdentity) return coding;
+
+  SetEncodingHeaders(res, coding);
+  res.AddHeader("Transfer-Encoding", "chunked");
+  return coding;
+}
+
+}  // namespace compression
@@ -1,5 +1,14 @@
 #include "ServerConfig.hpp"
 
+#include "ConfigParser.hpp"
+#include "FileValidator.hpp"
+#include "lib/http/MimeType.hpp"
+#include "lib/utils/file_utils.hpp"
+#include "lib/utils/string_utils.hpp"
+
+const int ServerConfig::kDefaultShutdownTimeout;
+const size_t ServerConfig::kDefaultAioMaxQueue;
+
 /*
 If the port is omitted, the default port is 80.
 If the address is omitted, the server listens on all addresses (0.0.0.0).
@@ -9,9 +18,35 @@ ServerConfig::ServerConfig()
       port_(80),
       server_name_(),
       max_body_size_(0),
+      gzip_(false),
+      gzip_min_length_(20),
+      gzip_comp_level_(1),
+      shutdown_timeout_(kDefaultShutdownTimeout),
+      access_log_path_(),
+      access_log_format_(),
+      access_log_(),
+      slow_log_path_(),
+      slow_log_threshold_us_(0),
+      slow_log_sample_(0),
+      slow_log_(),
+      log_level_(lib::logging::kInfo),
+      event_backend_(event::kBackendEpoll),
+      aio_threads_(0),
+      aio_max_queue_(kDefaultAioMaxQueue),
       has_listen_(false),
       has_server_name_(false),
-      has_max_body_(false) {
+      has_max_body_(false),
+      has_gzip_(false),
+      has_gzip_types_(false),
+      has_gzip_min_length_(false),
+      has_gzip_comp_level_(false),
+      has_shutdown_timeout_(false),
+      has_access_log_(false),
+      has_slow_log_(false),
+      has_log_level_(false),
+      has_event_backend_(false),
+      has_aio_threads_(false) {
+  gzip_types_.insert("text/html");
 }
 
 void ServerConfig::SetListen(const std::string& host,
@@ -55,3 +90,167 @@ void ServerConfig::SetMaxBodySize(int size) {
   max_body_size_ = size;
   has_max_body_ = true;
 }
+
+void ServerConfig::SetGzip(const std::string& value) {
+  if (has_gzip_) {
+    throw std::runtime_error("Duplicate gzip directive");
+  }
+  if (value != "on" && value != "off") {
+    throw std::runtime_error("Invalid gzip value: " + value);
+  }
+  gzip_ = (value == "on");
+  has_gzip_ = true;
+}
+
+void ServerConfig::SetGzipTypes(const std::vector<std::string>& types) {
+  if (has_gzip_types_) {
+    throw std::runtime_error("Duplicate gzip_types directive");
+  }
+  for (size_t i = 0; i < types.size(); ++i) {
+    gzip_types_.insert(lib::utils::ToLowerAscii(types[i]));
+  }
+  has_gzip_types_ = true;
+}
+
+void ServerConfig::SetGzipMinLength(size_t length) {
+  if (has_gzip_min_length_) {
+    throw std::runtime_error("Duplicate gzip_min_length directive");
+  }
+  gzip_min_length_ = length;
+  has_gzip_min_length_ = true;
+}
+
+void ServerConfig::SetGzipCompLevel(int level) {
+  if (has_gzip_comp_level_) {
+    throw std::runtime_error("Duplicate gzip_comp_level directive");
+  }
+  gzip_comp_level_ = level;
+  has_gzip_comp_level_ = true;
+}
+
+void ServerConfig::SetShutdownTimeout(int seconds) {
+  if (has_shutdown_timeout_) {
+    throw std::runtime_error("Duplicate shutdown_timeout directive");
+  }
+  shutdown_timeout_ = seconds;
+  has_shutdown_timeout_ = true;
+}
+
+void ServerConfig::SetAccessLog(const std::string& path,
+                                const std::string& format) {
+  if (has_access_log_) {
+    throw std::runtime_error("Duplicate access_log directive");
+  }
+  access_log_format_ =
+      format.empty() ? access_log::LogFormat() : access_log::LogFormat(format);
+  access_log_path_ = path;
+  has_access_log_ = true;
+}
+
+void ServerConfig::SetSlowLog(const std::string& path, uint64_t threshold_ms,
+                              size_t sample) {
+  if (has_slow_log_) {
+    throw std::runtime_error("Duplicate slow_log directive");
+  }
+  slow_log_path_ = path;
+  slow_log_threshold_us_ = threshold_ms * 1000;
+  slow_log_sample_ = sample;
+  has_slow_log_ = true;
+}
+
+void ServerConfig::SetLogLevel(const std::string& level) {
+  if (has_log_level_) {
+    throw std::runtime_error("Duplicate log_level directive");
+  }
+  log_level_ = lib::logging::ParseLevel(level);
+  has_log_level_ = true;
+}
+
+void ServerConfig::SetEventBackend(const std::string& backend) {
+  if (has_event_backend_) {
+    throw std::runtime_error("Duplicate event_backend directive");
+  }
+  event_backend_ = event::ParseBackend(backend);
+  has_event_backend_ = true;
+}
+
+void ServerConfig::SetAioThreads(size_t threads, size_t max_queue) {
+  if (has_aio_threads_) {
+    throw std::runtime_error("Duplicate aio_threads directive");
+  }
+  aio_threads_ = threads;
+  aio_max_queue_ = max_queue;
+  has_aio_threads_ = true;
+}
+
+void ServerConfig::OpenLogs() {
+  if (!access_log_path_.empty()) {
+    access_log_ = access_log::AccessLog::Open(access_log_path_);
+  }
+  if (!slow_log_path_.empty()) {
+    slow_log_ = access_log::AccessLog::Open(slow_log_path_);
+  }
+}
+
+void ServerConfig::ShareCgiLimiters() {
+  for (size_t i = 0; i < locations_.size(); ++i) {
+    std::ostringstream key;
+    key << port_ << ' '
+        << TrimTrailingSlashExceptRoot(locations_[i].GetName());
+    locations_[i].ShareCgiLimiter(key.str());
+  }
+}
+
+bool ServerConfig::IsGzipType(const std::string& content_type) const {
+  if (gzip_types_.count("*")) return true;
+  std::string media_type = content_type.substr(0, content_type.find(';'));
+  size_t end = media_type.find_last_not_of(" \t");
+  media_type.erase(end == std::string::npos ? 0 : end + 1);
+  return gzip_types_.count(lib::utils::ToLowerAscii(media_type)) > 0;
+}
+
+/*
+Internal targets are resolved like a GET of that URI would be (location
+root + remainder); external URLs are kept for a 302. The new set replaces
+the old one only when every page loaded, so a failed reload keeps serving
+the previous pages.
+*/
+void ServerConfig::LoadErrorPages() {
+  std::map<lib::http::Status, ErrorPage> pages;
+  for (std::map<lib::http::Status, std::string>::const_iterator it =
+           errors_.begin();
+       it != errors_.end(); ++it) {
+    const std::string& target = it->second;
+    ErrorPage page;
+    if (lib::utils::StartsWith(target, url_constants::kHttpPrefix) ||
+        lib::utils::StartsWith(target, url_constants::kHttpsPrefix)) {
+      page.redirect = target;
+      pages[it->first] = page;
+      continue;
+    }
+    try {
+      LocationMatch match = FindLocationForUri(target);
+      if (match.loc->HasRedirect()) {
+        throw std::runtime_error("location redirects");
+      }
+      const std::string path = FileValidator::ValidateAndNormalizePath(
+          match.loc->GetRoot() + match.remainder, match.loc->GetRoot());
+      lib::utils::CheckReadableRegularFileOrThrow(path);
+      page.body = lib::type::SharedPtr<const std::string>(
+          new std::string(lib::utils::ReadFileToStringOrThrow(path)));
+      page.content_type = lib::http::DetectMimeTypeFromPath(path);
+    } catch (const std::exception&) {
+      throw std::runtime_error("error_page " +
+                               lib::utils::ToString(it->first) +
+                               ": cannot load " + target);
+    }
+    pages[it->first] = page;
+  }
+  error_pages_.swap(pages);
+}
+
+const ErrorPage* ServerConfig::FindErrorPage(lib::http::Status status) const {
+  std::map<lib::http::Status, ErrorPage>::const_iterator it =
+      error_pages_.find(status);
+  return it == error_pages_.end() ? NULL : &it->second;
+}
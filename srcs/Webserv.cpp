@@ -1,90 +1,243 @@
 #include "Webserv.hpp"
 
-#include <sys/epoll.h>
+#include <fcntl.h>
+#include <spawn.h>
 #include <unistd.h>
 
 #include <cerrno>
 #include <csignal>
+#include <cstdlib>
 #include <cstring>
 #include <ctime>
 #include <iostream>
+#include <sstream>
 
+#include "CgiReaper.hpp"
 #include "ConfigParser.hpp"
+#include "access_log/AccessLog.hpp"
+#include "aio/ThreadPool.hpp"
+#include "lib/logging/Logging.hpp"
+#include "lib/thread/Mutex.hpp"
 #include "lib/type/Fd.hpp"
+#include "lib/type/Optional.hpp"
+#include "lib/utils/string_utils.hpp"
 #include "socket/ServerSocket.hpp"
 
-Webserv::Webserv() : epoll_fd_(-1) {
+namespace {
+
+const char* const kListenFdsEnv = "WEBSERV_LISTEN_FDS";
+const char* const kReadyFdEnv = "WEBSERV_READY_FD";
+
+volatile sig_atomic_t g_reload_requested = 0;
+volatile sig_atomic_t g_upgrade_requested = 0;
+volatile sig_atomic_t g_shutdown_requested = 0;
+volatile sig_atomic_t g_reopen_requested = 0;
+
+void HandleSighup(int signum) {
+  (void)signum;
+  g_reload_requested = 1;
+}
+
+void HandleSigusr2(int signum) {
+  (void)signum;
+  g_upgrade_requested = 1;
+}
+
+void HandleShutdownSignal(int signum) {
+  (void)signum;
+  g_shutdown_requested = 1;
+}
+
+void HandleSigusr1(int signum) {
+  (void)signum;
+  g_reopen_requested = 1;
+}
+
+}  // namespace
+
+// the new configuration, built off the loop; `done` hands it over
+struct Webserv::ReloadJob {
+  explicit ReloadJob(const std::string& path)
+      : config_file(path), configs(), error(), mutex(), done(false) {
+  }
+
+  void Run() {
+    std::map<unsigned short, ServerConfigSnapshot> parsed;
+    std::string failure;
+    try {
+      ConfigParser config_parser;
+      config_parser.LoadFileOrThrowRuntime(config_file);
+      config_parser.Parse();
+      parsed = MapConfigsByPort(config_parser.GetServerConfigs());
+    } catch (const std::exception& e) {
+      failure = e.what();
+    }
+    lib::thread::ScopedLock lock(mutex);
+    configs.swap(parsed);
+    error = failure;
+    done = true;
+  }
+
+  bool IsDone() {
+    lib::thread::ScopedLock lock(mutex);
+    return done;
+  }
+
+  const std::string config_file;
+  std::map<unsigned short, ServerConfigSnapshot> configs;
+  std::string error;  // set instead of configs on failure
+  lib::thread::Mutex mutex;
+  bool done;
+};
+
+Webserv::Webserv()
+    : draining_(false),
+      drain_deadline_(0),
+      drain_reported_(0),
+      poller_(NULL),
+      reload_job_(NULL),
+      upgrade_pid_(0),
+      upgrade_deadline_(0) {
 }
 
 Webserv::~Webserv() {
+  if (upgrade_pid_ != 0) AbandonUpgrade("server stopped");
+  if (reload_job_) {
+    pthread_join(reload_thread_, NULL);
+    delete reload_job_;
+  }
+  // joins the pool first: a running task still uses its connection
+  aio::ThreadPool::Stop();
   ClearResources();
+  // after the logs the configuration held are closed and written out
+  access_log::AccessLog::StopWriter();
+  cgi::CgiReaper::KillAll();
+  delete poller_;
 }
 
-Webserv::Webserv(const std::string& config_file) {
+Webserv::Webserv(const std::string& config_file, const std::string& executable)
+    : config_file_(config_file),
+      executable_(executable),
+      draining_(false),
+      drain_deadline_(0),
+      drain_reported_(0),
+      poller_(NULL),
+      reload_job_(NULL),
+      upgrade_pid_(0),
+      upgrade_deadline_(0) {
   signal(SIGPIPE, SIG_IGN);  // avoid client disconnect crashes
+  signal(SIGHUP, HandleSighup);
+  signal(SIGUSR2, HandleSigusr2);
+  signal(SIGTERM, HandleShutdownSignal);
+  signal(SIGQUIT, HandleShutdownSignal);
+  signal(SIGUSR1, HandleSigusr1);
 
   ConfigParser config_parser;
   config_parser.LoadFileOrThrowRuntime(config_file);
   config_parser.Parse();
   const std::vector<ServerConfig>& configs = config_parser.GetServerConfigs();
   InitServersFromConfigs(configs);
+  std::map<unsigned short, int> inherited = TakeInheritedListeners();
 
-  epoll_fd_.Reset(epoll_create(1));
-  if (epoll_fd_.GetFd() == -1) {
-    throw std::runtime_error("epoll_create() failed. " +
-                             std::string(strerror(errno)));
+  try {
+    poller_ = event::Poller::Create(SelectEventBackend());
+  } catch (...) {
+    for (std::map<unsigned short, int>::iterator it = inherited.begin();
+         it != inherited.end(); ++it) {
+      close(it->second);
+    }
+    throw;
   }
+  WEBSERV_LOG(kInfo) << "Event backend: "
+                     << event::BackendToString(poller_->GetBackend())
+                     << std::endl;
 
   try {
-    for (std::map<unsigned short, ServerConfig>::const_iterator it =
+    StartAioThreads();
+    for (std::map<unsigned short, ServerConfigSnapshot>::const_iterator it =
              port_to_server_configs_.begin();
          it != port_to_server_configs_.end(); ++it) {
-      const ServerConfig& config = it->second;
-
-      ServerSocket* server_socket = new ServerSocket(config);
-      sockets_[server_socket->GetFd()] = server_socket;
-
-      epoll_event ev;
-      ev.events = EPOLLIN;
-      ev.data.ptr = server_socket;
-      if (epoll_ctl(epoll_fd_.GetFd(), EPOLL_CTL_ADD, server_socket->GetFd(),
-                    &ev) == -1) {
-        throw std::runtime_error("epoll_ctl() failed. " +
-                                 std::string(strerror(errno)));
+      std::map<unsigned short, int>::iterator fd = inherited.find(it->first);
+      if (fd == inherited.end()) {
+        RegisterListener(it->first, new ServerSocket(it->second));
+        continue;
       }
+      lib::type::Fd listening_fd(fd->second);
+      inherited.erase(fd);
+      RegisterListener(it->first, new ServerSocket(it->second, listening_fd));
     }
   } catch (...) {
+    for (std::map<unsigned short, int>::iterator it = inherited.begin();
+         it != inherited.end(); ++it) {
+      close(it->second);
+    }
+    aio::ThreadPool::Stop();
     ClearResources();
+    delete poller_;
+    poller_ = NULL;
     throw;
   }
+  // ports the new configuration no longer listens on
+  for (std::map<unsigned short, int>::iterator it = inherited.begin();
+       it != inherited.end(); ++it) {
+    close(it->second);
+  }
+  NotifyUpgradeReady();
 }
 
 void Webserv::Run() {
-  epoll_event events[kMaxEvents];
-  while (true) {
+  event::Event events[kMaxEvents];
+  while (!IsDrained()) {
+    // a SIGHUP during a reload waits for it: the file may have changed
+    if (g_reload_requested && reload_job_ == NULL) {
+      g_reload_requested = 0;
+      if (!draining_) StartReload();
+    }
+    PollReload();
+    if (g_upgrade_requested) {
+      g_upgrade_requested = 0;
+      Upgrade();
+    }
+    if (g_shutdown_requested) {
+      g_shutdown_requested = 0;
+      Shutdown();
+    }
+    if (g_reopen_requested) {
+      g_reopen_requested = 0;
+      access_log::AccessLog::ReopenAll();
+    }
+    if (draining_) ReportDrainProgress();
+    CheckUpgradeTimeout();
     CheckTimeout();
-    int nfds =
-        epoll_wait(epoll_fd_.GetFd(), events, kMaxEvents, kEpollWaitTimeout);
+    cgi::CgiReaper::Reap();
+    int nfds = poller_->Wait(events, kMaxEvents, kWaitTimeout);
     if (nfds == -1) {
-      std::cerr << "epoll_wait() failed. " << strerror(errno) << std::endl;
+      if (errno != EINTR) {
+        std::cerr << "Poller Wait() failed. " << strerror(errno) << std::endl;
+      }
       continue;
     }
 
     for (int i = 0; i < nfds; ++i) {
-      ASocket* socket = static_cast<ASocket*>(events[i].data.ptr);
-      SocketResult result =
-          socket->HandleEvent(epoll_fd_.GetFd(), events[i].events);
+      if (events[i].data == NULL) {  // see StartAioThreads()
+        aio::ThreadPool::DispatchCompletions(*poller_);
+        continue;
+      }
+      if (events[i].data == &upgrade_ready_fd_) {  // see Upgrade()
+        OnUpgradeReadable();
+        continue;
+      }
+      ASocket* socket = static_cast<ASocket*>(events[i].data);
+      SocketResult result = socket->HandleEvent(*poller_, events[i].events);
 
       if (result.new_socket) {
         sockets_[result.new_socket->GetFd()] = result.new_socket;
-        epoll_event ev;
-        ev.events = EPOLLIN;
-        ev.data.ptr = result.new_socket;
-        if (epoll_ctl(epoll_fd_.GetFd(), EPOLL_CTL_ADD,
-                      result.new_socket->GetFd(), &ev) == -1) {
-          std::cerr << "epoll_ctl() failed for new socket. " << strerror(errno)
-                    << std::endl;
+        if (poller_->Add(result.new_socket->GetFd(), event::kReadable,
+                         result.new_socket) == -1) {
+          std::cerr << "Poller Add() failed for new socket. "
+                    << strerror(errno) << std::endl;
           sockets_.erase(result.new_socket->GetFd());
+          result.new_socket->OnPollerAddFailed(*poller_);
           delete result.new_socket;
         }
       }
@@ -94,33 +247,473 @@ void Webserv::Run() {
         delete socket;
       }
     }
+    access_log::AccessLog::FlushPending(false);
+  }
+  access_log::AccessLog::FlushPending(true);
+  if (sockets_.empty()) {
+    std::cerr << "Drain complete" << std::endl;
+  } else {
+    std::cerr << "Drain deadline reached, closing " << sockets_.size()
+              << " connection(s)" << std::endl;
   }
 }
 
-void Webserv::InitServersFromConfigs(const std::vector<ServerConfig>& configs) {
-  port_to_server_configs_.clear();
+void Webserv::Reload() {
+  ReloadJob job(config_file_);
+  job.Run();
+  ApplyReload(job);
+}
+
+void Webserv::StartReload() {
+  if (reload_job_) return;
+  ReloadJob* job = new ReloadJob(config_file_);
+  if (pthread_create(&reload_thread_, NULL, ReloadThreadMain, job) != 0) {
+    WEBSERV_LOG(kWarn) << "Reload: no helper thread, parsing on the loop"
+                       << std::endl;
+    delete job;
+    Reload();
+    return;
+  }
+  reload_job_ = job;
+}
+
+void* Webserv::ReloadThreadMain(void* arg) {
+  static_cast<ReloadJob*>(arg)->Run();
+  return NULL;
+}
+
+bool Webserv::PollReload() {
+  if (reload_job_ == NULL || !reload_job_->IsDone()) return false;
+  pthread_join(reload_thread_, NULL);
+  ReloadJob* job = reload_job_;
+  reload_job_ = NULL;
+  if (draining_) {
+    std::cerr << "Reload dropped: draining" << std::endl;
+  } else {
+    ApplyReload(*job);
+  }
+  delete job;
+  return true;
+}
+
+// loop thread; the access logs and CGI limiters are taken here, their
+// registries are not shared with other threads
+void Webserv::ApplyReload(ReloadJob& job) {
+  std::map<unsigned short, ServerConfigSnapshot> next;
+  next.swap(job.configs);
+  try {
+    if (!job.error.empty()) throw std::runtime_error(job.error);
+    OpenSharedResources(next);
+  } catch (const std::exception& e) {
+    std::cerr << "Reload failed, keeping the current configuration: "
+              << e.what() << std::endl;
+    return;
+  }
+
+  // open the new ports first: a failed bind leaves everything as it was
+  std::map<unsigned short, ServerSocket*> opened;
+  try {
+    for (std::map<unsigned short, ServerConfigSnapshot>::const_iterator it =
+             next.begin();
+         it != next.end(); ++it) {
+      if (listeners_.count(it->first)) continue;
+      ServerSocket* listener = new ServerSocket(it->second);
+      opened[it->first] = listener;
+      RegisterListener(it->first, listener);
+    }
+  } catch (const std::exception& e) {
+    for (std::map<unsigned short, ServerSocket*>::iterator it = opened.begin();
+         it != opened.end(); ++it) {
+      CloseListener(it->first, it->second);
+    }
+    std::cerr << "Reload failed, keeping the current configuration: "
+              << e.what() << std::endl;
+    return;
+  }
+
+  std::vector<unsigned short> removed;
+  for (std::map<unsigned short, ServerSocket*>::iterator it =
+           listeners_.begin();
+       it != listeners_.end(); ++it) {
+    std::map<unsigned short, ServerConfigSnapshot>::const_iterator config =
+        next.find(it->first);
+    if (config == next.end()) {
+      removed.push_back(it->first);
+    } else {
+      it->second->SetConfig(config->second);
+    }
+  }
+  for (size_t i = 0; i < removed.size(); ++i) {
+    CloseListener(removed[i], listeners_[removed[i]]);
+  }
+  port_to_server_configs_.swap(next);
+  ApplyLogLevel();
+  std::cerr << "Configuration reloaded from " << config_file_ << std::endl;
+}
+
+void Webserv::Upgrade() {
+  if (draining_) return;
+  if (upgrade_pid_ != 0) {
+    std::cerr << "Upgrade already in progress (pid " << upgrade_pid_ << ")"
+              << std::endl;
+    return;
+  }
+  if (executable_.empty()) {
+    std::cerr << "Upgrade unavailable: executable path unknown" << std::endl;
+    return;
+  }
+  // close-on-exec from the start: a CGI script spawned meanwhile must not
+  // hold the write end, or the EOF of a failed upgrade never comes
+  int ready[2];
+  if (pipe2(ready, O_CLOEXEC) == -1) {
+    std::cerr << "Upgrade failed: pipe2() " << strerror(errno) << std::endl;
+    return;
+  }
+  pid_t pid;
+  const int err = SpawnUpgradedBinary(ready[1], &pid);
+  close(ready[1]);
+  if (err != 0) {
+    std::cerr << "Upgrade failed: spawn " << executable_ << ": "
+              << strerror(err) << std::endl;
+    close(ready[0]);
+    return;
+  }
+  upgrade_pid_ = pid;
+  upgrade_ready_fd_.Reset(ready[0]);
+  upgrade_deadline_ = std::time(NULL) + kUpgradeStartTimeout;
+  if (poller_->Add(ready[0], event::kReadable, &upgrade_ready_fd_) == -1) {
+    std::cerr << "Upgrade failed: Poller Add() " << strerror(errno)
+              << std::endl;
+    AbandonUpgrade("ready pipe not watched");
+    return;
+  }
+  std::cerr << "Upgrade: started new binary (pid " << pid
+            << "), waiting for it to listen" << std::endl;
+}
+
+// one byte means the new process listens; EOF means it exited first
+void Webserv::OnUpgradeReadable() {
+  char ready;
+  const ssize_t n = read(upgrade_ready_fd_.GetFd(), &ready, 1);
+  if (n == -1 && (errno == EINTR || errno == EAGAIN)) return;
+  if (n != 1) {
+    AbandonUpgrade("new binary exited before it was ready");
+    return;
+  }
+  std::cerr << "New binary is serving (pid " << upgrade_pid_ << "), draining"
+            << std::endl;
+  poller_->Remove(upgrade_ready_fd_.GetFd());
+  upgrade_ready_fd_.Reset();
+  upgrade_pid_ = 0;
+  StartDraining(GetShutdownTimeout());
+}
+
+void Webserv::CheckUpgradeTimeout() {
+  if (upgrade_pid_ != 0 && std::time(NULL) >= upgrade_deadline_) {
+    AbandonUpgrade("new binary did not become ready in time");
+  }
+}
+
+// the child holds our listeners: it must not start accepting later on
+void Webserv::AbandonUpgrade(const char* reason) {
+  std::cerr << "Upgrade failed: " << reason << " (pid " << upgrade_pid_
+            << "), still serving" << std::endl;
+  if (poller_) poller_->Remove(upgrade_ready_fd_.GetFd());
+  upgrade_ready_fd_.Reset();
+  kill(upgrade_pid_, SIGKILL);
+  cgi::CgiReaper::Adopt(upgrade_pid_);  // collected like a dropped script
+  upgrade_pid_ = 0;
+}
+
+void Webserv::Shutdown() {
+  if (draining_) {
+    std::cerr << "Shutdown requested again, closing remaining connections"
+              << std::endl;
+    drain_deadline_ = std::time(NULL);
+    return;
+  }
+  if (upgrade_pid_ != 0) AbandonUpgrade("shutdown requested");
+  std::cerr << "Graceful shutdown, waiting up to " << GetShutdownTimeout()
+            << "s" << std::endl;
+  StartDraining(GetShutdownTimeout());
+}
+
+/*
+posix_spawn() like CgiExecutor: the aio pool and the reload thread may hold
+locks, so nothing that allocates runs between fork and exec. Every other
+descriptor is close-on-exec; dup2() onto itself clears the flag on the
+child's copy of the listeners and the ready pipe only. Returns an errno
+value, 0 on success.
+*/
+int Webserv::SpawnUpgradedBinary(int ready_fd, pid_t* pid) const {
+  posix_spawn_file_actions_t actions;
+  int err = posix_spawn_file_actions_init(&actions);
+  if (err != 0) return err;
+  std::ostringstream listen_fds;
+  for (std::map<unsigned short, ServerSocket*>::const_iterator it =
+           listeners_.begin();
+       it != listeners_.end() && err == 0; ++it) {
+    const int fd = it->second->GetFd();
+    if (it != listeners_.begin()) listen_fds << ",";
+    listen_fds << it->first << ":" << fd;
+    err = posix_spawn_file_actions_adddup2(&actions, fd, fd);
+  }
+  if (err == 0) {
+    err = posix_spawn_file_actions_adddup2(&actions, ready_fd, ready_fd);
+  }
+  if (err == 0) {
+    const std::string listen_var =
+        std::string(kListenFdsEnv) + "=" + listen_fds.str();
+    const std::string ready_var =
+        std::string(kReadyFdEnv) + "=" + lib::utils::ToString(ready_fd);
+    std::vector<char*> envp;
+    for (char** var = environ; *var != NULL; ++var) {
+      if (std::strncmp(*var, listen_var.c_str(),
+                       std::strlen(kListenFdsEnv) + 1) != 0 &&
+          std::strncmp(*var, ready_var.c_str(),
+                       std::strlen(kReadyFdEnv) + 1) != 0) {
+        envp.push_back(*var);
+      }
+    }
+    envp.push_back(const_cast<char*>(listen_var.c_str()));
+    envp.push_back(const_cast<char*>(ready_var.c_str()));
+    envp.push_back(NULL);
+    char* argv[] = {const_cast<char*>(executable_.c_str()),
+                    const_cast<char*>(config_file_.c_str()), NULL};
+    err = posix_spawn(pid, executable_.c_str(), &actions, NULL, argv,
+                      &envp[0]);
+  }
+  posix_spawn_file_actions_destroy(&actions);
+  return err;
+}
+
+// WEBSERV_LISTEN_FDS="8080:3,8081:4", set by Upgrade() of the old process
+std::map<unsigned short, int> Webserv::TakeInheritedListeners() {
+  std::map<unsigned short, int> fds;
+  const char* env = std::getenv(kListenFdsEnv);
+  if (env == NULL) return fds;
+  std::stringstream ss(env);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    const size_t colon = item.find(':');
+    if (colon == std::string::npos) continue;
+    lib::type::Optional<unsigned short> port =
+        lib::utils::StrToUnsignedShort(item.substr(0, colon));
+    lib::type::Optional<long> fd =
+        lib::utils::StrToLong(item.substr(colon + 1));
+    if (!port.HasValue() || !fd.HasValue() || fd.Value() < 0) continue;
+    fds[port.Value()] = static_cast<int>(fd.Value());
+  }
+  unsetenv(kListenFdsEnv);  // not for CGI children
+  return fds;
+}
+
+void Webserv::NotifyUpgradeReady() {
+  const char* env = std::getenv(kReadyFdEnv);
+  if (env == NULL) return;
+  lib::type::Optional<long> fd = lib::utils::StrToLong(env);
+  unsetenv(kReadyFdEnv);
+  if (!fd.HasValue() || fd.Value() < 0) return;
+  const char ready = '1';
+  if (write(static_cast<int>(fd.Value()), &ready, 1) != 1) {
+    std::cerr << "Failed to report readiness to the previous binary"
+              << std::endl;
+  }
+  close(static_cast<int>(fd.Value()));
+}
+
+// stop accepting; Run() returns once the connections are gone or at the
+// deadline
+void Webserv::StartDraining(time_t timeout) {
+  std::map<unsigned short, ServerSocket*> listeners = listeners_;
+  for (std::map<unsigned short, ServerSocket*>::iterator it =
+           listeners.begin();
+       it != listeners.end(); ++it) {
+    CloseListener(it->first, it->second);
+  }
+  // nothing to finish on connections that have not sent a request
+  for (std::map<int, ASocket*>::iterator it = sockets_.begin();
+       it != sockets_.end();) {
+    if (it->second->IsIdle()) {
+      poller_->Remove(it->first);
+      delete it->second;
+      sockets_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  draining_ = true;
+  drain_deadline_ = std::time(NULL) + timeout;
+  drain_reported_ = sockets_.size();
+  std::cerr << "Draining " << sockets_.size() << " connection(s)" << std::endl;
+}
+
+// one line whenever the number of open sockets (clients and CGI) drops
+void Webserv::ReportDrainProgress() {
+  if (sockets_.size() == drain_reported_) return;
+  drain_reported_ = sockets_.size();
+  const time_t left = drain_deadline_ - std::time(NULL);
+  std::cerr << "Draining: " << sockets_.size() << " connection(s) left, "
+            << (left > 0 ? left : 0) << "s to deadline" << std::endl;
+}
+
+bool Webserv::IsDrained() const {
+  return draining_ &&
+         (sockets_.empty() || std::time(NULL) >= drain_deadline_);
+}
+
+void Webserv::RegisterListener(unsigned short port, ServerSocket* listener) {
+  if (poller_->Add(listener->GetFd(), event::kReadable, listener) == -1) {
+    int saved_errno = errno;
+    delete listener;
+    throw std::runtime_error("Poller Add() failed. " +
+                             std::string(strerror(saved_errno)));
+  }
+  sockets_[listener->GetFd()] = listener;
+  listeners_[port] = listener;
+}
+
+// accepted connections are separate sockets and stay open
+void Webserv::CloseListener(unsigned short port, ServerSocket* listener) {
+  std::map<unsigned short, ServerSocket*>::iterator it = listeners_.find(port);
+  if (it == listeners_.end() || it->second != listener) return;
+  poller_->Remove(listener->GetFd());
+  sockets_.erase(listener->GetFd());
+  listeners_.erase(it);
+  delete listener;
+}
+
+// the first server block for a port wins; error pages are loaded here and
+// access logs and CGI limiters by OpenSharedResources() so a snapshot is
+// complete before anything can reference it. Touches nothing shared: runs
+// on the reload thread too.
+std::map<unsigned short, ServerConfigSnapshot> Webserv::MapConfigsByPort(
+    const std::vector<ServerConfig>& configs) {
+  std::map<unsigned short, ServerConfigSnapshot> by_port;
   for (std::vector<ServerConfig>::const_iterator server = configs.begin();
        server != configs.end(); ++server) {
     const unsigned short& port = server->GetPort();
-    if (port_to_server_configs_.find(port) != port_to_server_configs_.end()) {
+    if (by_port.find(port) != by_port.end()) {
       std::cerr << "Warning: Multiple server blocks for port " << port
                 << ", using first one only" << std::endl;
       continue;
     }
-    port_to_server_configs_[port] = *server;
+    ServerConfig* config = new ServerConfig(*server);
+    ServerConfigSnapshot snapshot(config);
+    config->LoadErrorPages();
+    by_port[port] = snapshot;
+  }
+  return by_port;
+}
+
+void Webserv::OpenSharedResources(
+    const std::map<unsigned short, ServerConfigSnapshot>& configs) {
+  for (std::map<unsigned short, ServerConfigSnapshot>::const_iterator it =
+           configs.begin();
+       it != configs.end(); ++it) {
+    // not yet handed to any connection
+    ServerConfig* config = const_cast<ServerConfig*>(it->second.Get());
+    config->OpenLogs();
+    config->ShareCgiLimiters();
+  }
+}
+
+void Webserv::InitServersFromConfigs(const std::vector<ServerConfig>& configs) {
+  std::map<unsigned short, ServerConfigSnapshot> by_port =
+      MapConfigsByPort(configs);
+  OpenSharedResources(by_port);
+  port_to_server_configs_.swap(by_port);
+  ApplyLogLevel();
+}
+
+// log_level is process-wide: the most verbose server block wins
+void Webserv::ApplyLogLevel() const {
+  lib::logging::Level level = lib::logging::kInfo;
+  bool configured = false;
+  for (std::map<unsigned short, ServerConfigSnapshot>::const_iterator it =
+           port_to_server_configs_.begin();
+       it != port_to_server_configs_.end(); ++it) {
+    if (!it->second->HasLogLevel()) continue;
+    if (!configured || it->second->GetLogLevel() < level) {
+      level = it->second->GetLogLevel();
+      configured = true;
+    }
+  }
+  lib::logging::SetLevel(level);
+}
+
+// chosen once at startup (a reload keeps the running backend): io_uring as
+// soon as one server block asks for it
+event::Backend Webserv::SelectEventBackend() const {
+  for (std::map<unsigned short, ServerConfigSnapshot>::const_iterator it =
+           port_to_server_configs_.begin();
+       it != port_to_server_configs_.end(); ++it) {
+    if (it->second->GetEventBackend() == event::kBackendIoUring) {
+      return event::kBackendIoUring;
+    }
   }
+  return event::kBackendEpoll;
 }
 
-const std::map<unsigned short, ServerConfig>& Webserv::GetPortConfigs() const {
+/*
+One pool for the process, sized by the largest aio_threads and max_queue
+among the server blocks. Reload() keeps the pool it started with: blocks
+that turn aio_threads on later run their handlers on the pool only if one
+is running already.
+*/
+void Webserv::StartAioThreads() {
+  size_t threads = 0;
+  size_t max_queue = 0;
+  for (std::map<unsigned short, ServerConfigSnapshot>::const_iterator it =
+           port_to_server_configs_.begin();
+       it != port_to_server_configs_.end(); ++it) {
+    if (it->second->GetAioThreads() == 0) continue;
+    if (it->second->GetAioThreads() > threads) {
+      threads = it->second->GetAioThreads();
+    }
+    if (it->second->GetAioMaxQueue() > max_queue) {
+      max_queue = it->second->GetAioMaxQueue();
+    }
+  }
+  if (threads == 0) return;
+  aio::ThreadPool::Start(threads, max_queue);
+  // the only registration without a socket behind it
+  if (poller_->Add(aio::ThreadPool::CompletionFd(), event::kReadable, NULL) ==
+      -1) {
+    aio::ThreadPool::Stop();
+    throw std::runtime_error("Poller Add() failed for the aio pool. " +
+                             std::string(strerror(errno)));
+  }
+  WEBSERV_LOG(kInfo) << "aio threads: " << threads << " (max_queue "
+                     << max_queue << ")" << std::endl;
+}
+
+const std::map<unsigned short, ServerConfigSnapshot>&
+Webserv::GetPortConfigs() const {
   return port_to_server_configs_;
 }
 
+int Webserv::GetShutdownTimeout() const {
+  if (port_to_server_configs_.empty()) {
+    return ServerConfig::kDefaultShutdownTimeout;
+  }
+  int timeout = 0;
+  for (std::map<unsigned short, ServerConfigSnapshot>::const_iterator it =
+           port_to_server_configs_.begin();
+       it != port_to_server_configs_.end(); ++it) {
+    if (it->second->GetShutdownTimeout() > timeout) {
+      timeout = it->second->GetShutdownTimeout();
+    }
+  }
+  return timeout;
+}
+
 const ServerConfig* Webserv::FindServerConfigByPort(
     const unsigned short& port) const {
-  std::map<unsigned short, ServerConfig>::const_iterator it =
+  std::map<unsigned short, ServerConfigSnapshot>::const_iterator it =
       port_to_server_configs_.find(port);
   if (it != port_to_server_configs_.end()) {
-    return &it->second;
+    return it->second.Get();
   }
   return NULL;
 }
@@ -134,7 +727,7 @@ void Webserv::CheckTimeout() {
     if (it->second->IsTimeout(threshold)) {
       ASocket* socket = it->second;
       int fd = socket->GetFd();
-      socket->HandleTimeout(epoll_fd_.GetFd());
+      socket->HandleTimeout(*poller_);
       delete socket;
       sockets_.erase(it++);
       std::cerr << "Connection timed out. fd: " << fd << std::endl;
@@ -152,4 +745,5 @@ void Webserv::ClearResources() {
   }
   std::cerr << "All sockets cleaned up." << std::endl;
   sockets_.clear();
+  listeners_.clear();
 }
@@ -0,0 +1,19 @@
+#include "Worker.hpp"
+
+namespace worker {
+
+namespace {
+
+__thread size_t t_index = 0;
+
+}  // namespace
+
+void Bind(size_t index) {
+  t_index = index < kMaxWorkers ? index : kMaxWorkers - 1;
+}
+
+size_t Current() {
+  return t_index;
+}
+
+}  // namespace worker
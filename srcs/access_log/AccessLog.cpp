@@ -0,0 +1,292 @@
+#include "access_log/AccessLog.hpp"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+
+#include "Worker.hpp"
+#include "lib/thread/Mutex.hpp"
+
+namespace access_log {
+
+const size_t AccessLog::kBufferSize;
+const size_t AccessLog::kFlushThreshold;
+const time_t AccessLog::kFlushInterval;
+const size_t AccessLog::kMaxQueuedBytes;
+
+namespace {
+
+typedef std::map<std::string, AccessLog::Handle> Registry;
+
+Registry& OpenLogs() {
+  static Registry logs;
+  return logs;
+}
+
+int OpenForAppend(const std::string& path) {
+  return open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+}
+
+// a buffer's worth of lines, or a reopen, for the writer thread
+struct Job {
+  AccessLog::Handle log;
+  std::string data;
+  bool reopen;
+};
+
+// one writer for every log; allocated once and never freed, so a thread
+// still waiting at exit never sees it destroyed
+struct Writer {
+  lib::thread::Mutex mutex;
+  lib::thread::Condition changed;  // jobs queued, done or stopping
+  std::deque<Job*> queue;
+  size_t queued_bytes;
+  bool busy;  // a job taken off the queue is being written
+  bool running;
+  bool stopping;
+  bool dropping;  // warned about the full queue already
+  pthread_t thread;
+
+  Writer()
+      : queued_bytes(0),
+        busy(false),
+        running(false),
+        stopping(false),
+        dropping(false) {
+  }
+};
+
+Writer& TheWriter() {
+  static Writer* writer = new Writer();
+  return *writer;
+}
+
+}  // namespace
+
+AccessLog::AccessLog(const std::string& path, int fd)
+    : path_(path),
+      fd_(fd),
+      buffers_(worker::kMaxWorkers, static_cast<lib::io::RingBuffer*>(NULL)),
+      pending_since_(worker::kMaxWorkers, 0) {
+}
+
+AccessLog::~AccessLog() {
+  for (size_t w = 0; w < buffers_.size(); ++w) {
+    if (buffers_[w]) {
+      while (!buffers_[w]->Empty() && buffers_[w]->WriteTo(fd_.GetFd()) > 0) {
+      }
+      delete buffers_[w];
+    }
+  }
+}
+
+AccessLog::Handle AccessLog::Open(const std::string& path) {
+  Registry& logs = OpenLogs();
+  Registry::iterator it = logs.find(path);
+  if (it != logs.end()) return it->second;
+  int fd = OpenForAppend(path);
+  if (fd == -1) {
+    throw std::runtime_error("access_log " + path +
+                             ": cannot open: " + std::strerror(errno));
+  }
+  Handle log(new AccessLog(path, fd));
+  logs[path] = log;
+  return log;
+}
+
+lib::io::RingBuffer& AccessLog::Buffer() {
+  const size_t w = worker::Current();
+  if (!buffers_[w]) buffers_[w] = new lib::io::RingBuffer(kBufferSize);
+  return *buffers_[w];
+}
+
+void AccessLog::Write(const std::string& line) {
+  lib::io::RingBuffer& buffer = Buffer();
+  if (line.size() > buffer.Available()) {
+    Flush();
+    if (line.size() > buffer.Available()) {  // larger than the buffer
+      std::string data(line);
+      Submit(&data, false);
+      return;
+    }
+  }
+  if (buffer.Empty()) pending_since_[worker::Current()] = std::time(NULL);
+  buffer.Append(line.data(), line.size());
+}
+
+void AccessLog::Flush() {
+  lib::io::RingBuffer& buffer = Buffer();
+  if (buffer.Empty()) return;
+  std::string data;
+  data.reserve(buffer.Size());
+  buffer.MoveTo(&data);
+  Submit(&data, false);
+}
+
+void AccessLog::Reopen() {
+  Flush();
+  Submit(NULL, true);
+}
+
+/*
+Starts the writer on first use. When no thread can be started the job runs
+right here, as it did before there was a writer.
+*/
+void AccessLog::Submit(std::string* data, bool reopen) {
+  Writer& writer = TheWriter();
+  Job* job = new Job();
+  Registry::iterator registered = OpenLogs().find(path_);
+  if (registered != OpenLogs().end()) job->log = registered->second;
+  job->reopen = reopen;
+  if (data) job->data.swap(*data);
+  if (job->log.IsNull()) {  // closing: nothing refers to the log anymore
+    Perform(job->data, reopen);
+    delete job;
+    return;
+  }
+  {
+    lib::thread::ScopedLock lock(writer.mutex);
+    if (!reopen && writer.queued_bytes + job->data.size() > kMaxQueuedBytes) {
+      if (!writer.dropping) {
+        std::cerr << "access_log " << path_ << ": writer behind, dropping "
+                  << job->data.size() << " bytes" << std::endl;
+      }
+      writer.dropping = true;
+      delete job;
+      return;
+    }
+    if (!writer.running) {
+      writer.stopping = false;
+      writer.running =
+          pthread_create(&writer.thread, NULL, WriterMain, NULL) == 0;
+    }
+    if (writer.running) {
+      writer.queued_bytes += job->data.size();
+      writer.queue.push_back(job);
+      writer.changed.Broadcast();
+      return;
+    }
+  }
+  Perform(job->data, reopen);
+  delete job;
+}
+
+void* AccessLog::WriterMain(void* arg) {
+  (void)arg;
+  Writer& writer = TheWriter();
+  lib::thread::ScopedLock lock(writer.mutex);
+  for (;;) {
+    while (writer.queue.empty() && !writer.stopping) {
+      writer.changed.Wait(writer.mutex);
+    }
+    if (writer.queue.empty()) return NULL;  // stopping and drained
+    Job* job = writer.queue.front();
+    writer.queue.pop_front();
+    writer.queued_bytes -= job->data.size();
+    writer.busy = true;
+    writer.mutex.Unlock();
+    job->log->Perform(job->data, job->reopen);
+    delete job;  // may close a log nobody refers to anymore
+    writer.mutex.Lock();
+    writer.busy = false;
+    if (writer.queue.empty()) writer.dropping = false;
+    writer.changed.Broadcast();
+  }
+}
+
+void AccessLog::Perform(const std::string& data, bool reopen) {
+  if (reopen) {
+    ReopenNow();
+  } else {
+    WriteOut(data.data(), data.size());
+  }
+}
+
+// a failed write drops the lines rather than retrying forever
+void AccessLog::WriteOut(const char* data, size_t len) {
+  while (len > 0) {
+    ssize_t n = write(fd_.GetFd(), data, len);
+    if (n == -1) {
+      if (errno == EINTR) continue;
+      std::cerr << "access_log " << path_ << ": " << std::strerror(errno)
+                << ", dropping " << len << " bytes" << std::endl;
+      return;
+    }
+    data += n;
+    len -= static_cast<size_t>(n);
+  }
+}
+
+void AccessLog::ReopenNow() {
+  int fd = OpenForAppend(path_);
+  if (fd == -1) {
+    std::cerr << "access_log " << path_
+              << ": reopen failed, keeping the old file: "
+              << std::strerror(errno) << std::endl;
+    return;
+  }
+  fd_.Reset(fd);
+}
+
+const std::string& AccessLog::GetPath() const {
+  return path_;
+}
+
+void AccessLog::FlushPending(bool force) {
+  Registry& logs = OpenLogs();
+  const time_t now = std::time(NULL);
+  const size_t w = worker::Current();
+  for (Registry::iterator it = logs.begin(); it != logs.end(); ++it) {
+    AccessLog& log = *it->second;
+    const lib::io::RingBuffer* buffer = log.buffers_[w];
+    if (buffer && !buffer->Empty() &&
+        (force || buffer->Size() >= kFlushThreshold ||
+         now - log.pending_since_[w] >= kFlushInterval)) {
+      log.Flush();
+    }
+  }
+  if (force) {
+    Writer& writer = TheWriter();
+    lib::thread::ScopedLock lock(writer.mutex);
+    while (!writer.queue.empty() || writer.busy) {
+      writer.changed.Wait(writer.mutex);
+    }
+  }
+  for (Registry::iterator it = logs.begin(); it != logs.end();) {
+    // only the registry (queued jobs hold a reference too): close it
+    if (it->second.UseCount() == 1) {
+      logs.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void AccessLog::ReopenAll() {
+  Registry& logs = OpenLogs();
+  for (Registry::iterator it = logs.begin(); it != logs.end(); ++it) {
+    it->second->Reopen();
+  }
+}
+
+void AccessLog::StopWriter() {
+  Writer& writer = TheWriter();
+  {
+    lib::thread::ScopedLock lock(writer.mutex);
+    if (!writer.running) return;
+    writer.stopping = true;
+    writer.changed.Broadcast();
+  }
+  pthread_join(writer.thread, NULL);
+  lib::thread::ScopedLock lock(writer.mutex);
+  writer.running = false;
+}
+
+}  // namespace access_log
@@ -0,0 +1,285 @@
+#include "access_log/LogFormat.hpp"
+
+#include <stdexcept>
+
+#include "HttpRequest.hpp"
+#include "Location.hpp"
+#include "lib/http/Method.hpp"
+#include "lib/type/Optional.hpp"
+
+namespace access_log {
+
+namespace {
+
+const char* const kCombinedFormat =
+    "$remote_addr - - [$time_local] \"$request\" $status $body_bytes_sent "
+    "\"$http_referer\" \"$http_user_agent\"";
+const char* const kCommonFormat =
+    "$remote_addr - - [$time_local] \"$request\" $status $body_bytes_sent";
+
+const char* const kHttpPrefix = "http_";
+
+bool IsNameChar(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+void AppendNumber(uint64_t value, std::string* out) {
+  char buf[24];
+  size_t len = 0;
+  do {
+    buf[len++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+  while (len > 0) out->push_back(buf[--len]);
+}
+
+// request data is client-controlled: keep the line parseable
+void AppendEscaped(const std::string& value, std::string* out) {
+  static const char kHex[] = "0123456789ABCDEF";
+  if (value.empty()) {
+    out->push_back('-');
+    return;
+  }
+  for (size_t i = 0; i < value.size(); ++i) {
+    const unsigned char c = static_cast<unsigned char>(value[i]);
+    if (c == '"' || c == '\\' || c < 0x20 || c >= 0x7f) {
+      out->append("\\x");
+      out->push_back(kHex[c >> 4]);
+      out->push_back(kHex[c & 0x0f]);
+    } else {
+      out->push_back(static_cast<char>(c));
+    }
+  }
+}
+
+// both renderings change once per second; format them once per second
+struct TimeStrings {
+  time_t second;
+  std::string local;    // 19/Oct/2026:06:58:40 +0000
+  std::string iso8601;  // 2026-10-19T06:58:40+00:00
+};
+
+// +hhmm, or +hh:mm for ISO 8601 (strftime's %z is not C++98)
+std::string UtcOffset(long gmtoff, bool colon) {
+  std::string out(1, gmtoff < 0 ? '-' : '+');
+  if (gmtoff < 0) gmtoff = -gmtoff;
+  const long hours = gmtoff / 3600;
+  const long minutes = gmtoff / 60 % 60;
+  out.push_back(static_cast<char>('0' + hours / 10));
+  out.push_back(static_cast<char>('0' + hours % 10));
+  if (colon) out.push_back(':');
+  out.push_back(static_cast<char>('0' + minutes / 10));
+  out.push_back(static_cast<char>('0' + minutes % 10));
+  return out;
+}
+
+const TimeStrings& TimeStringsFor(time_t t) {
+  static TimeStrings cached = {static_cast<time_t>(-1), "", ""};
+  if (cached.second != t) {
+    struct tm tm;
+    localtime_r(&t, &tm);
+    char buf[64];
+    strftime(buf, sizeof(buf), "%d/%b/%Y:%H:%M:%S ", &tm);
+    cached.local = buf + UtcOffset(tm.tm_gmtoff, false);
+    strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm);
+    cached.iso8601 = buf + UtcOffset(tm.tm_gmtoff, true);
+    cached.second = t;
+  }
+  return cached;
+}
+
+std::string RequestUri(const HttpRequest& req) {
+  if (req.GetQuery().empty()) return req.GetUri();
+  return req.GetUri() + "?" + req.GetQuery();
+}
+
+std::string MethodName(const HttpRequest& req) {
+  const lib::http::Method method = req.GetMethod();
+  if (method == lib::http::kNone || method == lib::http::kUnknownMethod) {
+    return "";
+  }
+  return lib::http::MethodToString(method);
+}
+
+}  // namespace
+
+Entry::Entry()
+    : request(NULL),
+      location(NULL),
+      status(0),
+      bytes_received(0),
+      bytes_sent(0),
+      body_bytes_sent(0),
+      request_time_us(0),
+      time(0) {
+}
+
+LogFormat::LogFormat() {
+  Compile(kCombinedFormat);
+}
+
+LogFormat::LogFormat(const std::string& spec) {
+  if (spec == "combined") {
+    Compile(kCombinedFormat);
+  } else if (spec == "common") {
+    Compile(kCommonFormat);
+  } else {
+    Compile(spec);
+  }
+}
+
+void LogFormat::Compile(const std::string& format) {
+  struct Name {
+    const char* name;
+    Variable variable;
+  };
+  static const Name kNames[] = {
+      {"remote_addr", kRemoteAddr},
+      {"time_local", kTimeLocal},
+      {"time_iso8601", kTimeIso8601},
+      {"request", kRequest},
+      {"request_method", kRequestMethod},
+      {"request_uri", kRequestUri},
+      {"uri", kUri},
+      {"args", kArgs},
+      {"server_protocol", kServerProtocol},
+      {"status", kStatus},
+      {"bytes_sent", kBytesSent},
+      {"body_bytes_sent", kBodyBytesSent},
+      {"request_length", kRequestLength},
+      {"request_time", kRequestTime},
+      {"location", kLocation},
+  };
+  const std::string http_prefix(kHttpPrefix);
+
+  parts_.clear();
+  std::string literal;
+  size_t i = 0;
+  while (i < format.size()) {
+    size_t end = i + 1;
+    while (format[i] == '$' && end < format.size() && IsNameChar(format[end])) {
+      ++end;
+    }
+    if (format[i] != '$' || end == i + 1) {  // a lone '$' is literal
+      literal += format[i++];
+      continue;
+    }
+    const std::string name = format.substr(i + 1, end - i - 1);
+    Part part;
+    part.variable = kLiteral;
+    for (size_t n = 0; n < sizeof(kNames) / sizeof(kNames[0]); ++n) {
+      if (name == kNames[n].name) part.variable = kNames[n].variable;
+    }
+    if (part.variable == kLiteral &&
+        name.compare(0, http_prefix.size(), http_prefix) == 0 &&
+        name.size() > http_prefix.size()) {
+      part.variable = kHttpHeader;
+      part.text = name.substr(http_prefix.size());
+      for (size_t c = 0; c < part.text.size(); ++c) {
+        if (part.text[c] == '_') part.text[c] = '-';
+      }
+    }
+    if (part.variable == kLiteral) {
+      throw std::runtime_error("Unknown access_log variable: $" + name);
+    }
+    if (!literal.empty()) {
+      Part text;
+      text.variable = kLiteral;
+      text.text = literal;
+      parts_.push_back(text);
+      literal.clear();
+    }
+    parts_.push_back(part);
+    i = end;
+  }
+  if (!literal.empty()) {
+    Part text;
+    text.variable = kLiteral;
+    text.text = literal;
+    parts_.push_back(text);
+  }
+}
+
+void LogFormat::Render(const Entry& entry, std::string* out) const {
+  for (std::vector<Part>::const_iterator it = parts_.begin();
+       it != parts_.end(); ++it) {
+    RenderPart(*it, entry, out);
+  }
+  out->push_back('\n');
+}
+
+void LogFormat::RenderPart(const Part& part, const Entry& entry,
+                           std::string* out) const {
+  const HttpRequest& req = *entry.request;
+  switch (part.variable) {
+    case kLiteral:
+      out->append(part.text);
+      break;
+    case kRemoteAddr:
+      AppendEscaped(req.GetClientIp(), out);
+      break;
+    case kTimeLocal:
+      out->append(TimeStringsFor(entry.time).local);
+      break;
+    case kTimeIso8601:
+      out->append(TimeStringsFor(entry.time).iso8601);
+      break;
+    case kRequest: {
+      const std::string method = MethodName(req);
+      if (method.empty()) {
+        out->push_back('-');
+        break;
+      }
+      out->append(method);
+      out->push_back(' ');
+      AppendEscaped(RequestUri(req), out);
+      out->push_back(' ');
+      AppendEscaped(req.GetVersion(), out);
+      break;
+    }
+    case kRequestMethod:
+      AppendEscaped(MethodName(req), out);
+      break;
+    case kRequestUri:
+      AppendEscaped(RequestUri(req), out);
+      break;
+    case kUri:
+      AppendEscaped(req.GetUri(), out);
+      break;
+    case kArgs:
+      AppendEscaped(req.GetQuery(), out);
+      break;
+    case kServerProtocol:
+      AppendEscaped(req.GetVersion(), out);
+      break;
+    case kStatus:
+      AppendNumber(entry.status, out);
+      break;
+    case kBytesSent:
+      AppendNumber(entry.bytes_sent, out);
+      break;
+    case kBodyBytesSent:
+      AppendNumber(entry.body_bytes_sent, out);
+      break;
+    case kRequestLength:
+      AppendNumber(entry.bytes_received, out);
+      break;
+    case kRequestTime: {  // seconds with millisecond resolution
+      const uint64_t ms = entry.request_time_us / 1000;
+      AppendNumber(ms / 1000, out);
+      out->push_back('.');
+      out->push_back(static_cast<char>('0' + ms % 1000 / 100));
+      out->push_back(static_cast<char>('0' + ms % 100 / 10));
+      out->push_back(static_cast<char>('0' + ms % 10));
+      break;
+    }
+    case kLocation:
+      AppendEscaped(entry.location ? entry.location->GetName() : "", out);
+      break;
+    case kHttpHeader:
+      AppendEscaped(req.GetHeader(part.text).ValueOr(""), out);
+      break;
+  }
+}
+
+}  // namespace access_log
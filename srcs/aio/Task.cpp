@@ -0,0 +1,30 @@
+#include "aio/Task.hpp"
+
+namespace aio {
+
+const char* OpName(Op op) {
+  switch (op) {
+    case kOpRead:
+      return "read";
+    case kOpWrite:
+      return "write";
+    case kOpUnlink:
+      return "unlink";
+    case kOpSpawn:
+      return "spawn";
+    default:
+      return "unknown";
+  }
+}
+
+Task::Task(Op op) : op_(op), queued_us_(0) {
+}
+
+Task::~Task() {
+}
+
+Op Task::GetOp() const {
+  return op_;
+}
+
+}  // namespace aio
@@ -0,0 +1,187 @@
+#include "aio/ThreadPool.hpp"
+
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "lib/thread/Mutex.hpp"
+#include "lib/type/Fd.hpp"
+#include "lib/utils/time_utils.hpp"
+#include "metrics/Metrics.hpp"
+
+namespace aio {
+
+const size_t ThreadPool::kMaxThreads;
+
+namespace {
+
+struct Pool {
+  lib::thread::Mutex mutex;
+  lib::thread::Condition queued;  // a task was queued or the pool stops
+  std::deque<Task*> queue;
+  std::vector<Task*> done;
+  std::vector<pthread_t> threads;
+  size_t max_queue;
+  bool running;
+  bool stopping;
+  lib::type::Fd completion_fd;
+
+  Pool() : max_queue(0), running(false), stopping(false) {
+  }
+};
+
+Pool& State() {
+  static Pool pool;
+  return pool;
+}
+
+void RunTask(Task* task, uint64_t queued_us) {
+  const uint64_t started_us = lib::utils::MonotonicMicros();
+  try {
+    task->Run();
+  } catch (const std::exception& e) {
+    std::cerr << "aio task failed: " << e.what() << std::endl;
+  }
+  metrics::RecordAio(task->GetOp(), started_us - queued_us,
+                     lib::utils::MonotonicMicros() - started_us);
+}
+
+}  // namespace
+
+// tasks in queue order until Stop()
+void* ThreadPool::ThreadMain(void* arg) {
+  worker::Bind(reinterpret_cast<size_t>(arg));
+  Pool& pool = State();
+  for (;;) {
+    Task* task;
+    {
+      lib::thread::ScopedLock lock(pool.mutex);
+      while (pool.queue.empty() && !pool.stopping) {
+        pool.queued.Wait(pool.mutex);
+      }
+      if (pool.stopping) return NULL;
+      task = pool.queue.front();
+      pool.queue.pop_front();
+    }
+    RunTask(task, task->queued_us_);
+    {
+      lib::thread::ScopedLock lock(pool.mutex);
+      pool.done.push_back(task);
+    }
+    const uint64_t one = 1;
+    if (write(pool.completion_fd.GetFd(), &one, sizeof(one)) == -1 &&
+        errno != EAGAIN) {
+      std::cerr << "aio eventfd write failed: " << strerror(errno)
+                << std::endl;
+    }
+  }
+}
+
+void ThreadPool::Start(size_t threads, size_t max_queue) {
+  Pool& pool = State();
+  if (pool.running) throw std::runtime_error("aio pool already running");
+  if (threads == 0 || threads > kMaxThreads || max_queue == 0) {
+    throw std::runtime_error("Invalid aio pool size");
+  }
+  pool.completion_fd.Reset(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+  if (pool.completion_fd.GetFd() == -1) {
+    throw std::runtime_error("eventfd() failed. " +
+                             std::string(strerror(errno)));
+  }
+  pool.max_queue = max_queue;
+  pool.stopping = false;
+  pool.running = true;
+  for (size_t i = 0; i < threads; ++i) {
+    pthread_t thread;
+    // worker 0 is the event loop
+    const int err = pthread_create(&thread, NULL, ThreadMain,
+                                   reinterpret_cast<void*>(i + 1));
+    if (err != 0) {
+      Stop();
+      throw std::runtime_error("pthread_create() failed. " +
+                               std::string(strerror(err)));
+    }
+    pool.threads.push_back(thread);
+  }
+}
+
+void ThreadPool::Stop() {
+  Pool& pool = State();
+  if (!pool.running) return;
+  {
+    lib::thread::ScopedLock lock(pool.mutex);
+    pool.stopping = true;
+    pool.queued.Broadcast();
+  }
+  for (size_t i = 0; i < pool.threads.size(); ++i) {
+    pthread_join(pool.threads[i], NULL);
+  }
+  pool.threads.clear();
+  for (size_t i = 0; i < pool.queue.size(); ++i) delete pool.queue[i];
+  pool.queue.clear();
+  for (size_t i = 0; i < pool.done.size(); ++i) delete pool.done[i];
+  pool.done.clear();
+  pool.completion_fd.Reset();
+  pool.running = false;
+}
+
+bool ThreadPool::IsRunning() {
+  return State().running;
+}
+
+bool ThreadPool::Submit(Task* task) {
+  Pool& pool = State();
+  lib::thread::ScopedLock lock(pool.mutex);
+  if (!pool.running || pool.stopping || pool.queue.size() >= pool.max_queue) {
+    return false;
+  }
+  task->queued_us_ = lib::utils::MonotonicMicros();
+  pool.queue.push_back(task);
+  pool.queued.Signal();
+  return true;
+}
+
+int ThreadPool::CompletionFd() {
+  return State().running ? State().completion_fd.GetFd() : -1;
+}
+
+// the eventfd counter is reset before the done list is taken: a task
+// finishing in between bumps it again and is picked up next time
+void ThreadPool::DispatchCompletions(event::Poller& poller) {
+  Pool& pool = State();
+  if (!pool.running) return;
+  uint64_t count;
+  if (read(pool.completion_fd.GetFd(), &count, sizeof(count)) == -1 &&
+      errno != EAGAIN) {
+    std::cerr << "aio eventfd read failed: " << strerror(errno) << std::endl;
+  }
+  std::vector<Task*> done;
+  {
+    lib::thread::ScopedLock lock(pool.mutex);
+    done.swap(pool.done);
+  }
+  for (size_t i = 0; i < done.size(); ++i) {
+    try {
+      done[i]->Complete(poller);
+    } catch (const std::exception& e) {
+      std::cerr << "aio completion failed: " << e.what() << std::endl;
+    }
+    delete done[i];
+  }
+}
+
+size_t ThreadPool::QueueLength() {
+  Pool& pool = State();
+  lib::thread::ScopedLock lock(pool.mutex);
+  return pool.queue.size();
+}
+
+}  // namespace aio
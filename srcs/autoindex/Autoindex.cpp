@@ -0,0 +1,150 @@
+#include "autoindex/Autoindex.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace autoindex {
+
+namespace {
+
+// directories stay first in both orders when sorting by type
+struct EntryLess {
+  SortKey sort;
+  bool descending;
+
+  bool operator()(const lib::io::DirEntry& a,
+                  const lib::io::DirEntry& b) const {
+    if (sort == kSortByType && a.is_dir != b.is_dir) return a.is_dir;
+    return descending ? b.name < a.name : a.name < b.name;
+  }
+};
+
+void AppendHtmlEscaped(const std::string& s, std::string* out) {
+  for (size_t i = 0; i < s.size(); ++i) {
+    switch (s[i]) {
+      case '&':
+        out->append("&amp;");
+        break;
+      case '<':
+        out->append("&lt;");
+        break;
+      case '>':
+        out->append("&gt;");
+        break;
+      case '"':
+        out->append("&quot;");
+        break;
+      default:
+        out->push_back(s[i]);
+    }
+  }
+}
+
+void AppendJsonEscaped(const std::string& s, std::string* out) {
+  for (size_t i = 0; i < s.size(); ++i) {
+    unsigned char c = static_cast<unsigned char>(s[i]);
+    if (c == '"' || c == '\\') {
+      out->push_back('\\');
+      out->push_back(c);
+    } else if (c < 0x20) {
+      char buf[8];
+      std::sprintf(buf, "\\u%04x", c);
+      out->append(buf);
+    } else {
+      out->push_back(c);
+    }
+  }
+}
+
+// value of name in an a=b&c=d query, "" when absent
+std::string QueryParam(const std::string& query, const std::string& name) {
+  size_t pos = 0;
+  while (pos <= query.size()) {
+    size_t amp = query.find('&', pos);
+    if (amp == std::string::npos) amp = query.size();
+    const std::string pair = query.substr(pos, amp - pos);
+    if (pair.compare(0, name.size() + 1, name + "=") == 0) {
+      return pair.substr(name.size() + 1);
+    }
+    pos = amp + 1;
+  }
+  return "";
+}
+
+}  // namespace
+
+ListingOptions::ListingOptions()
+    : format(kHtml), sort(kSortByType), descending(false) {
+}
+
+ListingOptions ListingOptions::FromQuery(Format format,
+                                         const std::string& query) {
+  ListingOptions options;
+  options.format = format;
+  if (QueryParam(query, "sort") == "name") options.sort = kSortByName;
+  if (QueryParam(query, "order") == "desc") options.descending = true;
+  return options;
+}
+
+std::string ListingOptions::CacheKey() const {
+  std::string key;
+  key += (format == kJson ? 'j' : 'h');
+  key += (sort == kSortByName ? 'n' : 't');
+  key += (descending ? 'd' : 'a');
+  return key;
+}
+
+Format FormatFromString(const std::string& value) {
+  return value == "json" ? kJson : kHtml;
+}
+
+std::string ContentType(Format format) {
+  return format == kJson ? "application/json" : "text/html";
+}
+
+void SortEntries(std::vector<lib::io::DirEntry>* entries,
+                 const ListingOptions& options) {
+  EntryLess less;
+  less.sort = options.sort;
+  less.descending = options.descending;
+  std::sort(entries->begin(), entries->end(), less);
+}
+
+std::string RenderHead(const std::string& dir_uri,
+                       const ListingOptions& options) {
+  if (options.format == kJson) return "[";
+  std::string out = "<html>\n<head><title>Index of ";
+  AppendHtmlEscaped(dir_uri, &out);
+  out += "</title></head>\n<body>\n<h1>Index of ";
+  AppendHtmlEscaped(dir_uri, &out);
+  out += "</h1><hr><pre>";
+  if (dir_uri != "/") out += "<a href=\"../\">../</a>\n";
+  return out;
+}
+
+// the server does not decode %XX, so links carry the raw names
+void RenderEntry(const std::string& dir_uri, const lib::io::DirEntry& entry,
+                 bool first, const ListingOptions& options, std::string* out) {
+  if (options.format == kJson) {
+    if (!first) out->push_back(',');
+    out->append("\n{\"name\":\"");
+    AppendJsonEscaped(entry.name, out);
+    out->append(entry.is_dir ? "\",\"type\":\"directory\"}"
+                             : "\",\"type\":\"file\"}");
+    return;
+  }
+  out->append("<a href=\"");
+  AppendHtmlEscaped(dir_uri + entry.name, out);
+  if (entry.is_dir) out->push_back('/');
+  out->append("\">");
+  AppendHtmlEscaped(entry.name, out);
+  if (entry.is_dir) out->push_back('/');
+  out->append("</a>\n");
+}
+
+std::string RenderTail(const ListingOptions& options) {
+  if (options.format == kJson) return "\n]\n";
+  return "</pre><hr></body>\n</html>\n";
+}
+
+}  // namespace autoindex
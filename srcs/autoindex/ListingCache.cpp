@@ -0,0 +1,115 @@
+#include "autoindex/ListingCache.hpp"
+
+#include <ctime>
+#include <map>
+
+#include "lib/thread/Mutex.hpp"
+
+namespace autoindex {
+
+const size_t ListingCache::kMaxBytes;
+const size_t ListingCache::kMaxBodyBytes;
+
+namespace {
+
+struct Entry {
+  dev_t dev;
+  ino_t ino;
+  time_t mtime_sec;
+  long mtime_nsec;
+  ListingCache::Body body;
+};
+
+typedef std::map<std::string, Entry> EntryMap;
+
+EntryMap& Entries() {
+  static EntryMap entries;
+  return entries;
+}
+
+size_t& TotalBytes() {
+  static size_t total = 0;
+  return total;
+}
+
+lib::io::CacheStats& Counters() {
+  static lib::io::CacheStats stats;
+  return stats;
+}
+
+lib::thread::Mutex& CacheMutex() {
+  static lib::thread::Mutex mutex;
+  return mutex;
+}
+
+bool Matches(const Entry& e, const struct stat& st) {
+  return e.dev == st.st_dev && e.ino == st.st_ino &&
+         e.mtime_sec == st.st_mtim.tv_sec &&
+         e.mtime_nsec == st.st_mtim.tv_nsec;
+}
+
+void Erase(EntryMap& entries, EntryMap::iterator it) {
+  TotalBytes() -= it->second.body->size();
+  entries.erase(it);
+}
+
+}  // namespace
+
+ListingCache::Body ListingCache::Find(const std::string& key,
+                                      const struct stat& dir_st) {
+  lib::thread::ScopedLock lock(CacheMutex());
+  EntryMap& entries = Entries();
+  EntryMap::iterator it = entries.find(key);
+  if (it == entries.end()) {
+    ++Counters().misses;
+    return Body();
+  }
+  if (!Matches(it->second, dir_st)) {
+    ++Counters().misses;
+    Erase(entries, it);
+    return Body();
+  }
+  ++Counters().hits;
+  return it->second.body;
+}
+
+void ListingCache::Store(const std::string& key, const struct stat& dir_st,
+                         const Body& body) {
+  if (body.IsNull() || body->size() > kMaxBodyBytes) return;
+  if (dir_st.st_mtim.tv_sec >= std::time(NULL) - 1) return;  // racy mtime
+
+  lib::thread::ScopedLock lock(CacheMutex());
+  EntryMap& entries = Entries();
+  EntryMap::iterator it = entries.find(key);
+  if (it != entries.end()) Erase(entries, it);
+  // no recency tracking: evict in key order until the new body fits
+  while (!entries.empty() && TotalBytes() + body->size() > kMaxBytes) {
+    Erase(entries, entries.begin());
+  }
+  Entry entry;
+  entry.dev = dir_st.st_dev;
+  entry.ino = dir_st.st_ino;
+  entry.mtime_sec = dir_st.st_mtim.tv_sec;
+  entry.mtime_nsec = dir_st.st_mtim.tv_nsec;
+  entry.body = body;
+  entries.insert(std::make_pair(key, entry));
+  TotalBytes() += body->size();
+}
+
+void ListingCache::Clear() {
+  lib::thread::ScopedLock lock(CacheMutex());
+  Entries().clear();
+  TotalBytes() = 0;
+}
+
+size_t ListingCache::Size() {
+  lib::thread::ScopedLock lock(CacheMutex());
+  return Entries().size();
+}
+
+lib::io::CacheStats ListingCache::Stats() {
+  lib::thread::ScopedLock lock(CacheMutex());
+  return Counters();
+}
+
+}  // namespace autoindex
@@ -0,0 +1,68 @@
+#include "autoindex/ListingProducer.hpp"
+
+#include "autoindex/ListingCache.hpp"
+#include "lib/http/Chunked.hpp"
+
+namespace autoindex {
+
+const size_t ListingProducer::kEntriesPerProduce;
+
+ListingProducer::ListingProducer(std::vector<lib::io::DirEntry>& entries,
+                                 const std::string& dir_uri,
+                                 const ListingOptions& options,
+                                 const std::string& cache_key,
+                                 const struct stat& dir_st)
+    : entries_(),
+      dir_uri_(dir_uri),
+      options_(options),
+      cache_key_(cache_key),
+      dir_st_(dir_st),
+      next_(0),
+      started_(false),
+      finished_(false),
+      cacheable_(true) {
+  entries_.swap(entries);
+}
+
+ListingProducer::~ListingProducer() {
+}
+
+bool ListingProducer::Produce(lib::io::OutputQueue& out) {
+  if (finished_) return true;
+
+  std::string piece;
+  if (!started_) {
+    piece = RenderHead(dir_uri_, options_);
+    started_ = true;
+  }
+  size_t end = next_ + kEntriesPerProduce;
+  if (end > entries_.size()) end = entries_.size();
+  for (; next_ < end; ++next_) {
+    RenderEntry(dir_uri_, entries_[next_], next_ == 0, options_, &piece);
+  }
+  if (next_ == entries_.size()) {
+    piece += RenderTail(options_);
+    finished_ = true;
+  }
+  lib::http::AppendChunk(out, piece.data(), piece.size());
+
+  if (cacheable_) {
+    if (rendered_.size() + piece.size() > ListingCache::kMaxBodyBytes) {
+      cacheable_ = false;
+      std::string().swap(rendered_);
+    } else {
+      rendered_ += piece;
+    }
+  }
+  if (finished_) {
+    lib::http::AppendLastChunk(out);
+    if (cacheable_) {
+      std::string* body = new std::string();
+      body->swap(rendered_);
+      ListingCache::Store(cache_key_, dir_st_, ListingCache::Body(body));
+    }
+  }
+  return finished_;
+}
+
+}  // namespace autoindex
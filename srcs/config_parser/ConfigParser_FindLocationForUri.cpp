@@ -1,4 +1,5 @@
 #include "ServerConfig.hpp"
+#include "lib/logging/Logging.hpp"
 
 // treat "/path////" as "/path"
 // NOTE(routing): We intentionally do NOT normalize internal "//" in the URI
@@ -30,27 +31,23 @@ bool ServerConfig::IsPathPrefix(const std::string& uri_key,
 // URI is the full request URI (e.g., "/images/logo.png")
 // Trailing '/' can be present or absent so needs to be normalized
 // *_key means trimmed of trailing slashes (except for root "/")
+// routes_ is ordered longest key first, so the first match is the longest
 LocationMatch ServerConfig::FindLocationForUri(const std::string& uri) const {
   LocationMatch best;
   best.loc = NULL;  // pointer to best matching location
-  size_t best_len = 0;
   const std::string uri_key = TrimTrailingSlashExceptRoot(uri);
 
-  for (std::vector<Location>::const_iterator it = locations_.begin();
-       it != locations_.end(); ++it) {
-    const std::string loc_key = TrimTrailingSlashExceptRoot(it->GetName());
-    if (IsPathPrefix(uri_key, loc_key)) {
-      size_t len = loc_key.size();
-      if (len > best_len) {
-        best_len = len;
-        best.loc = &(*it);  // Location pointer
-      }
+  std::vector<Route>::const_iterator it = routes_.begin();
+  for (; it != routes_.end(); ++it) {
+    if (IsPathPrefix(uri_key, it->first)) {
+      best.loc = &locations_[it->second];  // Location pointer
+      break;
     }
   }
   if (!best.loc) {
     throw lib::exception::ResponseStatusException(lib::http::kNotFound);
   }
-  const std::string best_key = TrimTrailingSlashExceptRoot(best.loc->GetName());
+  const std::string& best_key = it->first;
   // build remainder (make sure remainder always starts with '/')
   if (uri_key.size() == best_key.size()) {  // exact match
     best.remainder = "/";
@@ -59,7 +56,32 @@ LocationMatch ServerConfig::FindLocationForUri(const std::string& uri) const {
     if (best.remainder.empty()) best.remainder = "/";  // should not happen
     if (best.remainder[0] != '/') best.remainder = "/" + best.remainder;
   }
-  std::cerr << "Best match: location=" << best.loc->GetName()
-            << ", remainder=" << best.remainder << std::endl;
+  WEBSERV_LOG(kDebug) << "Best match: location=" << best.loc->GetName()
+                      << ", remainder=" << best.remainder << std::endl;
   return best;
 }
+
+// the result is routed again, so it need not be normalized here
+lib::type::Optional<std::string> ServerConfig::FindInternalUriForPath(
+    const std::string& path) const {
+  const std::string path_key = TrimTrailingSlashExceptRoot(path);
+  const Location* best = NULL;
+  std::string best_root;
+  for (size_t i = 0; i < locations_.size(); ++i) {
+    if (!locations_[i].IsInternal()) continue;
+    const std::string root =
+        TrimTrailingSlashExceptRoot(locations_[i].GetRoot());
+    if (root.empty() || !IsPathPrefix(path_key, root)) continue;
+    if (best == NULL || root.size() > best_root.size()) {
+      best = &locations_[i];
+      best_root = root;
+    }
+  }
+  if (best == NULL) return lib::type::Optional<std::string>();
+  std::string uri = TrimTrailingSlashExceptRoot(best->GetName());
+  if (uri == "/") uri.clear();
+  const std::string rest =
+      best_root == "/" ? path_key : path_key.substr(best_root.size());
+  uri += rest.empty() ? "/" : rest;
+  return lib::type::Optional<std::string>(uri);
+}
@@ -0,0 +1,37 @@
+#include "ConfigParser.hpp"
+
+/*
+access_log off;
+access_log path [combined|common|format ...];
+
+The config tokenizer has no quoting, so a custom format is every token up
+to the ';' joined by single spaces:
+  access_log logs/access.log $remote_addr "$request" $status $request_time;
+A relative path is resolved against the working directory, like root.
+*/
+void ConfigParser::ParseAccessLog(ServerConfig* server_config) {
+  std::string path = Tokenize(content);
+  if (path.empty() || path == ";" || path == "{" || path == "}") {
+    throw std::runtime_error("Syntax error: expected access_log path");
+  }
+  std::string format;
+  std::string token = Tokenize(content);
+  while (token != ";") {
+    if (token.empty() || token == "{" || token == "}") {
+      throw std::runtime_error("Expected ';' after access_log directive");
+    }
+    if (!format.empty()) format += ' ';
+    format += token;
+    token = Tokenize(content);
+  }
+  if (path == "off") {
+    if (!format.empty()) {
+      throw std::runtime_error("access_log off takes no format");
+    }
+    server_config->SetAccessLog("", "");
+    return;
+  }
+  std::string resolved = ResolveRootPath(path);
+  RequireAbsoluteSafePathOrThrow(resolved, "access_log path");
+  server_config->SetAccessLog(resolved, format);
+}
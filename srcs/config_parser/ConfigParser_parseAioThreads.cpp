@@ -0,0 +1,55 @@
+#include <cstdlib>
+
+#include "ConfigParser.hpp"
+#include "aio/ThreadPool.hpp"
+
+namespace {
+
+const long kMaxQueue = 65536;
+const size_t kMaxDigits = 5;
+const std::string kMaxQueuePrefix = "max_queue=";
+
+long ParseBoundedNumber(const std::string& token, long min, long max,
+                        const std::string& what) {
+  if (token.empty() || token.size() > kMaxDigits ||
+      token.find_first_not_of("0123456789") != std::string::npos ||
+      std::atol(token.c_str()) < min || std::atol(token.c_str()) > max) {
+    throw std::runtime_error("Invalid aio_threads " + what + ": " + token);
+  }
+  return std::atol(token.c_str());
+}
+
+}  // namespace
+
+/*
+aio_threads off;
+aio_threads N [max_queue=M];
+
+Static file, upload and DELETE handlers run on N threads so stat(), open(),
+read() and unlink() never block the event loop (see aio/ThreadPool.hpp).
+When M requests (1024 by default) already wait for a thread, the next one
+is answered 503. The process runs one pool sized by the largest values
+among its server blocks; server blocks without the directive stay inline.
+*/
+void ConfigParser::ParseAioThreads(ServerConfig* server_config) {
+  std::string token = Tokenize(content);
+  if (token == "off") {
+    ConsumeExpectedSemicolon("aio_threads");
+    server_config->SetAioThreads(0, ServerConfig::kDefaultAioMaxQueue);
+    return;
+  }
+  const long threads =
+      ParseBoundedNumber(token, 1, aio::ThreadPool::kMaxThreads, "count");
+  long max_queue = ServerConfig::kDefaultAioMaxQueue;
+  token = Tokenize(content);
+  if (token.compare(0, kMaxQueuePrefix.size(), kMaxQueuePrefix) == 0) {
+    max_queue = ParseBoundedNumber(token.substr(kMaxQueuePrefix.size()), 1,
+                                   kMaxQueue, "max_queue");
+    token = Tokenize(content);
+  }
+  if (token != ";") {
+    throw std::runtime_error("Expected ';' after aio_threads directive");
+  }
+  server_config->SetAioThreads(static_cast<size_t>(threads),
+                               static_cast<size_t>(max_queue));
+}
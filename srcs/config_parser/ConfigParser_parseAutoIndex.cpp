@@ -13,3 +13,9 @@ void ConfigParser::ParseAutoIndex(Location* location) {
   location->SetAutoIndex(value);
   ConsumeExpectedSemicolon("autoindex");
 }
+
+// autoindex_format html|json; (html by default)
+void ConfigParser::ParseAutoIndexFormat(Location* location) {
+  ParseSimpleDirective(location, &Location::SetAutoIndexFormat,
+                       "autoindex_format value");
+}
@@ -0,0 +1,83 @@
+#include <cstdlib>
+
+#include "ConfigParser.hpp"
+
+namespace {
+
+const long kMaxSeconds = 86400;
+const long kMaxEntries = 1000000;
+const size_t kMaxDigits = 7;
+const std::string kStalePrefix = "stale=";
+const std::string kMaxEntriesPrefix = "max_entries=";
+
+long ParseBoundedNumber(const std::string& token, long min, long max,
+                        const std::string& what) {
+  if (token.empty() || token.size() > kMaxDigits ||
+      token.find_first_not_of("0123456789") != std::string::npos ||
+      std::atol(token.c_str()) < min || std::atol(token.c_str()) > max) {
+    throw std::runtime_error("Invalid cgi_cache " + what + ": " + token);
+  }
+  return std::atol(token.c_str());
+}
+
+}  // namespace
+
+/*
+cgi_cache off;
+cgi_cache seconds [stale=S] [max_entries=N];
+
+GET responses of the location's scripts are cached for the given seconds
+unless their Cache-Control says otherwise (see CgiCache.hpp). With stale=S
+an expired entry is served S seconds longer while one request refreshes
+it. At most N entries (1024 by default) are kept.
+*/
+void ConfigParser::ParseCgiCache(Location* location) {
+  std::string token = Tokenize(content);
+  if (token == "off") {
+    ConsumeExpectedSemicolon("cgi_cache");
+    location->SetCgiCache(0, 0, Location::kDefaultCgiCacheMaxEntries);
+    return;
+  }
+  const long ttl = ParseBoundedNumber(token, 1, kMaxSeconds, "time");
+  long stale = 0;
+  long max_entries = Location::kDefaultCgiCacheMaxEntries;
+  token = Tokenize(content);
+  if (token.compare(0, kStalePrefix.size(), kStalePrefix) == 0) {
+    stale = ParseBoundedNumber(token.substr(kStalePrefix.size()), 0,
+                               kMaxSeconds, "stale");
+    token = Tokenize(content);
+  }
+  if (token.compare(0, kMaxEntriesPrefix.size(), kMaxEntriesPrefix) == 0) {
+    max_entries = ParseBoundedNumber(token.substr(kMaxEntriesPrefix.size()),
+                                     1, kMaxEntries, "max_entries");
+    token = Tokenize(content);
+  }
+  if (token != ";") {
+    throw std::runtime_error("Expected ';' after cgi_cache directive");
+  }
+  location->SetCgiCache(static_cast<int>(ttl), static_cast<int>(stale),
+                        static_cast<size_t>(max_entries));
+}
+
+/*
+cgi_cache_key format ...;
+
+access_log variables naming what tells responses apart, joined like an
+access_log format; "$request_method $http_host $request_uri" by default.
+*/
+void ConfigParser::ParseCgiCacheKey(Location* location) {
+  std::string format;
+  std::string token = Tokenize(content);
+  while (token != ";") {
+    if (token.empty() || token == "{" || token == "}") {
+      throw std::runtime_error("Expected ';' after cgi_cache_key directive");
+    }
+    if (!format.empty()) format += ' ';
+    format += token;
+    token = Tokenize(content);
+  }
+  if (format.empty()) {
+    throw std::runtime_error("Syntax error: expected cgi_cache_key format");
+  }
+  location->SetCgiCacheKey(format);
+}
@@ -0,0 +1,50 @@
+#include <cstdlib>
+
+#include "ConfigParser.hpp"
+
+namespace {
+
+const long kMaxCgiConcurrent = 4096;
+const long kMaxCgiQueueSize = 65536;
+const long kMaxCgiQueueTimeout = 3600;
+const size_t kMaxDigits = 5;
+
+long ParseBoundedNumber(const std::string& token, long min, long max,
+                        const std::string& directive) {
+  if (token.empty() || token.size() > kMaxDigits ||
+      token.find_first_not_of("0123456789") != std::string::npos ||
+      std::atol(token.c_str()) < min || std::atol(token.c_str()) > max) {
+    throw std::runtime_error("Invalid " + directive + " value: " + token);
+  }
+  return std::atol(token.c_str());
+}
+
+}  // namespace
+
+/*
+cgi_max_concurrent N; (0, no limit, by default)
+cgi_queue_size N; (64 by default)
+cgi_queue_timeout seconds; (10 by default)
+At most N scripts of the location run at once. Further requests wait in
+arrival order for a slot, up to cgi_queue_size of them, each for at most
+cgi_queue_timeout seconds; the others get 503 with Retry-After (see
+CgiLimiter.hpp). Across a reload, the scripts a location's limiter counts
+keep counting against its new limits.
+*/
+void ConfigParser::ParseCgiMaxConcurrent(Location* location) {
+  location->SetCgiMaxConcurrent(static_cast<size_t>(ParseBoundedNumber(
+      Tokenize(content), 0, kMaxCgiConcurrent, "cgi_max_concurrent")));
+  ConsumeExpectedSemicolon("cgi_max_concurrent");
+}
+
+void ConfigParser::ParseCgiQueueSize(Location* location) {
+  location->SetCgiQueueSize(static_cast<size_t>(ParseBoundedNumber(
+      Tokenize(content), 0, kMaxCgiQueueSize, "cgi_queue_size")));
+  ConsumeExpectedSemicolon("cgi_queue_size");
+}
+
+void ConfigParser::ParseCgiQueueTimeout(Location* location) {
+  location->SetCgiQueueTimeout(static_cast<int>(ParseBoundedNumber(
+      Tokenize(content), 1, kMaxCgiQueueTimeout, "cgi_queue_timeout")));
+  ConsumeExpectedSemicolon("cgi_queue_timeout");
+}
@@ -0,0 +1,36 @@
+#include "ConfigParser.hpp"
+
+namespace {
+
+const long kMaxCgiTimeout = 86400;
+
+}  // namespace
+
+/*
+cgi_read_timeout seconds; (10 by default)
+cgi_total_timeout seconds; (0, no limit, by default)
+A script that writes nothing for cgi_read_timeout seconds, or still runs
+cgi_total_timeout seconds after it was started, gets SIGTERM and, if it
+ignores that, SIGKILL (see CgiReaper.hpp). A client still waiting for the
+header block gets 504; a body already being sent is cut short.
+*/
+void ConfigParser::ParseCgiReadTimeout(Location* location) {
+  std::string token = Tokenize(content);
+  if (token.empty() || !IsAllDigits(token) || token.size() > 5 ||
+      std::atol(token.c_str()) < 1 ||
+      std::atol(token.c_str()) > kMaxCgiTimeout) {
+    throw std::runtime_error("Invalid cgi_read_timeout value: " + token);
+  }
+  location->SetCgiReadTimeout(std::atoi(token.c_str()));
+  ConsumeExpectedSemicolon("cgi_read_timeout");
+}
+
+void ConfigParser::ParseCgiTotalTimeout(Location* location) {
+  std::string token = Tokenize(content);
+  if (token.empty() || !IsAllDigits(token) || token.size() > 5 ||
+      std::atol(token.c_str()) > kMaxCgiTimeout) {
+    throw std::runtime_error("Invalid cgi_total_timeout value: " + token);
+  }
+  location->SetCgiTotalTimeout(std::atoi(token.c_str()));
+  ConsumeExpectedSemicolon("cgi_total_timeout");
+}
@@ -0,0 +1,57 @@
+#include "ConfigParser.hpp"
+
+namespace {
+
+const long kMaxGzipMinLength = 100000000;
+
+}  // namespace
+
+// gzip on|off; (off by default, see ServerConfig constructor)
+void ConfigParser::ParseGzip(ServerConfig* server_config) {
+  ParseSimpleDirective(server_config, &ServerConfig::SetGzip, "gzip value");
+}
+
+// gzip_types mime/type ...; text/html is always compressed
+void ConfigParser::ParseGzipTypes(ServerConfig* server_config) {
+  std::string token = Tokenize(content);
+  if (token.empty() || token == ";") {
+    throw std::runtime_error(
+        "Syntax error: expected gzip_types but got empty token or ;");
+  }
+  std::vector<std::string> types;
+  while (!token.empty() && token != ";") {
+    if (token != "*" && token.find('/') == std::string::npos) {
+      throw std::runtime_error("Invalid gzip_types value: " + token);
+    }
+    types.push_back(token);
+    token = Tokenize(content);
+  }
+  if (token.empty()) {
+    throw std::runtime_error("Expected ';' after gzip_types directive");
+  }
+  server_config->SetGzipTypes(types);
+}
+
+// gzip_min_length bytes; smaller bodies are sent as is
+void ConfigParser::ParseGzipMinLength(ServerConfig* server_config) {
+  std::string token = Tokenize(content);
+  if (token.empty() || !IsAllDigits(token)) {
+    throw std::runtime_error("Invalid gzip_min_length value: " + token);
+  }
+  long length = std::atol(token.c_str());
+  if (token.size() > 9 || length > kMaxGzipMinLength) {
+    throw std::runtime_error("Invalid gzip_min_length value: " + token);
+  }
+  server_config->SetGzipMinLength(static_cast<size_t>(length));
+  ConsumeExpectedSemicolon("gzip_min_length");
+}
+
+// gzip_comp_level 1..9; zlib trades CPU for ratio
+void ConfigParser::ParseGzipCompLevel(ServerConfig* server_config) {
+  std::string token = Tokenize(content);
+  if (token.size() != 1 || token[0] < '1' || token[0] > '9') {
+    throw std::runtime_error("Invalid gzip_comp_level value: " + token);
+  }
+  server_config->SetGzipCompLevel(token[0] - '0');
+  ConsumeExpectedSemicolon("gzip_comp_level");
+}
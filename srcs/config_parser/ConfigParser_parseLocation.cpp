@@ -44,6 +44,9 @@ void ConfigParser::ParseLocation(ServerConfig* server) {
       case kTokenAutoindex:
         ParseAutoIndex(&location);
         break;
+      case kTokenAutoindexFormat:
+        ParseAutoIndexFormat(&location);
+        break;
       case kTokenIndex:
         ParseIndex(&location);
         break;
@@ -59,6 +62,39 @@ void ConfigParser::ParseLocation(ServerConfig* server) {
       case kTokenCgiAllowedExtensions:
         ParseCgiAllowedExtensions(&location);
         break;
+      case kTokenCgiReadTimeout:
+        ParseCgiReadTimeout(&location);
+        break;
+      case kTokenCgiTotalTimeout:
+        ParseCgiTotalTimeout(&location);
+        break;
+      case kTokenCgiMaxConcurrent:
+        ParseCgiMaxConcurrent(&location);
+        break;
+      case kTokenCgiQueueSize:
+        ParseCgiQueueSize(&location);
+        break;
+      case kTokenCgiQueueTimeout:
+        ParseCgiQueueTimeout(&location);
+        break;
+      case kTokenCgiCache:
+        ParseCgiCache(&location);
+        break;
+      case kTokenCgiCacheKey:
+        ParseCgiCacheKey(&location);
+        break;
+      case kTokenGzipStatic:
+        ParseGzipStatic(&location);
+        break;
+      case kTokenBrotliStatic:
+        ParseBrotliStatic(&location);
+        break;
+      case kTokenStubStatus:
+        ParseStubStatus(&location);
+        break;
+      case kTokenInternal:
+        ParseInternal(&location);
+        break;
       default:
         throw std::runtime_error("Unknown directive in location: " + token);
     }
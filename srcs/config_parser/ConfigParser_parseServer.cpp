@@ -38,6 +38,36 @@ void ConfigParser::ParseServer() {
       case kTokenLocation:
         ParseLocation(&server_config);
         break;
+      case kTokenGzip:
+        ParseGzip(&server_config);
+        break;
+      case kTokenGzipTypes:
+        ParseGzipTypes(&server_config);
+        break;
+      case kTokenGzipMinLength:
+        ParseGzipMinLength(&server_config);
+        break;
+      case kTokenGzipCompLevel:
+        ParseGzipCompLevel(&server_config);
+        break;
+      case kTokenShutdownTimeout:
+        ParseShutdownTimeout(&server_config);
+        break;
+      case kTokenAccessLog:
+        ParseAccessLog(&server_config);
+        break;
+      case kTokenSlowLog:
+        ParseSlowLog(&server_config);
+        break;
+      case kTokenLogLevel:
+        ParseLogLevel(&server_config);
+        break;
+      case kTokenEventBackend:
+        ParseEventBackend(&server_config);
+        break;
+      case kTokenAioThreads:
+        ParseAioThreads(&server_config);
+        break;
       default:
         throw std::runtime_error("Unknown directive: " + token);
     }
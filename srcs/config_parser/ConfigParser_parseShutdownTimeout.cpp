@@ -0,0 +1,23 @@
+#include "ConfigParser.hpp"
+
+namespace {
+
+const long kMaxShutdownTimeout = 3600;
+
+}  // namespace
+
+/*
+shutdown_timeout seconds; (30 by default)
+How long SIGTERM/SIGQUIT and a binary upgrade wait for in-flight
+connections before closing them. The process uses the largest value among
+its server blocks.
+*/
+void ConfigParser::ParseShutdownTimeout(ServerConfig* server_config) {
+  std::string token = Tokenize(content);
+  if (token.empty() || !IsAllDigits(token) || token.size() > 4 ||
+      std::atol(token.c_str()) > kMaxShutdownTimeout) {
+    throw std::runtime_error("Invalid shutdown_timeout value: " + token);
+  }
+  server_config->SetShutdownTimeout(std::atoi(token.c_str()));
+  ConsumeExpectedSemicolon("shutdown_timeout");
+}
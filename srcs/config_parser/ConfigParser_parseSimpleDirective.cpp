@@ -9,7 +9,35 @@ void ConfigParser::ParseCgi(Location* location) {
   ParseSimpleDirective(location, &Location::SetCgiEnabled, "cgi value");
 }
 
+void ConfigParser::ParseGzipStatic(Location* location) {
+  ParseSimpleDirective(location, &Location::SetGzipStatic,
+                       "gzip_static value");
+}
+
+void ConfigParser::ParseBrotliStatic(Location* location) {
+  ParseSimpleDirective(location, &Location::SetBrotliStatic,
+                       "brotli_static value");
+}
+
+// internal; (no value): the location answers CGI internal redirects only
+void ConfigParser::ParseInternal(Location* location) {
+  ConsumeExpectedSemicolon("internal");
+  location->SetInternal();
+}
+
 void ConfigParser::ParseServerName(ServerConfig* server_config) {
   ParseSimpleDirective(server_config, &ServerConfig::SetServerName,
                        "server_name value");
 }
+
+// log_level debug|info|warn|error; (info by default)
+void ConfigParser::ParseLogLevel(ServerConfig* server_config) {
+  ParseSimpleDirective(server_config, &ServerConfig::SetLogLevel,
+                       "log_level value");
+}
+
+// event_backend epoll|io_uring; (epoll by default)
+void ConfigParser::ParseEventBackend(ServerConfig* server_config) {
+  ParseSimpleDirective(server_config, &ServerConfig::SetEventBackend,
+                       "event_backend value");
+}
@@ -0,0 +1,59 @@
+#include <cstdlib>
+
+#include "ConfigParser.hpp"
+
+namespace {
+
+const long kMaxThresholdMs = 3600000;
+const long kMaxSampleRate = 1000000;
+const size_t kMaxDigits = 7;
+const std::string kSamplePrefix = "sample=";
+
+long ParseBoundedNumber(const std::string& token, long max,
+                        const std::string& what) {
+  if (token.empty() || token.size() > kMaxDigits ||
+      token.find_first_not_of("0123456789") != std::string::npos ||
+      std::atol(token.c_str()) > max) {
+    throw std::runtime_error("Invalid slow_log " + what + ": " + token);
+  }
+  return std::atol(token.c_str());
+}
+
+}  // namespace
+
+/*
+slow_log off;
+slow_log path threshold_ms [sample=N];
+
+Requests taking at least threshold_ms from their first byte until the last
+response byte are written to path as JSON lines with their phase spans
+(see trace/Trace.hpp). With sample=N, one request in N is also logged with
+every phase timestamp, however fast it was.
+*/
+void ConfigParser::ParseSlowLog(ServerConfig* server_config) {
+  std::string path = Tokenize(content);
+  if (path.empty() || path == ";" || path == "{" || path == "}") {
+    throw std::runtime_error("Syntax error: expected slow_log path");
+  }
+  if (path == "off") {
+    ConsumeExpectedSemicolon("slow_log");
+    server_config->SetSlowLog("", 0, 0);
+    return;
+  }
+  const long threshold =
+      ParseBoundedNumber(Tokenize(content), kMaxThresholdMs, "threshold");
+  long sample = 0;
+  std::string token = Tokenize(content);
+  if (token.compare(0, kSamplePrefix.size(), kSamplePrefix) == 0) {
+    sample = ParseBoundedNumber(token.substr(kSamplePrefix.size()),
+                                kMaxSampleRate, "sample rate");
+    token = Tokenize(content);
+  }
+  if (token != ";") {
+    throw std::runtime_error("Expected ';' after slow_log directive");
+  }
+  std::string resolved = ResolveRootPath(path);
+  RequireAbsoluteSafePathOrThrow(resolved, "slow_log path");
+  server_config->SetSlowLog(resolved, static_cast<uint64_t>(threshold),
+                            static_cast<size_t>(sample));
+}
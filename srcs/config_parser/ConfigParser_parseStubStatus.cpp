@@ -0,0 +1,15 @@
+#include "ConfigParser.hpp"
+
+// stub_status [text|prometheus]; (text, the nginx layout, when omitted)
+void ConfigParser::ParseStubStatus(Location* location) {
+  std::string token = Tokenize(content);
+  if (token.empty()) {
+    throw std::runtime_error("Syntax error: expected stub_status value");
+  }
+  if (token == ";") {
+    location->SetStubStatus("text");
+    return;
+  }
+  location->SetStubStatus(token);
+  ConsumeExpectedSemicolon("stub_status");
+}
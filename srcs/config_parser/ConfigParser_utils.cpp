@@ -13,16 +13,46 @@ std::map<std::string, TokenType> CreateTokenTable() {
   m.insert(std::make_pair(config_tokens::kMaxBody, kTokenMaxBody));
   m.insert(std::make_pair(config_tokens::kErrorPage, kTokenErrorPage));
   m.insert(std::make_pair(config_tokens::kLocation, kTokenLocation));
+  m.insert(std::make_pair(config_tokens::kGzip, kTokenGzip));
+  m.insert(std::make_pair(config_tokens::kGzipTypes, kTokenGzipTypes));
+  m.insert(
+      std::make_pair(config_tokens::kGzipMinLength, kTokenGzipMinLength));
+  m.insert(
+      std::make_pair(config_tokens::kGzipCompLevel, kTokenGzipCompLevel));
+  m.insert(
+      std::make_pair(config_tokens::kShutdownTimeout, kTokenShutdownTimeout));
+  m.insert(std::make_pair(config_tokens::kAccessLog, kTokenAccessLog));
+  m.insert(std::make_pair(config_tokens::kSlowLog, kTokenSlowLog));
+  m.insert(std::make_pair(config_tokens::kLogLevel, kTokenLogLevel));
+  m.insert(std::make_pair(config_tokens::kEventBackend, kTokenEventBackend));
+  m.insert(std::make_pair(config_tokens::kAioThreads, kTokenAioThreads));
   m.insert(
       std::make_pair(config_tokens::kAllowedMethods, kTokenAllowedMethods));
   m.insert(std::make_pair(config_tokens::kRoot, kTokenRoot));
   m.insert(std::make_pair(config_tokens::kAutoIndex, kTokenAutoindex));
+  m.insert(
+      std::make_pair(config_tokens::kAutoIndexFormat, kTokenAutoindexFormat));
   m.insert(std::make_pair(config_tokens::kIndex, kTokenIndex));
   m.insert(std::make_pair(config_tokens::kUploadPath, kTokenUploadPath));
   m.insert(std::make_pair(config_tokens::kRedirect, kTokenRedirect));
   m.insert(std::make_pair(config_tokens::kCgi, kTokenCgi));
   m.insert(std::make_pair(config_tokens::kCgiAllowedExtensions,
                           kTokenCgiAllowedExtensions));
+  m.insert(
+      std::make_pair(config_tokens::kCgiReadTimeout, kTokenCgiReadTimeout));
+  m.insert(
+      std::make_pair(config_tokens::kCgiTotalTimeout, kTokenCgiTotalTimeout));
+  m.insert(std::make_pair(config_tokens::kCgiMaxConcurrent,
+                          kTokenCgiMaxConcurrent));
+  m.insert(std::make_pair(config_tokens::kCgiQueueSize, kTokenCgiQueueSize));
+  m.insert(
+      std::make_pair(config_tokens::kCgiQueueTimeout, kTokenCgiQueueTimeout));
+  m.insert(std::make_pair(config_tokens::kCgiCache, kTokenCgiCache));
+  m.insert(std::make_pair(config_tokens::kCgiCacheKey, kTokenCgiCacheKey));
+  m.insert(std::make_pair(config_tokens::kGzipStatic, kTokenGzipStatic));
+  m.insert(std::make_pair(config_tokens::kInternal, kTokenInternal));
+  m.insert(std::make_pair(config_tokens::kBrotliStatic, kTokenBrotliStatic));
+  m.insert(std::make_pair(config_tokens::kStubStatus, kTokenStubStatus));
   return m;
 }
 
@@ -0,0 +1,70 @@
+#include "event/EpollPoller.hpp"
+
+#include <sys/epoll.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "lib/utils/time_utils.hpp"
+
+namespace event {
+
+EpollPoller::EpollPoller() : epoll_fd_(epoll_create1(EPOLL_CLOEXEC)) {
+  if (epoll_fd_.GetFd() == -1) {
+    throw std::runtime_error("epoll_create() failed. " +
+                             std::string(strerror(errno)));
+  }
+}
+
+EpollPoller::~EpollPoller() {
+}
+
+int EpollPoller::Add(int fd, uint32_t events, void* data) {
+  return Control(EPOLL_CTL_ADD, fd, events, data);
+}
+
+int EpollPoller::Modify(int fd, uint32_t events, void* data) {
+  return Control(EPOLL_CTL_MOD, fd, events, data);
+}
+
+int EpollPoller::Remove(int fd) {
+  return epoll_ctl(epoll_fd_.GetFd(), EPOLL_CTL_DEL, fd, NULL);
+}
+
+int EpollPoller::Wait(Event* events, int max_events, int timeout_ms) {
+  if (ready_.size() < static_cast<size_t>(max_events)) {
+    ready_.resize(max_events);
+  }
+  const uint64_t deadline_us =
+      lib::utils::MonotonicMicros() + static_cast<uint64_t>(timeout_ms) * 1000;
+  int n;
+  int wait_ms = timeout_ms;
+  while ((n = epoll_wait(epoll_fd_.GetFd(), &ready_[0], max_events,
+                         wait_ms)) == -1 &&
+         errno == EINTR) {
+    if (timeout_ms < 0) continue;
+    const uint64_t now_us = lib::utils::MonotonicMicros();
+    if (now_us >= deadline_us) return 0;
+    wait_ms = static_cast<int>((deadline_us - now_us + 999) / 1000);
+  }
+  for (int i = 0; i < n; ++i) {
+    events[i].data = ready_[i].data.ptr;
+    events[i].events = ready_[i].events;
+  }
+  return n;
+}
+
+Backend EpollPoller::GetBackend() const {
+  return kBackendEpoll;
+}
+
+int EpollPoller::Control(int op, int fd, uint32_t events, void* data) {
+  epoll_event ev;
+  ev.events = events;
+  ev.data.ptr = data;
+  return epoll_ctl(epoll_fd_.GetFd(), op, fd, &ev);
+}
+
+}  // namespace event
@@ -0,0 +1,42 @@
+#include "event/Poller.hpp"
+
+#include <sys/socket.h>
+
+#include <stdexcept>
+
+#include "event/EpollPoller.hpp"
+#include "event/UringPoller.hpp"
+#include "lib/logging/Logging.hpp"
+
+namespace event {
+
+Backend ParseBackend(const std::string& name) {
+  if (name == "epoll") return kBackendEpoll;
+  if (name == "io_uring") return kBackendIoUring;
+  throw std::runtime_error("Unknown event backend: " + name);
+}
+
+const char* BackendToString(Backend backend) {
+  return backend == kBackendIoUring ? "io_uring" : "epoll";
+}
+
+int Poller::Accept(int fd, sockaddr* addr, socklen_t* addr_len) {
+  return accept4(fd, addr, addr_len, SOCK_CLOEXEC);
+}
+
+ssize_t Poller::Receive(int fd, char* buf, size_t len) {
+  return recv(fd, buf, len, 0);
+}
+
+Poller* Poller::Create(Backend backend) {
+  if (backend == kBackendIoUring) {
+    try {
+      return new UringPoller();
+    } catch (const std::exception& e) {
+      WEBSERV_LOG(kWarn) << e.what() << "; falling back to epoll" << std::endl;
+    }
+  }
+  return new EpollPoller();
+}
+
+}  // namespace event
@@ -0,0 +1,641 @@
+#include "event/UringPoller.hpp"
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "lib/utils/time_utils.hpp"
+
+namespace event {
+
+namespace {
+
+const uint32_t kFdMask = 0x3fffffffu;
+const uint16_t kBufferGroup = 0;
+
+uint64_t UserData(int fd, uint32_t generation, unsigned kind) {
+  return (static_cast<uint64_t>(generation) << 32) | (kind << 30) |
+         (static_cast<uint32_t>(fd) & kFdMask);
+}
+
+int SetupRing(io_uring_params* params) {
+  // one thread submits and reaps: let completions run only when we wait
+  std::memset(params, 0, sizeof(*params));
+  params->flags = IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+  int fd = syscall(__NR_io_uring_setup, UringPoller::kRingEntries, params);
+  if (fd == -1 && errno == EINVAL) {  // before 6.1
+    std::memset(params, 0, sizeof(*params));
+    fd = syscall(__NR_io_uring_setup, UringPoller::kRingEntries, params);
+  }
+  return fd;
+}
+
+void* MapRing(int fd, size_t size, off_t offset) {
+  void* p = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, fd, offset);
+  if (p == MAP_FAILED) {
+    throw std::runtime_error("io_uring mmap() failed. " +
+                             std::string(strerror(errno)));
+  }
+  return p;
+}
+
+}  // namespace
+
+const unsigned UringPoller::kRingEntries;
+const unsigned UringPoller::kRecvBuffers;
+const size_t UringPoller::kRecvBufferSize;
+const size_t UringPoller::kMaxReceived;
+const size_t UringPoller::kMaxAccepted;
+
+UringPoller::Watch::Watch()
+    : data(NULL),
+      events(0),
+      generation(0),
+      used(false),
+      armed(false),
+      input(kPoll),
+      owner(0),
+      input_armed(false),
+      cancel_queued(false),
+      input_eof(false),
+      input_error(0),
+      received_offset(0),
+      listed(false),
+      batch(0),
+      slot(0) {
+}
+
+UringPoller::UringPoller()
+    : ring_fd_(),
+      sq_ring_(NULL),
+      sq_ring_size_(0),
+      cq_ring_(NULL),
+      cq_ring_size_(0),
+      sqes_(NULL),
+      sqes_size_(0),
+      sq_head_(NULL),
+      sq_tail_(NULL),
+      sq_mask_(0),
+      sq_entries_(0),
+      cq_head_(NULL),
+      cq_tail_(NULL),
+      cq_mask_(0),
+      cqes_(NULL),
+      local_sq_tail_(0),
+      buf_ring_(NULL),
+      recv_buffers_(NULL),
+      multishot_accept_(true),
+      multishot_recv_(false),
+      next_generation_(1),
+      batch_(0) {
+  io_uring_params params;
+  int fd = SetupRing(&params);
+  if (fd == -1) {
+    throw std::runtime_error("io_uring_setup() failed. " +
+                             std::string(strerror(errno)));
+  }
+  ring_fd_.Reset(fd);
+  if (!(params.features & IORING_FEAT_EXT_ARG) ||
+      !(params.features & IORING_FEAT_NODROP)) {
+    throw std::runtime_error("io_uring: kernel too old (needs 5.11)");
+  }
+  try {
+    MapRings(params);
+  } catch (...) {
+    UnmapRings();
+    throw;
+  }
+  SetUpBufferRing();
+}
+
+// the ring goes first: no request writes into the buffers after that
+UringPoller::~UringPoller() {
+  for (size_t fd = 0; fd < watches_.size(); ++fd) ResetInput(&watches_[fd]);
+  ring_fd_.Reset();
+  UnmapRings();
+  if (buf_ring_) munmap(buf_ring_, kRecvBuffers * sizeof(io_uring_buf));
+  if (recv_buffers_) munmap(recv_buffers_, kRecvBuffers * kRecvBufferSize);
+}
+
+void UringPoller::MapRings(const io_uring_params& params) {
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ =
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap) {
+    if (cq_ring_size_ > sq_ring_size_) sq_ring_size_ = cq_ring_size_;
+    cq_ring_size_ = sq_ring_size_;
+  }
+  sq_ring_ = MapRing(ring_fd_.GetFd(), sq_ring_size_, IORING_OFF_SQ_RING);
+  cq_ring_ = single_mmap ? sq_ring_
+                         : MapRing(ring_fd_.GetFd(), cq_ring_size_,
+                                   IORING_OFF_CQ_RING);
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  sqes_ = static_cast<io_uring_sqe*>(
+      MapRing(ring_fd_.GetFd(), sqes_size_, IORING_OFF_SQES));
+
+  char* sq = static_cast<char*>(sq_ring_);
+  sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+  sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+  sq_entries_ = params.sq_entries;
+  // SQE i always sits in slot i
+  unsigned* array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+  for (unsigned i = 0; i < sq_entries_; ++i) array[i] = i;
+  local_sq_tail_ = *sq_tail_;
+
+  char* cq = static_cast<char*>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+  cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+}
+
+void UringPoller::UnmapRings() {
+  if (sqes_) munmap(sqes_, sqes_size_);
+  if (cq_ring_ && cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_size_);
+  if (sq_ring_) munmap(sq_ring_, sq_ring_size_);
+  sqes_ = NULL;
+  cq_ring_ = NULL;
+  sq_ring_ = NULL;
+}
+
+// without a buffer ring (before 5.19, or no memory) recv stays on readiness
+void UringPoller::SetUpBufferRing() {
+  const size_t ring_size = kRecvBuffers * sizeof(io_uring_buf);
+  const size_t buffers_size = kRecvBuffers * kRecvBufferSize;
+  void* ring = mmap(NULL, ring_size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  void* buffers = mmap(NULL, buffers_size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  io_uring_buf_reg reg;
+  std::memset(&reg, 0, sizeof(reg));
+  reg.ring_addr = reinterpret_cast<uintptr_t>(ring);
+  reg.ring_entries = kRecvBuffers;
+  reg.bgid = kBufferGroup;
+  if (ring == MAP_FAILED || buffers == MAP_FAILED ||
+      syscall(__NR_io_uring_register, ring_fd_.GetFd(),
+              IORING_REGISTER_PBUF_RING, &reg, 1) == -1) {
+    if (ring != MAP_FAILED) munmap(ring, ring_size);
+    if (buffers != MAP_FAILED) munmap(buffers, buffers_size);
+    return;
+  }
+  buf_ring_ = static_cast<io_uring_buf_ring*>(ring);
+  recv_buffers_ = static_cast<char*>(buffers);
+  for (unsigned bid = 0; bid < kRecvBuffers; ++bid) RecycleBuffer(bid);
+  multishot_recv_ = true;
+}
+
+// hands buffer bid back to the kernel; only this thread moves the tail. The
+// ring is an array of io_uring_buf, the tail sharing the first one's
+// reserved field: C++ sees io_uring_buf_ring::bufs 8 bytes too far (the
+// header's flexible array becomes a member after an empty struct)
+void UringPoller::RecycleBuffer(uint16_t bid) {
+  const uint16_t tail = buf_ring_->tail;
+  io_uring_buf* bufs = reinterpret_cast<io_uring_buf*>(buf_ring_);
+  io_uring_buf& buf = bufs[tail & (kRecvBuffers - 1)];
+  buf.addr = reinterpret_cast<uintptr_t>(recv_buffers_ + bid * kRecvBufferSize);
+  buf.len = kRecvBufferSize;
+  buf.bid = bid;
+  __atomic_store_n(&buf_ring_->tail, static_cast<uint16_t>(tail + 1),
+                   __ATOMIC_RELEASE);
+}
+
+int UringPoller::Add(int fd, uint32_t events, void* data) {
+  if (fd < 0 || static_cast<uint32_t>(fd) > kFdMask) {
+    errno = EBADF;
+    return -1;
+  }
+  if (static_cast<size_t>(fd) >= watches_.size()) watches_.resize(fd + 1);
+  Watch& watch = watches_[fd];
+  if (watch.used) {
+    errno = EEXIST;
+    return -1;
+  }
+  watch.data = data;
+  watch.events = events;
+  watch.generation = next_generation_++;
+  if (next_generation_ == 0) next_generation_ = 1;
+  watch.used = true;
+  watch.armed = false;
+  watch.owner = watch.generation;
+  to_arm_.push_back(fd);
+  return 0;
+}
+
+// a poll in flight with the old mask is cancelled and replaced; a
+// multishot request keeps going, its input is only reported with kReadable
+int UringPoller::Modify(int fd, uint32_t events, void* data) {
+  Watch* watch = FindWatch(fd);
+  if (!watch) return -1;
+  watch->data = data;
+  if (watch->events == events) return 0;
+  watch->events = events;
+  if (watch->armed) Disarm(fd, watch);
+  to_arm_.push_back(fd);
+  return 0;
+}
+
+int UringPoller::Remove(int fd) {
+  Watch* watch = FindWatch(fd);
+  if (!watch) return -1;
+  const bool in_kernel = watch->armed || watch->input_armed;
+  if (watch->armed) Disarm(fd, watch);
+  if (watch->input_armed) CancelInput(fd, watch);
+  ResetInput(watch);
+  watch->used = false;
+  if (in_kernel) {
+    // run the cancellations now (task work included): the caller closes
+    // the descriptor next, and the requests keep the file open until then
+    Flush();
+    Enter(0, IORING_ENTER_GETEVENTS, NULL, 0);
+  }
+  return 0;
+}
+
+// the plain syscall opts the listener into multishot accept
+int UringPoller::Accept(int fd, sockaddr* addr, socklen_t* addr_len) {
+  Watch* watch = FindWatch(fd);
+  if (!watch || watch->input == kPoll) {
+    if (watch && multishot_accept_) {
+      watch->input = kAccept;
+      if (watch->armed) Disarm(fd, watch);
+      to_arm_.push_back(fd);
+    }
+    return Poller::Accept(fd, addr, addr_len);
+  }
+  if (watch->accepted.empty()) {
+    if (watch->input_error != 0) {
+      errno = watch->input_error;
+      watch->input_error = 0;
+      InputTaken(fd, watch);
+      return -1;
+    }
+    errno = EAGAIN;
+    return -1;
+  }
+  const int client = watch->accepted.front();
+  watch->accepted.pop_front();
+  InputTaken(fd, watch);
+  if (addr && getpeername(client, addr, addr_len) == -1) {
+    std::memset(addr, 0, *addr_len);
+  }
+  return client;
+}
+
+// what arrived first, then the plain syscall, which opts the socket into
+// multishot recv
+ssize_t UringPoller::Receive(int fd, char* buf, size_t len) {
+  Watch* watch = FindWatch(fd);
+  if (!watch) return Poller::Receive(fd, buf, len);
+  const size_t pending = watch->received.size() - watch->received_offset;
+  if (pending > 0) {
+    const size_t n = std::min(len, pending);
+    std::memcpy(buf, watch->received.data() + watch->received_offset, n);
+    watch->received_offset += n;
+    if (watch->received_offset == watch->received.size()) {
+      watch->received.clear();
+      watch->received_offset = 0;
+    }
+    InputTaken(fd, watch);
+    return static_cast<ssize_t>(n);
+  }
+  if (watch->input == kPoll) {
+    if (multishot_recv_) {
+      watch->input = kRecv;
+      if (watch->armed) Disarm(fd, watch);
+      to_arm_.push_back(fd);
+    }
+    return Poller::Receive(fd, buf, len);
+  }
+  if (watch->input_eof) return 0;
+  if (watch->input_error != 0) {
+    errno = watch->input_error;
+    watch->input_error = 0;
+    InputTaken(fd, watch);
+    return -1;
+  }
+  errno = EAGAIN;
+  return -1;
+}
+
+UringPoller::Watch* UringPoller::FindWatch(int fd) {
+  if (fd < 0 || static_cast<size_t>(fd) >= watches_.size() ||
+      !watches_[fd].used) {
+    errno = ENOENT;
+    return NULL;
+  }
+  return &watches_[fd];
+}
+
+void UringPoller::Disarm(int fd, Watch* watch) {
+  to_cancel_.push_back(UserData(fd, watch->generation, kPoll));
+  watch->generation = next_generation_++;
+  if (next_generation_ == 0) next_generation_ = 1;
+  watch->armed = false;
+}
+
+// the request stays armed until its last completion comes in; a running
+// one can miss the cancellation and is cancelled again on its next result
+void UringPoller::CancelInput(int fd, Watch* watch) {
+  if (watch->cancel_queued) return;
+  to_cancel_.push_back(UserData(fd, watch->owner, watch->input));
+  watch->cancel_queued = true;
+}
+
+// drops what was not taken; a request still in the kernel turns stale
+void UringPoller::ResetInput(Watch* watch) {
+  for (size_t i = 0; i < watch->accepted.size(); ++i) {
+    close(watch->accepted[i]);
+  }
+  watch->accepted.clear();
+  watch->received.clear();
+  watch->received_offset = 0;
+  watch->input = kPoll;
+  watch->input_armed = false;
+  watch->cancel_queued = false;
+  watch->input_eof = false;
+  watch->input_error = 0;
+}
+
+bool UringPoller::WantsInput(const Watch& watch) const {
+  return watch.input != kPoll && !watch.input_eof && watch.input_error == 0 &&
+         watch.received.size() - watch.received_offset < kMaxReceived &&
+         watch.accepted.size() < kMaxAccepted;
+}
+
+bool UringPoller::HasInput(const Watch& watch) const {
+  return watch.received_offset < watch.received.size() ||
+         !watch.accepted.empty() || watch.input_eof || watch.input_error != 0;
+}
+
+// a request cancelled because the socket fell behind is armed again
+void UringPoller::InputTaken(int fd, Watch* watch) {
+  if (!watch->input_armed && WantsInput(*watch)) to_arm_.push_back(fd);
+}
+
+// cancelled and stale polls complete too: those wake the wait up without
+// anything to report, so it goes on until the timeout
+int UringPoller::Wait(Event* events, int max_events, int timeout_ms) {
+  const uint64_t deadline_us =
+      lib::utils::MonotonicMicros() + static_cast<uint64_t>(timeout_ms) * 1000;
+  for (;;) {
+    Flush();  // Harvest() re-arms multishot requests that ended quietly
+    if (HasCompletions() || HasReadyInput()) {
+      if (Enter(0, 0, NULL, 0) == -1 && errno != EINTR) return -1;
+    } else {
+      io_uring_getevents_arg arg;
+      std::memset(&arg, 0, sizeof(arg));
+      __kernel_timespec ts;
+      if (timeout_ms >= 0) {
+        const uint64_t now_us = lib::utils::MonotonicMicros();
+        const uint64_t left_us =
+            now_us < deadline_us ? deadline_us - now_us : 0;
+        ts.tv_sec = left_us / 1000000;
+        ts.tv_nsec = (left_us % 1000000) * 1000;
+        arg.ts = reinterpret_cast<uintptr_t>(&ts);
+      }
+      if (Enter(1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg,
+                sizeof(arg)) == -1) {
+        if (errno == ETIME) return 0;
+        if (errno != EINTR) return -1;
+      }
+    }
+    const int n = Harvest(events, max_events);
+    if (n > 0) return n;
+    if (timeout_ms >= 0 && lib::utils::MonotonicMicros() >= deadline_us) {
+      return 0;
+    }
+  }
+}
+
+Backend UringPoller::GetBackend() const {
+  return kBackendIoUring;
+}
+
+// writes the queued requests into the SQ; what does not fit waits for the
+// next call
+void UringPoller::Flush() {
+  size_t cancelled = 0;
+  for (; cancelled < to_cancel_.size(); ++cancelled) {
+    io_uring_sqe* sqe = NextSqe();
+    if (!sqe) break;
+    const uint64_t user_data = to_cancel_[cancelled];
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = user_data;
+    sqe->user_data = UserData(0, 0, kPoll);
+    const size_t fd = user_data & kFdMask;
+    if (((user_data >> 30) & 3) != kPoll && fd < watches_.size()) {
+      watches_[fd].cancel_queued = false;
+    }
+  }
+  to_cancel_.erase(to_cancel_.begin(), to_cancel_.begin() + cancelled);
+
+  size_t armed = 0;
+  while (armed < to_arm_.size() && Arm(to_arm_[armed])) ++armed;
+  to_arm_.erase(to_arm_.begin(), to_arm_.begin() + armed);
+}
+
+// queues what the watch lacks: a poll for the events that no multishot
+// request covers, and the multishot request; false when the SQ is full
+bool UringPoller::Arm(int fd) {
+  Watch& watch = watches_[fd];
+  if (!watch.used) return true;
+  const bool by_input = watch.input != kPoll && (watch.events & kReadable);
+  const uint32_t poll_events =
+      by_input ? watch.events & ~kReadable : watch.events;
+  if (!watch.armed && (!by_input || poll_events != 0)) {
+    io_uring_sqe* sqe = NextSqe();
+    if (!sqe) return false;
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = poll_events;
+    sqe->user_data = UserData(fd, watch.generation, kPoll);
+    watch.armed = true;
+  }
+  if (!watch.input_armed && WantsInput(watch)) {
+    io_uring_sqe* sqe = NextSqe();
+    if (!sqe) return false;
+    sqe->fd = fd;
+    if (watch.input == kAccept) {
+      sqe->opcode = IORING_OP_ACCEPT;
+      sqe->accept_flags = SOCK_CLOEXEC;
+      sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    } else {
+      sqe->opcode = IORING_OP_RECV;
+      sqe->flags = IOSQE_BUFFER_SELECT;
+      sqe->buf_group = kBufferGroup;
+      sqe->ioprio = IORING_RECV_MULTISHOT;
+    }
+    sqe->user_data = UserData(fd, watch.owner, watch.input);
+    watch.input_armed = true;
+  }
+  return true;
+}
+
+// submits what is pending when the SQ is full
+io_uring_sqe* UringPoller::NextSqe() {
+  if (local_sq_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >=
+      sq_entries_) {
+    Enter(0, 0, NULL, 0);
+    if (local_sq_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >=
+        sq_entries_) {
+      return NULL;
+    }
+  }
+  io_uring_sqe* sqe = &sqes_[local_sq_tail_ & sq_mask_];
+  std::memset(sqe, 0, sizeof(*sqe));
+  ++local_sq_tail_;
+  return sqe;
+}
+
+// publishes the written SQEs and submits them, waiting for min_complete
+// completions when asked; the kernel's SQ head tells what it consumed
+int UringPoller::Enter(unsigned min_complete, unsigned flags, void* arg,
+                       size_t size) {
+  __atomic_store_n(sq_tail_, local_sq_tail_, __ATOMIC_RELEASE);
+  const unsigned to_submit =
+      local_sq_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  if (to_submit == 0 && !(flags & IORING_ENTER_GETEVENTS)) return 0;
+  long ret = syscall(__NR_io_uring_enter, ring_fd_.GetFd(), to_submit,
+                     min_complete, flags, arg, size);
+  return ret < 0 ? -1 : 0;
+}
+
+bool UringPoller::HasCompletions() const {
+  return *cq_head_ != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+}
+
+bool UringPoller::HasReadyInput() const {
+  for (size_t i = 0; i < ready_.size(); ++i) {
+    const Watch& watch = watches_[ready_[i]];
+    if (watch.used && (watch.events & kReadable) && HasInput(watch)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// polls report as they complete; input is gathered into the watches first
+// and reported once per descriptor, merged with its poll's bits
+int UringPoller::Harvest(Event* events, int max_events) {
+  ++batch_;
+  unsigned head = *cq_head_;
+  const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  int n = 0;
+  while (head != tail && n < max_events) {
+    const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+    ++head;
+    const uint32_t generation = static_cast<uint32_t>(cqe.user_data >> 32);
+    const int fd = static_cast<int>(cqe.user_data & kFdMask);
+    const Kind kind = static_cast<Kind>((cqe.user_data >> 30) & 3);
+    if (kind != kPoll) {
+      Complete(cqe);
+      continue;
+    }
+    if (generation == 0) continue;  // a cancellation
+    if (static_cast<size_t>(fd) >= watches_.size()) continue;
+    Watch& watch = watches_[fd];
+    if (!watch.used || watch.generation != generation) continue;  // stale
+    watch.armed = false;
+    to_arm_.push_back(fd);
+    Report(fd, cqe.res < 0 ? kError | kHangup : static_cast<uint32_t>(cqe.res),
+           events, max_events, &n);
+  }
+  __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+
+  size_t kept = 0;
+  for (size_t i = 0; i < ready_.size(); ++i) {
+    const int fd = ready_[i];
+    Watch& watch = watches_[fd];
+    if (!watch.used || !HasInput(watch)) {
+      watch.listed = false;
+      continue;
+    }
+    ready_[kept++] = fd;
+    if (watch.events & kReadable) Report(fd, kReadable, events, max_events, &n);
+  }
+  ready_.resize(kept);
+  return n;
+}
+
+// a multishot accept or recv completion; stale ones only give back what
+// they hold
+void UringPoller::Complete(const io_uring_cqe& cqe) {
+  const uint32_t generation = static_cast<uint32_t>(cqe.user_data >> 32);
+  const int fd = static_cast<int>(cqe.user_data & kFdMask);
+  Watch* watch = NULL;
+  if (static_cast<size_t>(fd) < watches_.size() && watches_[fd].used &&
+      watches_[fd].owner == generation) {
+    watch = &watches_[fd];
+  }
+  if (cqe.flags & IORING_CQE_F_BUFFER) {
+    const uint16_t bid = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+    if (watch && cqe.res > 0) {
+      watch->received.append(recv_buffers_ + bid * kRecvBufferSize, cqe.res);
+    }
+    RecycleBuffer(bid);
+  } else if (((cqe.user_data >> 30) & 3) == kAccept && cqe.res >= 0) {
+    if (watch) {
+      watch->accepted.push_back(cqe.res);
+    } else {
+      close(cqe.res);
+    }
+  }
+  if (watch) CompleteInput(fd, watch, cqe);
+}
+
+void UringPoller::CompleteInput(int fd, Watch* watch,
+                                const io_uring_cqe& cqe) {
+  if (cqe.res == 0 && watch->input == kRecv) {
+    watch->input_eof = true;
+  } else if (cqe.res == -EINVAL) {  // no multishot in this kernel
+    if (watch->input == kAccept) multishot_accept_ = false;
+    if (watch->input == kRecv) multishot_recv_ = false;
+    watch->input = kPoll;
+    if (watch->armed) Disarm(fd, watch);  // its mask lacks kReadable
+    to_arm_.push_back(fd);
+  } else if (cqe.res < 0 && cqe.res != -ECANCELED && cqe.res != -ENOBUFS) {
+    watch->input_error = -cqe.res;
+  }
+  if (!(cqe.flags & IORING_CQE_F_MORE)) {
+    watch->input_armed = false;
+    watch->cancel_queued = false;
+    InputTaken(fd, watch);  // ended on its own, or out of buffers
+  } else if (!WantsInput(*watch) && !watch->input_eof &&
+             watch->input_error == 0) {
+    CancelInput(fd, watch);  // the socket is behind
+  }
+  if (HasInput(*watch) && !watch->listed) {
+    watch->listed = true;
+    ready_.push_back(fd);
+  }
+}
+
+// one event per descriptor and Harvest(): a second one could reach a
+// socket the first one deleted
+void UringPoller::Report(int fd, uint32_t bits, Event* events,
+                         int max_events, int* n) {
+  Watch& watch = watches_[fd];
+  if (watch.batch == batch_) {
+    events[watch.slot].events |= bits;
+  } else if (*n < max_events) {
+    watch.batch = batch_;
+    watch.slot = *n;
+    events[*n].data = watch.data;
+    events[*n].events = bits;
+    ++*n;
+  }
+}
+
+}  // namespace event
@@ -21,7 +21,7 @@ static const bool kEnableChunkDebugLogging = false;
  * @post
  *  - body_: appended with newly parsed body data
  *  - state_: updated to kDone if finished
- *  - buffer_: updated to remove consumed data
+ *  - buffer_read_pos_: moved past consumed data
  */
 // TODO: maybe I should not throw bad request for extensions(trailing section)
 // but just ignore them. For now, we just throw bad request for simplicity.
@@ -51,6 +51,10 @@ ValidateBodyHeaders in ConsumeBodyHeaders ensures the following conditions:
 */
 bool HttpRequest::AdvanceBody() {
   try {
+    // content_length_ >= 0 already rules out Transfer-Encoding (see above)
+    if (content_length_ > 0) {
+      return AdvanceContentLengthBody();
+    }
     const bool has_transfer_encoding = headers_.count("transfer-encoding");
     if (content_length_ == 0 && !has_transfer_encoding) {
       state_ = kDone;
@@ -69,124 +73,78 @@ bool HttpRequest::AdvanceBody() {
   }
 }
 
-// content length mode
+// content length mode: bytes are moved to body_ as they arrive
 bool HttpRequest::AdvanceContentLengthBody() {
   const size_t need = static_cast<size_t>(content_length_);
   if (need > max_body_size_limit_) {
     throw lib::exception::ResponseStatusException(lib::http::kPayloadTooLarge);
   }
-  if (need == 0) {
-    state_ = kDone;
-    return true;
-  }
-  if (buffer_.size() < need) {
+  const size_t missing = need - body_.Size();
+  AppendBody(UnreadSize() < missing ? UnreadSize() : missing);
+  if (body_.Size() < need) {
     return false;
   }
-  body_.assign(buffer_.data(), need);
-  buffer_.erase(0, need);  // erase consumed data
   state_ = kDone;
   return true;
 }
 
 // chunked transfer encoding: "size\r\n<data>\r\n ... 0\r\n\r\n"
+// payload bytes are moved to body_ as soon as they arrive, even before the
+// rest of their chunk, so buffer_ never holds more than one read
 // return false if need more data
 bool HttpRequest::AdvanceChunkedBody() {
-  if (kEnableChunkDebugLogging) {
-    std::cerr << "[DEBUG chunk] enter AdvanceChunkedBody"
-              << " state=" << state_ << " buffer_size=" << buffer_.size()
-              << " read_pos=" << buffer_read_pos_
-              << " next_chunk_size=" << next_chunk_size_ << std::endl;
-  }
-
-  if (buffer_read_pos_ > buffer_.size()) {
-    throw lib::exception::ResponseStatusException(
-        lib::http::kInternalServerError);  // should not happen
-  }
-  if (buffer_read_pos_ == buffer_.size()) {
-    if (kEnableChunkDebugLogging) {
-      std::cerr << "[DEBUG chunk] no more buffered data, need more"
-                << std::endl;
-    }
-    return false;  // parsed all available data, need more
-  }
   for (;;) {
     if (kEnableChunkDebugLogging) {
       std::cerr << "[DEBUG chunk] loop begin"
+                << " chunk_state=" << chunk_state_
                 << " read_pos=" << buffer_read_pos_
-                << " next_chunk_size=" << next_chunk_size_ << std::endl;
-      std::cerr << "[DEBUG chunk] remaining=["
+                << " chunk_remaining=" << chunk_remaining_ << " remaining=["
                 << EscapeForDebug(buffer_.substr(buffer_read_pos_)) << "]"
                 << std::endl;
     }
-    if (next_chunk_size_ == -1) {
-      size_t size = 0;
-      size_t pos = buffer_read_pos_;
-      if (kEnableChunkDebugLogging) {
-        std::cerr << "[DEBUG chunk] trying ParseChunkSize at pos=" << pos
-                  << std::endl;
-      }
-
-      if (!ParseChunkSize(pos, size)) {
-        if (kEnableChunkDebugLogging) {
-          std::cerr << "[DEBUG chunk] ParseChunkSize -> false (need more data)"
-                    << std::endl;
+    switch (chunk_state_) {
+      case kChunkSize: {
+        size_t size = 0;
+        size_t pos = buffer_read_pos_;
+        if (!ParseChunkSize(pos, size)) {
+          return false;  // need to wait for size line
         }
-        return false;  // need to wait for size line
-      }
-      if (kEnableChunkDebugLogging) {
-        std::cerr << "[DEBUG chunk] ParseChunkSize -> true"
-                  << " parsed_size=" << size << " new_pos=" << pos << std::endl;
-      }
-      buffer_read_pos_ = pos;
-      next_chunk_size_ = static_cast<ptrdiff_t>(size);
-    }
-    // last chunk (0\r\n) has already been parsed.
-    // now we must wait for and validate the final CRLF.
-    if (next_chunk_size_ == 0) {
-      if (kEnableChunkDebugLogging) {
-        std::cerr << "[DEBUG chunk] last chunk detected (size 0)"
-                  << " validate from pos=" << buffer_read_pos_ << std::endl;
-      }
-      bool done = ValidateFinalCRLF(buffer_read_pos_);
-      if (kEnableChunkDebugLogging) {
-        std::cerr << "[DEBUG chunk] ValidateFinalCRLF -> " << done
-                  << " read_pos(after?)=" << buffer_read_pos_ << std::endl;
-      }
-      if (!done) {
-        return false;  // need to wait for final CRLF
-      }
-      if (kEnableChunkDebugLogging) {
-        std::cerr << "[DEBUG chunk] request done, erasing consumed data"
-                  << " erase_len=" << buffer_read_pos_ << std::endl;
+        buffer_read_pos_ = pos;
+        if (size == 0) {
+          chunk_state_ = kChunkLastEnd;
+          break;
+        }
+        // overflow check: body_ size + size > max_body_size_limit_
+        if (size > max_body_size_limit_ ||
+            body_.Size() > max_body_size_limit_ - size) {
+          throw lib::exception::ResponseStatusException(
+              lib::http::kPayloadTooLarge);
+        }
+        chunk_remaining_ = size;
+        chunk_state_ = kChunkData;
+        break;
       }
-      buffer_.erase(0, buffer_read_pos_);  // erase consumed data
-      buffer_read_pos_ = 0;
-      next_chunk_size_ = -1;
-      state_ = kDone;
-      return true;
-    }
-    size_t pos = buffer_read_pos_;
-    if (kEnableChunkDebugLogging) {
-      std::cerr << "[DEBUG chunk] trying AppendChunkData"
-                << " pos=" << pos << " chunk_size=" << next_chunk_size_
-                << std::endl;
-    }
-    if (!AppendChunkData(pos, static_cast<size_t>(next_chunk_size_))) {
-      if (kEnableChunkDebugLogging) {
-        std::cerr << "[DEBUG chunk] AppendChunkData -> false (need more data)"
-                  << std::endl;
+      case kChunkData: {
+        if (UnreadSize() == 0) return false;
+        const size_t n =
+            UnreadSize() < chunk_remaining_ ? UnreadSize() : chunk_remaining_;
+        AppendBody(n);
+        chunk_remaining_ -= n;
+        if (chunk_remaining_ == 0) chunk_state_ = kChunkDataEnd;
+        break;
       }
-      return false;
-    }
-    if (kEnableChunkDebugLogging) {
-      std::cerr << "[DEBUG chunk] AppendChunkData -> true"
-                << " new_pos=" << pos << std::endl;
-    }
-    buffer_read_pos_ = pos;
-    next_chunk_size_ = -1;  // reset state, read next size line
-    if (kEnableChunkDebugLogging) {
-      std::cerr << "[DEBUG chunk] chunk consumed, reset next_chunk_size"
-                << std::endl;
+      case kChunkDataEnd:
+        if (!ValidateAndSkipCRLF(buffer_read_pos_)) return false;
+        chunk_state_ = kChunkSize;
+        break;
+      case kChunkLastEnd:
+        // last chunk (0\r\n) has already been parsed.
+        // now we must wait for and validate the final CRLF.
+        if (!ValidateFinalCRLF(buffer_read_pos_)) {
+          return false;  // need to wait for final CRLF
+        }
+        chunk_state_ = kChunkSize;
+        return true;
     }
   }
 }
@@ -224,10 +182,12 @@ bool HttpRequest::ParseChunkSize(size_t& pos, size_t& chunk_size) {
 
 // called after reading "0\r\n"; now expect the final CRLF
 bool HttpRequest::ValidateFinalCRLF(size_t& pos) {
-  std::cerr << "[DEBUG chunk] ValidateFinalCRLF enter"
-            << " pos=" << pos << " buffer_size=" << buffer_.size()
-            << " remaining=[" << EscapeForDebug(buffer_.substr(pos)) << "]"
-            << std::endl;
+  if (kEnableChunkDebugLogging) {
+    std::cerr << "[DEBUG chunk] ValidateFinalCRLF enter"
+              << " pos=" << pos << " buffer_size=" << buffer_.size()
+              << " remaining=[" << EscapeForDebug(buffer_.substr(pos)) << "]"
+              << std::endl;
+  }
 
   if (!ValidateAndSkipCRLF(pos)) return false;
   // ensure no extra data after final CRLF
@@ -235,23 +195,13 @@ bool HttpRequest::ValidateFinalCRLF(size_t& pos) {
     throw lib::exception::ResponseStatusException(lib::http::kBadRequest);
   }
   buffer_.clear();  // erase consumed data including last chunk
+  pos = 0;
   state_ = kDone;
   return true;
 }
 
-// append "<data>\r\n" and advance pos, but do not erase yet
-bool HttpRequest::AppendChunkData(size_t& pos, size_t chunk_size) {
-  // overflow check: body_ size + chunk_size > max_body_size_limit_
-  if (chunk_size > max_body_size_limit_ ||
-      body_.size() > max_body_size_limit_ - chunk_size) {
-    throw lib::exception::ResponseStatusException(lib::http::kPayloadTooLarge);
-  }
-
-  const size_t total_needed = chunk_size + 2;
-  if (pos + total_needed > buffer_.size()) {
-    return false;
-  }
-  body_.append(buffer_, pos, chunk_size);
-  pos += chunk_size;
-  return ValidateAndSkipCRLF(pos);
+// moves the next len unread bytes to body_
+void HttpRequest::AppendBody(size_t len) {
+  body_.Append(buffer_.data() + buffer_read_pos_, len);
+  Consume(len);
 }
@@ -13,13 +13,19 @@
  *        - INTERNAL_SERVER_ERROR: unexpected exception
  *
  * @post
- *  - consumed data is removed from buffer_
+ *  - buffer_read_pos_ is moved past the header block
  *  - progress is updated to BODY when header parsing completes
  */
 
 bool HttpRequest::AdvanceHeader() {
   std::string::size_type end_of_header = FindEndOfHeader(buffer_);
   if (end_of_header == std::string::npos) {
+    // the request line and the fields are limited separately; do not
+    // buffer more than both while waiting for the blank line
+    if (buffer_.size() > kMaxUriSize + kMaxHeaderSize + kMaxRequestLineSlack) {
+      throw lib::exception::ResponseStatusException(
+          lib::http::kRequestHeaderFieldsTooLarge);
+    }
     return false;  // need more data
   }
   try {
@@ -35,7 +41,7 @@ bool HttpRequest::AdvanceHeader() {
     throw lib::exception::ResponseStatusException(
         lib::http::kInternalServerError);
   }
-  buffer_.erase(0, end_of_header);
+  Consume(end_of_header);
   state_ = kBody;
   return true;
 }
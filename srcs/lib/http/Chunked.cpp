@@ -0,0 +1,26 @@
+#include "lib/http/Chunked.hpp"
+
+#include <sstream>
+
+namespace lib {
+namespace http {
+
+void AppendChunk(lib::io::OutputQueue& out, const char* data, size_t len) {
+  if (len == 0) return;
+  AppendChunkSize(out, len);
+  out.Append(data, len);
+  out.Append("\r\n", 2);
+}
+
+void AppendChunkSize(lib::io::OutputQueue& out, size_t len) {
+  std::ostringstream size_line;
+  size_line << std::hex << len << "\r\n";
+  out.Append(size_line.str());
+}
+
+void AppendLastChunk(lib::io::OutputQueue& out) {
+  out.Append("0\r\n\r\n", 5);
+}
+
+}  // namespace http
+}  // namespace lib
@@ -0,0 +1,62 @@
+#include "lib/http/CompressedBodyProducer.hpp"
+
+#include <algorithm>
+#include <string>
+
+#include "lib/http/Chunked.hpp"
+
+namespace lib {
+namespace http {
+
+const size_t CompressedBodyProducer::kCopySize;
+
+CompressedBodyProducer::CompressedBodyProducer(lib::io::OutputQueue& source,
+                                               ContentCoding coding,
+                                               int level, bool chunked,
+                                               size_t budget)
+    : source_(),
+      deflater_(coding == kCodingGzip ? lib::io::Deflater::kGzip
+                                      : lib::io::Deflater::kZlib,
+                level),
+      chunked_(chunked),
+      budget_(budget),
+      finished_(false) {
+  source_.Swap(source);
+}
+
+CompressedBodyProducer::~CompressedBodyProducer() {
+}
+
+bool CompressedBodyProducer::Produce(lib::io::OutputQueue& out) {
+  if (finished_) return true;
+
+  std::string encoded;
+  char buf[kCopySize];
+  size_t spent = 0;
+  while (spent < budget_ && !source_.Empty()) {
+    size_t len = std::min(sizeof(buf), budget_ - spent);
+    len = source_.CopyOut(buf, len);
+    deflater_.Update(buf, len, &encoded);
+    source_.Consume(len);
+    spent += len;
+  }
+  if (source_.Empty()) {
+    deflater_.Finish(&encoded);
+    finished_ = true;
+  }
+
+  if (chunked_) {
+    AppendChunk(out, encoded.data(), encoded.size());
+    if (finished_) AppendLastChunk(out);
+  } else {
+    out.Append(encoded);
+  }
+  return finished_;
+}
+
+const lib::io::OutputQueue* CompressedBodyProducer::PendingInput() const {
+  return &source_;
+}
+
+}  // namespace http
+}  // namespace lib
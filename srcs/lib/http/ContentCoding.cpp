@@ -0,0 +1,100 @@
+#include "lib/http/ContentCoding.hpp"
+
+#include "lib/utils/string_utils.hpp"
+
+namespace lib {
+namespace http {
+
+namespace {
+
+const int kQvalueUnset = -1;
+
+std::string TrimOws(const std::string& s) {
+  size_t begin = s.find_first_not_of(" \t");
+  if (begin == std::string::npos) return "";
+  size_t end = s.find_last_not_of(" \t");
+  return s.substr(begin, end - begin + 1);
+}
+
+// qvalue = ( "0" [ "." 0*3DIGIT ] ) / ( "1" [ "." 0*3("0") ] ), in 1/1000
+// a malformed weight makes the whole element unacceptable
+int ParseQvalue(const std::string& s) {
+  if (s.empty() || (s[0] != '0' && s[0] != '1')) return 0;
+  int value = (s[0] - '0') * 1000;
+  if (s.size() == 1) return value;
+  if (s[1] != '.' || s.size() > 5) return 0;
+  int scale = 100;
+  for (size_t i = 2; i < s.size(); ++i, scale /= 10) {
+    if (s[i] < '0' || s[i] > '9') return 0;
+    value += (s[i] - '0') * scale;
+  }
+  return value > 1000 ? 0 : value;
+}
+
+// "coding;q=0.5" -> coding (lowercased) and its weight
+void ParseElement(const std::string& element, std::string* coding,
+                  int* qvalue) {
+  size_t semi = element.find(';');
+  *coding = lib::utils::ToLowerAscii(TrimOws(element.substr(0, semi)));
+  *qvalue = 1000;
+  while (semi != std::string::npos) {
+    size_t next = element.find(';', semi + 1);
+    std::string param = TrimOws(element.substr(semi + 1, next - semi - 1));
+    if (param.size() >= 2 && (param[0] == 'q' || param[0] == 'Q') &&
+        param[1] == '=') {
+      *qvalue = ParseQvalue(param.substr(2));
+    }
+    semi = next;
+  }
+}
+
+}  // namespace
+
+int AcceptEncodingQvalue(const std::string& accept_encoding,
+                         ContentCoding coding) {
+  const std::string name = ContentCodingToString(coding);
+  if (name.empty()) return 0;
+  int coding_q = kQvalueUnset;
+  int any_q = kQvalueUnset;
+
+  size_t pos = 0;
+  while (pos <= accept_encoding.size()) {
+    size_t comma = accept_encoding.find(',', pos);
+    if (comma == std::string::npos) comma = accept_encoding.size();
+    std::string element;
+    int qvalue;
+    ParseElement(accept_encoding.substr(pos, comma - pos), &element, &qvalue);
+    if (element == name || (coding == kCodingGzip && element == "x-gzip")) {
+      coding_q = qvalue;
+    } else if (element == "*") {
+      any_q = qvalue;
+    }
+    pos = comma + 1;
+  }
+  if (coding_q == kQvalueUnset) coding_q = any_q;
+  return coding_q == kQvalueUnset ? 0 : coding_q;
+}
+
+ContentCoding SelectContentCoding(const std::string& accept_encoding) {
+  int gzip_q = AcceptEncodingQvalue(accept_encoding, kCodingGzip);
+  int deflate_q = AcceptEncodingQvalue(accept_encoding, kCodingDeflate);
+  if (gzip_q > 0 && gzip_q >= deflate_q) return kCodingGzip;
+  if (deflate_q > 0) return kCodingDeflate;
+  return kCodingIdentity;
+}
+
+std::string ContentCodingToString(ContentCoding coding) {
+  switch (coding) {
+    case kCodingGzip:
+      return "gzip";
+    case kCodingDeflate:
+      return "deflate";
+    case kCodingBrotli:
+      return "br";
+    default:
+      return "";
+  }
+}
+
+}  // namespace http
+}  // namespace lib
@@ -0,0 +1,54 @@
+#include "lib/http/ETag.hpp"
+
+#include <sstream>
+
+namespace lib {
+namespace http {
+
+namespace {
+
+// strip the weakness indicator so W/"x" and "x" compare equal
+std::string OpaqueTag(const std::string& etag) {
+  if (etag.compare(0, 2, "W/") == 0) return etag.substr(2);
+  return etag;
+}
+
+}  // namespace
+
+std::string MakeWeakETag(const struct stat& st) {
+  std::ostringstream oss;
+  oss << std::hex << "W/\"" << static_cast<unsigned long>(st.st_ino) << "-"
+      << static_cast<unsigned long>(st.st_size) << "-"
+      << static_cast<unsigned long>(st.st_mtim.tv_sec) << "."
+      << static_cast<unsigned long>(st.st_mtim.tv_nsec) << "\"";
+  return oss.str();
+}
+
+bool IfNoneMatchMatches(const std::string& header_value,
+                        const std::string& etag) {
+  const std::string ours = OpaqueTag(etag);
+  size_t pos = 0;
+  while (pos < header_value.size()) {
+    while (pos < header_value.size() &&
+           (header_value[pos] == ' ' || header_value[pos] == '\t' ||
+            header_value[pos] == ',')) {
+      ++pos;
+    }
+    if (pos >= header_value.size()) break;
+    if (header_value[pos] == '*') return true;
+
+    size_t start = pos;
+    if (header_value.compare(pos, 2, "W/") == 0) pos += 2;
+    if (pos >= header_value.size() || header_value[pos] != '"') return false;
+    size_t close = header_value.find('"', pos + 1);
+    if (close == std::string::npos) return false;  // malformed list
+    pos = close + 1;
+    if (OpaqueTag(header_value.substr(start, pos - start)) == ours) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace http
+}  // namespace lib
@@ -0,0 +1,86 @@
+#include "lib/http/HttpDate.hpp"
+
+#include <cstring>
+
+namespace lib {
+namespace http {
+
+namespace {
+
+const char* const kWeekdays[] = {"Sun", "Mon", "Tue", "Wed",
+                                 "Thu", "Fri", "Sat"};
+const char* const kMonths[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                               "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+int IndexOf(const char* const* names, int count, const std::string& name) {
+  for (int i = 0; i < count; ++i) {
+    if (name == names[i]) return i;
+  }
+  return -1;
+}
+
+bool ReadNumber(const std::string& s, size_t pos, size_t len, int* out) {
+  int value = 0;
+  for (size_t i = pos; i < pos + len; ++i) {
+    if (s[i] < '0' || s[i] > '9') return false;
+    value = value * 10 + (s[i] - '0');
+  }
+  *out = value;
+  return true;
+}
+
+}  // namespace
+
+std::string FormatHttpDate(time_t t) {
+  std::tm tm;
+  gmtime_r(&t, &tm);
+  char buf[64];
+  std::strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+  return std::string(buf);
+}
+
+const std::string& CurrentHttpDate() {
+  static time_t cached_time = static_cast<time_t>(-1);
+  static std::string cached_date;
+  const time_t now = std::time(NULL);
+  if (now != cached_time) {
+    cached_date = FormatHttpDate(now);
+    cached_time = now;
+  }
+  return cached_date;
+}
+
+// "Sun, 06 Nov 1994 08:49:37 GMT"
+//  0123456789012345678901234567
+lib::type::Optional<time_t> ParseHttpDate(const std::string& s) {
+  if (s.size() != 29 || s.compare(3, 2, ", ") != 0 || s[7] != ' ' ||
+      s[11] != ' ' || s[16] != ' ' || s[19] != ':' || s[22] != ':' ||
+      s.compare(25, 4, " GMT") != 0) {
+    return lib::type::Optional<time_t>();
+  }
+  if (IndexOf(kWeekdays, 7, s.substr(0, 3)) < 0) {
+    return lib::type::Optional<time_t>();
+  }
+  int month = IndexOf(kMonths, 12, s.substr(8, 3));
+  int day, year, hour, min, sec;
+  if (month < 0 || !ReadNumber(s, 5, 2, &day) ||
+      !ReadNumber(s, 12, 4, &year) || !ReadNumber(s, 17, 2, &hour) ||
+      !ReadNumber(s, 20, 2, &min) || !ReadNumber(s, 23, 2, &sec)) {
+    return lib::type::Optional<time_t>();
+  }
+  if (day < 1 || day > 31 || hour > 23 || min > 59 || sec > 60) {
+    return lib::type::Optional<time_t>();
+  }
+  std::tm tm;
+  std::memset(&tm, 0, sizeof(tm));
+  tm.tm_year = year - 1900;
+  tm.tm_mon = month;
+  tm.tm_mday = day;
+  tm.tm_hour = hour;
+  tm.tm_min = min;
+  tm.tm_sec = sec;
+  return lib::type::Optional<time_t>(timegm(&tm));
+}
+
+}  // namespace http
+}  // namespace lib
@@ -0,0 +1,122 @@
+#include "lib/http/Range.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include "lib/utils/string_utils.hpp"
+
+namespace lib {
+namespace http {
+
+namespace {
+
+const std::string kBytesUnit = "bytes=";
+
+bool ByFirst(const ByteRange& a, const ByteRange& b) {
+  return a.first < b.first;
+}
+
+std::string Trim(const std::string& s) {
+  size_t begin = s.find_first_not_of(" \t");
+  if (begin == std::string::npos) return "";
+  size_t end = s.find_last_not_of(" \t");
+  return s.substr(begin, end - begin + 1);
+}
+
+bool ParsePosition(const std::string& s, size_t* out) {
+  if (s.empty()) return false;
+  const size_t max_before_mul = std::numeric_limits<size_t>::max() / 10;
+  size_t value = 0;
+  for (size_t i = 0; i < s.size(); ++i) {
+    if (s[i] < '0' || s[i] > '9') return false;
+    size_t digit = static_cast<size_t>(s[i] - '0');
+    if (value > max_before_mul ||
+        value * 10 > std::numeric_limits<size_t>::max() - digit) {
+      // larger than any file we can serve; clamp instead of rejecting
+      value = std::numeric_limits<size_t>::max();
+      continue;
+    }
+    value = value * 10 + digit;
+  }
+  *out = value;
+  return true;
+}
+
+// false: syntax error; true with *satisfiable == false: spec is valid but
+// starts past the end of the representation
+bool ParseSpec(const std::string& spec, size_t size, ByteRange* range,
+               bool* satisfiable) {
+  size_t dash = spec.find('-');
+  if (dash == std::string::npos) return false;
+  const std::string first_str = spec.substr(0, dash);
+  const std::string last_str = spec.substr(dash + 1);
+  *satisfiable = false;
+
+  if (first_str.empty()) {  // suffix: "-500" means the last 500 bytes
+    size_t suffix;
+    if (!ParsePosition(last_str, &suffix)) return false;
+    if (suffix == 0 || size == 0) return true;
+    range->first = suffix >= size ? 0 : size - suffix;
+    range->last = size - 1;
+    *satisfiable = true;
+    return true;
+  }
+  size_t first;
+  if (!ParsePosition(first_str, &first)) return false;
+  size_t last = std::numeric_limits<size_t>::max();
+  if (!last_str.empty()) {
+    if (!ParsePosition(last_str, &last)) return false;
+    if (last < first) return false;
+  }
+  if (first >= size) return true;
+  range->first = first;
+  range->last = std::min(last, size - 1);
+  *satisfiable = true;
+  return true;
+}
+
+}  // namespace
+
+RangeResult ParseRangeHeader(const std::string& value, size_t size,
+                             std::vector<ByteRange>* ranges) {
+  ranges->clear();
+  if (!lib::utils::StartsWith(value, kBytesUnit)) return kRangeIgnored;
+
+  std::vector<ByteRange> parsed;
+  size_t spec_count = 0;
+  size_t start = kBytesUnit.size();
+  while (start <= value.size()) {
+    size_t comma = value.find(',', start);
+    if (comma == std::string::npos) comma = value.size();
+    const std::string spec = Trim(value.substr(start, comma - start));
+    start = comma + 1;
+    if (spec.empty()) continue;  // "1-2, , 4-5" is allowed by the list rule
+    if (++spec_count > kMaxRanges) return kRangeIgnored;
+    ByteRange range;
+    bool satisfiable;
+    if (!ParseSpec(spec, size, &range, &satisfiable)) return kRangeIgnored;
+    if (satisfiable) parsed.push_back(range);
+  }
+  if (spec_count == 0) return kRangeIgnored;
+  if (parsed.empty()) return kRangeUnsatisfiable;
+
+  std::sort(parsed.begin(), parsed.end(), ByFirst);
+  ranges->push_back(parsed[0]);
+  for (size_t i = 1; i < parsed.size(); ++i) {
+    ByteRange& back = ranges->back();
+    if (parsed[i].first <= back.last + 1) {
+      back.last = std::max(back.last, parsed[i].last);
+    } else {
+      ranges->push_back(parsed[i]);
+    }
+  }
+  return kRangeSatisfiable;
+}
+
+std::string ContentRangeValue(const ByteRange& range, size_t size) {
+  return "bytes " + lib::utils::ToString(range.first) + "-" +
+         lib::utils::ToString(range.last) + "/" + lib::utils::ToString(size);
+}
+
+}  // namespace http
+}  // namespace lib
@@ -0,0 +1,71 @@
+#include "lib/http/SplicedBody.hpp"
+
+#include "lib/http/Chunked.hpp"
+
+namespace lib {
+namespace http {
+
+SplicedBody::SplicedBody(bool chunked)
+    : pipe_(),
+      chunked_(chunked),
+      source_state_(kOpen),
+      chunk_left_(0),
+      chunk_open_(false),
+      finished_(false) {
+}
+
+SplicedBody::~SplicedBody() {
+}
+
+ssize_t SplicedBody::Fill(int in) {
+  return pipe_.FillFrom(in);
+}
+
+void SplicedBody::Finish() {
+  if (source_state_ == kOpen) source_state_ = kFinished;
+}
+
+void SplicedBody::Abort() {
+  if (source_state_ == kOpen) source_state_ = kAborted;
+}
+
+size_t SplicedBody::Pending() const {
+  return pipe_.Size();
+}
+
+bool SplicedBody::IsFull() const {
+  return pipe_.IsFull();
+}
+
+// a chunk covers what the pipe held when it was announced; an aborted
+// chunked body gets no last-chunk, so the peer sees it truncated
+bool SplicedBody::Produce(lib::io::OutputQueue& out) {
+  if (finished_) return true;
+  if (chunk_left_ > 0) return false;
+  if (pipe_.Size() > 0) {
+    chunk_left_ = pipe_.Size();
+    if (chunked_) {
+      if (chunk_open_) out.Append("\r\n", 2);
+      AppendChunkSize(out, chunk_left_);
+      chunk_open_ = true;
+    }
+    return false;
+  }
+  if (source_state_ == kOpen) return false;
+  if (chunked_ && source_state_ == kFinished) {
+    if (chunk_open_) out.Append("\r\n", 2);
+    AppendLastChunk(out);
+  }
+  finished_ = true;
+  return true;
+}
+
+ssize_t SplicedBody::SpliceTo(int fd) {
+  if (chunk_left_ == 0) return 0;
+  const ssize_t n = pipe_.DrainTo(fd, chunk_left_);
+  if (n > 0) chunk_left_ -= n;
+  return n;
+}
+
+}  // namespace http
+}  // namespace lib
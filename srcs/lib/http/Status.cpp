@@ -15,8 +15,12 @@ std::string StatusToString(Status status) {
       return "No Content";
     case kResetContent:
       return "Reset Content";
+    case kPartialContent:
+      return "Partial Content";
     case kFound:
       return "Found";
+    case kNotModified:
+      return "Not Modified";
     case kTemporaryRedirect:
       return "Temporary Redirect";
     case kBadRequest:
@@ -37,6 +41,8 @@ std::string StatusToString(Status status) {
       return "Payload Too Large";
     case kUriTooLong:
       return "URI Too Long";
+    case kRangeNotSatisfiable:
+      return "Range Not Satisfiable";
     case kRequestHeaderFieldsTooLarge:
       return "Request Header Fields Too Large";
     case kInternalServerError:
@@ -45,6 +51,10 @@ std::string StatusToString(Status status) {
       return "Not Implemented";
     case kBadGateway:
       return "Bad Gateway";
+    case kServiceUnavailable:
+      return "Service Unavailable";
+    case kGatewayTimeout:
+      return "Gateway Timeout";
     default:
       return "I'm a teapot";
   }
@@ -0,0 +1,113 @@
+#include "lib/http/StreamedBodyProducer.hpp"
+
+#include <string>
+
+#include "lib/http/Chunked.hpp"
+
+namespace lib {
+namespace http {
+
+StreamedBodyProducer::StreamedBodyProducer(bool chunked, size_t chunk_limit)
+    : source_(),
+      deflater_(NULL),
+      chunked_(chunked),
+      chunk_limit_(chunk_limit),
+      source_state_(kOpen),
+      finished_(false) {
+}
+
+StreamedBodyProducer::StreamedBodyProducer(bool chunked, size_t chunk_limit,
+                                           ContentCoding coding, int level)
+    : source_(),
+      deflater_(NULL),
+      chunked_(chunked),
+      chunk_limit_(chunk_limit),
+      source_state_(kOpen),
+      finished_(false) {
+  if (coding != kCodingIdentity) {
+    deflater_ = new lib::io::Deflater(coding == kCodingGzip
+                                          ? lib::io::Deflater::kGzip
+                                          : lib::io::Deflater::kZlib,
+                                      level);
+  }
+}
+
+StreamedBodyProducer::~StreamedBodyProducer() {
+  delete deflater_;
+}
+
+void StreamedBodyProducer::Feed(const char* data, size_t len) {
+  if (source_state_ == kOpen) source_.Append(data, len);
+}
+
+void StreamedBodyProducer::Feed(const lib::io::OutputQueue& data) {
+  if (source_state_ == kOpen) source_.Append(data);
+}
+
+void StreamedBodyProducer::Finish() {
+  if (source_state_ == kOpen) source_state_ = kFinished;
+}
+
+void StreamedBodyProducer::Abort() {
+  if (source_state_ != kOpen) return;
+  source_state_ = kAborted;
+}
+
+size_t StreamedBodyProducer::Pending() const {
+  return source_.Size();
+}
+
+bool StreamedBodyProducer::IsStarved() const {
+  return !finished_ && source_.Empty() && source_state_ == kOpen;
+}
+
+void StreamedBodyProducer::SetChunkLimit(size_t chunk_limit) {
+  chunk_limit_ = chunk_limit;
+}
+
+bool StreamedBodyProducer::Produce(lib::io::OutputQueue& out) {
+  if (finished_) return true;
+
+  std::string piece;
+  const size_t take =
+      source_.Size() < chunk_limit_ ? source_.Size() : chunk_limit_;
+  piece.reserve(take);
+  while (piece.size() < take) {
+    const char* data;
+    size_t len = source_.Peek(&data);
+    if (len > take - piece.size()) len = take - piece.size();
+    piece.append(data, len);
+    source_.Consume(len);
+  }
+
+  const bool drained = source_.Empty();
+  if (deflater_) {
+    std::string encoded;
+    deflater_->Update(piece.data(), piece.size(), &encoded);
+    if (drained && source_state_ == kFinished) {
+      deflater_->Finish(&encoded);
+    } else if (drained && !piece.empty()) {
+      deflater_->Flush(&encoded);
+    }
+    piece.swap(encoded);
+  }
+  Emit(out, piece);
+  if (drained && source_state_ != kOpen) {
+    // an aborted body gets no last-chunk: it ends truncated
+    if (chunked_ && source_state_ == kFinished) AppendLastChunk(out);
+    finished_ = true;
+  }
+  return finished_;
+}
+
+void StreamedBodyProducer::Emit(lib::io::OutputQueue& out,
+                                const std::string& piece) const {
+  if (chunked_) {
+    AppendChunk(out, piece.data(), piece.size());
+  } else {
+    out.Append(piece);
+  }
+}
+
+}  // namespace http
+}  // namespace lib
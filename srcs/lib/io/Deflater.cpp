@@ -0,0 +1,71 @@
+#include "lib/io/Deflater.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace lib {
+namespace io {
+
+namespace {
+
+const int kWindowBits = 15;
+const int kGzipWrapper = 16;  // added to windowBits for a gzip header
+const int kMemLevel = 8;
+const size_t kOutChunk = 16384;
+
+}  // namespace
+
+Deflater::Deflater(Format format, int level) {
+  std::memset(&stream_, 0, sizeof(stream_));
+  int window_bits = kWindowBits + (format == kGzip ? kGzipWrapper : 0);
+  if (deflateInit2(&stream_, level, Z_DEFLATED, window_bits, kMemLevel,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    throw std::runtime_error("deflateInit2 failed");
+  }
+}
+
+Deflater::~Deflater() {
+  deflateEnd(&stream_);
+}
+
+void Deflater::Update(const char* data, size_t len, std::string* out) {
+  // avail_in is a uInt; feed oversized slices piecewise
+  while (len > 0) {
+    uInt n = len > 0x40000000u ? 0x40000000u : static_cast<uInt>(len);
+    stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream_.avail_in = n;
+    Run(Z_NO_FLUSH, out);
+    data += n;
+    len -= n;
+  }
+}
+
+void Deflater::Flush(std::string* out) {
+  stream_.next_in = NULL;
+  stream_.avail_in = 0;
+  Run(Z_SYNC_FLUSH, out);
+}
+
+void Deflater::Finish(std::string* out) {
+  stream_.next_in = NULL;
+  stream_.avail_in = 0;
+  Run(Z_FINISH, out);
+}
+
+void Deflater::Run(int flush, std::string* out) {
+  char buf[kOutChunk];
+  int ret;
+  do {
+    stream_.next_out = reinterpret_cast<Bytef*>(buf);
+    stream_.avail_out = sizeof(buf);
+    ret = deflate(&stream_, flush);
+    if (ret == Z_STREAM_ERROR) {
+      throw std::runtime_error("deflate failed");
+    }
+    out->append(buf, sizeof(buf) - stream_.avail_out);
+  } while (stream_.avail_out == 0 ||
+           (flush == Z_FINISH && ret != Z_STREAM_END));
+}
+
+}  // namespace io
+}  // namespace lib
@@ -0,0 +1,76 @@
+#include "lib/io/DirectoryReader.hpp"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include "lib/exception/ResponseStatusException.hpp"
+#include "lib/utils/file_utils.hpp"
+
+namespace lib {
+namespace io {
+
+namespace {
+
+// getdents64 record layout (the libc wrapper is not available everywhere)
+struct LinuxDirent64 {
+  uint64_t d_ino;
+  int64_t d_off;
+  unsigned short d_reclen;
+  unsigned char d_type;
+  char d_name[1];
+};
+
+const size_t kGetdentsBufferSize = 256 * 1024;
+
+void ThrowErrno(int saved_errno) {
+  throw lib::exception::ResponseStatusException(
+      lib::utils::MapErrnoToHttpStatus(saved_errno));
+}
+
+bool IsDirEntryDir(int dir_fd, const char* name, unsigned char d_type) {
+  if (d_type != DT_UNKNOWN) return d_type == DT_DIR;
+  struct stat st;
+  if (fstatat(dir_fd, name, &st, 0) != 0) return false;
+  return S_ISDIR(st.st_mode);
+}
+
+}  // namespace
+
+void ReadDirectoryOrThrow(const std::string& path,
+                          std::vector<DirEntry>* entries) {
+  int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd == -1) ThrowErrno(errno);
+
+  std::vector<char> buf(kGetdentsBufferSize);
+  while (true) {
+    long n = syscall(SYS_getdents64, fd, &buf[0], buf.size());
+    if (n == 0) break;
+    if (n < 0) {
+      int saved_errno = errno;
+      close(fd);
+      ThrowErrno(saved_errno);
+    }
+    for (long pos = 0; pos < n;) {
+      const LinuxDirent64* d =
+          reinterpret_cast<const LinuxDirent64*>(&buf[pos]);
+      pos += d->d_reclen;
+      if (d->d_name[0] == '.') continue;  // ".", ".." and hidden files
+      DirEntry entry;
+      entry.name = d->d_name;
+      entry.is_dir = IsDirEntryDir(fd, d->d_name, d->d_type);
+      entries->push_back(entry);
+    }
+  }
+  close(fd);
+}
+
+}  // namespace io
+}  // namespace lib
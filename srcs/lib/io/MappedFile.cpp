@@ -0,0 +1,272 @@
+#include "lib/io/MappedFile.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "lib/exception/ResponseStatusException.hpp"
+#include "lib/http/Status.hpp"
+#include "lib/thread/Mutex.hpp"
+#include "lib/utils/file_utils.hpp"
+
+namespace lib {
+namespace io {
+
+namespace {
+
+// MADV_WILLNEED starts readahead right away; limit it to the head of the
+// queued slice so a multi-GB file is not pulled into the page cache at once.
+const size_t kWillNeedWindow = 1024 * 1024;
+
+// Populate() falls back to reading through this much when the kernel lacks
+// MADV_POPULATE_READ (before 5.14)
+const size_t kPopulateReadSize = 65536;
+
+#ifndef MADV_POPULATE_READ
+#define MADV_POPULATE_READ 22
+#endif
+
+typedef std::pair<dev_t, ino_t> MappingKey;
+
+}  // namespace
+
+struct MappedFile::Mapping {
+  MappingKey key;
+  void* addr;
+  size_t size;
+  int fd;  // kept open for Read()
+  time_t mtime_sec;
+  long mtime_nsec;
+  size_t refcount;
+  bool cached;
+};
+
+namespace {
+
+typedef std::map<MappingKey, MappedFile::Mapping*> MappingCache;
+
+MappingCache& Cache() {
+  static MappingCache cache;
+  return cache;
+}
+
+size_t& LiveCount() {
+  static size_t count = 0;
+  return count;
+}
+
+CacheStats& Counters() {
+  static CacheStats stats;
+  return stats;
+}
+
+// guards the cache, the counters and every refcount; never held across
+// open() or mmap()
+lib::thread::Mutex& CacheMutex() {
+  static lib::thread::Mutex mutex;
+  return mutex;
+}
+
+}  // namespace
+
+MappedFile::MappedFile() : mapping_(NULL) {
+}
+
+MappedFile::MappedFile(Mapping* mapping) : mapping_(mapping) {
+}
+
+MappedFile::MappedFile(const MappedFile& other) : mapping_(other.mapping_) {
+  if (mapping_) {
+    lib::thread::ScopedLock lock(CacheMutex());
+    ++mapping_->refcount;
+  }
+}
+
+MappedFile& MappedFile::operator=(const MappedFile& other) {
+  if (mapping_ != other.mapping_) {
+    Release();
+    mapping_ = other.mapping_;
+    if (mapping_) {
+      lib::thread::ScopedLock lock(CacheMutex());
+      ++mapping_->refcount;
+    }
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() {
+  Release();
+}
+
+void MappedFile::Release() {
+  if (!mapping_) return;
+  {
+    lib::thread::ScopedLock lock(CacheMutex());
+    if (--mapping_->refcount != 0) {
+      mapping_ = NULL;
+      return;
+    }
+    if (mapping_->cached) {
+      Cache().erase(mapping_->key);
+    }
+    --LiveCount();
+  }
+  munmap(mapping_->addr, mapping_->size);
+  close(mapping_->fd);
+  delete mapping_;
+  mapping_ = NULL;
+}
+
+MappedFile MappedFile::Open(const std::string& path, const struct stat& st) {
+  if (st.st_size <= 0) {
+    throw lib::exception::ResponseStatusException(
+        lib::http::kInternalServerError);
+  }
+  const MappingKey key(st.st_dev, st.st_ino);
+  const size_t size = static_cast<size_t>(st.st_size);
+
+  MappingCache& cache = Cache();
+  {
+    lib::thread::ScopedLock lock(CacheMutex());
+    MappingCache::iterator it = cache.find(key);
+    if (it != cache.end()) {
+      Mapping* cached = it->second;
+      if (cached->size == size && cached->mtime_sec == st.st_mtim.tv_sec &&
+          cached->mtime_nsec == st.st_mtim.tv_nsec) {
+        ++Counters().hits;
+        ++cached->refcount;
+        return MappedFile(cached);
+      }
+      // stale: detach it, current holders keep their reference
+      cached->cached = false;
+      cache.erase(it);
+    }
+    ++Counters().misses;
+  }
+
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    int saved_errno = errno;
+    throw lib::exception::ResponseStatusException(
+        lib::utils::MapErrnoToHttpStatus(saved_errno));
+  }
+  void* addr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (addr == MAP_FAILED) {
+    close(fd);
+    throw lib::exception::ResponseStatusException(
+        lib::http::kInternalServerError);
+  }
+  madvise(addr, size, MADV_SEQUENTIAL);
+
+  Mapping* mapping = new Mapping();
+  mapping->key = key;
+  mapping->addr = addr;
+  mapping->size = size;
+  mapping->fd = fd;
+  mapping->mtime_sec = st.st_mtim.tv_sec;
+  mapping->mtime_nsec = st.st_mtim.tv_nsec;
+  mapping->refcount = 1;
+  mapping->cached = true;
+  lib::thread::ScopedLock lock(CacheMutex());
+  // another thread may have mapped the file meanwhile: the newest wins
+  MappingCache::iterator it = cache.find(key);
+  if (it != cache.end()) it->second->cached = false;
+  cache[key] = mapping;
+  ++LiveCount();
+  return MappedFile(mapping);
+}
+
+const char* MappedFile::Data() const {
+  return mapping_ ? static_cast<const char*>(mapping_->addr) : NULL;
+}
+
+size_t MappedFile::Size() const {
+  return mapping_ ? mapping_->size : 0;
+}
+
+bool MappedFile::IsValid() const {
+  return mapping_ != NULL;
+}
+
+// pread() loops over short reads so that a short result means EOF
+ssize_t MappedFile::Read(size_t offset, char* buf, size_t len) const {
+  if (!mapping_ || offset >= mapping_->size) return 0;
+  if (len > mapping_->size - offset) len = mapping_->size - offset;
+  size_t done = 0;
+  while (done < len) {
+    const ssize_t n = pread(mapping_->fd, buf + done, len - done,
+                            static_cast<off_t>(offset + done));
+    if (n == -1 && errno == EINTR) continue;
+    if (n == -1) return -1;
+    if (n == 0) break;
+    done += static_cast<size_t>(n);
+  }
+  return static_cast<ssize_t>(done);
+}
+
+void MappedFile::AdviseWillNeed(size_t offset, size_t length) const {
+  if (!mapping_ || offset >= mapping_->size) return;
+  const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const size_t begin = offset - offset % page;  // madvise needs alignment
+  size_t end = offset + (length < kWillNeedWindow ? length : kWillNeedWindow);
+  if (end > mapping_->size) end = mapping_->size;
+  madvise(static_cast<char*>(mapping_->addr) + begin, end - begin,
+          MADV_WILLNEED);
+}
+
+bool MappedFile::IsResident(size_t offset, size_t length) const {
+  if (!mapping_ || offset >= mapping_->size) return true;
+  const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const size_t begin = offset - offset % page;
+  const size_t end = length < mapping_->size - offset ? offset + length
+                                                      : mapping_->size;
+  std::vector<unsigned char> pages((end - begin + page - 1) / page);
+  if (mincore(static_cast<char*>(mapping_->addr) + begin, end - begin,
+              &pages[0]) == -1) {
+    return false;
+  }
+  for (size_t i = 0; i < pages.size(); ++i) {
+    if (!(pages[i] & 1)) return false;
+  }
+  return true;
+}
+
+// MADV_POPULATE_READ reports pages past a truncated end as EFAULT where
+// touching them would raise SIGBUS; the pread() fallback sees a short count
+bool MappedFile::Populate(size_t offset, size_t length) const {
+  if (!mapping_ || offset >= mapping_->size) return true;
+  const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const size_t begin = offset - offset % page;
+  const size_t end = length < mapping_->size - offset ? offset + length
+                                                      : mapping_->size;
+  if (madvise(static_cast<char*>(mapping_->addr) + begin, end - begin,
+              MADV_POPULATE_READ) == 0) {
+    return true;
+  }
+  if (errno != EINVAL) return false;
+  std::vector<char> buf(kPopulateReadSize);
+  for (size_t pos = begin; pos < end; pos += buf.size()) {
+    const size_t len = std::min(buf.size(), end - pos);
+    if (Read(pos, &buf[0], len) != static_cast<ssize_t>(len)) return false;
+  }
+  return true;
+}
+
+size_t MappedFile::LiveMappingCount() {
+  lib::thread::ScopedLock lock(CacheMutex());
+  return LiveCount();
+}
+
+CacheStats MappedFile::CacheCounters() {
+  lib::thread::ScopedLock lock(CacheMutex());
+  return Counters();
+}
+
+}  // namespace io
+}  // namespace lib
@@ -0,0 +1,192 @@
+#include "lib/io/OutputQueue.hpp"
+
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace lib {
+namespace io {
+
+const size_t OutputQueue::kMaxIovecs;
+const size_t OutputQueue::kCoalesceLimit;
+
+const char* OutputQueue::Segment::Begin() const {
+  if (file.IsValid()) return file.Data() + offset;
+  if (!shared.IsNull()) return shared->data() + offset;
+  return data.data() + offset;
+}
+
+bool OutputQueue::Segment::IsOwned() const {
+  return !file.IsValid() && shared.IsNull();
+}
+
+OutputQueue::OutputQueue() : segments_(), size_(0) {
+}
+
+OutputQueue::~OutputQueue() {
+}
+
+void OutputQueue::Append(const std::string& data) {
+  Append(data.data(), data.size());
+}
+
+void OutputQueue::Append(const char* data, size_t len) {
+  if (len == 0) return;
+  if (!segments_.empty()) {
+    Segment& last = segments_.back();
+    if (last.IsOwned() && last.length + len <= kCoalesceLimit) {
+      last.data.append(data, len);
+      last.length += len;
+      size_ += len;
+      return;
+    }
+  }
+  Segment seg;
+  seg.data.assign(data, len);
+  seg.offset = 0;
+  seg.length = len;
+  segments_.push_back(seg);
+  size_ += len;
+}
+
+void OutputQueue::Append(const MappedFile& file, size_t offset,
+                         size_t length) {
+  if (length == 0) return;
+  if (!file.IsValid() || offset > file.Size() ||
+      length > file.Size() - offset) {
+    throw std::out_of_range("OutputQueue: mapped slice out of range");
+  }
+  file.AdviseWillNeed(offset, length);
+  Segment seg;
+  seg.file = file;
+  seg.offset = offset;
+  seg.length = length;
+  segments_.push_back(seg);
+  size_ += length;
+}
+
+void OutputQueue::Append(
+    const lib::type::SharedPtr<const std::string>& buffer) {
+  if (buffer.IsNull() || buffer->empty()) return;
+  Segment seg;
+  seg.shared = buffer;
+  seg.offset = 0;
+  seg.length = buffer->size();
+  segments_.push_back(seg);
+  size_ += seg.length;
+}
+
+// segments were validated and advised when first queued
+void OutputQueue::Append(const OutputQueue& other) {
+  for (std::deque<Segment>::const_iterator it = other.segments_.begin();
+       it != other.segments_.end(); ++it) {
+    if (!it->IsOwned()) {
+      segments_.push_back(*it);
+      size_ += it->length;
+    } else {
+      Append(it->Begin(), it->length);
+    }
+  }
+}
+
+bool OutputQueue::Empty() const {
+  return size_ == 0;
+}
+
+size_t OutputQueue::Size() const {
+  return size_;
+}
+
+void OutputQueue::Clear() {
+  segments_.clear();
+  size_ = 0;
+}
+
+void OutputQueue::Swap(OutputQueue& other) {
+  segments_.swap(other.segments_);
+  std::swap(size_, other.size_);
+}
+
+size_t OutputQueue::Peek(const char** data) const {
+  if (segments_.empty()) {
+    *data = NULL;
+    return 0;
+  }
+  *data = segments_.front().Begin();
+  return segments_.front().length;
+}
+
+size_t OutputQueue::CopyOut(char* buf, size_t len) const {
+  size_t copied = 0;
+  for (std::deque<Segment>::const_iterator it = segments_.begin();
+       it != segments_.end() && copied < len; ++it) {
+    const size_t n = std::min(it->length, len - copied);
+    if (it->file.IsValid()) {
+      if (it->file.Read(it->offset, buf + copied, n) !=
+          static_cast<ssize_t>(n)) {
+        throw std::runtime_error("OutputQueue: mapped file changed");
+      }
+    } else {
+      std::memcpy(buf + copied, it->Begin(), n);
+    }
+    copied += n;
+  }
+  return copied;
+}
+
+bool OutputQueue::FirstMappedSlice(MappedFile* file, size_t* offset,
+                                   size_t* length) const {
+  for (std::deque<Segment>::const_iterator it = segments_.begin();
+       it != segments_.end(); ++it) {
+    if (!it->file.IsValid()) continue;
+    *file = it->file;
+    *offset = it->offset;
+    *length = it->length;
+    return true;
+  }
+  return false;
+}
+
+std::string OutputQueue::ToString() const {
+  std::string out;
+  out.reserve(size_);
+  for (std::deque<Segment>::const_iterator it = segments_.begin();
+       it != segments_.end(); ++it) {
+    out.append(it->Begin(), it->length);
+  }
+  return out;
+}
+
+ssize_t OutputQueue::WriteTo(int fd) {
+  if (segments_.empty()) return 0;
+  struct iovec iov[kMaxIovecs];
+  int iovcnt = 0;
+  for (std::deque<Segment>::const_iterator it = segments_.begin();
+       it != segments_.end() && iovcnt < static_cast<int>(kMaxIovecs);
+       ++it, ++iovcnt) {
+    iov[iovcnt].iov_base = const_cast<char*>(it->Begin());
+    iov[iovcnt].iov_len = it->length;
+  }
+  ssize_t n = writev(fd, iov, iovcnt);
+  if (n > 0) Consume(static_cast<size_t>(n));
+  return n;
+}
+
+void OutputQueue::Consume(size_t n) {
+  size_ -= n;
+  while (n > 0) {
+    Segment& front = segments_.front();
+    if (n < front.length) {
+      front.offset += n;
+      front.length -= n;
+      return;
+    }
+    n -= front.length;
+    segments_.pop_front();
+  }
+}
+
+}  // namespace io
+}  // namespace lib
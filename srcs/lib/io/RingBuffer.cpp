@@ -0,0 +1,77 @@
+#include "lib/io/RingBuffer.hpp"
+
+#include <sys/uio.h>
+
+#include <cstring>
+
+namespace lib {
+namespace io {
+
+RingBuffer::RingBuffer(size_t capacity)
+    : data_(capacity), head_(0), size_(0) {
+}
+
+bool RingBuffer::Append(const char* data, size_t len) {
+  if (len > Available()) return false;
+  if (len == 0) return true;
+  const size_t capacity = data_.size();
+  const size_t tail = (head_ + size_) % capacity;
+  const size_t first = len < capacity - tail ? len : capacity - tail;
+  std::memcpy(&data_[tail], data, first);
+  if (first < len) std::memcpy(&data_[0], data + first, len - first);
+  size_ += len;
+  return true;
+}
+
+ssize_t RingBuffer::WriteTo(int fd) {
+  if (size_ == 0) return 0;
+  const size_t capacity = data_.size();
+  struct iovec iov[2];
+  int iovcnt = 1;
+  iov[0].iov_base = &data_[head_];
+  iov[0].iov_len = size_ < capacity - head_ ? size_ : capacity - head_;
+  if (iov[0].iov_len < size_) {
+    iov[1].iov_base = &data_[0];
+    iov[1].iov_len = size_ - iov[0].iov_len;
+    iovcnt = 2;
+  }
+  ssize_t n = writev(fd, iov, iovcnt);
+  if (n > 0) {
+    head_ = (head_ + static_cast<size_t>(n)) % capacity;
+    size_ -= static_cast<size_t>(n);
+    if (size_ == 0) head_ = 0;
+  }
+  return n;
+}
+
+void RingBuffer::MoveTo(std::string* out) {
+  const size_t capacity = data_.size();
+  const size_t first = size_ < capacity - head_ ? size_ : capacity - head_;
+  out->append(&data_[head_], first);
+  out->append(&data_[0], size_ - first);
+  Clear();
+}
+
+void RingBuffer::Clear() {
+  head_ = 0;
+  size_ = 0;
+}
+
+size_t RingBuffer::Size() const {
+  return size_;
+}
+
+size_t RingBuffer::Capacity() const {
+  return data_.size();
+}
+
+size_t RingBuffer::Available() const {
+  return data_.size() - size_;
+}
+
+bool RingBuffer::Empty() const {
+  return size_ == 0;
+}
+
+}  // namespace io
+}  // namespace lib
@@ -0,0 +1,195 @@
+#include "lib/io/SpillBuffer.hpp"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include "lib/exception/ResponseStatusException.hpp"
+#include "lib/http/Status.hpp"
+
+namespace lib {
+namespace io {
+
+const size_t SpillBuffer::kDefaultMemoryLimit;
+const char* const SpillBuffer::kTempTemplate = "/tmp/webserv_body.XXXXXX";
+
+namespace {
+
+const size_t kCopyBlock = 64 * 1024;
+
+void ThrowInternalError() {
+  throw lib::exception::ResponseStatusException(
+      lib::http::kInternalServerError);
+}
+
+// unlinked right away: the file disappears with its last descriptor
+int CreateTempFile() {
+  std::vector<char> path(SpillBuffer::kTempTemplate,
+                         SpillBuffer::kTempTemplate +
+                             std::strlen(SpillBuffer::kTempTemplate) + 1);
+  const int fd = mkostemp(&path[0], O_CLOEXEC);
+  if (fd == -1) ThrowInternalError();
+  unlink(&path[0]);
+  return fd;
+}
+
+void PwriteAll(int fd, const char* data, size_t len, off_t offset) {
+  while (len > 0) {
+    const ssize_t n = pwrite(fd, data, len, offset);
+    if (n == -1) {
+      if (errno == EINTR) continue;
+      ThrowInternalError();
+    }
+    data += n;
+    len -= n;
+    offset += n;
+  }
+}
+
+void WriteAll(int fd, const char* data, size_t len) {
+  while (len > 0) {
+    const ssize_t n = write(fd, data, len);
+    if (n == -1) {
+      if (errno == EINTR) continue;
+      ThrowInternalError();
+    }
+    data += n;
+    len -= n;
+  }
+}
+
+// reads exactly len bytes at offset (the file never shrinks under us)
+void PreadAll(int fd, char* out, size_t len, off_t offset) {
+  while (len > 0) {
+    const ssize_t n = pread(fd, out, len, offset);
+    if (n == -1 && errno == EINTR) continue;
+    if (n <= 0) ThrowInternalError();
+    out += n;
+    len -= n;
+    offset += n;
+  }
+}
+
+}  // namespace
+
+SpillBuffer::SpillBuffer()
+    : memory_limit_(kDefaultMemoryLimit), memory_(), file_(), size_(0) {
+}
+
+SpillBuffer::SpillBuffer(size_t memory_limit)
+    : memory_limit_(memory_limit), memory_(), file_(), size_(0) {
+}
+
+void SpillBuffer::Append(const std::string& data) {
+  Append(data.data(), data.size());
+}
+
+void SpillBuffer::Append(const char* data, size_t len) {
+  if (len == 0) return;
+  if (!IsSpilled()) {
+    if (memory_.size() + len <= memory_limit_) {
+      memory_.append(data, len);
+      size_ += len;
+      return;
+    }
+    Spill();
+  }
+  Unshare();
+  WriteFile(data, len);
+}
+
+void SpillBuffer::Clear() {
+  std::string().swap(memory_);
+  file_.Reset();
+  size_ = 0;
+}
+
+size_t SpillBuffer::Size() const {
+  return size_;
+}
+
+bool SpillBuffer::Empty() const {
+  return size_ == 0;
+}
+
+bool SpillBuffer::IsSpilled() const {
+  return !file_.IsNull();
+}
+
+int SpillBuffer::FileFd() const {
+  return IsSpilled() ? file_->GetFd() : -1;
+}
+
+std::string SpillBuffer::ToString() const {
+  if (!IsSpilled()) return memory_;
+  std::string out(size_, '\0');
+  if (size_ > 0) PreadAll(file_->GetFd(), &out[0], size_, 0);
+  return out;
+}
+
+void SpillBuffer::WriteTo(std::ostream& out) const {
+  if (!IsSpilled()) {
+    out.write(memory_.data(), static_cast<std::streamsize>(memory_.size()));
+    return;
+  }
+  std::vector<char> block(kCopyBlock);
+  for (size_t offset = 0; offset < size_ && out;) {
+    const size_t n = size_ - offset < kCopyBlock ? size_ - offset : kCopyBlock;
+    PreadAll(file_->GetFd(), &block[0], n, static_cast<off_t>(offset));
+    out.write(&block[0], static_cast<std::streamsize>(n));
+    offset += n;
+  }
+}
+
+void SpillBuffer::WriteTo(int fd) const {
+  if (!IsSpilled()) {
+    WriteAll(fd, memory_.data(), memory_.size());
+    return;
+  }
+  std::vector<char> block(kCopyBlock);
+  for (size_t offset = 0; offset < size_;) {
+    const size_t n = size_ - offset < kCopyBlock ? size_ - offset : kCopyBlock;
+    PreadAll(file_->GetFd(), &block[0], n, static_cast<off_t>(offset));
+    WriteAll(fd, &block[0], n);
+    offset += n;
+  }
+}
+
+// moves the in-memory bytes to a fresh temporary file
+void SpillBuffer::Spill() {
+  file_ = lib::type::SharedPtr<lib::type::Fd>(
+      new lib::type::Fd(CreateTempFile()));
+  const size_t buffered = size_;
+  size_ = 0;
+  WriteFile(memory_.data(), buffered);
+  std::string().swap(memory_);
+}
+
+// a copy appending to a shared file would overwrite the other's tail
+void SpillBuffer::Unshare() {
+  if (file_.UseCount() <= 1) return;
+  lib::type::SharedPtr<lib::type::Fd> shared = file_;
+  file_ = lib::type::SharedPtr<lib::type::Fd>(
+      new lib::type::Fd(CreateTempFile()));
+  const size_t total = size_;
+  size_ = 0;
+  std::vector<char> block(kCopyBlock);
+  for (size_t offset = 0; offset < total;) {
+    const size_t n = total - offset < kCopyBlock ? total - offset : kCopyBlock;
+    PreadAll(shared->GetFd(), &block[0], n, static_cast<off_t>(offset));
+    WriteFile(&block[0], n);
+    offset += n;
+  }
+}
+
+void SpillBuffer::WriteFile(const char* data, size_t len) {
+  PwriteAll(file_->GetFd(), data, len, static_cast<off_t>(size_));
+  size_ += len;
+}
+
+}  // namespace io
+}  // namespace lib
@@ -0,0 +1,75 @@
+#include "lib/io/SplicePipe.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace lib {
+namespace io {
+
+namespace {
+
+const size_t kDefaultPipeSize = 65536;
+
+}  // namespace
+
+SplicePipe::SplicePipe()
+    : read_end_(), write_end_(), capacity_(0), size_(0), full_(false) {
+  int fds[2];
+  if (pipe2(fds, O_NONBLOCK | O_CLOEXEC) == -1) {
+    throw std::runtime_error(std::string("pipe2: ") + std::strerror(errno));
+  }
+  read_end_.Reset(fds[0]);
+  write_end_.Reset(fds[1]);
+  fcntl(write_end_.GetFd(), F_SETPIPE_SZ, kCapacity);
+  const int size = fcntl(write_end_.GetFd(), F_GETPIPE_SZ);
+  capacity_ = size > 0 ? static_cast<size_t>(size) : kDefaultPipeSize;
+}
+
+SplicePipe::~SplicePipe() {
+}
+
+ssize_t SplicePipe::FillFrom(int in) {
+  if (size_ >= capacity_) {
+    full_ = true;
+    errno = EAGAIN;
+    return -1;
+  }
+  const ssize_t n =
+      splice(in, NULL, write_end_.GetFd(), NULL, capacity_ - size_,
+             SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  if (n > 0) {
+    size_ += n;
+  } else if (n == -1 && errno == EAGAIN && size_ > 0) {
+    // the caller saw in readable; an empty pipe always has room
+    full_ = true;
+  }
+  return n;
+}
+
+ssize_t SplicePipe::DrainTo(int out, size_t max) {
+  if (max > size_) max = size_;
+  if (max == 0) return 0;
+  const ssize_t n = splice(read_end_.GetFd(), NULL, out, NULL, max,
+                           SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  if (n > 0) {
+    size_ -= n;
+    full_ = false;
+  }
+  return n;
+}
+
+size_t SplicePipe::Size() const {
+  return size_;
+}
+
+bool SplicePipe::IsFull() const {
+  return full_;
+}
+
+}  // namespace io
+}  // namespace lib
@@ -0,0 +1,100 @@
+#include "lib/io/StatCache.hpp"
+
+#include <map>
+
+#include "lib/thread/Mutex.hpp"
+
+namespace lib {
+namespace io {
+
+const time_t StatCache::kValidSeconds;
+const size_t StatCache::kMaxEntries;
+
+namespace {
+
+struct Entry {
+  time_t checked_at;
+  bool exists;
+  struct stat st;
+};
+
+typedef std::map<std::string, Entry> EntryMap;
+
+EntryMap& Entries() {
+  static EntryMap entries;
+  return entries;
+}
+
+CacheStats& Counters() {
+  static CacheStats stats;
+  return stats;
+}
+
+// guards the entries and counters, not the stat() call
+lib::thread::Mutex& CacheMutex() {
+  static lib::thread::Mutex mutex;
+  return mutex;
+}
+
+// make room by dropping expired entries; start over if all are fresh
+void Evict(EntryMap& entries, time_t now) {
+  for (EntryMap::iterator it = entries.begin(); it != entries.end();) {
+    if (now - it->second.checked_at >= StatCache::kValidSeconds) {
+      entries.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  if (entries.size() >= StatCache::kMaxEntries) entries.clear();
+}
+
+}  // namespace
+
+bool StatCache::Lookup(const std::string& path, struct stat* st) {
+  EntryMap& entries = Entries();
+  const time_t now = std::time(NULL);
+  {
+    lib::thread::ScopedLock lock(CacheMutex());
+    EntryMap::iterator it = entries.find(path);
+    if (it != entries.end() && now - it->second.checked_at < kValidSeconds) {
+      ++Counters().hits;
+      if (it->second.exists) *st = it->second.st;
+      return it->second.exists;
+    }
+    ++Counters().misses;
+  }
+
+  Entry entry;
+  entry.checked_at = now;
+  entry.exists = (stat(path.c_str(), &entry.st) == 0);
+  {
+    lib::thread::ScopedLock lock(CacheMutex());
+    EntryMap::iterator it = entries.find(path);
+    if (it != entries.end()) {
+      it->second = entry;
+    } else {
+      if (entries.size() >= kMaxEntries) Evict(entries, now);
+      entries.insert(std::make_pair(path, entry));
+    }
+  }
+  if (entry.exists) *st = entry.st;
+  return entry.exists;
+}
+
+void StatCache::Clear() {
+  lib::thread::ScopedLock lock(CacheMutex());
+  Entries().clear();
+}
+
+size_t StatCache::Size() {
+  lib::thread::ScopedLock lock(CacheMutex());
+  return Entries().size();
+}
+
+CacheStats StatCache::Stats() {
+  lib::thread::ScopedLock lock(CacheMutex());
+  return Counters();
+}
+
+}  // namespace io
+}  // namespace lib
@@ -0,0 +1,35 @@
+#include "lib/logging/Logging.hpp"
+
+#include <stdexcept>
+
+namespace lib {
+namespace logging {
+
+namespace {
+
+Level g_level = kInfo;
+
+}  // namespace
+
+void SetLevel(Level level) {
+  g_level = level;
+}
+
+Level GetLevel() {
+  return g_level;
+}
+
+bool IsEnabled(Level level) {
+  return level >= g_level;
+}
+
+Level ParseLevel(const std::string& name) {
+  if (name == "debug") return kDebug;
+  if (name == "info") return kInfo;
+  if (name == "warn") return kWarn;
+  if (name == "error") return kError;
+  throw std::runtime_error("Invalid log_level value: " + name);
+}
+
+}  // namespace logging
+}  // namespace lib
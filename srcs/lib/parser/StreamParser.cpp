@@ -16,6 +16,7 @@ StreamParser::~StreamParser() {
 }
 
 void StreamParser::Parse(const char* data, size_t len) {
+  Compact();
   buffer_.append(data, len);
   for (;;) {
     switch (state_) {
@@ -35,6 +36,28 @@ void StreamParser::Parse(const char* data, size_t len) {
   }
 }
 
+void StreamParser::Consume(size_t n) {
+  buffer_read_pos_ += n;
+}
+
+size_t StreamParser::UnreadSize() const {
+  return buffer_.size() - buffer_read_pos_;
+}
+
+// read bytes are dropped once they are at least half of buffer_, so every
+// byte is moved at most once on average
+void StreamParser::Compact() {
+  if (buffer_read_pos_ == 0) return;
+  if (buffer_read_pos_ >= buffer_.size()) {
+    buffer_.clear();
+  } else if (buffer_read_pos_ * 2 >= buffer_.size()) {
+    buffer_.erase(0, buffer_read_pos_);
+  } else {
+    return;
+  }
+  buffer_read_pos_ = 0;
+}
+
 bool StreamParser::IsCRLF(const char* p) const {
   return p != NULL && p[0] == '\r' && p[1] == '\n';
 }
@@ -0,0 +1,43 @@
+#include "lib/thread/Mutex.hpp"
+
+namespace lib {
+namespace thread {
+
+Mutex::Mutex() {
+  pthread_mutex_init(&mutex_, NULL);
+}
+
+Mutex::~Mutex() {
+  pthread_mutex_destroy(&mutex_);
+}
+
+void Mutex::Lock() {
+  pthread_mutex_lock(&mutex_);
+}
+
+void Mutex::Unlock() {
+  pthread_mutex_unlock(&mutex_);
+}
+
+Condition::Condition() {
+  pthread_cond_init(&cond_, NULL);
+}
+
+Condition::~Condition() {
+  pthread_cond_destroy(&cond_);
+}
+
+void Condition::Wait(Mutex& mutex) {
+  pthread_cond_wait(&cond_, &mutex.mutex_);
+}
+
+void Condition::Signal() {
+  pthread_cond_signal(&cond_);
+}
+
+void Condition::Broadcast() {
+  pthread_cond_broadcast(&cond_);
+}
+
+}  // namespace thread
+}  // namespace lib
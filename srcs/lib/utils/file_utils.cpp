@@ -1,5 +1,9 @@
 #include "lib/utils/file_utils.hpp"
 
+#include <fcntl.h>
+
+#include "lib/type/Fd.hpp"
+
 namespace lib {
 namespace utils {
 
@@ -62,15 +66,26 @@ std::string ReadFileToStringOrThrow(const std::string& filename) {
   struct stat buffer = StatOrThrow(filename);
   EnsureRegularFileOrThrowForbidden(buffer);
   EnsureAccessOrThrow(filename, R_OK);
-  std::ifstream file(filename.c_str());
-  if (!file.is_open()) {  // errno might be unreliable here
+  // close-on-exec: an aio thread may read while the loop spawns a script
+  lib::type::Fd fd(open(filename.c_str(), O_RDONLY | O_CLOEXEC));
+  if (fd.GetFd() == -1) {
     int saved_errno = errno;
     throw lib::exception::ResponseStatusException(
         MapErrnoToHttpStatus(saved_errno));
   }
-  std::string content((std::istreambuf_iterator<char>(file)),
-                      std::istreambuf_iterator<char>());
-  file.close();
+  std::string content;
+  content.reserve(buffer.st_size);
+  char chunk[8192];
+  ssize_t n;
+  while ((n = read(fd.GetFd(), chunk, sizeof(chunk))) != 0) {
+    if (n == -1) {
+      if (errno == EINTR) continue;
+      int saved_errno = errno;
+      throw lib::exception::ResponseStatusException(
+          MapErrnoToHttpStatus(saved_errno));
+    }
+    content.append(chunk, n);
+  }
   return content;
 }
 
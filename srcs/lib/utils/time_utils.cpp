@@ -0,0 +1,16 @@
+#include "lib/utils/time_utils.hpp"
+
+#include <time.h>
+
+namespace lib {
+namespace utils {
+
+uint64_t MonotonicMicros() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000u +
+         static_cast<uint64_t>(ts.tv_nsec) / 1000u;
+}
+
+}  // namespace utils
+}  // namespace lib
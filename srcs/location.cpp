@@ -1,22 +1,79 @@
 #include "Location.hpp"
 
+const int Location::kDefaultCgiReadTimeout;
+const size_t Location::kDefaultCgiQueueSize;
+const int Location::kDefaultCgiQueueTimeout;
+const size_t Location::kDefaultCgiCacheMaxEntries;
+const char* const Location::kDefaultCgiCacheKey =
+    "$request_method $http_host $request_uri";
+
 Location::Location()
     : methods_(),
       name_("/"),
       root_("./"),
       autoindex_(false),
+      autoindex_format_("html"),
       index_file_(),
       upload_path_(),
       redirect_(),
       redirect_status_(lib::http::kFound),
       cgi_enabled_(false),
       cgi_allowed_extensions_(),
+      cgi_read_timeout_(kDefaultCgiReadTimeout),
+      cgi_total_timeout_(0),
+      cgi_max_concurrent_(0),
+      cgi_queue_size_(kDefaultCgiQueueSize),
+      cgi_queue_timeout_(kDefaultCgiQueueTimeout),
+      cgi_limiter_(),
+      cgi_cache_ttl_(0),
+      cgi_cache_stale_(0),
+      cgi_cache_max_entries_(kDefaultCgiCacheMaxEntries),
+      cgi_cache_key_(kDefaultCgiCacheKey),
+      cgi_cache_(),
+      gzip_static_(false),
+      brotli_static_(false),
+      stub_status_(),
+      internal_(false),
+      metrics_id_(0),
       has_allowed_methods_(false),
       has_root_(false),
       has_autoindex_(false),
+      has_autoindex_format_(false),
       has_index_directive_(false),
       has_upload_path_(false),
       has_redirect_(false),
       has_cgi_enabled_(false),
-      has_cgi_allowed_extensions_(false) {
+      has_cgi_allowed_extensions_(false),
+      has_cgi_read_timeout_(false),
+      has_cgi_total_timeout_(false),
+      has_cgi_max_concurrent_(false),
+      has_cgi_queue_size_(false),
+      has_cgi_queue_timeout_(false),
+      has_cgi_cache_(false),
+      has_cgi_cache_key_(false),
+      has_gzip_static_(false),
+      has_brotli_static_(false),
+      has_stub_status_(false),
+      has_internal_(false) {
+}
+
+bool Location::ParseOnOff(const std::string& directive,
+                          const std::string& value) {
+  if (value != "on" && value != "off") {
+    throw std::runtime_error("Invalid " + directive + " value: " + value);
+  }
+  return value == "on";
+}
+
+void Location::SetCgiCacheKey(const std::string& format) {
+  if (has_cgi_cache_key_) {
+    throw std::runtime_error("Duplicate cgi_cache_key directive");
+  }
+  try {
+    cgi_cache_key_ = access_log::LogFormat(format);
+  } catch (const std::runtime_error& e) {
+    throw std::runtime_error(std::string("Invalid cgi_cache_key: ") +
+                             e.what());
+  }
+  has_cgi_cache_key_ = true;
 }
@@ -10,7 +10,7 @@ int main(int argc, char* argv[]) {
 
     std::cout << "Loading configuration from: " << config_file << std::endl;
 
-    Webserv webserver(config_file);
+    Webserv webserver(config_file, argv[0]);
     webserver.Run();
 
   } catch (const std::exception& e) {
@@ -0,0 +1,201 @@
+#include <sstream>
+
+#include "metrics/Metrics.hpp"
+
+namespace metrics {
+
+namespace {
+
+const double kMicrosPerSecond = 1000000.0;
+
+std::string EscapeLabel(const std::string& value) {
+  std::string out;
+  for (size_t i = 0; i < value.size(); ++i) {
+    if (value[i] == '\\' || value[i] == '"') {
+      out += '\\';
+      out += value[i];
+    } else if (value[i] == '\n') {
+      out += "\\n";
+    } else {
+      out += value[i];
+    }
+  }
+  return out;
+}
+
+void WriteHeader(std::ostringstream& oss, const char* name, const char* type,
+                 const char* help) {
+  oss << "# HELP " << name << ' ' << help << '\n';
+  oss << "# TYPE " << name << ' ' << type << '\n';
+}
+
+void WriteCounter(std::ostringstream& oss, const char* name, const char* help,
+                  uint64_t value) {
+  WriteHeader(oss, name, "counter", help);
+  oss << name << ' ' << value << '\n';
+}
+
+// labels: "" or `key="value"` without braces
+void WriteHistogram(std::ostringstream& oss, const char* name,
+                    const std::string& labels, const Histogram& histogram) {
+  const std::string sep = labels.empty() ? "" : ",";
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i + 1 < Histogram::kBucketCount; ++i) {
+    cumulative += histogram.BucketValue(i);
+    oss << name << "_bucket{" << labels << sep << "le=\""
+        << Histogram::BucketUpperBound(i) / kMicrosPerSecond << "\"} "
+        << cumulative << '\n';
+  }
+  oss << name << "_bucket{" << labels << sep << "le=\"+Inf\"} "
+      << histogram.Count() << '\n';
+  const std::string braced = labels.empty() ? "" : "{" + labels + "}";
+  oss << name << "_sum" << braced << ' '
+      << histogram.Sum() / kMicrosPerSecond << '\n';
+  oss << name << "_count" << braced << ' ' << histogram.Count() << '\n';
+}
+
+}  // namespace
+
+std::string RenderStubStatus(const Snapshot& snapshot) {
+  std::ostringstream oss;
+  oss << "Active connections: " << snapshot.ActiveConnections() << " \n"
+      << "server accepts handled requests\n"
+      << ' ' << snapshot.counters[kConnectionsAccepted] << ' '
+      << snapshot.counters[kConnectionsHandled] << ' ' << snapshot.Requests()
+      << " \n";
+  return oss.str();
+}
+
+std::string RenderPrometheus(const Snapshot& snapshot) {
+  std::ostringstream oss;
+  oss.precision(10);
+
+  WriteHeader(oss, "webserv_connections_active", "gauge",
+              "Client connections currently open.");
+  oss << "webserv_connections_active " << snapshot.ActiveConnections()
+      << '\n';
+  WriteCounter(oss, "webserv_connections_accepted_total",
+               "Connections accepted.",
+               snapshot.counters[kConnectionsAccepted]);
+  WriteCounter(oss, "webserv_connections_handled_total",
+               "Accepted connections that were served.",
+               snapshot.counters[kConnectionsHandled]);
+
+  WriteHeader(oss, "webserv_requests_total", "counter",
+              "Responses sent, by status code.");
+  for (std::map<int, uint64_t>::const_iterator it =
+           snapshot.requests_by_status.begin();
+       it != snapshot.requests_by_status.end(); ++it) {
+    oss << "webserv_requests_total{code=\"" << it->first << "\"} "
+        << it->second << '\n';
+  }
+
+  WriteCounter(oss, "webserv_received_bytes_total",
+               "Bytes read from clients.", snapshot.counters[kBytesReceived]);
+  WriteCounter(oss, "webserv_sent_bytes_total", "Bytes written to clients.",
+               snapshot.counters[kBytesSent]);
+  WriteCounter(oss, "webserv_cgi_spawned_total", "CGI processes started.",
+               snapshot.counters[kCgiSpawned]);
+  WriteCounter(oss, "webserv_cgi_timeouts_total",
+               "CGI processes stopped by cgi_read_timeout or "
+               "cgi_total_timeout.",
+               snapshot.counters[kCgiTimeouts]);
+  WriteHeader(oss, "webserv_cgi_duration_seconds", "histogram",
+              "Time from CGI start until the script exited.");
+  WriteHistogram(oss, "webserv_cgi_duration_seconds", "",
+                 snapshot.cgi_duration);
+  WriteHeader(oss, "webserv_cgi_queue_depth", "gauge",
+              "Requests waiting for a cgi_max_concurrent slot.");
+  oss << "webserv_cgi_queue_depth "
+      << snapshot.counters[kCgiQueued] - snapshot.counters[kCgiDequeued]
+      << '\n';
+  WriteCounter(oss, "webserv_cgi_queued_total",
+               "Requests that waited for a cgi_max_concurrent slot.",
+               snapshot.counters[kCgiQueued]);
+  WriteCounter(oss, "webserv_cgi_rejected_total",
+               "Requests refused because the CGI queue was full.",
+               snapshot.counters[kCgiRejected]);
+  WriteHeader(oss, "webserv_cgi_queue_wait_seconds", "histogram",
+              "Time requests waited for a cgi_max_concurrent slot.");
+  WriteHistogram(oss, "webserv_cgi_queue_wait_seconds", "",
+                 snapshot.cgi_queue_wait);
+  WriteHeader(oss, "webserv_cgi_cache_requests_total", "counter",
+              "cgi_cache lookups by result.");
+  oss << "webserv_cgi_cache_requests_total{result=\"hit\"} "
+      << snapshot.counters[kCgiCacheHits] << '\n'
+      << "webserv_cgi_cache_requests_total{result=\"stale\"} "
+      << snapshot.counters[kCgiCacheStale] << '\n'
+      << "webserv_cgi_cache_requests_total{result=\"miss\"} "
+      << snapshot.counters[kCgiCacheMisses] << '\n'
+      << "webserv_cgi_cache_requests_total{result=\"collapsed\"} "
+      << snapshot.counters[kCgiCacheCollapsed] << '\n';
+  WriteCounter(oss, "webserv_cgi_spliced_bytes_total",
+               "CGI body bytes relayed to clients without user-space copies.",
+               snapshot.counters[kCgiBytesSpliced]);
+
+  WriteHeader(oss, "webserv_cache_hits_total", "counter",
+              "Cache lookups answered from the cache.");
+  for (size_t i = 0; i < snapshot.caches.size(); ++i) {
+    oss << "webserv_cache_hits_total{cache=\"" << snapshot.caches[i].first
+        << "\"} " << snapshot.caches[i].second.hits << '\n';
+  }
+  WriteHeader(oss, "webserv_cache_misses_total", "counter",
+              "Cache lookups that went to the filesystem.");
+  for (size_t i = 0; i < snapshot.caches.size(); ++i) {
+    oss << "webserv_cache_misses_total{cache=\"" << snapshot.caches[i].first
+        << "\"} " << snapshot.caches[i].second.misses << '\n';
+  }
+  WriteHeader(oss, "webserv_cache_hit_ratio", "gauge",
+              "Hits over lookups since start (0 before the first lookup).");
+  for (size_t i = 0; i < snapshot.caches.size(); ++i) {
+    const lib::io::CacheStats& stats = snapshot.caches[i].second;
+    const uint64_t lookups = stats.hits + stats.misses;
+    oss << "webserv_cache_hit_ratio{cache=\"" << snapshot.caches[i].first
+        << "\"} "
+        << (lookups == 0 ? 0.0
+                         : static_cast<double>(stats.hits) / lookups)
+        << '\n';
+  }
+
+  WriteHeader(oss, "webserv_request_duration_seconds", "histogram",
+              "Time from the first request byte until the connection "
+              "closed, by location.");
+  for (size_t i = 0; i < snapshot.request_duration.size(); ++i) {
+    WriteHistogram(oss, "webserv_request_duration_seconds",
+                   "location=\"" +
+                       EscapeLabel(snapshot.request_duration[i].first) + "\"",
+                   snapshot.request_duration[i].second);
+  }
+
+  WriteHeader(oss, "webserv_request_phase_duration_seconds", "histogram",
+              "Time spent between request phases (see trace/Trace.hpp).");
+  for (size_t i = 0; i < trace::kSpanCount; ++i) {
+    WriteHistogram(oss, "webserv_request_phase_duration_seconds",
+                   std::string("phase=\"") +
+                       trace::SpanName(static_cast<trace::Span>(i)) + "\"",
+                   snapshot.phase_duration[i]);
+  }
+
+  WriteCounter(oss, "webserv_aio_rejected_total",
+               "Requests refused because the aio queue was full.",
+               snapshot.counters[kAioRejected]);
+  WriteHeader(oss, "webserv_aio_wait_seconds", "histogram",
+              "Time aio tasks waited for a pool thread, by operation.");
+  for (size_t i = 0; i < aio::kOpCount; ++i) {
+    WriteHistogram(oss, "webserv_aio_wait_seconds",
+                   std::string("op=\"") +
+                       aio::OpName(static_cast<aio::Op>(i)) + "\"",
+                   snapshot.aio_wait[i]);
+  }
+  WriteHeader(oss, "webserv_aio_run_seconds", "histogram",
+              "Time aio tasks ran on a pool thread, by operation.");
+  for (size_t i = 0; i < aio::kOpCount; ++i) {
+    WriteHistogram(oss, "webserv_aio_run_seconds",
+                   std::string("op=\"") +
+                       aio::OpName(static_cast<aio::Op>(i)) + "\"",
+                   snapshot.aio_run[i]);
+  }
+  return oss.str();
+}
+
+}  // namespace metrics
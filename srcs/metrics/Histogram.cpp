@@ -0,0 +1,82 @@
+#include "metrics/Histogram.hpp"
+
+namespace metrics {
+
+const size_t Histogram::kSubBucketBits;
+const size_t Histogram::kSubBuckets;
+const size_t Histogram::kBucketCount;
+
+Histogram::Histogram() {
+  Clear();
+}
+
+/*
+Values below kSubBuckets get a bucket each. Above that, the position of the
+highest set bit picks the power of two and the kSubBucketBits bits below it
+pick the sub-bucket.
+*/
+size_t Histogram::BucketIndex(uint64_t value) {
+  if (value < kSubBuckets) return static_cast<size_t>(value);
+  size_t msb = 0;
+  for (uint64_t v = value; v > 1; v >>= 1) ++msb;
+  const size_t shift = msb - kSubBucketBits;
+  const size_t sub = static_cast<size_t>(value >> shift) & (kSubBuckets - 1);
+  const size_t index = ((shift + 1) << kSubBucketBits) + sub;
+  return index < kBucketCount ? index : kBucketCount - 1;
+}
+
+uint64_t Histogram::BucketUpperBound(size_t index) {
+  if (index < kSubBuckets) return index + 1;
+  const size_t shift = (index >> kSubBucketBits) - 1;
+  const uint64_t sub = index & (kSubBuckets - 1);
+  return (kSubBuckets + sub + 1) << shift;
+}
+
+void Histogram::Record(uint64_t value) {
+  ++buckets_[BucketIndex(value)];
+  ++count_;
+  sum_ += value;
+}
+
+void Histogram::Merge(const Histogram& other) {
+  for (size_t i = 0; i < kBucketCount; ++i) {
+    buckets_[i] += other.buckets_[i];
+  }
+  count_ += other.count_;
+  sum_ += other.sum_;
+}
+
+void Histogram::Clear() {
+  for (size_t i = 0; i < kBucketCount; ++i) {
+    buckets_[i] = 0;
+  }
+  count_ = 0;
+  sum_ = 0;
+}
+
+uint64_t Histogram::Count() const {
+  return count_;
+}
+
+uint64_t Histogram::Sum() const {
+  return sum_;
+}
+
+uint64_t Histogram::BucketValue(size_t index) const {
+  return index < kBucketCount ? buckets_[index] : 0;
+}
+
+uint64_t Histogram::ValueAtQuantile(double fraction) const {
+  if (count_ == 0) return 0;
+  const double wanted = fraction * static_cast<double>(count_);
+  uint64_t rank = static_cast<uint64_t>(wanted);
+  if (rank < wanted || rank == 0) ++rank;
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBucketCount; ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) return BucketUpperBound(i);
+  }
+  return BucketUpperBound(kBucketCount - 1);
+}
+
+}  // namespace metrics
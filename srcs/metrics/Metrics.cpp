@@ -0,0 +1,192 @@
+#include "metrics/Metrics.hpp"
+
+#include "Worker.hpp"
+#include "autoindex/ListingCache.hpp"
+#include "lib/io/MappedFile.hpp"
+#include "lib/io/StatCache.hpp"
+
+namespace metrics {
+
+namespace {
+
+const size_t kCacheLineSize = 64;
+const int kMinStatus = 100;
+const int kMaxStatus = 599;
+const size_t kStatusCount = kMaxStatus - kMinStatus + 1;
+
+struct WorkerSlot {
+  uint64_t counters[kCounterCount];
+  uint64_t statuses[kStatusCount];
+  Histogram cgi_duration;
+  Histogram cgi_queue_wait;
+  Histogram request_duration[kMaxLocations];
+  Histogram phase_duration[trace::kSpanCount];
+  Histogram aio_wait[aio::kOpCount];
+  Histogram aio_run[aio::kOpCount];
+
+  WorkerSlot() {
+    Clear();
+  }
+
+  void Clear() {
+    for (size_t i = 0; i < kCounterCount; ++i) counters[i] = 0;
+    for (size_t i = 0; i < kStatusCount; ++i) statuses[i] = 0;
+    cgi_duration.Clear();
+    cgi_queue_wait.Clear();
+    for (size_t i = 0; i < kMaxLocations; ++i) request_duration[i].Clear();
+    for (size_t i = 0; i < trace::kSpanCount; ++i) phase_duration[i].Clear();
+    for (size_t i = 0; i < aio::kOpCount; ++i) {
+      aio_wait[i].Clear();
+      aio_run[i].Clear();
+    }
+  }
+} __attribute__((aligned(kCacheLineSize)));
+
+WorkerSlot* Slots() {
+  static WorkerSlot slots[worker::kMaxWorkers];
+  return slots;
+}
+
+WorkerSlot& CurrentSlot() {
+  return Slots()[worker::Current()];
+}
+
+// index = LocationId; written at config load only
+std::vector<std::string>& LocationNames() {
+  static std::vector<std::string> names(1, "none");
+  return names;
+}
+
+}  // namespace
+
+void Add(Counter counter, uint64_t n) {
+  CurrentSlot().counters[counter] += n;
+}
+
+void Increment(Counter counter) {
+  ++CurrentSlot().counters[counter];
+}
+
+void RecordRequest(LocationId location, int status, uint64_t micros) {
+  WorkerSlot& slot = CurrentSlot();
+  if (status >= kMinStatus && status <= kMaxStatus) {
+    ++slot.statuses[status - kMinStatus];
+  }
+  if (location >= kMaxLocations) location = kMaxLocations - 1;
+  slot.request_duration[location].Record(micros);
+}
+
+void RecordCgiDuration(uint64_t micros) {
+  CurrentSlot().cgi_duration.Record(micros);
+}
+
+void RecordCgiQueueWait(uint64_t micros) {
+  CurrentSlot().cgi_queue_wait.Record(micros);
+}
+
+void RecordTrace(const trace::Trace& trace) {
+  WorkerSlot& slot = CurrentSlot();
+  for (size_t i = 0; i < trace::kSpanCount; ++i) {
+    uint64_t micros;
+    if (trace.Duration(static_cast<trace::Span>(i), &micros)) {
+      slot.phase_duration[i].Record(micros);
+    }
+  }
+}
+
+void RecordAio(aio::Op op, uint64_t wait_micros, uint64_t run_micros) {
+  WorkerSlot& slot = CurrentSlot();
+  slot.aio_wait[op].Record(wait_micros);
+  slot.aio_run[op].Record(run_micros);
+}
+
+LocationId RegisterLocation(const std::string& name) {
+  std::vector<std::string>& names = LocationNames();
+  for (size_t i = 1; i < names.size(); ++i) {
+    if (names[i] == name) return i;
+  }
+  if (names.size() == kMaxLocations - 1) names.push_back("other");
+  if (names.size() == kMaxLocations) return kMaxLocations - 1;
+  names.push_back(name);
+  return names.size() - 1;
+}
+
+Snapshot::Snapshot() : cgi_duration(), cgi_queue_wait() {
+  for (size_t i = 0; i < kCounterCount; ++i) counters[i] = 0;
+}
+
+uint64_t Snapshot::Requests() const {
+  uint64_t total = 0;
+  for (std::map<int, uint64_t>::const_iterator it =
+           requests_by_status.begin();
+       it != requests_by_status.end(); ++it) {
+    total += it->second;
+  }
+  return total;
+}
+
+uint64_t Snapshot::ActiveConnections() const {
+  return counters[kConnectionsHandled] - counters[kConnectionsClosed];
+}
+
+/*
+Reads other workers' slots without synchronization: a counter may be one
+increment behind, which a scrape tolerates, and 64-bit aligned loads do not
+tear on the platforms we run on.
+*/
+Snapshot Collect() {
+  Snapshot snapshot;
+  uint64_t statuses[kStatusCount] = {0};
+  Histogram request_duration[kMaxLocations];
+  const WorkerSlot* slots = Slots();
+  for (size_t w = 0; w < worker::kMaxWorkers; ++w) {
+    const WorkerSlot& slot = slots[w];
+    for (size_t i = 0; i < kCounterCount; ++i) {
+      snapshot.counters[i] += slot.counters[i];
+    }
+    for (size_t i = 0; i < kStatusCount; ++i) {
+      statuses[i] += slot.statuses[i];
+    }
+    snapshot.cgi_duration.Merge(slot.cgi_duration);
+    snapshot.cgi_queue_wait.Merge(slot.cgi_queue_wait);
+    for (size_t i = 0; i < kMaxLocations; ++i) {
+      request_duration[i].Merge(slot.request_duration[i]);
+    }
+    for (size_t i = 0; i < trace::kSpanCount; ++i) {
+      snapshot.phase_duration[i].Merge(slot.phase_duration[i]);
+    }
+    for (size_t i = 0; i < aio::kOpCount; ++i) {
+      snapshot.aio_wait[i].Merge(slot.aio_wait[i]);
+      snapshot.aio_run[i].Merge(slot.aio_run[i]);
+    }
+  }
+  for (size_t i = 0; i < kStatusCount; ++i) {
+    if (statuses[i] != 0) {
+      snapshot.requests_by_status[kMinStatus + static_cast<int>(i)] =
+          statuses[i];
+    }
+  }
+  const std::vector<std::string>& names = LocationNames();
+  for (size_t i = 0; i < names.size(); ++i) {
+    if (request_duration[i].Count() != 0) {
+      snapshot.request_duration.push_back(
+          std::make_pair(names[i], request_duration[i]));
+    }
+  }
+  snapshot.caches.push_back(
+      std::make_pair("stat", lib::io::StatCache::Stats()));
+  snapshot.caches.push_back(
+      std::make_pair("mmap", lib::io::MappedFile::CacheCounters()));
+  snapshot.caches.push_back(
+      std::make_pair("autoindex", autoindex::ListingCache::Stats()));
+  return snapshot;
+}
+
+void Reset() {
+  WorkerSlot* slots = Slots();
+  for (size_t w = 0; w < worker::kMaxWorkers; ++w) {
+    slots[w].Clear();
+  }
+}
+
+}  // namespace metrics
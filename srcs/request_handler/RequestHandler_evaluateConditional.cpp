@@ -0,0 +1,30 @@
+#include "RequestHandler.hpp"
+#include "lib/http/ETag.hpp"
+#include "lib/http/HttpDate.hpp"
+
+void RequestHandler::AddValidatorHeaders(HttpResponse& res,
+                                         const struct stat& st) const {
+  res.AddHeader("ETag", lib::http::MakeWeakETag(st));
+  res.AddHeader("Last-Modified", lib::http::FormatHttpDate(st.st_mtime));
+}
+
+/*
+RFC 9110 13.2.2 precedence for GET:
+- If-None-Match, when present, decides alone (weak comparison)
+- otherwise If-Modified-Since: not modified when mtime <= the given date
+  an unparsable date means the header is ignored
+*/
+bool RequestHandler::IsNotModified(const struct stat& st) const {
+  lib::type::Optional<std::string> if_none_match =
+      req_.GetHeader("if-none-match");
+  if (if_none_match.HasValue()) {
+    return lib::http::IfNoneMatchMatches(if_none_match.Value(),
+                                         lib::http::MakeWeakETag(st));
+  }
+  lib::type::Optional<std::string> if_modified_since =
+      req_.GetHeader("if-modified-since");
+  if (!if_modified_since.HasValue()) return false;
+  lib::type::Optional<time_t> since =
+      lib::http::ParseHttpDate(if_modified_since.Value());
+  return since.HasValue() && st.st_mtime <= since.Value();
+}
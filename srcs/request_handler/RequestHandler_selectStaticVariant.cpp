@@ -0,0 +1,64 @@
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Location.hpp"
+#include "RequestHandler.hpp"
+#include "lib/io/StatCache.hpp"
+
+namespace {
+
+struct Variant {
+  lib::http::ContentCoding coding;
+  const char* suffix;
+};
+
+// preferred first when the client weighs both codings equally
+const Variant kVariants[] = {{lib::http::kCodingBrotli, ".br"},
+                             {lib::http::kCodingGzip, ".gz"}};
+
+}  // namespace
+
+/*
+Looks for path + ".br" / ".gz" built at deploy time and returns the coding
+of the best one the client accepts (highest qvalue, brotli on ties).
+Probes go through StatCache, so assets without variants cost no syscalls;
+a variant found there is stat()ed again before it is used. A variant must
+be a readable regular file; otherwise the original is served.
+*/
+lib::http::ContentCoding RequestHandler::SelectStaticVariant(
+    const std::string& path, std::string* variant_path,
+    struct stat* variant_st) const {
+  const Location& loc = *location_match_.loc;
+  if (!loc.GetGzipStatic() && !loc.GetBrotliStatic()) {
+    return lib::http::kCodingIdentity;
+  }
+  lib::type::Optional<std::string> accept = req_.GetHeader("accept-encoding");
+  if (!accept.HasValue()) return lib::http::kCodingIdentity;
+
+  lib::http::ContentCoding best = lib::http::kCodingIdentity;
+  int best_q = 0;
+  for (size_t i = 0; i < sizeof(kVariants) / sizeof(kVariants[0]); ++i) {
+    const Variant& v = kVariants[i];
+    if (v.coding == lib::http::kCodingBrotli && !loc.GetBrotliStatic()) {
+      continue;
+    }
+    if (v.coding == lib::http::kCodingGzip && !loc.GetGzipStatic()) continue;
+    int q = lib::http::AcceptEncodingQvalue(accept.Value(), v.coding);
+    if (q <= best_q) continue;
+
+    struct stat st;
+    const std::string candidate = path + v.suffix;
+    if (!lib::io::StatCache::Lookup(candidate, &st)) continue;
+    // the cached result may be a second old: what is served comes from a
+    // fresh stat() of the file that is actually there now
+    if (stat(candidate.c_str(), &st) == -1 || !S_ISREG(st.st_mode) ||
+        access(candidate.c_str(), R_OK) == -1) {
+      continue;
+    }
+    best = v.coding;
+    best_q = q;
+    *variant_path = candidate;
+    *variant_st = st;
+  }
+  return best;
+}
@@ -0,0 +1,88 @@
+#include <vector>
+
+#include "Location.hpp"
+#include "RequestHandler.hpp"
+#include "autoindex/Autoindex.hpp"
+#include "autoindex/ListingCache.hpp"
+#include "autoindex/ListingProducer.hpp"
+#include "lib/io/DirectoryReader.hpp"
+
+/*
+autoindex on: a directory whose index file does not exist gets a listing.
+Everything else (autoindex off, CGI locations, an existing index file, plain
+files) goes through the regular GET path and keeps its 403/404 behavior.
+*/
+bool RequestHandler::TryServeAutoindex() {
+  const Location& loc = *location_match_.loc;
+  if (!loc.GetAutoIndex() || loc.GetCgiEnabled()) return false;
+
+  struct stat dir_st;
+  if (stat(filesystem_path_.c_str(), &dir_st) != 0 ||
+      !S_ISDIR(dir_st.st_mode)) {
+    return false;
+  }
+  if (!loc.GetIndexFile().empty()) {
+    std::string index_path = filesystem_path_;
+    if (index_path[index_path.size() - 1] != '/') index_path += '/';
+    index_path += loc.GetIndexFile();
+    struct stat index_st;
+    if (stat(index_path.c_str(), &index_st) == 0) return false;
+  }
+  ServeAutoindex(filesystem_path_, dir_st);
+  return true;
+}
+
+/*
+Cached listings are answered without touching the directory. Otherwise the
+entries are read with getdents64 and sorted; small listings are rendered
+right away, large ones are streamed chunked by a ListingProducer so the
+response starts before the whole listing is rendered. Both end up in
+ListingCache.
+*/
+void RequestHandler::ServeAutoindex(const std::string& dir_path,
+                                    const struct stat& dir_st) {
+  std::string dir_uri = req_.GetUri();
+  if (dir_uri[dir_uri.size() - 1] != '/') dir_uri += '/';
+  const autoindex::ListingOptions options =
+      autoindex::ListingOptions::FromQuery(
+          autoindex::FormatFromString(
+              location_match_.loc->GetAutoIndexFormat()),
+          req_.GetQuery());
+  const std::string cache_key =
+      dir_path + '\n' + dir_uri + '\n' + options.CacheKey();
+
+  HttpResponse res;
+  res.AddHeader("Content-Type", autoindex::ContentType(options.format));
+  autoindex::ListingCache::Body cached =
+      autoindex::ListingCache::Find(cache_key, dir_st);
+  if (!cached.IsNull()) {
+    res.SetBody(cached);
+    result_ = ExecResult(res);
+    return;
+  }
+
+  std::vector<lib::io::DirEntry> entries;
+  lib::io::ReadDirectoryOrThrow(dir_path, &entries);
+  autoindex::SortEntries(&entries, options);
+
+  // chunked framing needs HTTP/1.1; 1.0 peers get the listing in one piece
+  if (entries.size() > autoindex::ListingProducer::kEntriesPerProduce &&
+      req_.GetVersion() == "HTTP/1.1") {
+    res.AddHeader("Transfer-Encoding", "chunked");
+    res.SetBodyProducer(lib::type::SharedPtr<lib::io::BodyProducer>(
+        new autoindex::ListingProducer(entries, dir_uri, options, cache_key,
+                                       dir_st)));
+    result_ = ExecResult(res);
+    return;
+  }
+
+  std::string* body = new std::string(autoindex::RenderHead(dir_uri, options));
+  autoindex::ListingCache::Body shared(body);
+  for (size_t i = 0; i < entries.size(); ++i) {
+    autoindex::RenderEntry(dir_uri, entries[i], i == 0, options, body);
+  }
+  *body += autoindex::RenderTail(options);
+  autoindex::ListingCache::Store(cache_key, dir_st, shared);
+  res.SetBody(shared);
+  result_ = ExecResult(res);
+}
@@ -0,0 +1,64 @@
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <map>
+
+#include "Location.hpp"
+#include "RequestHandler.hpp"
+#include "lib/exception/ResponseStatusException.hpp"
+#include "lib/logging/Logging.hpp"
+#include "lib/utils/file_utils.hpp"
+#include "lib/utils/time_utils.hpp"
+
+namespace {
+
+// set by the file response (or its framing) whenever they apply
+bool IsFileHeader(const std::string& name) {
+  return name == "content-length" || name == "transfer-encoding" ||
+         name == "content-type" || name == "content-range" ||
+         name == "content-encoding" || name == "accept-ranges" ||
+         name == "etag" || name == "last-modified" || name == "location";
+}
+
+}  // namespace
+
+/*
+A CGI script answered with X-Accel-Redirect / X-Sendfile: the file at
+internal_uri_ goes out through the static path (mmap, Range, conditional
+GET) with the client's request headers. Only internal locations may be the
+target; any other is a script error (502), like a missing file is a 404.
+*/
+ExecResult RequestHandler::ServeInternalRedirect() {
+  try {
+    location_match_ = conf_.FindLocationForUri(internal_uri_);
+    if (!location_match_.loc->IsInternal()) {
+      WEBSERV_LOG(kWarn) << "CGI redirect to non-internal location: "
+                         << internal_uri_ << std::endl;
+      return ExecResult(HttpResponse(lib::http::kBadGateway));
+    }
+    filesystem_path_ = ResolveFilesystemPath();
+    routed_us_ = lib::utils::MonotonicMicros();
+    struct stat st = lib::utils::StatOrThrow(filesystem_path_);
+    lib::utils::EnsureRegularFileOrThrowForbidden(st);
+    lib::utils::EnsureAccessOrThrow(filesystem_path_, R_OK);
+    ServeStaticFile(filesystem_path_, st);
+    KeepScriptHeaders(result_.response);
+    return result_;
+  } catch (const lib::exception::ResponseStatusException& e) {
+    return ExecResult(HttpResponse(e.GetStatus()));
+  } catch (const std::exception& e) {
+    return ExecResult(HttpResponse(lib::http::kInternalServerError));
+  }
+}
+
+// what the script decided besides the file (Content-Disposition,
+// Cache-Control, Set-Cookie, ...) stays on a successful response
+void RequestHandler::KeepScriptHeaders(HttpResponse& res) const {
+  if (res.GetStatus() >= 400) return;
+  const std::map<std::string, std::string>& headers = script_res_.GetHeaders();
+  for (std::map<std::string, std::string>::const_iterator it = headers.begin();
+       it != headers.end(); ++it) {
+    if (IsFileHeader(it->first) || res.HasHeader(it->first)) continue;
+    res.AddHeader(it->first, it->second);
+  }
+}
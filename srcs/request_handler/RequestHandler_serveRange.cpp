@@ -0,0 +1,89 @@
+#include <ctime>
+#include <vector>
+
+#include "RequestHandler.hpp"
+#include "lib/http/HttpDate.hpp"
+#include "lib/http/Range.hpp"
+#include "lib/io/MappedFile.hpp"
+#include "lib/utils/string_utils.hpp"
+
+namespace {
+
+std::string MakeBoundary() {
+  static unsigned long counter = 0;
+  return "webserv_" + lib::utils::ToString(std::time(NULL)) + "_" +
+         lib::utils::ToString(__sync_add_and_fetch(&counter, 1));
+}
+
+}  // namespace
+
+/*
+RFC 9110 13.1.5 If-Range
+A date matches only when it equals Last-Modified exactly. An entity-tag must
+match with the strong comparison; we only send weak entity-tags, so an
+entity-tag in If-Range always falls back to the full 200 response.
+*/
+bool RequestHandler::IfRangeMatches(const struct stat& st) const {
+  lib::type::Optional<std::string> if_range = req_.GetHeader("if-range");
+  if (!if_range.HasValue()) return true;
+  const std::string& value = if_range.Value();
+  if (!value.empty() &&
+      (value[0] == '"' || lib::utils::StartsWith(value, "W/"))) {
+    return false;
+  }
+  lib::type::Optional<time_t> date = lib::http::ParseHttpDate(value);
+  return date.HasValue() && date.Value() == st.st_mtime;
+}
+
+/*
+Answers a Range request with 206 or 416.
+Returns false when the full representation should be sent instead
+(no Range header, If-Range mismatch, or a Range we choose to ignore).
+Range bodies are slices of the shared mapping: only the requested pages are
+read from disk and nothing is copied into the response.
+*/
+bool RequestHandler::TryServeRange(HttpResponse res, const std::string& path,
+                                   const struct stat& st,
+                                   const std::string& mime_type) {
+  lib::type::Optional<std::string> range_header = req_.GetHeader("range");
+  if (!range_header.HasValue() || !IfRangeMatches(st)) return false;
+
+  const size_t size = static_cast<size_t>(st.st_size);
+  std::vector<lib::http::ByteRange> ranges;
+  lib::http::RangeResult parsed =
+      lib::http::ParseRangeHeader(range_header.Value(), size, &ranges);
+  if (parsed == lib::http::kRangeIgnored) return false;
+
+  if (parsed == lib::http::kRangeUnsatisfiable) {
+    res.SetStatus(lib::http::kRangeNotSatisfiable);  // 416
+    res.RemoveHeader("content-encoding");  // the error page is not encoded
+    res.AddHeader("Content-Range", "bytes */" + lib::utils::ToString(size));
+    res.AddHeader("Content-Type", "text/html");
+    res.EnsureDefaultErrorContent();
+    result_ = ExecResult(res);
+    return true;
+  }
+
+  lib::io::MappedFile file = lib::io::MappedFile::Open(path, st);
+  res.SetStatus(lib::http::kPartialContent);  // 206
+  if (ranges.size() == 1) {
+    res.AddHeader("Content-Type", mime_type);
+    res.AddHeader("Content-Range",
+                  lib::http::ContentRangeValue(ranges[0], size));
+    res.AppendBody(file, ranges[0].first, ranges[0].Length());
+  } else {
+    // RFC 9110 14.6 multipart/byteranges
+    const std::string boundary = MakeBoundary();
+    res.AddHeader("Content-Type", "multipart/byteranges; boundary=" + boundary);
+    for (size_t i = 0; i < ranges.size(); ++i) {
+      res.AppendBody("\r\n--" + boundary + "\r\nContent-Type: " + mime_type +
+                     "\r\nContent-Range: " +
+                     lib::http::ContentRangeValue(ranges[i], size) +
+                     "\r\n\r\n");
+      res.AppendBody(file, ranges[i].first, ranges[i].Length());
+    }
+    res.AppendBody("\r\n--" + boundary + "--\r\n");
+  }
+  result_ = ExecResult(res);
+  return true;
+}
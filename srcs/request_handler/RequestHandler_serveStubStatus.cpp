@@ -0,0 +1,26 @@
+#include "Location.hpp"
+#include "RequestHandler.hpp"
+#include "metrics/Metrics.hpp"
+
+/*
+The page is generated on every request (never cached) and only for GET;
+allowed_methods and the filesystem are ignored in a stub_status location.
+*/
+ExecResult RequestHandler::ServeStubStatus() const {
+  if (req_.GetMethod() != lib::http::kGet) {
+    HttpResponse res(lib::http::kMethodNotAllowed);
+    res.AddHeader("Allow", "GET");
+    return ExecResult(res);
+  }
+  const metrics::Snapshot snapshot = metrics::Collect();
+  HttpResponse res;
+  if (location_match_.loc->GetStubStatus() == "prometheus") {
+    res.SetBody(metrics::RenderPrometheus(snapshot));
+    res.AddHeader("Content-Type", "text/plain; version=0.0.4");
+  } else {
+    res.SetBody(metrics::RenderStubStatus(snapshot));
+    res.AddHeader("Content-Type", "text/plain");
+  }
+  res.AddHeader("Cache-Control", "no-store");
+  return ExecResult(res);
+}
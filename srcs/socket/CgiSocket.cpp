@@ -1,74 +1,294 @@
 #include "socket/CgiSocket.hpp"
 
-#include <sys/epoll.h>
+#include <sys/syscall.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
 #include <cerrno>
+#include <cstring>
 #include <iostream>
 
+#include "CgiReaper.hpp"
+#include "CgiResponseParser.hpp"
+#include "HttpResponse.hpp"
 #include "lib/exception/ResponseStatusException.hpp"
+#include "lib/logging/Logging.hpp"
 #include "lib/type/Fd.hpp"
 #include "lib/utils/file_utils.hpp"
+#include "lib/utils/time_utils.hpp"
+#include "metrics/Metrics.hpp"
 #include "socket/ClientSocket.hpp"
+#include "trace/Trace.hpp"
 
-CgiSocket::CgiSocket(lib::type::Fd fd, int pid)
-    : ASocket(fd), pid_(pid), owner_(NULL) {
+namespace {
+
+// readable once the process exits (Linux 5.3); close-on-exec
+int OpenPidFd(pid_t pid) {
+#ifdef SYS_pidfd_open
+  return static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+#else
+  (void)pid;
+  return -1;
+#endif
+}
+
+}  // namespace
+
+CgiSocket::CgiSocket(lib::type::Fd fd, pid_t pid, int read_timeout,
+                     int total_timeout)
+    : ASocket(fd),
+      pid_(pid),
+      pidfd_(OpenPidFd(pid)),
+      awaiting_exit_(false),
+      read_timeout_(read_timeout),
+      total_timeout_(total_timeout),
+      started_(std::time(NULL)),
+      owner_(NULL),
+      started_us_(lib::utils::MonotonicMicros()),
+      parser_(),
+      headers_sent_(false),
+      paused_(false),
+      limiter_(),
+      cache_fill_() {
 }
 
 CgiSocket::~CgiSocket() {
   if (owner_) {
     owner_->RemoveCgiSocket(this);
   }
-  if (pid_ > 0) {
-    kill(pid_, SIGTERM);
-    waitpid(pid_, NULL, 0);
-  }
+  cgi::CgiReaper::Adopt(pid_);
+  if (!limiter_.IsNull()) limiter_->Release();
 }
 
-SocketResult CgiSocket::HandleEvent(int epoll_fd, uint32_t events) {
+SocketResult CgiSocket::HandleEvent(event::Poller& poller, uint32_t events) {
   SocketResult result;
   try {
-    if (events & EPOLLIN) {
+    if (awaiting_exit_) {
+      int status;
+      if (waitpid(pid_, &status, WNOHANG) != pid_) return result;
+      result.remove_socket = true;
+      poller.Remove(pidfd_.GetFd());
+      OnExit(poller, status);
+      ReleaseSlot(poller);
+      return result;
+    }
+    lib::http::SplicedBody* splice =
+        owner_ && cache_fill_.IsNull() ? owner_->GetCgiSplice() : NULL;
+    if ((events & event::kReadable) && splice != NULL) {
+      SpliceOutput(poller, splice, &result);
+    } else if (events & event::kReadable) {
       char buf[kBufferSize];
       ssize_t n = read(fd_.GetFd(), buf, sizeof(buf));
       if (n > 0) {
-        read_buffer_.append(buf, n);
+        UpdateLastActivity();
+        if (owner_) owner_->GetTrace().Mark(trace::kCgiFirstOutput);
+        OnOutput(poller, buf, n);
       } else {
-        int status;
-        waitpid(pid_, &status, 0);
-        pid_ = -1;
-
-        result.remove_socket = true;
-        if (epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd_.GetFd(), NULL) == -1) {
-          int saved_errno = errno;
-          throw lib::exception::ResponseStatusException(
-              lib::utils::MapErrnoToHttpStatus(saved_errno));
-        }
-
-        if (owner_) {
-          if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
-            owner_->OnCgiExecutionFinished(epoll_fd, read_buffer_);
-          } else {
-            owner_->OnCgiExecutionError(epoll_fd);
-          }
-        }
+        OnOutputEnd(poller, &result);
       }
     }
   } catch (const std::exception& e) {
     std::cerr << "CgiSocket error: " << e.what() << std::endl;
     result.remove_socket = true;
-    if (epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd_.GetFd(), NULL) == -1) {
-      std::cerr << "epoll_ctl error" << std::endl;
+    if (poller.Remove(awaiting_exit_ ? pidfd_.GetFd() : fd_.GetFd()) == -1) {
+      std::cerr << "poller Remove error" << std::endl;
     }
+    NotifyFailure(poller, lib::http::kInternalServerError);
   }
+  if (result.remove_socket) ReleaseSlot(poller);
   return result;
 }
 
+// the header block is held back until it is complete and valid; after that
+// every read goes straight to the client
+void CgiSocket::OnOutput(event::Poller& poller, const char* data, size_t len) {
+  // client gone and nothing to cache: drain until the script exits
+  if (!owner_ && cache_fill_.IsNull()) return;
+  if (headers_sent_) {
+    if (!cache_fill_.IsNull()) cache_fill_->OnBody(data, len);
+    if (owner_) owner_->OnCgiBody(poller, data, len);
+    return;
+  }
+  parser_.Parse(data, len);
+  if (!parser_.IsDone()) return;
+  HttpResponse res = parser_.GetResponse();
+  if (parser_.GetInternalRedirect().HasValue()) {
+    headers_sent_ = true;
+    EndCacheFill(poller, false);
+    if (owner_) {
+      owner_->OnCgiInternalRedirect(poller, res,
+                                    parser_.GetInternalRedirect().Value(),
+                                    parser_.IsSendfile());
+    }
+    return;
+  }
+  cgi::ValidateCgiResponse(res);
+  headers_sent_ = true;
+  if (!cache_fill_.IsNull()) cache_fill_->OnHeaders(res);
+  if (owner_) owner_->OnCgiHeaders(poller, res);
+}
+
+// a spurious wake-up (nothing to read) leaves everything as it is
+void CgiSocket::SpliceOutput(event::Poller& poller,
+                             lib::http::SplicedBody* body,
+                             SocketResult* result) {
+  const ssize_t n = body->Fill(fd_.GetFd());
+  if (n > 0) {
+    UpdateLastActivity();
+    metrics::Add(metrics::kCgiBytesSpliced, n);
+    owner_->OnCgiBodySpliced(poller);
+  } else if (n == -1 && errno == EAGAIN) {
+    if (body->IsFull()) PauseOutput(poller);
+  } else {
+    OnOutputEnd(poller, result);
+  }
+}
+
+/*
+Most scripts have exited by the time their output ends. One that has not
+is waited for through its pidfd, still bounded by cgi_read_timeout. Without
+a pidfd the exit status cannot be awaited: the output counts as complete
+and the script is left to the reaper.
+*/
+void CgiSocket::OnOutputEnd(event::Poller& poller, SocketResult* result) {
+  if (poller.Remove(fd_.GetFd()) == -1) {
+    int saved_errno = errno;
+    throw lib::exception::ResponseStatusException(
+        lib::utils::MapErrnoToHttpStatus(saved_errno));
+  }
+  int status;
+  if (waitpid(pid_, &status, WNOHANG) == pid_) {
+    result->remove_socket = true;
+    OnExit(poller, status);
+    return;
+  }
+  if (pidfd_.GetFd() != -1 &&
+      poller.Add(pidfd_.GetFd(), event::kReadable, this) == 0) {
+    awaiting_exit_ = true;
+    UpdateLastActivity();
+    return;
+  }
+  result->remove_socket = true;
+  cgi::CgiReaper::Adopt(pid_);
+  OnExit(poller, 0);
+}
+
+void CgiSocket::OnExit(event::Poller& poller, int status) {
+  pid_ = -1;
+  const uint64_t exited_us = lib::utils::MonotonicMicros();
+  metrics::RecordCgiDuration(exited_us - started_us_);
+  if (owner_) owner_->GetTrace().MarkAt(trace::kCgiExited, exited_us);
+
+  if (WIFEXITED(status) && WEXITSTATUS(status) == 0 && headers_sent_) {
+    EndCacheFill(poller, true);
+    if (owner_) owner_->OnCgiBodyEnd(poller, true);
+  } else {
+    NotifyFailure(poller, lib::http::kInternalServerError);
+  }
+}
+
+// before the headers the client can still get an error status; afterwards
+// its body can only be cut short
+void CgiSocket::NotifyFailure(event::Poller& poller,
+                              lib::http::Status status) {
+  EndCacheFill(poller, false);
+  if (!owner_) return;
+  if (headers_sent_) {
+    owner_->OnCgiBodyEnd(poller, false);
+  } else {
+    owner_->OnCgiExecutionError(poller, status);
+  }
+}
+
 ssize_t CgiSocket::Send(const std::string& data) {
   return write(fd_.GetFd(), data.c_str(), data.length());
 }
 
 void CgiSocket::OnSetOwner(ClientSocket* owner) {
   owner_ = owner;
+  if (owner_) owner_->GetTrace().MarkAt(trace::kCgiSpawned, started_us_);
+}
+
+bool CgiSocket::IsTimeout(time_t threshold_time) const {
+  (void)threshold_time;  // the location's timeouts apply instead
+  const time_t now = std::time(NULL);
+  if (total_timeout_ > 0 && now - started_ >= total_timeout_) return true;
+  if (paused_ && owner_) return false;
+  return now - last_activity_time_ > read_timeout_;
+}
+
+// a poller may hold on to a descriptor that is closed while still watched;
+// the destructor hands the script to the reaper
+void CgiSocket::HandleTimeout(event::Poller& poller) {
+  if (awaiting_exit_) {
+    poller.Remove(pidfd_.GetFd());
+  } else if (!paused_) {
+    poller.Remove(fd_.GetFd());
+  }
+  metrics::Increment(metrics::kCgiTimeouts);
+  WEBSERV_LOG(kWarn) << "CGI pid " << pid_ << " timed out" << std::endl;
+  NotifyFailure(poller, lib::http::kGatewayTimeout);
+  ReleaseSlot(poller);
+}
+
+// the script never gets read: the client hears about it and the slot
+// goes to the next queued request
+void CgiSocket::OnPollerAddFailed(event::Poller& poller) {
+  NotifyFailure(poller, lib::http::kInternalServerError);
+  ReleaseSlot(poller);
+}
+
+// leaving the poller (instead of an empty event mask) keeps the hangup
+// of a finished script from being reported over and over while paused
+void CgiSocket::PauseOutput(event::Poller& poller) {
+  if (paused_ || awaiting_exit_) return;
+  if (poller.Remove(fd_.GetFd()) == -1) {
+    std::cerr << "poller Remove failed in PauseOutput: "
+              << std::strerror(errno) << std::endl;
+    return;
+  }
+  paused_ = true;
+}
+
+void CgiSocket::ResumeOutput(event::Poller& poller) {
+  if (!paused_) return;
+  if (poller.Add(fd_.GetFd(), event::kReadable, this) == -1) {
+    std::cerr << "poller Add failed in ResumeOutput: "
+              << std::strerror(errno) << std::endl;
+    return;
+  }
+  paused_ = false;
+  UpdateLastActivity();
+}
+
+bool CgiSocket::IsPaused() const {
+  return paused_;
+}
+
+void CgiSocket::HoldSlot(
+    const lib::type::SharedPtr<cgi::CgiLimiter>& limiter) {
+  limiter_ = limiter;
+}
+
+// the next queued request, if any, starts its script
+void CgiSocket::ReleaseSlot(event::Poller& poller) {
+  if (limiter_.IsNull()) return;
+  limiter_->Release(poller);
+  limiter_.Reset();
+}
+
+void CgiSocket::SetCacheFill(
+    const lib::type::SharedPtr<cgi::CacheFill>& fill) {
+  cache_fill_ = fill;
+}
+
+bool CgiSocket::IsCaching() const {
+  return !cache_fill_.IsNull();
+}
+
+// requests collapsed onto this script look the key up again
+void CgiSocket::EndCacheFill(event::Poller& poller, bool complete) {
+  if (cache_fill_.IsNull()) return;
+  cache_fill_->End(poller, complete);
+  cache_fill_.Reset();
 }
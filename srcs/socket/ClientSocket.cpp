@@ -1,6 +1,7 @@
 #include "socket/ClientSocket.hpp"
 
-#include <sys/epoll.h>
+#include <linux/sockios.h>
+#include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <unistd.h>
 
@@ -8,15 +9,28 @@
 #include <cerrno>
 #include <cstddef>
 #include <cstring>
+#include <ctime>
 #include <iostream>
+#include <sstream>
 
-#include "CgiResponseParser.hpp"
+#include "ErrorResponse.hpp"
 #include "RequestHandler.hpp"
+#include "ResponseCompression.hpp"
+#include "access_log/AccessLog.hpp"
+#include "access_log/LogFormat.hpp"
+#include "aio/ThreadPool.hpp"
 #include "lib/exception/ConnectionClosed.hpp"
 #include "lib/exception/ResponseStatusException.hpp"
+#include "lib/http/Chunked.hpp"
+#include "lib/http/ContentCoding.hpp"
+#include "lib/logging/Logging.hpp"
 #include "lib/type/Fd.hpp"
 #include "lib/utils/file_utils.hpp"
+#include "lib/utils/string_utils.hpp"
+#include "lib/utils/time_utils.hpp"
+#include "metrics/Metrics.hpp"
 #include "socket/CgiSocket.hpp"
+#include "trace/Trace.hpp"
 
 namespace {
 
@@ -26,27 +40,225 @@ static const bool kEnableClientSocketDebugLogging = false;
 // Maximum number of bytes of raw data to log to stderr.
 static const std::size_t kMaxDebugLogBytes = 1024;
 
+// free room in the socket send buffer, clamped to [min_size, max_size]:
+// a chunk that fits leaves in one writev() instead of trailing a remainder
+size_t SendWindow(int fd, size_t min_size, size_t max_size) {
+  int sndbuf = 0;
+  socklen_t len = sizeof(sndbuf);
+  int queued = 0;
+  if (getsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, &len) == -1 ||
+      ioctl(fd, SIOCOUTQ, &queued) == -1) {
+    return max_size;
+  }
+  size_t room = sndbuf > queued ? static_cast<size_t>(sndbuf - queued) : 0;
+  return std::max(min_size, std::min(room, max_size));
+}
+
+// a whole RequestHandler::Run() on an aio thread; the request and the
+// config snapshot stay with the connection, which waits for Complete().
+// A script spawned for a connection that never hears back is dropped
+// with the task (its socket hands it to the reaper)
+class HandlerTask : public aio::Task {
+ public:
+  // internal_uri: see RequestHandler::SetInternalRedirect() (empty: none)
+  HandlerTask(aio::Op op, ClientSocket* owner, const ServerConfig& config,
+              const HttpRequest& req, const std::string& internal_uri,
+              const HttpResponse& script_res)
+      : aio::Task(op), owner_(owner), handler_(config, req) {
+    if (!internal_uri.empty()) {
+      handler_.SetInternalRedirect(internal_uri, script_res);
+    }
+  }
+
+  virtual ~HandlerTask() {
+    delete result_.new_socket;
+  }
+
+  virtual void Run() {
+    result_ = handler_.Run();
+  }
+
+  virtual void Complete(event::Poller& poller) {
+    owner_->OnHandlerDone(poller, result_);
+    result_.new_socket = NULL;
+  }
+
+ private:
+  ClientSocket* owner_;
+  RequestHandler handler_;
+  ExecResult result_;
+};
+
+// pages a window of a mapped body into the page cache, so the loop's
+// writev() or deflate finds them there instead of waiting for the disk
+class PrefetchTask : public aio::Task {
+ public:
+  PrefetchTask(ClientSocket* owner, const lib::io::MappedFile& file,
+               size_t offset, size_t length)
+      : aio::Task(aio::kOpRead),
+        owner_(owner),
+        file_(file),
+        offset_(offset),
+        length_(length) {
+  }
+
+  // a file that shrank meanwhile fails writev() with EFAULT afterwards
+  virtual void Run() {
+    file_.Populate(offset_, length_);
+  }
+
+  virtual void Complete(event::Poller& poller) {
+    owner_->OnPrefetchDone(poller);
+  }
+
+ private:
+  ClientSocket* owner_;
+  lib::io::MappedFile file_;
+  size_t offset_;
+  size_t length_;
+};
+
+// false for requests answered without touching the disk (redirect,
+// stub_status); CGI resolves and stats the script, then spawns it
+bool SelectAioOp(const ServerConfig& config, const HttpRequest& req,
+                 aio::Op* op) {
+  try {
+    const Location* loc = config.FindLocationForUri(req.GetUri()).loc;
+    if (loc == NULL || loc->HasRedirect() || loc->HasStubStatus()) {
+      return false;
+    }
+    if (loc->GetCgiEnabled()) {
+      *op = aio::kOpSpawn;
+      return true;
+    }
+  } catch (const std::exception& e) {
+    return false;  // the handler answers it inline
+  }
+  switch (req.GetMethod()) {
+    case lib::http::kGet:
+      *op = aio::kOpRead;
+      return true;
+    case lib::http::kPost:
+      *op = aio::kOpWrite;
+      return true;
+    case lib::http::kDelete:
+      *op = aio::kOpUnlink;
+      return true;
+    default:
+      return false;
+  }
+}
+
 }  // namespace
 
-ClientSocket::ClientSocket(lib::type::Fd fd, const ServerConfig& config,
+ClientSocket::ClientSocket(lib::type::Fd fd,
+                           const ServerConfigSnapshot& config,
                            const std::string& client_ip)
-    : ASocket(fd), config_(config), cgi_socket_(NULL) {
+    : ASocket(fd),
+      config_(config),
+      cgi_socket_(NULL),
+      request_started_(false),
+      trace_(),
+      response_status_(0),
+      response_header_bytes_(0),
+      location_(NULL),
+      bytes_received_(0),
+      bytes_sent_(0),
+      body_producer_(),
+      cgi_body_(),
+      awaiting_cgi_body_(false),
+      cgi_splice_(),
+      handler_in_flight_(false),
+      handler_done_(false),
+      handled_(),
+      prefetch_in_flight_(false),
+      prefetched_(false),
+      cgi_limiter_(),
+      cgi_queued_(false),
+      cgi_slot_held_(false),
+      cgi_admitted_(false),
+      cgi_queue_timeout_(0),
+      cgi_queued_at_(0),
+      cgi_queued_us_(0),
+      cgi_cache_(),
+      cache_key_(),
+      cache_fill_(),
+      cache_waiting_(false),
+      cache_woken_(false),
+      cache_collapsed_(false),
+      refresh_fill_(),
+      refresh_limiter_(),
+      refresh_entry_(),
+      refresh_location_(NULL),
+      internal_uri_(),
+      cgi_head_() {
   req_.SetClientIp(client_ip);
-  req_.SetMaxBodySizeLimit(config_.GetMaxBodySize());
+  req_.SetMaxBodySizeLimit(config_->GetMaxBodySize());
+  trace_.Mark(trace::kAccept);
+  metrics::Increment(metrics::kConnectionsHandled);
 }
 
 ClientSocket::~ClientSocket() {
   if (cgi_socket_) {
     cgi_socket_->OnSetOwner(NULL);
   }
+  // a script the pool spawned for the request no event took up yet
+  if (handler_done_) delete handled_.new_socket;
+  // normally ReleaseCgiSlot() ran already; at shutdown nobody is woken
+  if (cgi_queued_) cgi_limiter_->Cancel(this);
+  if (cgi_slot_held_) cgi_limiter_->Release();
+  // an unfinished fill is abandoned by its destructor
+  if (cache_waiting_) cgi_cache_->Cancel(this);
+  if (!refresh_fill_.IsNull() && !refresh_limiter_.IsNull()) {
+    refresh_limiter_->Release();
+  }
+  // the connection closes once the response is out
+  if (request_started_ && response_status_ != 0) {
+    RecordRequest();
+  }
+  metrics::Increment(metrics::kConnectionsClosed);
 }
 
-SocketResult ClientSocket::HandleEvent(int epoll_fd, uint32_t events) {
+SocketResult ClientSocket::HandleEvent(event::Poller& poller, uint32_t events) {
   UpdateLastActivity();
   SocketResult result;
   try {
-    if (events & EPOLLIN) {
-      SocketResult in_result = HandleEpollIn(epoll_fd);
+    // while awaiting CGI output only the peer closing is watched
+    if ((events & (event::kPeerClosed | event::kHangup | event::kError)) &&
+        !(events & (event::kReadable | event::kWritable))) {
+      throw lib::exception::ConnectionClosed();
+    }
+    if (handler_done_ && !refresh_fill_.IsNull()) {
+      // the refresh script is spawned; the stale entry answers the client
+      handler_done_ = false;
+      result = EndCgiRefresh(poller, handled_.new_socket);
+      handled_ = ExecResult();
+    }
+    if (handler_done_) {
+      handler_done_ = false;
+      const bool is_async = handled_.is_async;
+      result = OnRequestHandled(poller, handled_);
+      handled_ = ExecResult();
+      if (is_async) {
+        // the script's output wakes the socket; until then, as inline
+        WatchEvents(poller, event::kReadable);
+        return result;
+      }
+    }
+    if (cgi_admitted_) {
+      // back to the interest the request had when it was read
+      cgi_admitted_ = false;
+      WatchEvents(poller, event::kReadable);
+      return RunHandler(poller);
+    }
+    if (cache_woken_) {
+      cache_woken_ = false;
+      cache_collapsed_ = true;
+      WatchEvents(poller, event::kReadable);
+      return DispatchRequest(poller);
+    }
+    if (events & event::kReadable) {
+      SocketResult in_result = HandleEpollIn(poller);
       if (in_result.new_socket) {
         result.new_socket = in_result.new_socket;
       }
@@ -54,39 +266,41 @@ SocketResult ClientSocket::HandleEvent(int epoll_fd, uint32_t events) {
         result.remove_socket = true;
       }
     }
-    if (events & EPOLLOUT) {
-      HandleEpollOut();
+    if (events & event::kWritable) {
+      HandleEpollOut(poller);
     }
   } catch (const lib::exception::ResponseStatusException& e) {  // 413/400/500
     res_ = HttpResponse(e.GetStatus());
     res_.AddHeader("Connection", "close");
-    res_.AddHeader("Content-Type", "text/html");
-    res_.EnsureDefaultErrorContent();
-    write_buffer_ = res_.ToHttpString();
-    epoll_event ev;
-    ev.events = EPOLLOUT;
-    ev.data.ptr = this;
-    if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd_.GetFd(), &ev) == -1) {
-      std::cerr << "epoll_ctl EPOLL_CTL_MOD failed in ResponseStatusException "
+    error_response::ApplyErrorPage(*config_, res_);
+    ResetBodyProducer();
+    write_queue_.Clear();
+    WriteResponseHead();
+    if (poller.Modify(fd_.GetFd(), event::kWritable, this) == -1) {
+      std::cerr << "poller Modify failed in ResponseStatusException "
                    "handler: "
                 << std::strerror(errno) << std::endl;
       result.remove_socket = true;
-      epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd_.GetFd(), NULL);
+      poller.Remove(fd_.GetFd());
     }
   } catch (const lib::exception::ConnectionClosed& e) {
     result.remove_socket = true;
-    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd_.GetFd(), NULL);
+    poller.Remove(fd_.GetFd());
   } catch (const std::exception& e) {
     std::cerr << "ClientSocket error: " << e.what() << std::endl;
     result.remove_socket = true;
-    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd_.GetFd(), NULL);
+    poller.Remove(fd_.GetFd());
+  }
+  if (result.remove_socket) {
+    ReleaseCgiSlot(poller);
+    AbandonCgiCache(poller);
   }
   return result;
 }
 
-SocketResult ClientSocket::HandleEpollIn(int epoll_fd) {
+SocketResult ClientSocket::HandleEpollIn(event::Poller& poller) {
   char buffer[kBufferSize];
-  ssize_t bytes_received = recv(fd_.GetFd(), buffer, sizeof(buffer), 0);
+  ssize_t bytes_received = poller.Receive(fd_.GetFd(), buffer, sizeof(buffer));
 
   if (kEnableClientSocketDebugLogging) {
     std::cerr << "[DEBUG] recv fd=" << fd_.GetFd()
@@ -106,133 +320,774 @@ SocketResult ClientSocket::HandleEpollIn(int epoll_fd) {
   if (bytes_received <= 0) {
     throw lib::exception::ConnectionClosed();
   }
+  metrics::Add(metrics::kBytesReceived, bytes_received);
+  bytes_received_ += bytes_received;
+  trace_.Mark(trace::kFirstByte);
+  request_started_ = true;
 
   req_.Parse(buffer, bytes_received);
   if (kEnableClientSocketDebugLogging) {
     std::cerr << "[DEBUG] req done=" << req_.IsDone() << std::endl;
   }
+  if (req_.GetState() != HttpRequest::kHeader) {
+    trace_.Mark(trace::kHeadersParsed);
+  }
   if (req_.IsDone()) {
-    RequestHandler handler(config_, req_);
-    ExecResult result = handler.Run();
+    trace_.Mark(trace::kBodyComplete);
+    return DispatchRequest(poller);
+  }
+  return SocketResult();
+}
 
-    if (kEnableClientSocketDebugLogging) {
-      std::cerr << "[DEBUG] final response status = "
-                << result.response.GetStatus() << std::endl;
-    }
+// a CGI location's cache answers before its limiter is asked for a slot
+SocketResult ClientSocket::DispatchRequest(event::Poller& poller) {
+  const Location* loc = FindCgiLocation();
+  SocketResult result;
+  if (LookupCgiCache(poller, loc, &result)) return result;
+  if (!AdmitCgi(poller, loc)) return SocketResult();
+  return RunHandler(poller);
+}
+
+// NULL unless the request is routed to a CGI location
+const Location* ClientSocket::FindCgiLocation() const {
+  const Location* loc = NULL;
+  try {
+    loc = config_->FindLocationForUri(req_.GetUri()).loc;
+  } catch (const std::exception& e) {
+    return NULL;  // the handler answers it
+  }
+  if (loc == NULL || !loc->GetCgiEnabled()) return NULL;
+  return loc;
+}
 
-    res_ = result.response;
-    write_buffer_ = res_.ToHttpString();
+/*
+cgi_cache, for GET requests without credentials: a fresh entry is served
+as is. A stale one is served too, while a script refreshes it in the
+background unless another request does already. On a miss the request
+runs the script and fills the entry, or, when another request is filling
+it, waits for that fill with only the peer closing watched and looks the
+key up again once woken. A request that waited runs the script uncached
+if the fill stored nothing. false: the script is to run.
+*/
+bool ClientSocket::LookupCgiCache(event::Poller& poller, const Location* loc,
+                                  SocketResult* result) {
+  if (loc == NULL || loc->GetCgiCache().IsNull() ||
+      req_.GetMethod() != lib::http::kGet ||
+      req_.GetHeader("authorization").HasValue()) {
+    return false;
+  }
+  cgi_cache_ = loc->GetCgiCache();
+  access_log::Entry key_entry;
+  key_entry.request = &req_;
+  key_entry.location = loc;
+  key_entry.time = std::time(NULL);
+  cache_key_.clear();
+  loc->GetCgiCacheKey().Render(key_entry, &cache_key_);
 
-    if (kEnableClientSocketDebugLogging) {
-      std::size_t len = std::min(write_buffer_.size(), kMaxDebugLogBytes);
-      std::string data(write_buffer_.c_str(), len);
-      if (len < write_buffer_.size()) {
-        data.append("...(truncated)");
+  cgi::CgiCache::Entry entry;
+  switch (cgi_cache_->Find(cache_key_, std::time(NULL), &entry)) {
+    case cgi::CgiCache::kFresh:
+      metrics::Increment(metrics::kCgiCacheHits);
+      *result = ServeCachedResponse(poller, loc, entry, "HIT");
+      return true;
+    case cgi::CgiCache::kStale:
+      metrics::Increment(metrics::kCgiCacheStale);
+      if (cgi_cache_->IsFilling(cache_key_) ||
+          !BeginCgiRefresh(loc, entry)) {
+        *result = ServeCachedResponse(poller, loc, entry, "STALE");
+      } else if (!SubmitHandler(poller)) {
+        RequestHandler handler(*config_, req_);
+        *result = EndCgiRefresh(poller, handler.Run().new_socket);
       }
-      std::cerr << "[DEBUG] raw response:\n" << data << std::endl;
+      return true;
+    case cgi::CgiCache::kAbsent:
+      break;
+  }
+  if (cgi_cache_->IsFilling(cache_key_)) {
+    if (cache_collapsed_) return false;
+    metrics::Increment(metrics::kCgiCacheCollapsed);
+    cgi_cache_->Wait(cache_key_, this);
+    cache_waiting_ = true;
+    WatchEvents(poller, event::kPeerClosed);
+    return true;
+  }
+  metrics::Increment(metrics::kCgiCacheMisses);
+  cgi_cache_->BeginFill(cache_key_);
+  cache_fill_ = lib::type::SharedPtr<cgi::CacheFill>(
+      new cgi::CacheFill(cgi_cache_, cache_key_, loc->GetCgiCacheTtl()));
+  return false;
+}
+
+// the stored head with a shared body, aged since it was stored
+SocketResult ClientSocket::ServeCachedResponse(
+    event::Poller& poller, const Location* loc,
+    const cgi::CgiCache::Entry& entry, const char* cache_status) {
+  HttpResponse res = entry.head;
+  res.SetBody(entry.body);
+  std::ostringstream age;
+  age << std::max<time_t>(0, std::time(NULL) - entry.stored_at);
+  res.RemoveHeader("age");
+  res.AddHeader("Age", age.str());
+  res.AddHeader("X-Cache-Status", cache_status);
+  ExecResult handled(res);
+  handled.location = loc;
+  return OnRequestHandled(poller, handled);
+}
+
+/*
+Refreshes a stale entry by running the script with no client attached: its
+output only refills the cache. It takes a cgi_max_concurrent slot only if
+one is free right away, so refreshes never queue ahead of requests. The
+handler spawning the script runs on the aio pool like any other, and the
+stale entry is served once it returns.
+*/
+bool ClientSocket::BeginCgiRefresh(const Location* loc,
+                                   const cgi::CgiCache::Entry& entry) {
+  const lib::type::SharedPtr<cgi::CgiLimiter>& limiter = loc->GetCgiLimiter();
+  if (!limiter.IsNull() && !limiter->TryAcquire()) return false;
+  cgi_cache_->BeginFill(cache_key_);
+  refresh_fill_ = lib::type::SharedPtr<cgi::CacheFill>(
+      new cgi::CacheFill(cgi_cache_, cache_key_, loc->GetCgiCacheTtl()));
+  refresh_limiter_ = limiter;
+  refresh_entry_ = entry;
+  refresh_location_ = loc;
+  return true;
+}
+
+// hands the fill and slot to the refresh script, if the handler spawned
+// one, and serves the stale entry with the script's socket as new_socket
+SocketResult ClientSocket::EndCgiRefresh(event::Poller& poller,
+                                         ASocket* new_socket) {
+  if (new_socket == NULL) {
+    refresh_fill_->End(poller, false);
+    if (!refresh_limiter_.IsNull()) refresh_limiter_->Release(poller);
+  } else {
+    CgiSocket* refresh = static_cast<CgiSocket*>(new_socket);
+    refresh->SetCacheFill(refresh_fill_);
+    if (!refresh_limiter_.IsNull()) refresh->HoldSlot(refresh_limiter_);
+  }
+  refresh_fill_.Reset();
+  refresh_limiter_.Reset();
+  const cgi::CgiCache::Entry entry = refresh_entry_;
+  refresh_entry_ = cgi::CgiCache::Entry();
+  SocketResult result =
+      ServeCachedResponse(poller, refresh_location_, entry, "STALE");
+  result.new_socket = new_socket;
+  return result;
+}
+
+// stops waiting for a fill / ends the one not handed to a CGI socket
+void ClientSocket::AbandonCgiCache(event::Poller& poller) {
+  if (cache_waiting_) cgi_cache_->Cancel(this);
+  cache_waiting_ = false;
+  if (!cache_fill_.IsNull()) cache_fill_->End(poller, false);
+  cache_fill_.Reset();
+}
+
+void ClientSocket::OnCacheFilled(event::Poller& poller) {
+  UpdateLastActivity();
+  cache_waiting_ = false;
+  cache_woken_ = true;
+  WatchEvents(poller, event::kWritable);
+}
+
+/*
+cgi_max_concurrent: a request for a limited CGI location takes a slot or
+waits for one with only the peer closing watched; the handler runs once
+OnAdmitted() has woken the socket. A full queue gets 503 right away.
+false: the handler does not run now.
+*/
+bool ClientSocket::AdmitCgi(event::Poller& poller, const Location* loc) {
+  if (loc == NULL || loc->GetCgiLimiter().IsNull()) return true;
+  cgi_limiter_ = loc->GetCgiLimiter();
+  switch (cgi_limiter_->Admit(poller, this)) {
+    case cgi::CgiLimiter::kAdmitted:
+      cgi_slot_held_ = true;
+      return true;
+    case cgi::CgiLimiter::kQueued:
+      cgi_queued_ = true;
+      cgi_queue_timeout_ = loc->GetCgiQueueTimeout();
+      cgi_queued_at_ = std::time(NULL);
+      cgi_queued_us_ = lib::utils::MonotonicMicros();
+      WatchEvents(poller, event::kPeerClosed);
+      return false;
+    case cgi::CgiLimiter::kRejected:
+      break;
+  }
+  cgi_limiter_.Reset();
+  RejectRequest(poller);
+  return false;
+}
+
+void ClientSocket::OnAdmitted(event::Poller& poller) {
+  UpdateLastActivity();
+  metrics::RecordCgiQueueWait(lib::utils::MonotonicMicros() - cgi_queued_us_);
+  cgi_queued_ = false;
+  cgi_slot_held_ = true;
+  cgi_admitted_ = true;
+  WatchEvents(poller, event::kWritable);
+}
+
+// gives up the queue place or the slot not handed to a CGI socket
+void ClientSocket::ReleaseCgiSlot(event::Poller& poller) {
+  if (cgi_queued_) {
+    cgi_limiter_->Cancel(this);
+  } else if (cgi_slot_held_) {
+    cgi_limiter_->Release(poller);
+  }
+  cgi_queued_ = false;
+  cgi_slot_held_ = false;
+  cgi_limiter_.Reset();
+}
+
+SocketResult ClientSocket::RunHandler(event::Poller& poller) {
+  if (SubmitHandler(poller)) return SocketResult();
+  RequestHandler handler(*config_, req_);
+  if (!internal_uri_.empty()) {
+    handler.SetInternalRedirect(internal_uri_, cgi_head_);
+  }
+  return OnRequestHandled(poller, handler.Run());
+}
+
+/*
+With aio_threads, a handler that stats, reads, writes or unlinks files runs
+on the pool while the fd sits out of the poller, so neither the request
+nor the connection changes until OnHandlerDone(). A full queue sheds the
+request with 503 instead of running it on the loop; for a stale cache
+entry, only its refresh is shed.
+*/
+bool ClientSocket::SubmitHandler(event::Poller& poller) {
+  aio::Op op = aio::kOpRead;  // an internal redirect serves a file
+  if (config_->GetAioThreads() == 0 || !aio::ThreadPool::IsRunning() ||
+      (internal_uri_.empty() && !SelectAioOp(*config_, req_, &op))) {
+    return false;
+  }
+  HandlerTask* task =
+      new HandlerTask(op, this, *config_, req_, internal_uri_, cgi_head_);
+  if (!aio::ThreadPool::Submit(task)) {
+    delete task;
+    metrics::Increment(metrics::kAioRejected);
+    if (refresh_fill_.IsNull()) {
+      RejectRequest(poller);
+    } else {
+      EndCgiRefresh(poller, NULL);
     }
+    return true;
+  }
+  poller.Remove(fd_.GetFd());
+  handler_in_flight_ = true;
+  return true;
+}
 
-    if (result.is_async) {
-      if (result.new_socket) {
-        result.new_socket->OnSetOwner(this);
-        cgi_socket_ = result.new_socket;
-      }
-      SocketResult socket_result;
-      socket_result.new_socket = result.new_socket;
-      return socket_result;
+// load shedding: 503, try again shortly
+void ClientSocket::RejectRequest(event::Poller& poller) {
+  HttpResponse res(lib::http::kServiceUnavailable);
+  res.AddHeader("Retry-After", "1");
+  res.AddHeader("Connection", "close");
+  error_response::ApplyErrorPage(*config_, res);
+  OnRequestHandled(poller, ExecResult(res));
+}
+
+void ClientSocket::OnHandlerDone(event::Poller& poller,
+                                 const ExecResult& result) {
+  UpdateLastActivity();
+  handler_in_flight_ = false;
+  handled_ = result;
+  handler_done_ = true;
+  // on failure the connection simply times out
+  if (poller.Add(fd_.GetFd(), event::kWritable, this) == -1) {
+    std::cerr << "poller Add failed in OnHandlerDone: "
+              << std::strerror(errno) << std::endl;
+  }
+}
+
+void ClientSocket::OnPrefetchDone(event::Poller& poller) {
+  UpdateLastActivity();
+  prefetch_in_flight_ = false;
+  prefetched_ = true;
+  // on failure the connection simply times out
+  if (poller.Add(fd_.GetFd(), event::kWritable, this) == -1) {
+    std::cerr << "poller Add failed in OnPrefetchDone: "
+              << std::strerror(errno) << std::endl;
+  }
+}
+
+SocketResult ClientSocket::OnRequestHandled(event::Poller& poller,
+                                            const ExecResult& result) {
+  if (result.routed_us != 0) {
+    trace_.MarkAt(trace::kRouted, result.routed_us);
+  }
+  trace_.Mark(trace::kHandled);
+  location_ = result.location;
+  if (cgi_slot_held_) {
+    // the script's socket keeps the slot until it exits
+    if (result.new_socket) {
+      static_cast<CgiSocket*>(result.new_socket)->HoldSlot(cgi_limiter_);
+      cgi_slot_held_ = false;
+      cgi_limiter_.Reset();
+    } else {
+      ReleaseCgiSlot(poller);
     }
+  }
+  if (!cache_fill_.IsNull()) {
+    // the script's socket fills the entry; anything else stores nothing
+    if (result.new_socket) {
+      static_cast<CgiSocket*>(result.new_socket)->SetCacheFill(cache_fill_);
+    } else {
+      cache_fill_->End(poller, false);
+    }
+    cache_fill_.Reset();
+  }
 
-    res_ = result.response;
-    write_buffer_ = res_.ToHttpString();
+  res_ = result.response;
+  if (kEnableClientSocketDebugLogging) {
+    std::cerr << "[DEBUG] final response status = " << res_.GetStatus()
+              << std::endl;
+  }
+  QueueResponse();
 
-    epoll_event ev;
-    ev.events = EPOLLOUT;
-    ev.data.ptr = this;
-    if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd_.GetFd(), &ev) == -1) {
-      int saved_errno = errno;
-      throw lib::exception::ResponseStatusException(
-          lib::utils::MapErrnoToHttpStatus(saved_errno));
+  if (kEnableClientSocketDebugLogging) {
+    std::string raw = write_queue_.ToString();
+    std::size_t len = std::min(raw.size(), kMaxDebugLogBytes);
+    std::string data(raw.c_str(), len);
+    if (len < raw.size()) {
+      data.append("...(truncated)");
+    }
+    std::cerr << "[DEBUG] raw response:\n" << data << std::endl;
+  }
+
+  if (result.is_async) {
+    if (result.new_socket) {
+      result.new_socket->OnSetOwner(this);
+      // handlers only go async to run a CGI script
+      cgi_socket_ = static_cast<CgiSocket*>(result.new_socket);
     }
+    SocketResult socket_result;
+    socket_result.new_socket = result.new_socket;
+    return socket_result;
+  }
+
+  if (poller.Modify(fd_.GetFd(), event::kWritable, this) == -1) {
+    int saved_errno = errno;
+    throw lib::exception::ResponseStatusException(
+        lib::utils::MapErrnoToHttpStatus(saved_errno));
   }
   return SocketResult();
 }
 
-void ClientSocket::HandleEpollOut() {
-  if (write_buffer_.empty()) return;
+void ClientSocket::HandleEpollOut(event::Poller& poller) {
+  // the window just paged in is not checked again
+  const bool prefetched = prefetched_;
+  prefetched_ = false;
+  if (!cgi_splice_.IsNull() && write_queue_.Empty() &&
+      !SpliceCgiBody(poller)) {
+    return;
+  }
+  if (!body_producer_.IsNull() &&
+      write_queue_.Size() < kProducerLowWatermark) {
+    const lib::io::OutputQueue* input = body_producer_->PendingInput();
+    if (!prefetched && input != NULL && PrefetchMappedBody(poller, *input)) {
+      return;
+    }
+    if (!cgi_body_.IsNull()) {
+      cgi_body_->SetChunkLimit(
+          SendWindow(fd_.GetFd(), kMinChunkSize, kMaxChunkSize));
+    }
+    if (body_producer_->Produce(write_queue_)) {
+      ResetBodyProducer();
+    } else if (!cgi_body_.IsNull() && cgi_socket_ &&
+               cgi_body_->Pending() <= kCgiResumeBytes) {
+      cgi_socket_->ResumeOutput(poller);
+    }
+  }
+  // a producer may yield nothing yet; kWritable fires again, except for a
+  // CGI body, which wakes the socket up itself once there is more
+  if (write_queue_.Empty()) {
+    if (body_producer_.IsNull()) {  // it finished without a last piece
+      trace_.Mark(trace::kLastByteSent);
+      throw lib::exception::ConnectionClosed();
+    }
+    if (!cgi_body_.IsNull() && cgi_body_->IsStarved()) {
+      WatchEvents(poller, event::kPeerClosed);
+      awaiting_cgi_body_ = true;
+    }
+    return;
+  }
+  if (!prefetched && PrefetchMappedBody(poller, write_queue_)) return;
 
-  ssize_t bytes_sent =
-      send(fd_.GetFd(), write_buffer_.c_str(), write_buffer_.length(), 0);
+  ssize_t bytes_sent = write_queue_.WriteTo(fd_.GetFd());
 
   if (bytes_sent == -1) {
     throw lib::exception::ConnectionClosed();
   }
+  metrics::Add(metrics::kBytesSent, bytes_sent);
+  bytes_sent_ += bytes_sent;
+  trace_.Mark(trace::kFirstByteSent);
 
-  if (static_cast<size_t>(bytes_sent) < write_buffer_.length()) {
-    write_buffer_ = write_buffer_.substr(bytes_sent);
-  } else {
-    write_buffer_.clear();
+  if (write_queue_.Empty() && body_producer_.IsNull() &&
+      cgi_splice_.IsNull()) {
+    trace_.Mark(trace::kLastByteSent);
     throw lib::exception::ConnectionClosed();
   }
 }
 
-void ClientSocket::HandleTimeout(int epoll_fd) {
-  res_ = HttpResponse(lib::http::kRequestTimeout);
+/*
+With aio_threads, the window of mapped file that writev() or a body filter
+reaches next is paged in on the pool unless mincore() finds it cached
+already; the fd sits out of the poller meanwhile, as for a handler. A full
+queue leaves the faults to the loop rather than fail the response. Pages
+evicted again before the write are faulted in on the loop.
+*/
+bool ClientSocket::PrefetchMappedBody(event::Poller& poller,
+                                      const lib::io::OutputQueue& queue) {
+  if (config_->GetAioThreads() == 0 || !aio::ThreadPool::IsRunning()) {
+    return false;
+  }
+  lib::io::MappedFile file;
+  size_t offset = 0;
+  size_t length = 0;
+  if (!queue.FirstMappedSlice(&file, &offset, &length)) return false;
+  if (length > kPrefetchWindow) length = kPrefetchWindow;
+  if (file.IsResident(offset, length)) return false;
+  PrefetchTask* task = new PrefetchTask(this, file, offset, length);
+  if (!aio::ThreadPool::Submit(task)) {
+    delete task;
+    return false;
+  }
+  poller.Remove(fd_.GetFd());
+  prefetch_in_flight_ = true;
+  return true;
+}
+
+/*
+The spliced CGI body moves from the pipe to the socket inside the kernel;
+only the framing SplicedBody::Produce() adds goes through write_queue_,
+ahead of the bytes it announces. true: framing is queued and goes out
+first. The script is resumed whenever the pipe has drained some.
+*/
+bool ClientSocket::SpliceCgiBody(event::Poller& poller) {
+  if (cgi_splice_->Produce(write_queue_)) {
+    cgi_splice_.Reset();
+    if (write_queue_.Empty()) {
+      trace_.Mark(trace::kLastByteSent);
+      throw lib::exception::ConnectionClosed();
+    }
+    return true;
+  }
+  if (!write_queue_.Empty()) return true;
+  const ssize_t bytes_sent = cgi_splice_->SpliceTo(fd_.GetFd());
+  if (bytes_sent > 0) {
+    metrics::Add(metrics::kBytesSent, bytes_sent);
+    bytes_sent_ += bytes_sent;
+    trace_.Mark(trace::kFirstByteSent);
+    if (cgi_socket_) cgi_socket_->ResumeOutput(poller);
+  } else if (bytes_sent == 0) {
+    // woken by OnCgiBodySpliced() / OnCgiBodyEnd()
+    WatchEvents(poller, event::kPeerClosed);
+    awaiting_cgi_body_ = true;
+  } else if (errno != EAGAIN) {
+    throw lib::exception::ConnectionClosed();
+  }
+  return false;
+}
+
+// headers and, unless the handler or a body filter streams it, the body
+void ClientSocket::QueueResponse() {
+  write_queue_.Clear();
+  body_producer_ = res_.GetBodyProducer();
+  if (body_producer_.IsNull()) {
+    body_producer_ = lib::type::SharedPtr<lib::io::BodyProducer>(
+        compression::EncodeResponse(*config_, req_, res_));
+  }
+  WriteResponseHead();
+}
+
+// status line, headers and the in-memory body (a producer adds the rest)
+void ClientSocket::WriteResponseHead() {
+  const size_t queued = write_queue_.Size();
+  res_.WriteTo(write_queue_);
+  response_status_ = res_.GetStatus();
+  response_header_bytes_ = write_queue_.Size() - queued - res_.GetBodySize();
+}
+
+void ClientSocket::RecordRequest() const {
+  const uint64_t elapsed =
+      lib::utils::MonotonicMicros() - trace_.At(trace::kFirstByte);
+  metrics::RecordRequest(
+      location_ ? location_->GetMetricsId() : metrics::kUnmatchedLocation,
+      response_status_, elapsed);
+  metrics::RecordTrace(trace_);
+
+  const access_log::AccessLog::Handle& log = config_->GetAccessLog();
+  const access_log::AccessLog::Handle& slow_log = config_->GetSlowLog();
+  if (log.IsNull() && slow_log.IsNull()) return;
+  access_log::Entry entry;
+  entry.request = &req_;
+  entry.location = location_;
+  entry.status = response_status_;
+  entry.bytes_received = bytes_received_;
+  entry.bytes_sent = bytes_sent_;
+  entry.body_bytes_sent = bytes_sent_ > response_header_bytes_
+                              ? bytes_sent_ - response_header_bytes_
+                              : 0;
+  entry.request_time_us = elapsed;
+  entry.time = std::time(NULL);
+  std::string line;
+  if (!log.IsNull()) {
+    config_->GetAccessLogFormat().Render(entry, &line);
+    log->Write(line);
+  }
+  if (!slow_log.IsNull()) {
+    const bool sampled = trace::Sample(config_->GetSlowLogSample());
+    if (sampled || elapsed >= config_->GetSlowLogThresholdMicros()) {
+      line.clear();
+      trace::RenderJson(trace_, entry, sampled, &line);
+      slow_log->Write(line);
+    }
+  }
+}
+
+bool ClientSocket::IsIdle() const {
+  return !request_started_ && write_queue_.Empty() && cgi_socket_ == NULL;
+}
+
+bool ClientSocket::IsTimeout(time_t threshold_time) const {
+  if (handler_in_flight_ || prefetch_in_flight_) return false;
+  // a fill that went away without waking anyone gives up the wait
+  if (cache_waiting_) return !cgi_cache_->IsFilling(cache_key_);
+  if (cgi_queued_) {
+    return std::time(NULL) - cgi_queued_at_ >= cgi_queue_timeout_;
+  }
+  if (cgi_socket_ && !cgi_socket_->IsPaused()) return false;
+  return ASocket::IsTimeout(threshold_time);
+}
+
+void ClientSocket::ResetBodyProducer() {
+  body_producer_.Reset();
+  cgi_body_.Reset();
+  cgi_splice_.Reset();
+}
+
+void ClientSocket::WatchEvents(event::Poller& poller, uint32_t events) {
+  if (poller.Modify(fd_.GetFd(), events, this) == -1) {
+    std::cerr << "poller Modify failed in WatchEvents: "
+              << std::strerror(errno) << std::endl;
+  }
+}
+
+void ClientSocket::WakeForCgiBody(event::Poller& poller) {
+  if (!awaiting_cgi_body_) return;
+  awaiting_cgi_body_ = false;
+  WatchEvents(poller, event::kWritable);
+}
+
+// a request that waited cgi_queue_timeout for a CGI slot, or for a cache
+// fill that was abandoned, gets 503
+void ClientSocket::HandleTimeout(event::Poller& poller) {
+  const bool queued = cgi_queued_ || cache_waiting_;
+  ReleaseCgiSlot(poller);
+  AbandonCgiCache(poller);
+  // part of a response is out already: a 408 now would corrupt it
+  if (bytes_sent_ > 0) {
+    poller.Remove(fd_.GetFd());
+    return;
+  }
+  if (queued) {
+    res_ = HttpResponse(lib::http::kServiceUnavailable);
+    res_.AddHeader("Retry-After", "1");
+  } else {
+    res_ = HttpResponse(lib::http::kRequestTimeout);
+  }
   res_.AddHeader("Connection", "close");
-  res_.AddHeader("Content-Type", "text/html");
-  res_.EnsureDefaultErrorContent();
+  error_response::ApplyErrorPage(*config_, res_);
 
-  write_buffer_ = res_.ToHttpString();
+  ResetBodyProducer();
+  write_queue_.Clear();
+  WriteResponseHead();
 
-  while (!write_buffer_.empty()) {
-    ssize_t bytes_sent =
-        send(fd_.GetFd(), write_buffer_.c_str(), write_buffer_.length(), 0);
+  while (!write_queue_.Empty()) {
+    ssize_t bytes_sent = write_queue_.WriteTo(fd_.GetFd());
     if (bytes_sent <= 0) {
       break;
     }
-    if (static_cast<size_t>(bytes_sent) < write_buffer_.length()) {
-      write_buffer_ = write_buffer_.substr(bytes_sent);
+    metrics::Add(metrics::kBytesSent, bytes_sent);
+    bytes_sent_ += bytes_sent;
+    trace_.Mark(trace::kFirstByteSent);
+  }
+  if (write_queue_.Empty()) trace_.Mark(trace::kLastByteSent);
+
+  poller.Remove(fd_.GetFd());
+}
+
+/*
+The CGI header block becomes the response head as soon as it is complete;
+the body follows through a StreamedBodyProducer fed by the CGI socket.
+Without a Content-Length from the script the body is sent chunked to
+HTTP/1.1 peers and delimited by closing the connection for HTTP/1.0 ones.
+Framing is the server's business (RFC 3875 6.3.4), so a Transfer-Encoding
+from the script is dropped. A body sent as is and not cached is spliced
+from the script's socket to the client's instead (see SpliceCgiBody()).
+*/
+void ClientSocket::OnCgiHeaders(event::Poller& poller,
+                                const HttpResponse& res) {
+  UpdateLastActivity();
+  res_ = res;
+  res_.RemoveHeader("transfer-encoding");
+  const lib::http::ContentCoding coding =
+      compression::EncodeStreamedResponse(*config_, req_, res_);
+  const bool is_bodiless = res_.GetStatus() == lib::http::kNoContent ||
+                           res_.GetStatus() == lib::http::kNotModified;
+  bool chunked = res_.HasHeader("transfer-encoding");
+  if (!chunked && !is_bodiless && !res_.HasHeader("content-length") &&
+      req_.GetVersion() == "HTTP/1.1") {
+    res_.AddHeader("Transfer-Encoding", "chunked");
+    chunked = true;
+  }
+
+  lib::io::OutputQueue received;
+  res_.TakeBody(received);
+  if (coding == lib::http::kCodingIdentity && !is_bodiless &&
+      StartCgiSplice(chunked)) {
+    // what came with the header block precedes the pipe
+    write_queue_.Clear();
+    body_producer_.Reset();
+    cgi_body_.Reset();
+    WriteResponseHead();
+    if (chunked) {
+      const std::string head = received.ToString();
+      lib::http::AppendChunk(write_queue_, head.data(), head.size());
     } else {
-      write_buffer_.clear();
+      write_queue_.Append(received);
     }
+    awaiting_cgi_body_ = false;
+    WatchEvents(poller, event::kWritable);
+    return;
+  }
+  cgi_body_ = lib::type::SharedPtr<lib::http::StreamedBodyProducer>(
+      new lib::http::StreamedBodyProducer(chunked, kMaxChunkSize, coding,
+                                          config_->GetGzipCompLevel()));
+  if (is_bodiless) {
+    cgi_body_->Finish();
+  } else {
+    cgi_body_->Feed(received);
   }
+  res_.SetBodyProducer(cgi_body_);
+  QueueResponse();
 
-  epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd_.GetFd(), NULL);
+  awaiting_cgi_body_ = false;
+  WatchEvents(poller, event::kWritable);
 }
 
-void ClientSocket::OnCgiExecutionFinished(int epoll_fd,
-                                          const std::string& cgi_output) {
+/*
+The script only decided: the response is the file an internal location
+serves for the target, run like any handler (on the aio pool with
+aio_threads). The CGI socket drains the rest of the output on its own. An
+X-Sendfile path no internal root contains is a bad gateway.
+*/
+void ClientSocket::OnCgiInternalRedirect(event::Poller& poller,
+                                         const HttpResponse& res,
+                                         const std::string& target,
+                                         bool is_path) {
   UpdateLastActivity();
-  try {
-    res_ = cgi::ParseCgiResponse(cgi_output);
-  } catch (const lib::exception::ResponseStatusException& e) {
-    res_ = HttpResponse(lib::http::kInternalServerError);
-    res_.AddHeader("Connection", "close");
-    res_.AddHeader("Content-Type", "text/html");
-    res_.EnsureDefaultErrorContent();
+  if (cgi_socket_) {
+    cgi_socket_->OnSetOwner(NULL);
+    cgi_socket_ = NULL;
+  }
+  internal_uri_ = target;
+  if (is_path) {
+    lib::type::Optional<std::string> uri =
+        config_->FindInternalUriForPath(target);
+    if (!uri.HasValue()) {
+      WEBSERV_LOG(kWarn) << "X-Sendfile outside internal locations: "
+                         << target << std::endl;
+      OnCgiExecutionError(poller, lib::http::kBadGateway);
+      return;
+    }
+    internal_uri_ = uri.Value();
+  }
+  cgi_head_ = res;
+  ResetBodyProducer();
+  awaiting_cgi_body_ = false;
+  RunHandler(poller);  // answered in place: never a new socket
+}
+
+void ClientSocket::OnCgiBody(event::Poller& poller, const char* data,
+                             size_t len) {
+  UpdateLastActivity();
+  if (cgi_body_.IsNull()) return;  // the response was replaced meanwhile
+  cgi_body_->Feed(data, len);
+  if (cgi_body_->Pending() >= kCgiPauseBytes && cgi_socket_) {
+    cgi_socket_->PauseOutput(poller);
   }
-  write_buffer_ = res_.ToHttpString();
+  WakeForCgiBody(poller);
+}
 
-  epoll_event ev;
-  ev.events = EPOLLOUT;
-  ev.data.ptr = this;
-  if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd_.GetFd(), &ev) == -1) {
-    std::cerr << "epoll_ctl EPOLL_CTL_MOD failed in OnCgiExecutionFinished: "
-              << std::strerror(errno) << std::endl;
+// false: the body goes through cgi_body_ (small, cached, delimited by the
+// connection closing, which needs a producer, or no pipe left)
+bool ClientSocket::StartCgiSplice(bool chunked) {
+  if (cgi_socket_ == NULL || cgi_socket_->IsCaching()) return false;
+  lib::type::Optional<std::string> length = res_.GetHeader("content-length");
+  if (length.HasValue()
+          ? lib::utils::StrToLong(length.Value()).ValueOr(0) <
+                kCgiSpliceMinBytes
+          : !chunked) {
+    return false;
   }
+  try {
+    cgi_splice_ = lib::type::SharedPtr<lib::http::SplicedBody>(
+        new lib::http::SplicedBody(chunked));
+  } catch (const std::exception& e) {
+    WEBSERV_LOG(kWarn) << "CGI body not spliced: " << e.what() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+lib::http::SplicedBody* ClientSocket::GetCgiSplice() {
+  return cgi_splice_.Get();
 }
 
-void ClientSocket::OnCgiExecutionError(int epoll_fd) {
+void ClientSocket::OnCgiBodySpliced(event::Poller& poller) {
   UpdateLastActivity();
-  res_ = HttpResponse(lib::http::kInternalServerError);
-  write_buffer_ = res_.ToHttpString();
-
-  epoll_event ev;
-  ev.events = EPOLLOUT;
-  ev.data.ptr = this;
-  if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd_.GetFd(), &ev) == -1) {
-    std::cerr << "epoll_ctl EPOLL_CTL_MOD failed in OnCgiExecutionError: "
-              << std::strerror(errno) << std::endl;
+  WakeForCgiBody(poller);
+}
+
+void ClientSocket::OnCgiBodyEnd(event::Poller& poller, bool complete) {
+  UpdateLastActivity();
+  if (!cgi_splice_.IsNull()) {
+    if (complete) {
+      cgi_splice_->Finish();
+    } else {
+      cgi_splice_->Abort();
+    }
+    WakeForCgiBody(poller);
+    return;
   }
+  if (cgi_body_.IsNull()) return;
+  if (complete) {
+    cgi_body_->Finish();
+  } else {
+    cgi_body_->Abort();
+  }
+  WakeForCgiBody(poller);
+}
+
+void ClientSocket::OnCgiExecutionError(event::Poller& poller,
+                                       lib::http::Status status) {
+  UpdateLastActivity();
+  res_ = HttpResponse(status);
+  res_.AddHeader("Connection", "close");
+  error_response::ApplyErrorPage(*config_, res_);
+  ResetBodyProducer();
+  write_queue_.Clear();
+  WriteResponseHead();
+
+  awaiting_cgi_body_ = false;
+  WatchEvents(poller, event::kWritable);
+}
+
+trace::Trace& ClientSocket::GetTrace() {
+  return trace_;
 }
 
 void ClientSocket::RemoveCgiSocket(ASocket* sock) {
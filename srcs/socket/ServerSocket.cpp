@@ -1,8 +1,8 @@
 #include "socket/ServerSocket.hpp"
 
 #include <arpa/inet.h>
+#include <fcntl.h>
 #include <netinet/in.h>
-#include <sys/epoll.h>
 #include <sys/socket.h>
 
 #include <cerrno>
@@ -11,13 +11,15 @@
 #include <sstream>
 #include <stdexcept>
 
+#include "lib/logging/Logging.hpp"
 #include "lib/type/Fd.hpp"
 #include "lib/utils/Bzero.hpp"
+#include "metrics/Metrics.hpp"
 #include "socket/ClientSocket.hpp"
 
 namespace {
 lib::type::Fd CreateServerSocketFd() {
-  int fd = socket(PF_INET, SOCK_STREAM, 0);
+  int fd = socket(PF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
   if (fd == -1) {
     throw std::runtime_error("socket() failed. " +
                              std::string(strerror(errno)));
@@ -34,7 +36,7 @@ std::string Ipv4ToString(in_addr addr) {
 }
 }  // namespace
 
-ServerSocket::ServerSocket(const ServerConfig& config)
+ServerSocket::ServerSocket(const ServerConfigSnapshot& config)
     : ASocket(CreateServerSocketFd()), config_(config) {
   int opt = 1;
   if (setsockopt(fd_.GetFd(), SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) ==
@@ -47,7 +49,7 @@ ServerSocket::ServerSocket(const ServerConfig& config)
   lib::utils::Bzero(&server_addr, sizeof(server_addr));
   server_addr.sin_family = AF_INET;
   server_addr.sin_addr.s_addr = INADDR_ANY;
-  server_addr.sin_port = htons(config_.GetPort());
+  server_addr.sin_port = htons(config_->GetPort());
 
   if (bind(fd_.GetFd(), (sockaddr*)&server_addr, sizeof(server_addr)) == -1) {
     throw std::runtime_error("bind() failed. " + std::string(strerror(errno)));
@@ -59,28 +61,46 @@ ServerSocket::ServerSocket(const ServerConfig& config)
   }
 }
 
+ServerSocket::ServerSocket(const ServerConfigSnapshot& config,
+                           lib::type::Fd listening_fd)
+    : ASocket(listening_fd), config_(config) {
+  int accepting = 0;
+  socklen_t len = sizeof(accepting);
+  if (getsockopt(fd_.GetFd(), SOL_SOCKET, SO_ACCEPTCONN, &accepting, &len) ==
+          -1 ||
+      !accepting) {
+    throw std::runtime_error("inherited fd is not a listening socket");
+  }
+  // it crossed the exec() of the upgrade; CGI scripts must not inherit it
+  fcntl(fd_.GetFd(), F_SETFD, FD_CLOEXEC);
+}
+
 ServerSocket::~ServerSocket() {
 }
 
-SocketResult ServerSocket::HandleEvent(int epoll_fd, uint32_t events) {
-  (void)epoll_fd;
+SocketResult ServerSocket::HandleEvent(event::Poller& poller, uint32_t events) {
   SocketResult result;
-  if (events & EPOLLIN) {
+  if (events & event::kReadable) {
     sockaddr_in client_addr;
     socklen_t client_addr_len = sizeof(client_addr);
-    lib::type::Fd client_fd(
-        accept(fd_.GetFd(), (sockaddr*)&client_addr, &client_addr_len));
+    lib::type::Fd client_fd(poller.Accept(
+        fd_.GetFd(), (sockaddr*)&client_addr, &client_addr_len));
     if (client_fd.GetFd() == -1) {
-      std::cerr << "Failed to accept fd:" << client_fd.GetFd() << std::endl;
+      // another process sharing the listener (binary upgrade) was faster
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        std::cerr << "Failed to accept fd:" << client_fd.GetFd() << std::endl;
+      }
       return result;
     }
+    metrics::Increment(metrics::kConnectionsAccepted);
 
     std::string client_ip = Ipv4ToString(client_addr.sin_addr);
     try {
       ClientSocket* client_socket =
           new ClientSocket(client_fd, config_, client_ip);
 
-      std::cout << "Accepted connection from " << client_ip << std::endl;
+      WEBSERV_LOG(kDebug) << "Accepted connection from " << client_ip
+                          << std::endl;
 
       result.new_socket = client_socket;
     } catch (const std::exception& e) {
@@ -90,6 +110,10 @@ SocketResult ServerSocket::HandleEvent(int epoll_fd, uint32_t events) {
   return result;
 }
 
+void ServerSocket::SetConfig(const ServerConfigSnapshot& config) {
+  config_ = config;
+}
+
 bool ServerSocket::IsTimeout(time_t threshold_time) const {
   (void)threshold_time;
   return false;
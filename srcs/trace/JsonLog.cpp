@@ -0,0 +1,116 @@
+#include <string>
+
+#include "HttpRequest.hpp"
+#include "Location.hpp"
+#include "access_log/LogFormat.hpp"
+#include "lib/http/Method.hpp"
+#include "trace/Trace.hpp"
+
+namespace trace {
+
+namespace {
+
+void AppendNumber(uint64_t value, std::string* out) {
+  char buf[24];
+  size_t len = 0;
+  do {
+    buf[len++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+  while (len > 0) out->push_back(buf[--len]);
+}
+
+// request data is client-controlled: bytes outside printable ASCII become
+// \u00XX so the line stays valid JSON
+void AppendString(const std::string& value, std::string* out) {
+  static const char kHex[] = "0123456789abcdef";
+  out->push_back('"');
+  for (size_t i = 0; i < value.size(); ++i) {
+    const unsigned char c = static_cast<unsigned char>(value[i]);
+    if (c == '"' || c == '\\') {
+      out->push_back('\\');
+      out->push_back(static_cast<char>(c));
+    } else if (c < 0x20 || c >= 0x7f) {
+      out->append("\\u00");
+      out->push_back(kHex[c >> 4]);
+      out->push_back(kHex[c & 0x0f]);
+    } else {
+      out->push_back(static_cast<char>(c));
+    }
+  }
+  out->push_back('"');
+}
+
+void AppendKey(const char* key, std::string* out) {
+  if (*out->rbegin() != '{') out->push_back(',');
+  out->push_back('"');
+  out->append(key);
+  out->append("\":");
+}
+
+std::string RequestLine(const HttpRequest& req) {
+  const lib::http::Method method = req.GetMethod();
+  if (method == lib::http::kNone || method == lib::http::kUnknownMethod) {
+    return "";
+  }
+  std::string line = lib::http::MethodToString(method) + " " + req.GetUri();
+  if (!req.GetQuery().empty()) line += "?" + req.GetQuery();
+  return line + " " + req.GetVersion();
+}
+
+}  // namespace
+
+/*
+{"time":1760857892,"remote_addr":"127.0.0.1","request":"GET / HTTP/1.1",
+ "status":200,"location":"/","bytes_sent":612,"request_time_us":523,
+ "spans":{"wait":40,"headers":3,...},"trace":{"accept":0,...}}
+
+Times are microseconds; spans the request did not reach are left out.
+*/
+void RenderJson(const Trace& trace, const access_log::Entry& entry,
+                bool sampled, std::string* out) {
+  out->push_back('{');
+  AppendKey("time", out);
+  AppendNumber(static_cast<uint64_t>(entry.time), out);
+  AppendKey("remote_addr", out);
+  AppendString(entry.request->GetClientIp(), out);
+  AppendKey("request", out);
+  AppendString(RequestLine(*entry.request), out);
+  AppendKey("status", out);
+  AppendNumber(static_cast<uint64_t>(entry.status), out);
+  if (entry.location) {
+    AppendKey("location", out);
+    AppendString(entry.location->GetName(), out);
+  }
+  AppendKey("bytes_sent", out);
+  AppendNumber(entry.bytes_sent, out);
+  AppendKey("request_time_us", out);
+  AppendNumber(entry.request_time_us, out);
+
+  AppendKey("spans", out);
+  out->push_back('{');
+  for (size_t s = 0; s < kSpanCount; ++s) {
+    uint64_t micros;
+    if (trace.Duration(static_cast<Span>(s), &micros)) {
+      AppendKey(SpanName(static_cast<Span>(s)), out);
+      AppendNumber(micros, out);
+    }
+  }
+  out->push_back('}');
+
+  if (sampled && trace.Has(kAccept)) {
+    AppendKey("trace", out);
+    out->push_back('{');
+    for (size_t p = 0; p < kPhaseCount; ++p) {
+      const Phase phase = static_cast<Phase>(p);
+      if (trace.Has(phase) && trace.At(phase) >= trace.At(kAccept)) {
+        AppendKey(PhaseName(phase), out);
+        AppendNumber(trace.At(phase) - trace.At(kAccept), out);
+      }
+    }
+    out->push_back('}');
+  }
+  out->append("}\n");
+}
+
+}  // namespace trace
@@ -0,0 +1,91 @@
+#include "trace/Trace.hpp"
+
+#include "Worker.hpp"
+#include "lib/utils/time_utils.hpp"
+
+namespace trace {
+
+namespace {
+
+const char* const kPhaseNames[kPhaseCount] = {
+    "accept",
+    "first_byte",
+    "headers_parsed",
+    "body_complete",
+    "routed",
+    "handled",
+    "cgi_spawned",
+    "cgi_first_output",
+    "cgi_exited",
+    "first_byte_sent",
+    "last_byte_sent",
+};
+
+struct SpanDef {
+  const char* name;
+  Phase from;
+  Phase to;
+};
+
+const SpanDef kSpans[kSpanCount] = {
+    {"wait", kAccept, kFirstByte},
+    {"headers", kFirstByte, kHeadersParsed},
+    {"body", kHeadersParsed, kBodyComplete},
+    {"routing", kBodyComplete, kRouted},
+    {"handler", kRouted, kHandled},
+    {"cgi_startup", kCgiSpawned, kCgiFirstOutput},
+    {"cgi", kCgiSpawned, kCgiExited},
+    {"time_to_first_byte", kFirstByte, kFirstByteSent},
+    {"send", kFirstByteSent, kLastByteSent},
+    {"total", kFirstByte, kLastByteSent},
+};
+
+}  // namespace
+
+const char* PhaseName(Phase phase) {
+  return kPhaseNames[phase];
+}
+
+const char* SpanName(Span span) {
+  return kSpans[span].name;
+}
+
+Trace::Trace() {
+  for (size_t i = 0; i < kPhaseCount; ++i) at_[i] = 0;
+}
+
+void Trace::Mark(Phase phase) {
+  if (at_[phase] == 0) at_[phase] = lib::utils::MonotonicMicros();
+}
+
+void Trace::MarkAt(Phase phase, uint64_t micros) {
+  if (at_[phase] == 0) at_[phase] = micros;
+}
+
+bool Trace::Has(Phase phase) const {
+  return at_[phase] != 0;
+}
+
+uint64_t Trace::At(Phase phase) const {
+  return at_[phase];
+}
+
+bool Trace::Duration(Span span, uint64_t* micros) const {
+  const SpanDef& def = kSpans[span];
+  if (!Has(def.from) || !Has(def.to) || at_[def.to] < at_[def.from]) {
+    return false;
+  }
+  *micros = at_[def.to] - at_[def.from];
+  return true;
+}
+
+bool Sample(size_t rate) {
+  static size_t counters[worker::kMaxWorkers] = {0};
+  if (rate == 0) return false;
+  size_t& counter = counters[worker::Current()];
+  if (++counter < rate) return false;
+  counter = 0;
+  return true;
+}
+
+}  // namespace trace
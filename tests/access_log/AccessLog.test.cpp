@@ -0,0 +1,91 @@
+#include "access_log/AccessLog.hpp"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+static std::string ReadAll(const std::string& path) {
+  std::ifstream ifs(path.c_str(), std::ios::binary);
+  std::string s((std::istreambuf_iterator<char>(ifs)),
+                std::istreambuf_iterator<char>());
+  return s;
+}
+
+class AccessLogTest : public ::testing::Test {
+ protected:
+  std::string dir_;
+  std::string path_;
+
+  void SetUp() override {
+    char tmpl[] = "/tmp/webserv_access_log_test.XXXXXX";
+    char* p = mkdtemp(tmpl);
+    ASSERT_TRUE(p != NULL);
+    dir_ = p;
+    path_ = dir_ + "/access.log";
+  }
+
+  void TearDown() override {
+    access_log::AccessLog::FlushPending(true);  // closes the test's logs
+    unlink(path_.c_str());
+    unlink((path_ + ".1").c_str());
+    rmdir(dir_.c_str());
+  }
+};
+
+TEST_F(AccessLogTest, LinesAreBufferedUntilFlushed) {
+  access_log::AccessLog::Handle log = access_log::AccessLog::Open(path_);
+  log->Write("one\n");
+  log->Write("two\n");
+  EXPECT_EQ(ReadAll(path_), "");
+  access_log::AccessLog::FlushPending(false);  // neither full nor old
+  EXPECT_EQ(ReadAll(path_), "");
+  access_log::AccessLog::FlushPending(true);
+  EXPECT_EQ(ReadAll(path_), "one\ntwo\n");
+}
+
+TEST_F(AccessLogTest, SamePathSharesOneLog) {
+  access_log::AccessLog::Handle a = access_log::AccessLog::Open(path_);
+  access_log::AccessLog::Handle b = access_log::AccessLog::Open(path_);
+  EXPECT_EQ(a.Get(), b.Get());
+}
+
+TEST_F(AccessLogTest, OversizedLineIsWrittenDirectly) {
+  access_log::AccessLog::Handle log = access_log::AccessLog::Open(path_);
+  log->Write("first\n");
+  const std::string big(access_log::AccessLog::kBufferSize + 1, 'x');
+  log->Write(big);
+  access_log::AccessLog::FlushPending(true);
+  EXPECT_EQ(ReadAll(path_), "first\n" + big);
+}
+
+TEST_F(AccessLogTest, ReopenFollowsRotation) {
+  access_log::AccessLog::Handle log = access_log::AccessLog::Open(path_);
+  log->Write("before\n");
+  ASSERT_EQ(rename(path_.c_str(), (path_ + ".1").c_str()), 0);
+  access_log::AccessLog::ReopenAll();
+  log->Write("after\n");
+  access_log::AccessLog::FlushPending(true);
+  EXPECT_EQ(ReadAll(path_ + ".1"), "before\n");
+  EXPECT_EQ(ReadAll(path_), "after\n");
+}
+
+TEST_F(AccessLogTest, StopWriterWritesWhatWasHandedOver) {
+  access_log::AccessLog::Handle log = access_log::AccessLog::Open(path_);
+  log->Write("one\n");
+  log->Flush();
+  access_log::AccessLog::StopWriter();
+  EXPECT_EQ(ReadAll(path_), "one\n");
+  log->Write("two\n");  // the next handoff starts the writer again
+  access_log::AccessLog::FlushPending(true);
+  EXPECT_EQ(ReadAll(path_), "one\ntwo\n");
+}
+
+TEST_F(AccessLogTest, UnopenablePath_Throws) {
+  EXPECT_THROW(access_log::AccessLog::Open(dir_ + "/missing/access.log"),
+               std::runtime_error);
+}
@@ -0,0 +1,82 @@
+#include "access_log/LogFormat.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <ctime>
+#include <stdexcept>
+#include <string>
+
+#include "HttpRequest.hpp"
+#include "Location.hpp"
+
+class LogFormatTest : public ::testing::Test {
+ protected:
+  HttpRequest req_;
+  access_log::Entry entry_;
+
+  void SetUp() override {
+    req_.SetBufferForTest(
+        "GET /index.html?a=1 HTTP/1.1\r\n"
+        "Host: example.com\r\n"
+        "User-Agent: test/1.0\r\n"
+        "X-Note: say \"hi\"\r\n"
+        "\r\n");
+    ASSERT_TRUE(req_.AdvanceHeader());
+    req_.SetClientIp("10.0.0.7");
+    entry_.request = &req_;
+    entry_.status = 200;
+    entry_.bytes_received = 80;
+    entry_.bytes_sent = 1100;
+    entry_.body_bytes_sent = 1000;
+    entry_.request_time_us = 2345678;
+  }
+
+  std::string Render(const std::string& spec) {
+    std::string line;
+    access_log::LogFormat(spec).Render(entry_, &line);
+    return line;
+  }
+};
+
+TEST_F(LogFormatTest, RequestVariables) {
+  EXPECT_EQ(Render("$remote_addr \"$request\" $status $body_bytes_sent"),
+            "10.0.0.7 \"GET /index.html?a=1 HTTP/1.1\" 200 1000\n");
+  EXPECT_EQ(Render("$request_method $uri $args $request_uri $server_protocol"),
+            "GET /index.html a=1 /index.html?a=1 HTTP/1.1\n");
+  EXPECT_EQ(Render("$bytes_sent $request_length $request_time"),
+            "1100 80 2.345\n");
+}
+
+TEST_F(LogFormatTest, HeadersAreEscapedAndMissingOnesAreDashes) {
+  EXPECT_EQ(Render("$http_user_agent|$http_x_note|$http_referer"),
+            "test/1.0|say \\x22hi\\x22|-\n");
+}
+
+TEST_F(LogFormatTest, LocationNameOrDash) {
+  EXPECT_EQ(Render("[$location]"), "[-]\n");
+  Location loc;
+  loc.SetName("/static");
+  entry_.location = &loc;
+  EXPECT_EQ(Render("[$location]"), "[/static]\n");
+}
+
+TEST_F(LogFormatTest, CombinedIsTheDefault) {
+  setenv("TZ", "UTC", 1);
+  tzset();
+  entry_.time = 86400;
+  std::string line;
+  access_log::LogFormat().Render(entry_, &line);
+  EXPECT_EQ(line,
+            "10.0.0.7 - - [02/Jan/1970:00:00:00 +0000] "
+            "\"GET /index.html?a=1 HTTP/1.1\" 200 1000 \"-\" \"test/1.0\"\n");
+  EXPECT_EQ(Render("common"),
+            "10.0.0.7 - - [02/Jan/1970:00:00:00 +0000] "
+            "\"GET /index.html?a=1 HTTP/1.1\" 200 1000\n");
+  EXPECT_EQ(Render("$time_iso8601"), "1970-01-02T00:00:00+00:00\n");
+}
+
+TEST_F(LogFormatTest, LiteralDollarAndUnknownVariable) {
+  EXPECT_EQ(Render("cost $ $status"), "cost $ 200\n");
+  EXPECT_THROW(access_log::LogFormat("$nope"), std::runtime_error);
+}
@@ -0,0 +1,124 @@
+#include "aio/ThreadPool.hpp"
+
+#include <gtest/gtest.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <stdexcept>
+
+#include "event/EpollPoller.hpp"
+#include "lib/thread/Mutex.hpp"
+
+namespace {
+
+// counts its runs and completions; Run() may be held until released
+class CountingTask : public aio::Task {
+ public:
+  CountingTask(int* ran, int* completed, lib::thread::Mutex* gate = NULL)
+      : aio::Task(aio::kOpRead),
+        ran_(ran),
+        completed_(completed),
+        gate_(gate) {
+  }
+
+  virtual void Run() {
+    if (gate_) {  // held by the test until it lets the task finish
+      gate_->Lock();
+      gate_->Unlock();
+    }
+    __sync_add_and_fetch(ran_, 1);
+  }
+
+  virtual void Complete(event::Poller& poller) {
+    (void)poller;
+    ++*completed_;
+  }
+
+ private:
+  int* ran_;
+  int* completed_;
+  lib::thread::Mutex* gate_;
+};
+
+class ThreadPoolTest : public ::testing::Test {
+ protected:
+  virtual void TearDown() {
+    aio::ThreadPool::Stop();
+  }
+
+  // dispatches until `want` tasks completed or a second passed
+  void DispatchUntil(int* completed, int want) {
+    for (int i = 0; i < 100 && *completed < want; ++i) {
+      struct pollfd pfd = {aio::ThreadPool::CompletionFd(), POLLIN, 0};
+      if (poll(&pfd, 1, 10) == 1) {
+        aio::ThreadPool::DispatchCompletions(poller_);
+      }
+    }
+  }
+
+  event::EpollPoller poller_;
+};
+
+}  // namespace
+
+TEST_F(ThreadPoolTest, RunsTasksAndCompletesThemOnDispatch) {
+  aio::ThreadPool::Start(2, 16);
+  int ran = 0;
+  int completed = 0;
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_TRUE(aio::ThreadPool::Submit(new CountingTask(&ran, &completed)));
+  }
+  DispatchUntil(&completed, 8);
+  EXPECT_EQ(ran, 8);
+  EXPECT_EQ(completed, 8);
+}
+
+TEST_F(ThreadPoolTest, RejectsTasksBeyondTheQueueBound) {
+  lib::thread::Mutex gate;
+  gate.Lock();  // the only thread blocks in its first task
+  aio::ThreadPool::Start(1, 1);
+  int ran = 0;
+  int completed = 0;
+  ASSERT_TRUE(
+      aio::ThreadPool::Submit(new CountingTask(&ran, &completed, &gate)));
+  while (aio::ThreadPool::QueueLength() != 0) {
+    usleep(1000);  // until the thread has taken it
+  }
+  ASSERT_TRUE(aio::ThreadPool::Submit(new CountingTask(&ran, &completed)));
+  CountingTask* rejected = new CountingTask(&ran, &completed);
+  EXPECT_FALSE(aio::ThreadPool::Submit(rejected));
+  delete rejected;
+
+  gate.Unlock();
+  DispatchUntil(&completed, 2);
+  EXPECT_EQ(completed, 2);
+}
+
+TEST_F(ThreadPoolTest, StopDropsPendingWorkAndRefusesMore) {
+  lib::thread::Mutex gate;
+  gate.Lock();
+  aio::ThreadPool::Start(1, 4);
+  int ran = 0;
+  int completed = 0;
+  ASSERT_TRUE(
+      aio::ThreadPool::Submit(new CountingTask(&ran, &completed, &gate)));
+  ASSERT_TRUE(aio::ThreadPool::Submit(new CountingTask(&ran, &completed)));
+  gate.Unlock();
+  aio::ThreadPool::Stop();
+
+  EXPECT_FALSE(aio::ThreadPool::IsRunning());
+  EXPECT_EQ(aio::ThreadPool::CompletionFd(), -1);
+  EXPECT_EQ(completed, 0);
+  CountingTask* late = new CountingTask(&ran, &completed);
+  EXPECT_FALSE(aio::ThreadPool::Submit(late));
+  delete late;
+}
+
+TEST_F(ThreadPoolTest, StartValidatesItsArguments) {
+  EXPECT_THROW(aio::ThreadPool::Start(0, 1), std::runtime_error);
+  EXPECT_THROW(aio::ThreadPool::Start(aio::ThreadPool::kMaxThreads + 1, 1),
+               std::runtime_error);
+  EXPECT_THROW(aio::ThreadPool::Start(1, 0), std::runtime_error);
+  aio::ThreadPool::Start(1, 1);
+  EXPECT_THROW(aio::ThreadPool::Start(1, 1), std::runtime_error);
+}
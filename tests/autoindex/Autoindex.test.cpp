@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "autoindex/Autoindex.hpp"
+#include "autoindex/ListingCache.hpp"
+#include "autoindex/ListingProducer.hpp"
+#include "lib/io/OutputQueue.hpp"
+
+static lib::io::DirEntry Entry(const std::string& name, bool is_dir) {
+  lib::io::DirEntry e;
+  e.name = name;
+  e.is_dir = is_dir;
+  return e;
+}
+
+static std::vector<lib::io::DirEntry> SampleEntries() {
+  std::vector<lib::io::DirEntry> entries;
+  entries.push_back(Entry("b.txt", false));
+  entries.push_back(Entry("z_dir", true));
+  entries.push_back(Entry("a.txt", false));
+  entries.push_back(Entry("c_dir", true));
+  return entries;
+}
+
+static std::string Names(const std::vector<lib::io::DirEntry>& entries) {
+  std::string out;
+  for (size_t i = 0; i < entries.size(); ++i) out += entries[i].name + " ";
+  return out;
+}
+
+static struct stat OldDirStat(ino_t ino) {
+  struct stat st;
+  std::memset(&st, 0, sizeof(st));
+  st.st_ino = ino;
+  st.st_mtim.tv_sec = std::time(NULL) - 60;
+  return st;
+}
+
+TEST(AutoindexTest, Options_FromQuery) {
+  autoindex::ListingOptions def =
+      autoindex::ListingOptions::FromQuery(autoindex::kHtml, "");
+  EXPECT_EQ(def.sort, autoindex::kSortByType);
+  EXPECT_FALSE(def.descending);
+
+  autoindex::ListingOptions o = autoindex::ListingOptions::FromQuery(
+      autoindex::kJson, "x=1&sort=name&order=desc");
+  EXPECT_EQ(o.format, autoindex::kJson);
+  EXPECT_EQ(o.sort, autoindex::kSortByName);
+  EXPECT_TRUE(o.descending);
+  EXPECT_NE(o.CacheKey(), def.CacheKey());
+}
+
+TEST(AutoindexTest, Sort_DirectoriesFirstInBothOrders) {
+  std::vector<lib::io::DirEntry> entries = SampleEntries();
+  autoindex::ListingOptions options;
+  autoindex::SortEntries(&entries, options);
+  EXPECT_EQ(Names(entries), "c_dir z_dir a.txt b.txt ");
+
+  options.descending = true;
+  autoindex::SortEntries(&entries, options);
+  EXPECT_EQ(Names(entries), "z_dir c_dir b.txt a.txt ");
+
+  options.sort = autoindex::kSortByName;
+  options.descending = false;
+  autoindex::SortEntries(&entries, options);
+  EXPECT_EQ(Names(entries), "a.txt b.txt c_dir z_dir ");
+}
+
+TEST(AutoindexTest, RenderHtml_EscapesNames) {
+  autoindex::ListingOptions options;
+  std::string out = autoindex::RenderHead("/files/", options);
+  autoindex::RenderEntry("/files/", Entry("a<b>&\"c", false), true, options,
+                         &out);
+  autoindex::RenderEntry("/files/", Entry("sub", true), false, options, &out);
+  out += autoindex::RenderTail(options);
+  EXPECT_NE(out.find("<title>Index of /files/</title>"), std::string::npos);
+  EXPECT_NE(out.find("<a href=\"../\">../</a>"), std::string::npos);
+  EXPECT_NE(out.find("<a href=\"/files/a&lt;b&gt;&amp;&quot;c\">"
+                     "a&lt;b&gt;&amp;&quot;c</a>"),
+            std::string::npos);
+  EXPECT_NE(out.find("<a href=\"/files/sub/\">sub/</a>"), std::string::npos);
+}
+
+TEST(AutoindexTest, RenderJson) {
+  autoindex::ListingOptions options;
+  options.format = autoindex::kJson;
+  std::string out = autoindex::RenderHead("/", options);
+  autoindex::RenderEntry("/", Entry("d", true), true, options, &out);
+  autoindex::RenderEntry("/", Entry("q\"\x01", false), false, options, &out);
+  out += autoindex::RenderTail(options);
+  EXPECT_EQ(out,
+            "[\n{\"name\":\"d\",\"type\":\"directory\"},"
+            "\n{\"name\":\"q\\\"\\u0001\",\"type\":\"file\"}\n]\n");
+  EXPECT_EQ(autoindex::ContentType(autoindex::kJson), "application/json");
+}
+
+TEST(ListingCacheTest, InvalidatedByDirectoryMtime) {
+  autoindex::ListingCache::Clear();
+  struct stat st = OldDirStat(42);
+  autoindex::ListingCache::Store("k", st,
+                                 autoindex::ListingCache::Body(
+                                     new std::string("listing")));
+  autoindex::ListingCache::Body hit = autoindex::ListingCache::Find("k", st);
+  ASSERT_FALSE(hit.IsNull());
+  EXPECT_EQ(*hit, "listing");
+
+  st.st_mtim.tv_nsec += 1;
+  EXPECT_TRUE(autoindex::ListingCache::Find("k", st).IsNull());
+  EXPECT_EQ(autoindex::ListingCache::Size(), 0u);
+}
+
+TEST(ListingCacheTest, RecentlyModifiedDirectoryIsNotCached) {
+  autoindex::ListingCache::Clear();
+  struct stat st = OldDirStat(43);
+  st.st_mtim.tv_sec = std::time(NULL);
+  autoindex::ListingCache::Store(
+      "k", st, autoindex::ListingCache::Body(new std::string("x")));
+  EXPECT_TRUE(autoindex::ListingCache::Find("k", st).IsNull());
+}
+
+TEST(ListingProducerTest, StreamsChunksAndFillsCache) {
+  autoindex::ListingCache::Clear();
+  const size_t kEntries = autoindex::ListingProducer::kEntriesPerProduce * 2 + 1;
+  std::vector<lib::io::DirEntry> entries;
+  for (size_t i = 0; i < kEntries; ++i) {
+    entries.push_back(Entry("f" + std::to_string(i), false));
+  }
+  autoindex::ListingOptions options;
+  struct stat st = OldDirStat(44);
+  autoindex::ListingProducer producer(entries, "/big/", options, "big", st);
+  EXPECT_TRUE(entries.empty());
+
+  lib::io::OutputQueue out;
+  int calls = 1;
+  while (!producer.Produce(out)) ++calls;
+  EXPECT_EQ(calls, 3);
+  const std::string body = out.ToString();
+  EXPECT_EQ(body.substr(body.size() - 5), "0\r\n\r\n");
+
+  autoindex::ListingCache::Body cached =
+      autoindex::ListingCache::Find("big", st);
+  ASSERT_FALSE(cached.IsNull());
+  EXPECT_EQ(cached->compare(0, 6, "<html>"), 0);
+  EXPECT_NE(cached->find("/big/f" + std::to_string(kEntries - 1)),
+            std::string::npos);
+  autoindex::ListingCache::Clear();
+}
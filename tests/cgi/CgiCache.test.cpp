@@ -0,0 +1,145 @@
+#include "CgiCache.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "event/Poller.hpp"
+
+namespace {
+
+class FakeWaiter : public cgi::CgiCache::Waiter {
+ public:
+  FakeWaiter() : woken(0) {
+  }
+
+  virtual void OnCacheFilled(event::Poller& poller) {
+    (void)poller;
+    ++woken;
+  }
+
+  int woken;
+};
+
+class CgiCacheTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    poller_ = event::Poller::Create(event::kBackendEpoll);
+  }
+
+  virtual void TearDown() {
+    delete poller_;
+  }
+
+  cgi::CgiCache::Entry MakeEntry(time_t stored_at, int ttl) {
+    cgi::CgiCache::Entry entry;
+    entry.body = lib::type::SharedPtr<const std::string>(
+        new std::string("cached"));
+    entry.stored_at = stored_at;
+    entry.expires_at = stored_at + ttl;
+    return entry;
+  }
+
+  event::Poller* poller_;
+};
+
+}  // namespace
+
+TEST_F(CgiCacheTest, EntriesAreFreshThenStaleThenGone) {
+  cgi::CgiCache cache(8, 5);
+  cache.BeginFill("k");
+  cgi::CgiCache::Entry stored = MakeEntry(100, 10);
+  cache.EndFill(*poller_, "k", &stored);
+
+  cgi::CgiCache::Entry found;
+  EXPECT_EQ(cache.Find("k", 109, &found), cgi::CgiCache::kFresh);
+  EXPECT_EQ(*found.body, "cached");
+  EXPECT_EQ(cache.Find("k", 114, &found), cgi::CgiCache::kStale);
+  EXPECT_EQ(cache.Find("k", 115, &found), cgi::CgiCache::kAbsent);
+  EXPECT_EQ(cache.Size(), 0u);
+  EXPECT_EQ(cache.Find("other", 100, &found), cgi::CgiCache::kAbsent);
+}
+
+TEST_F(CgiCacheTest, EndFillWakesWaitersOnceStoredOrNot) {
+  cgi::CgiCache cache(8, 0);
+  FakeWaiter a, b, gone;
+  cache.BeginFill("k");
+  EXPECT_TRUE(cache.IsFilling("k"));
+  cache.Wait("k", &a);
+  cache.Wait("k", &gone);
+  cache.Wait("k", &b);
+  cache.Cancel(&gone);
+  cache.EndFill(*poller_, "k", NULL);
+  EXPECT_FALSE(cache.IsFilling("k"));
+  EXPECT_EQ(a.woken, 1);
+  EXPECT_EQ(b.woken, 1);
+  EXPECT_EQ(gone.woken, 0);
+  EXPECT_EQ(cache.Size(), 0u);
+}
+
+TEST_F(CgiCacheTest, EvictsOldestBeyondMaxEntries) {
+  cgi::CgiCache cache(2, 0);
+  const char* keys[] = {"a", "b", "c"};
+  for (size_t i = 0; i < 3; ++i) {
+    cgi::CgiCache::Entry entry = MakeEntry(100, 60);
+    cache.EndFill(*poller_, keys[i], &entry);
+  }
+  cgi::CgiCache::Entry found;
+  EXPECT_EQ(cache.Size(), 2u);
+  EXPECT_EQ(cache.Find("a", 100, &found), cgi::CgiCache::kAbsent);
+  EXPECT_EQ(cache.Find("c", 100, &found), cgi::CgiCache::kFresh);
+}
+
+TEST_F(CgiCacheTest, CacheFillStoresOnlyCompleteCacheableOutput) {
+  lib::type::SharedPtr<cgi::CgiCache> cache(new cgi::CgiCache(8, 0));
+  HttpResponse head(lib::http::kOk);
+  head.AddHeader("Content-Length", "11");
+  head.SetBody("hello");
+  {
+    cache->BeginFill("ok");
+    cgi::CacheFill fill(cache, "ok", 30);
+    fill.OnHeaders(head);
+    fill.OnBody(" world", 6);
+    fill.End(*poller_, true);
+  }
+  {
+    cache->BeginFill("failed");
+    cgi::CacheFill fill(cache, "failed", 30);
+    fill.OnHeaders(head);
+    fill.End(*poller_, false);
+  }
+  {
+    cache->BeginFill("dropped");
+    cgi::CacheFill fill(cache, "dropped", 30);
+  }
+  EXPECT_FALSE(cache->IsFilling("dropped"));
+
+  cgi::CgiCache::Entry found;
+  ASSERT_EQ(cache->Find("ok", std::time(NULL), &found),
+            cgi::CgiCache::kFresh);
+  EXPECT_EQ(*found.body, "hello world");
+  EXPECT_FALSE(found.head.HasHeader("content-length"));
+  EXPECT_EQ(cache->Find("failed", std::time(NULL), &found),
+            cgi::CgiCache::kAbsent);
+}
+
+TEST(CgiCacheTtlTest, FollowsStatusAndCacheControl) {
+  HttpResponse ok(lib::http::kOk);
+  EXPECT_EQ(cgi::ResponseTtl(ok, 10), 10);
+
+  HttpResponse not_found(lib::http::kNotFound);
+  EXPECT_EQ(cgi::ResponseTtl(not_found, 10), 0);
+
+  HttpResponse cookie(lib::http::kOk);
+  cookie.AddHeader("Set-Cookie", "id=1");
+  EXPECT_EQ(cgi::ResponseTtl(cookie, 10), 0);
+
+  const char* values[] = {"max-age=60", "Public, Max-Age=60, s-maxage=5",
+                          "no-store", "private, max-age=60", "max-age=abc"};
+  const int expected[] = {60, 5, 0, 0, 10};
+  for (size_t i = 0; i < 5; ++i) {
+    HttpResponse res(lib::http::kOk);
+    res.AddHeader("Cache-Control", values[i]);
+    EXPECT_EQ(cgi::ResponseTtl(res, 10), expected[i]) << values[i];
+  }
+}
@@ -0,0 +1,54 @@
+#include "CgiEnvironment.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::string> Entries(cgi::Environment* env) {
+  std::vector<std::string> entries;
+  for (char* const* p = env->Envp(); *p != NULL; ++p) {
+    entries.push_back(*p);
+  }
+  return entries;
+}
+
+}  // namespace
+
+TEST(CgiEnvironmentTest, StartsWithTheFixedVariablesOnly) {
+  cgi::Environment env;
+  std::vector<std::string> entries = Entries(&env);
+  ASSERT_EQ(entries.size(), 2u);
+  EXPECT_EQ(entries[0], "GATEWAY_INTERFACE=CGI/1.1");
+  EXPECT_EQ(entries[1], "SERVER_SOFTWARE=webserv/1.0");
+  EXPECT_FALSE(env.IsSet(cgi::kRemoteUser));
+}
+
+TEST(CgiEnvironmentTest, SetSlotsAreRenderedInOrder) {
+  cgi::Environment env;
+  env.Set(cgi::kServerPort, "8080");
+  env.Set(cgi::kAuthType, "Basic");
+  env.Set(cgi::kQueryString, "");  // set, even though empty
+  std::vector<std::string> entries = Entries(&env);
+  ASSERT_EQ(entries.size(), 5u);
+  EXPECT_EQ(entries[0], "AUTH_TYPE=Basic");
+  EXPECT_EQ(entries[2], "QUERY_STRING=");
+  EXPECT_EQ(entries[3], "SERVER_PORT=8080");
+  EXPECT_EQ(env.Get(cgi::kServerPort), "8080");
+}
+
+TEST(CgiEnvironmentTest, SetReplacesAndUnsetRemoves) {
+  cgi::Environment env;
+  env.Set(cgi::kRequestMethod, "GET");
+  env.Set(cgi::kRequestMethod, "POST");
+  EXPECT_EQ(env.Get(cgi::kRequestMethod), "POST");
+  env.Unset(cgi::kRequestMethod);
+  env.Unset(cgi::kGatewayInterface);
+  EXPECT_FALSE(env.IsSet(cgi::kRequestMethod));
+  EXPECT_EQ(env.Get(cgi::kRequestMethod), "");
+  std::vector<std::string> entries = Entries(&env);
+  ASSERT_EQ(entries.size(), 1u);
+  EXPECT_EQ(entries[0], "SERVER_SOFTWARE=webserv/1.0");
+}
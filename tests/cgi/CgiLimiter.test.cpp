@@ -0,0 +1,148 @@
+#include "CgiLimiter.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "event/Poller.hpp"
+
+namespace {
+
+// records the order in which queued requests are admitted
+class FakeWaiter : public cgi::CgiLimiter::Waiter {
+ public:
+  FakeWaiter(int id, std::vector<int>* admitted)
+      : id_(id), admitted_(admitted) {
+  }
+
+  virtual void OnAdmitted(event::Poller& poller) {
+    (void)poller;
+    admitted_->push_back(id_);
+  }
+
+ private:
+  int id_;
+  std::vector<int>* admitted_;
+};
+
+class CgiLimiterTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    poller_ = event::Poller::Create(event::kBackendEpoll);
+  }
+
+  virtual void TearDown() {
+    delete poller_;
+  }
+
+  event::Poller* poller_;
+  std::vector<int> admitted_;
+};
+
+}  // namespace
+
+TEST_F(CgiLimiterTest, AdmitsUpToMaxThenQueuesThenRejects) {
+  cgi::CgiLimiter limiter(2, 1);
+  FakeWaiter a(1, &admitted_), b(2, &admitted_), c(3, &admitted_),
+      d(4, &admitted_);
+  EXPECT_EQ(limiter.Admit(*poller_, &a), cgi::CgiLimiter::kAdmitted);
+  EXPECT_EQ(limiter.Admit(*poller_, &b), cgi::CgiLimiter::kAdmitted);
+  EXPECT_EQ(limiter.Admit(*poller_, &c), cgi::CgiLimiter::kQueued);
+  EXPECT_EQ(limiter.Admit(*poller_, &d), cgi::CgiLimiter::kRejected);
+  EXPECT_EQ(limiter.Running(), 2u);
+  EXPECT_EQ(limiter.Queued(), 1u);
+  EXPECT_TRUE(admitted_.empty());
+}
+
+TEST_F(CgiLimiterTest, ReleaseHandsTheSlotOverInArrivalOrder) {
+  cgi::CgiLimiter limiter(1, 4);
+  FakeWaiter a(1, &admitted_), b(2, &admitted_), c(3, &admitted_);
+  ASSERT_EQ(limiter.Admit(*poller_, &a), cgi::CgiLimiter::kAdmitted);
+  ASSERT_EQ(limiter.Admit(*poller_, &b), cgi::CgiLimiter::kQueued);
+  ASSERT_EQ(limiter.Admit(*poller_, &c), cgi::CgiLimiter::kQueued);
+
+  limiter.Release(*poller_);
+  ASSERT_EQ(admitted_.size(), 1u);
+  EXPECT_EQ(admitted_[0], 2);
+  EXPECT_EQ(limiter.Running(), 1u);  // passed on, not freed
+
+  limiter.Release(*poller_);
+  limiter.Release(*poller_);
+  ASSERT_EQ(admitted_.size(), 2u);
+  EXPECT_EQ(admitted_[1], 3);
+  EXPECT_EQ(limiter.Running(), 0u);
+  EXPECT_EQ(limiter.Queued(), 0u);
+}
+
+TEST_F(CgiLimiterTest, CancelledWaiterIsSkipped) {
+  cgi::CgiLimiter limiter(1, 4);
+  FakeWaiter a(1, &admitted_), b(2, &admitted_), c(3, &admitted_);
+  ASSERT_EQ(limiter.Admit(*poller_, &a), cgi::CgiLimiter::kAdmitted);
+  ASSERT_EQ(limiter.Admit(*poller_, &b), cgi::CgiLimiter::kQueued);
+  ASSERT_EQ(limiter.Admit(*poller_, &c), cgi::CgiLimiter::kQueued);
+  limiter.Cancel(&b);
+  limiter.Cancel(&b);  // no longer queued: no-op
+  EXPECT_EQ(limiter.Queued(), 1u);
+
+  limiter.Release(*poller_);
+  ASSERT_EQ(admitted_.size(), 1u);
+  EXPECT_EQ(admitted_[0], 3);
+}
+
+// a slot freed without a poller goes to the queue head on the next call,
+// never to a newcomer, and never stays free while requests wait
+TEST_F(CgiLimiterTest, NewcomersDoNotOvertakeTheQueue) {
+  cgi::CgiLimiter limiter(1, 4);
+  FakeWaiter a(1, &admitted_), b(2, &admitted_), c(3, &admitted_);
+  ASSERT_EQ(limiter.Admit(*poller_, &a), cgi::CgiLimiter::kAdmitted);
+  ASSERT_EQ(limiter.Admit(*poller_, &b), cgi::CgiLimiter::kQueued);
+  limiter.Release();  // freed without waking anyone
+  EXPECT_TRUE(admitted_.empty());
+  EXPECT_EQ(limiter.Admit(*poller_, &c), cgi::CgiLimiter::kQueued);
+  ASSERT_EQ(admitted_.size(), 1u);
+  EXPECT_EQ(admitted_[0], 2);
+  EXPECT_EQ(limiter.Running(), 1u);
+}
+
+TEST_F(CgiLimiterTest, ReleaseWithPollerWakesAllFreeSlots) {
+  cgi::CgiLimiter limiter(2, 4);
+  FakeWaiter a(1, &admitted_), b(2, &admitted_), c(3, &admitted_),
+      d(4, &admitted_);
+  ASSERT_EQ(limiter.Admit(*poller_, &a), cgi::CgiLimiter::kAdmitted);
+  ASSERT_EQ(limiter.Admit(*poller_, &b), cgi::CgiLimiter::kAdmitted);
+  ASSERT_EQ(limiter.Admit(*poller_, &c), cgi::CgiLimiter::kQueued);
+  ASSERT_EQ(limiter.Admit(*poller_, &d), cgi::CgiLimiter::kQueued);
+  limiter.Release();
+  limiter.Release(*poller_);
+  ASSERT_EQ(admitted_.size(), 2u);
+  EXPECT_EQ(limiter.Running(), 2u);
+  EXPECT_EQ(limiter.Queued(), 0u);
+}
+
+// a reload's limiter for the same location: the running script still counts
+TEST_F(CgiLimiterTest, ShareKeepsTheRegisteredLimiterWithNewLimits) {
+  lib::type::SharedPtr<cgi::CgiLimiter> first(new cgi::CgiLimiter(1, 0));
+  ASSERT_EQ(cgi::CgiLimiter::Share("test /cgi", first).Get(), first.Get());
+  FakeWaiter a(1, &admitted_), b(2, &admitted_), c(3, &admitted_);
+  ASSERT_EQ(first->Admit(*poller_, &a), cgi::CgiLimiter::kAdmitted);
+
+  lib::type::SharedPtr<cgi::CgiLimiter> reloaded(new cgi::CgiLimiter(2, 1));
+  lib::type::SharedPtr<cgi::CgiLimiter> shared =
+      cgi::CgiLimiter::Share("test /cgi", reloaded);
+  ASSERT_EQ(shared.Get(), first.Get());
+  EXPECT_EQ(shared->Running(), 1u);
+  EXPECT_EQ(shared->Admit(*poller_, &b), cgi::CgiLimiter::kAdmitted);
+  EXPECT_EQ(shared->Admit(*poller_, &c), cgi::CgiLimiter::kQueued);
+  shared->Cancel(&c);
+  shared->Release();
+  shared->Release();
+}
+
+TEST_F(CgiLimiterTest, ShareDropsLimitersNothingRefersTo) {
+  {
+    lib::type::SharedPtr<cgi::CgiLimiter> gone(new cgi::CgiLimiter(1, 0));
+    cgi::CgiLimiter::Share("test /dropped", gone);
+  }
+  lib::type::SharedPtr<cgi::CgiLimiter> next(new cgi::CgiLimiter(1, 0));
+  EXPECT_EQ(cgi::CgiLimiter::Share("test /dropped", next).Get(), next.Get());
+}
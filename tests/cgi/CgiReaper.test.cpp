@@ -0,0 +1,65 @@
+#include "CgiReaper.hpp"
+
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <csignal>
+
+namespace {
+
+// a child that ignores SIGTERM unless told otherwise
+pid_t SpawnSleeper(bool ignore_sigterm) {
+  pid_t pid = fork();
+  if (pid == 0) {
+    if (ignore_sigterm) signal(SIGTERM, SIG_IGN);
+    for (;;) pause();
+  }
+  return pid;
+}
+
+bool IsReaped(pid_t pid) {
+  return waitpid(pid, NULL, WNOHANG) == -1 && errno == ECHILD;
+}
+
+class CgiReaperTest : public ::testing::Test {
+ protected:
+  virtual void TearDown() {
+    cgi::CgiReaper::KillAll();
+  }
+};
+
+}  // namespace
+
+TEST_F(CgiReaperTest, ReapsChildThatHonoursSigterm) {
+  pid_t pid = SpawnSleeper(false);
+  ASSERT_GT(pid, 0);
+  cgi::CgiReaper::Adopt(pid);
+  for (int i = 0; i < 200 && cgi::CgiReaper::Size() != 0; ++i) {
+    usleep(5000);
+    cgi::CgiReaper::Reap();
+  }
+  EXPECT_EQ(cgi::CgiReaper::Size(), 0u);
+  EXPECT_TRUE(IsReaped(pid));
+}
+
+TEST_F(CgiReaperTest, KeepsChildIgnoringSigtermUntilKilled) {
+  pid_t pid = SpawnSleeper(true);
+  ASSERT_GT(pid, 0);
+  usleep(50000);  // let it install SIG_IGN
+  cgi::CgiReaper::Adopt(pid);
+  usleep(50000);
+  cgi::CgiReaper::Reap();  // within the grace period
+  EXPECT_EQ(cgi::CgiReaper::Size(), 1u);
+
+  cgi::CgiReaper::KillAll();
+  EXPECT_EQ(cgi::CgiReaper::Size(), 0u);
+  EXPECT_TRUE(IsReaped(pid));
+}
+
+TEST_F(CgiReaperTest, IgnoresInvalidPids) {
+  cgi::CgiReaper::Adopt(-1);
+  cgi::CgiReaper::Adopt(0);
+  EXPECT_EQ(cgi::CgiReaper::Size(), 0u);
+}
@@ -74,3 +74,52 @@ TEST(CgiResponseParserTest, MalformedHeader) {
   EXPECT_THROW(cgi::ParseCgiResponse(output),
                lib::exception::ResponseStatusException);
 }
+
+// output arrives from the pipe in pieces; the header block completes first
+TEST(CgiResponseParserTest, Incremental_DoneOnceHeadersComplete) {
+  cgi::CgiResponseParser parser;
+  std::string first = "Content-Type: text/plain\r\nX-A: 1\r";
+  std::string second = "\n\r\npartial body";
+  parser.Parse(first.c_str(), first.size());
+  EXPECT_FALSE(parser.IsDone());
+  parser.Parse(second.c_str(), second.size());
+  ASSERT_TRUE(parser.IsDone());
+  HttpResponse res = parser.GetResponse();
+  EXPECT_EQ(res.GetHeader("x-a").ValueOr(""), "1");
+  EXPECT_EQ(res.GetBody(), "partial body");
+}
+
+TEST(CgiResponseParserTest, Incremental_UnterminatedHeadersRejected) {
+  cgi::CgiResponseParser parser;
+  std::string line = "X-Filler: " + std::string(1000, 'x') + "\r\n";
+  EXPECT_THROW(
+      {
+        for (int i = 0; i < 10; ++i) parser.Parse(line.c_str(), line.size());
+      },
+      lib::exception::ResponseStatusException);
+}
+
+TEST(CgiResponseParserTest, InternalRedirectHeadersAreTakenOut) {
+  cgi::CgiResponseParser accel;
+  std::string output =
+      "x-accel-redirect: /protected/a.bin\r\n"
+      "Content-Disposition: attachment\r\n\r\nignored";
+  accel.Parse(output.c_str(), output.size());
+  ASSERT_TRUE(accel.IsDone());
+  EXPECT_EQ(accel.GetInternalRedirect().ValueOr(""), "/protected/a.bin");
+  EXPECT_FALSE(accel.IsSendfile());
+  HttpResponse res = accel.GetResponse();
+  EXPECT_FALSE(res.HasHeader("x-accel-redirect"));
+  EXPECT_TRUE(res.HasHeader("content-disposition"));
+
+  cgi::CgiResponseParser sendfile;
+  output = "X-Sendfile: /data/a.bin\r\n\r\n";
+  sendfile.Parse(output.c_str(), output.size());
+  EXPECT_EQ(sendfile.GetInternalRedirect().ValueOr(""), "/data/a.bin");
+  EXPECT_TRUE(sendfile.IsSendfile());
+
+  cgi::CgiResponseParser plain;
+  output = "Content-Type: text/plain\r\n\r\n";
+  plain.Parse(output.c_str(), output.size());
+  EXPECT_FALSE(plain.GetInternalRedirect().HasValue());
+}
@@ -117,3 +117,44 @@ TEST(ConfigParser, Server_FindLocation_TrailingSlashes) {
     EXPECT_EQ(m3.remainder, "/");
   }
 }
+
+// the longest prefix wins regardless of declaration order, also on copies
+TEST(ConfigParser, Server_FindLocation_LongestPrefixAnyOrder) {
+  ConfigParser parser;
+  parser.content =
+      "{ "
+      "listen 8080; "
+      "location /a { root /a; } "
+      "location /a/b/c { root /abc; } "
+      "location / { root /www; } "
+      "location /a/b { root /ab; } "
+      "}";
+  ASSERT_NO_THROW(parser.ParseServer());
+  const ServerConfig server = parser.GetServerConfigs()[0];
+  EXPECT_EQ(server.FindLocationForUri("/a/b/c/d").loc->GetName(), "/a/b/c");
+  EXPECT_EQ(server.FindLocationForUri("/a/b/x").loc->GetName(), "/a/b");
+  EXPECT_EQ(server.FindLocationForUri("/a/bc").loc->GetName(), "/a");
+  EXPECT_EQ(server.FindLocationForUri("/b").loc->GetName(), "/");
+  EXPECT_EQ(server.FindLocationForUri("/a/b/").remainder, "/");
+}
+
+// X-Sendfile paths map to the internal location with the deepest root
+TEST(ConfigParser, Server_FindInternalUriForPath) {
+  ConfigParser parser;
+  parser.content =
+      "{ "
+      "listen 8080; "
+      "location /files { root /data; internal; } "
+      "location /videos/ { root /data/videos; internal; } "
+      "location /public { root /srv; } "
+      "}";
+  ASSERT_NO_THROW(parser.ParseServer());
+  const ServerConfig& server = parser.GetServerConfigs()[0];
+  EXPECT_EQ(server.FindInternalUriForPath("/data/a/b.txt").ValueOr(""),
+            "/files/a/b.txt");
+  EXPECT_EQ(server.FindInternalUriForPath("/data/videos/c.mp4").ValueOr(""),
+            "/videos/c.mp4");
+  EXPECT_EQ(server.FindInternalUriForPath("/data").ValueOr(""), "/files/");
+  EXPECT_FALSE(server.FindInternalUriForPath("/database/x").HasValue());
+  EXPECT_FALSE(server.FindInternalUriForPath("/srv/index.html").HasValue());
+}
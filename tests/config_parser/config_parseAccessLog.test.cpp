@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "ConfigParser.hpp"
+#include "HttpRequest.hpp"
+#include "access_log/LogFormat.hpp"
+
+static void callParseServer(const std::string& input, ConfigParser* parser) {
+  parser->content = input;
+  parser->ParseServer();
+}
+
+// ==================== happy path ====================
+TEST(ConfigParser, ParseAccessLog_DefaultIsOff) {
+  ConfigParser parser;
+  EXPECT_NO_THROW(callParseServer("{ listen 8080; }", &parser));
+  EXPECT_EQ(parser.GetServerConfigs()[0].GetAccessLogPath(), "");
+  EXPECT_FALSE(parser.GetServerConfigs()[0].HasLogLevel());
+}
+
+TEST(ConfigParser, ParseAccessLog_PathOnly) {
+  ConfigParser parser;
+  EXPECT_NO_THROW(callParseServer(
+      "{ listen 8080; access_log /var/log/webserv/access.log; }", &parser));
+  EXPECT_EQ(parser.GetServerConfigs()[0].GetAccessLogPath(),
+            "/var/log/webserv/access.log");
+}
+
+TEST(ConfigParser, ParseAccessLog_CustomFormatJoinsTokens) {
+  ConfigParser parser;
+  EXPECT_NO_THROW(callParseServer(
+      "{ listen 8080; access_log /tmp/a.log $status  $request_time; }",
+      &parser));
+  HttpRequest req;
+  access_log::Entry entry;
+  entry.request = &req;
+  entry.status = 204;
+  entry.request_time_us = 1500;
+  std::string line;
+  parser.GetServerConfigs()[0].GetAccessLogFormat().Render(entry, &line);
+  EXPECT_EQ(line, "204 0.001\n");
+}
+
+TEST(ConfigParser, ParseAccessLog_Off) {
+  ConfigParser parser;
+  EXPECT_NO_THROW(callParseServer("{ listen 8080; access_log off; }", &parser));
+  EXPECT_EQ(parser.GetServerConfigs()[0].GetAccessLogPath(), "");
+}
+
+TEST(ConfigParser, ParseLogLevel_OK) {
+  ConfigParser parser;
+  EXPECT_NO_THROW(callParseServer("{ listen 8080; log_level warn; }", &parser));
+  EXPECT_TRUE(parser.GetServerConfigs()[0].HasLogLevel());
+  EXPECT_EQ(parser.GetServerConfigs()[0].GetLogLevel(), lib::logging::kWarn);
+}
+
+// ==================== error cases ====================
+TEST(ConfigParser, ParseAccessLog_Invalid_Throws) {
+  ConfigParser p1;
+  EXPECT_THROW(callParseServer("{ access_log; }", &p1), std::runtime_error);
+  ConfigParser p2;
+  EXPECT_THROW(callParseServer("{ access_log /tmp/a.log combined }", &p2),
+               std::runtime_error);
+  ConfigParser p3;
+  EXPECT_THROW(callParseServer("{ access_log off combined; }", &p3),
+               std::runtime_error);
+  ConfigParser p4;
+  EXPECT_THROW(callParseServer("{ access_log /tmp/a.log $nope; }", &p4),
+               std::runtime_error);
+}
+
+TEST(ConfigParser, ParseAccessLog_Duplicate_Throws) {
+  ConfigParser parser;
+  EXPECT_THROW(callParseServer(
+                   "{ access_log off; access_log /tmp/a.log; }", &parser),
+               std::runtime_error);
+}
+
+TEST(ConfigParser, ParseLogLevel_Invalid_Throws) {
+  ConfigParser p1;
+  EXPECT_THROW(callParseServer("{ log_level verbose; }", &p1),
+               std::runtime_error);
+  ConfigParser p2;
+  EXPECT_THROW(callParseServer("{ log_level info; log_level debug; }", &p2),
+               std::runtime_error);
+}
+
+TEST(ConfigParser, ParseSlowLog_OK) {
+  ConfigParser parser;
+  EXPECT_NO_THROW(callParseServer(
+      "{ listen 8080; slow_log /tmp/slow.log 250 sample=100; }", &parser));
+  const ServerConfig& sc = parser.GetServerConfigs()[0];
+  EXPECT_EQ(sc.GetSlowLogPath(), "/tmp/slow.log");
+  EXPECT_EQ(sc.GetSlowLogThresholdMicros(), 250000u);
+  EXPECT_EQ(sc.GetSlowLogSample(), 100u);
+
+  ConfigParser no_sample;
+  EXPECT_NO_THROW(callParseServer(
+      "{ listen 8080; slow_log /tmp/slow.log 0; }", &no_sample));
+  EXPECT_EQ(no_sample.GetServerConfigs()[0].GetSlowLogSample(), 0u);
+}
+
+TEST(ConfigParser, ParseSlowLog_Invalid_Throws) {
+  ConfigParser p1;
+  EXPECT_THROW(callParseServer("{ slow_log /tmp/slow.log; }", &p1),
+               std::runtime_error);
+  ConfigParser p2;
+  EXPECT_THROW(callParseServer("{ slow_log /tmp/slow.log 1s; }", &p2),
+               std::runtime_error);
+  ConfigParser p3;
+  EXPECT_THROW(callParseServer("{ slow_log /tmp/slow.log 10 sample=x; }", &p3),
+               std::runtime_error);
+  ConfigParser p4;
+  EXPECT_THROW(callParseServer("{ slow_log /tmp/slow.log 10 20; }", &p4),
+               std::runtime_error);
+  ConfigParser p5;
+  EXPECT_THROW(callParseServer("{ slow_log off; slow_log off; }", &p5),
+               std::runtime_error);
+}
@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "ConfigParser.hpp"
+
+static void callParseServer(const std::string& input, ConfigParser* parser) {
+  parser->content = input;
+  parser->ParseServer();
+}
+
+// ==================== happy path ====================
+TEST(ConfigParser, ParseAioThreads_Default) {
+  ServerConfig sc;
+  EXPECT_EQ(sc.GetAioThreads(), 0u);
+  EXPECT_EQ(sc.GetAioMaxQueue(), ServerConfig::kDefaultAioMaxQueue);
+}
+
+TEST(ConfigParser, ParseAioThreads_OK) {
+  ConfigParser p1;
+  EXPECT_NO_THROW(callParseServer("{ listen 8080; aio_threads 4; }", &p1));
+  EXPECT_EQ(p1.GetServerConfigs()[0].GetAioThreads(), 4u);
+  EXPECT_EQ(p1.GetServerConfigs()[0].GetAioMaxQueue(),
+            ServerConfig::kDefaultAioMaxQueue);
+
+  ConfigParser p2;
+  EXPECT_NO_THROW(callParseServer(
+      "{ listen 8080; aio_threads 2 max_queue=64; }", &p2));
+  EXPECT_EQ(p2.GetServerConfigs()[0].GetAioThreads(), 2u);
+  EXPECT_EQ(p2.GetServerConfigs()[0].GetAioMaxQueue(), 64u);
+
+  ConfigParser p3;
+  EXPECT_NO_THROW(callParseServer("{ listen 8080; aio_threads off; }", &p3));
+  EXPECT_EQ(p3.GetServerConfigs()[0].GetAioThreads(), 0u);
+}
+
+// ==================== error cases ====================
+TEST(ConfigParser, ParseAioThreads_Invalid_Throws) {
+  const char* inputs[] = {
+      "{ aio_threads; }",
+      "{ aio_threads 0; }",
+      "{ aio_threads 16; }",  // more than the worker slots
+      "{ aio_threads -1; }",
+      "{ aio_threads 2 max_queue=0; }",
+      "{ aio_threads 2 max_queue=; }",
+      "{ aio_threads 2 queue=8; }",
+      "{ aio_threads 2 }",
+      "{ aio_threads 2; aio_threads 2; }",
+  };
+  for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); ++i) {
+    ConfigParser parser;
+    EXPECT_THROW(callParseServer(inputs[i], &parser), std::runtime_error)
+        << inputs[i];
+  }
+}
@@ -74,3 +74,29 @@ TEST_F(ConfigParserTest, ErrorMessage_MissingValue_EmptyInput) {
                              "expected autoindex value");
 }
 
+
+// autoindex_format
+TEST_F(ConfigParserTest, ParseAutoIndexFormat_DefaultIsHtml) {
+  EXPECT_EQ(loc.GetAutoIndexFormat(), "html");
+}
+
+TEST_F(ConfigParserTest, ParseAutoIndexFormat_Json) {
+  parser.content = "json;";
+  EXPECT_NO_THROW(parser.ParseAutoIndexFormat(&loc));
+  EXPECT_EQ(loc.GetAutoIndexFormat(), "json");
+}
+
+TEST_F(ConfigParserTest, ParseAutoIndexFormat_InvalidValue_Throws) {
+  parser.content = "xml;";
+  EXPECT_THROW_WHAT_CONTAINS(parser.ParseAutoIndexFormat(&loc),
+                             std::runtime_error,
+                             "Invalid autoindex_format value");
+}
+
+TEST_F(ConfigParserTest, ParseAutoIndexFormat_Duplicate_Throws) {
+  parser.content = "html; json;";
+  EXPECT_NO_THROW(parser.ParseAutoIndexFormat(&loc));
+  EXPECT_THROW_WHAT_CONTAINS(parser.ParseAutoIndexFormat(&loc),
+                             std::runtime_error,
+                             "Duplicate autoindex_format directive");
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "ConfigParser.hpp"
+
+static void callParseServer(const std::string& input, ConfigParser* parser) {
+  parser->content = input;
+  parser->ParseServer();
+}
+
+// ==================== happy path ====================
+TEST(ConfigParser, ParseCgiCache_DefaultsToNoCache) {
+  ConfigParser parser;
+  EXPECT_NO_THROW(
+      callParseServer("{ listen 8080; location /cgi { cgi on; } }", &parser));
+  const Location& loc = parser.GetServerConfigs()[0].GetLocations()[0];
+  EXPECT_EQ(loc.GetCgiCacheTtl(), 0);
+  EXPECT_TRUE(loc.GetCgiCache().IsNull());
+}
+
+TEST(ConfigParser, ParseCgiCache_OK) {
+  ConfigParser parser;
+  EXPECT_NO_THROW(callParseServer(
+      "{ listen 8080; location /cgi { cgi on; "
+      "cgi_cache 5 stale=30 max_entries=100; "
+      "cgi_cache_key $request_method $request_uri $http_accept_language; } }",
+      &parser));
+  const Location& loc = parser.GetServerConfigs()[0].GetLocations()[0];
+  EXPECT_EQ(loc.GetCgiCacheTtl(), 5);
+  EXPECT_EQ(loc.GetCgiCacheStale(), 30);
+  EXPECT_EQ(loc.GetCgiCacheMaxEntries(), 100u);
+  ASSERT_FALSE(loc.GetCgiCache().IsNull());
+  EXPECT_EQ(loc.GetCgiCache()->Size(), 0u);
+}
+
+TEST(ConfigParser, ParseCgiCache_OffAndDefaults) {
+  ConfigParser parser;
+  EXPECT_NO_THROW(callParseServer(
+      "{ listen 8080; location /a { cgi_cache off; } "
+      "location /b { cgi_cache 1; } }",
+      &parser));
+  const Location& off = parser.GetServerConfigs()[0].GetLocations()[0];
+  EXPECT_TRUE(off.GetCgiCache().IsNull());
+  const Location& on = parser.GetServerConfigs()[0].GetLocations()[1];
+  EXPECT_EQ(on.GetCgiCacheStale(), 0);
+  EXPECT_EQ(on.GetCgiCacheMaxEntries(), Location::kDefaultCgiCacheMaxEntries);
+  EXPECT_FALSE(on.GetCgiCache().IsNull());
+}
+
+// ==================== error cases ====================
+TEST(ConfigParser, ParseCgiCache_Invalid_Throws) {
+  const char* inputs[] = {
+      "{ location /cgi { cgi_cache; } }",
+      "{ location /cgi { cgi_cache 0; } }",
+      "{ location /cgi { cgi_cache 5s; } }",
+      "{ location /cgi { cgi_cache 5 stale=; } }",
+      "{ location /cgi { cgi_cache 5 max_entries=0; } }",
+      "{ location /cgi { cgi_cache 5 max_entries=1 stale=1; } }",
+      "{ location /cgi { cgi_cache 5; cgi_cache 5; } }",
+      "{ location /cgi { cgi_cache_key; } }",
+      "{ location /cgi { cgi_cache_key $no_such_variable; } }",
+      "{ location /cgi { cgi_cache_key $uri; cgi_cache_key $uri; } }",
+  };
+  for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); ++i) {
+    ConfigParser parser;
+    EXPECT_THROW(callParseServer(inputs[i], &parser), std::runtime_error)
+        << inputs[i];
+  }
+}
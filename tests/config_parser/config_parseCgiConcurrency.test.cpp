@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "ConfigParser.hpp"
+
+static void callParseServer(const std::string& input, ConfigParser* parser) {
+  parser->content = input;
+  parser->ParseServer();
+}
+
+// ==================== happy path ====================
+TEST(ConfigParser, ParseCgiConcurrency_DefaultsToNoLimiter) {
+  ConfigParser parser;
+  EXPECT_NO_THROW(
+      callParseServer("{ listen 8080; location /cgi { cgi on; } }", &parser));
+  const Location& loc = parser.GetServerConfigs()[0].GetLocations()[0];
+  EXPECT_EQ(loc.GetCgiMaxConcurrent(), 0u);
+  EXPECT_EQ(loc.GetCgiQueueSize(), Location::kDefaultCgiQueueSize);
+  EXPECT_EQ(loc.GetCgiQueueTimeout(), Location::kDefaultCgiQueueTimeout);
+  EXPECT_TRUE(loc.GetCgiLimiter().IsNull());
+}
+
+TEST(ConfigParser, ParseCgiConcurrency_OK) {
+  ConfigParser parser;
+  EXPECT_NO_THROW(callParseServer(
+      "{ listen 8080; location /cgi { cgi on; cgi_max_concurrent 4; "
+      "cgi_queue_size 0; cgi_queue_timeout 3; } }",
+      &parser));
+  const Location& loc = parser.GetServerConfigs()[0].GetLocations()[0];
+  EXPECT_EQ(loc.GetCgiMaxConcurrent(), 4u);
+  EXPECT_EQ(loc.GetCgiQueueSize(), 0u);
+  EXPECT_EQ(loc.GetCgiQueueTimeout(), 3);
+  ASSERT_FALSE(loc.GetCgiLimiter().IsNull());
+  EXPECT_EQ(loc.GetCgiLimiter()->Running(), 0u);
+}
+
+// ==================== error cases ====================
+TEST(ConfigParser, ParseCgiConcurrency_Invalid_Throws) {
+  const char* inputs[] = {
+      "{ location /cgi { cgi_max_concurrent -1; } }",
+      "{ location /cgi { cgi_max_concurrent 5000; } }",
+      "{ location /cgi { cgi_max_concurrent; } }",
+      "{ location /cgi { cgi_queue_size 10k; } }",
+      "{ location /cgi { cgi_queue_timeout 0; } }",
+      "{ location /cgi { cgi_queue_timeout 2 3; } }",
+      "{ location /cgi { cgi_max_concurrent 1; cgi_max_concurrent 1; } }",
+      "{ location /cgi { cgi_queue_size 1; cgi_queue_size 1; } }",
+  };
+  for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); ++i) {
+    ConfigParser parser;
+    EXPECT_THROW(callParseServer(inputs[i], &parser), std::runtime_error)
+        << inputs[i];
+  }
+}
@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "ConfigParser.hpp"
+
+static void callParseServer(const std::string& input, ConfigParser* parser) {
+  parser->content = input;
+  parser->ParseServer();
+}
+
+// ==================== happy path ====================
+TEST(ConfigParser, ParseCgiTimeouts_Defaults) {
+  Location loc;
+  EXPECT_EQ(loc.GetCgiReadTimeout(), Location::kDefaultCgiReadTimeout);
+  EXPECT_EQ(loc.GetCgiTotalTimeout(), 0);
+}
+
+TEST(ConfigParser, ParseCgiTimeouts_OK) {
+  ConfigParser parser;
+  EXPECT_NO_THROW(callParseServer(
+      "{ listen 8080; location /cgi { cgi on; cgi_read_timeout 30; "
+      "cgi_total_timeout 120; } }",
+      &parser));
+  const Location& loc = parser.GetServerConfigs()[0].GetLocations()[0];
+  EXPECT_EQ(loc.GetCgiReadTimeout(), 30);
+  EXPECT_EQ(loc.GetCgiTotalTimeout(), 120);
+}
+
+// ==================== error cases ====================
+TEST(ConfigParser, ParseCgiTimeouts_Invalid_Throws) {
+  const char* inputs[] = {
+      "{ location /cgi { cgi_read_timeout 0; } }",
+      "{ location /cgi { cgi_read_timeout -1; } }",
+      "{ location /cgi { cgi_read_timeout 90000; } }",
+      "{ location /cgi { cgi_total_timeout 10s; } }",
+      "{ location /cgi { cgi_total_timeout; } }",
+      "{ location /cgi { cgi_read_timeout 5 6; } }",
+      "{ location /cgi { cgi_read_timeout 5; cgi_read_timeout 5; } }",
+      "{ location /cgi { cgi_total_timeout 5; cgi_total_timeout 5; } }",
+  };
+  for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); ++i) {
+    ConfigParser parser;
+    EXPECT_THROW(callParseServer(inputs[i], &parser), std::runtime_error)
+        << inputs[i];
+  }
+}
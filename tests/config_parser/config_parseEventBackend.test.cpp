@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "ConfigParser.hpp"
+
+static void callParseServer(const std::string& input, ConfigParser* parser) {
+  parser->content = input;
+  parser->ParseServer();
+}
+
+// ==================== happy path ====================
+TEST(ConfigParser, ParseEventBackend_Default) {
+  ServerConfig sc;
+  EXPECT_FALSE(sc.HasEventBackend());
+  EXPECT_EQ(sc.GetEventBackend(), event::kBackendEpoll);
+}
+
+TEST(ConfigParser, ParseEventBackend_OK) {
+  ConfigParser parser;
+  EXPECT_NO_THROW(
+      callParseServer("{ listen 8080; event_backend io_uring; }", &parser));
+  EXPECT_TRUE(parser.GetServerConfigs()[0].HasEventBackend());
+  EXPECT_EQ(parser.GetServerConfigs()[0].GetEventBackend(),
+            event::kBackendIoUring);
+}
+
+// ==================== error cases ====================
+TEST(ConfigParser, ParseEventBackend_Invalid_Throws) {
+  ConfigParser p1;
+  EXPECT_THROW(callParseServer("{ event_backend kqueue; }", &p1),
+               std::runtime_error);
+  ConfigParser p2;
+  EXPECT_THROW(callParseServer("{ event_backend epoll io_uring; }", &p2),
+               std::runtime_error);
+  ConfigParser p3;
+  EXPECT_THROW(
+      callParseServer("{ event_backend epoll; event_backend epoll; }", &p3),
+      std::runtime_error);
+}
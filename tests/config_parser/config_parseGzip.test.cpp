@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "ConfigParser.hpp"
+
+static void callParseServer(const std::string& input, ConfigParser* parser) {
+  parser->content = input;
+  parser->ParseServer();
+}
+
+// ==================== happy path ====================
+TEST(ConfigParser, ParseGzip_Defaults) {
+  ServerConfig sc;
+  EXPECT_FALSE(sc.GetGzip());
+  EXPECT_EQ(sc.GetGzipMinLength(), 20u);
+  EXPECT_EQ(sc.GetGzipCompLevel(), 1);
+  EXPECT_TRUE(sc.IsGzipType("text/html"));
+  EXPECT_FALSE(sc.IsGzipType("text/css"));
+}
+
+TEST(ConfigParser, ParseGzip_AllDirectives_OK) {
+  ConfigParser parser;
+  EXPECT_NO_THROW(callParseServer(
+      "{ listen 8080; gzip on; gzip_types text/css application/json; "
+      "gzip_min_length 1024; gzip_comp_level 6; }",
+      &parser));
+  const ServerConfig& sc = parser.GetServerConfigs()[0];
+  EXPECT_TRUE(sc.GetGzip());
+  EXPECT_EQ(sc.GetGzipMinLength(), 1024u);
+  EXPECT_EQ(sc.GetGzipCompLevel(), 6);
+  EXPECT_TRUE(sc.IsGzipType("text/html"));
+  EXPECT_TRUE(sc.IsGzipType("text/css"));
+  EXPECT_TRUE(sc.IsGzipType("Application/JSON; charset=utf-8"));
+  EXPECT_FALSE(sc.IsGzipType("image/png"));
+}
+
+TEST(ConfigParser, ParseGzipTypes_Star_MatchesAnything) {
+  ConfigParser parser;
+  EXPECT_NO_THROW(callParseServer("{ gzip_types *; }", &parser));
+  EXPECT_TRUE(parser.GetServerConfigs()[0].IsGzipType("image/png"));
+}
+
+// ==================== error cases ====================
+TEST(ConfigParser, ParseGzip_InvalidValue_Throws) {
+  ConfigParser parser;
+  EXPECT_THROW(callParseServer("{ gzip yes; }", &parser), std::runtime_error);
+}
+
+TEST(ConfigParser, ParseGzip_Duplicate_Throws) {
+  ConfigParser parser;
+  EXPECT_THROW(callParseServer("{ gzip on; gzip off; }", &parser),
+               std::runtime_error);
+}
+
+TEST(ConfigParser, ParseGzipTypes_NotAMimeType_Throws) {
+  ConfigParser parser;
+  EXPECT_THROW(callParseServer("{ gzip_types html; }", &parser),
+               std::runtime_error);
+}
+
+TEST(ConfigParser, ParseGzipMinLength_NonNumeric_Throws) {
+  ConfigParser parser;
+  EXPECT_THROW(callParseServer("{ gzip_min_length -1; }", &parser),
+               std::runtime_error);
+}
+
+TEST(ConfigParser, ParseGzipCompLevel_OutOfRange_Throws) {
+  ConfigParser parser;
+  EXPECT_THROW(callParseServer("{ gzip_comp_level 0; }", &parser),
+               std::runtime_error);
+  ConfigParser parser2;
+  EXPECT_THROW(callParseServer("{ gzip_comp_level 10; }", &parser2),
+               std::runtime_error);
+}
+
+TEST(ConfigParser, ParseGzipStatic_InLocation_OK) {
+  ConfigParser parser;
+  EXPECT_NO_THROW(callParseServer(
+      "{ location /assets { root /tmp; gzip_static on; brotli_static on; } "
+      "location / { root /tmp; } }",
+      &parser));
+  const std::vector<Location>& locs =
+      parser.GetServerConfigs()[0].GetLocations();
+  ASSERT_EQ(locs.size(), 2u);
+  EXPECT_TRUE(locs[0].GetGzipStatic());
+  EXPECT_TRUE(locs[0].GetBrotliStatic());
+  EXPECT_FALSE(locs[1].GetGzipStatic());
+  EXPECT_FALSE(locs[1].GetBrotliStatic());
+}
+
+TEST(ConfigParser, ParseGzipStatic_InvalidOrDuplicate_Throws) {
+  ConfigParser parser;
+  EXPECT_THROW(callParseServer("{ location / { gzip_static yes; } }", &parser),
+               std::runtime_error);
+  ConfigParser parser2;
+  EXPECT_THROW(callParseServer(
+                   "{ location / { brotli_static on; brotli_static off; } }",
+                   &parser2),
+               std::runtime_error);
+}
@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "ConfigParser.hpp"
+
+static void callParseServer(const std::string& input, ConfigParser* parser) {
+  parser->content = input;
+  parser->ParseServer();
+}
+
+// ==================== happy path ====================
+TEST(ConfigParser, ParseShutdownTimeout_Default) {
+  ServerConfig sc;
+  EXPECT_EQ(sc.GetShutdownTimeout(), ServerConfig::kDefaultShutdownTimeout);
+}
+
+TEST(ConfigParser, ParseShutdownTimeout_OK) {
+  ConfigParser parser;
+  EXPECT_NO_THROW(
+      callParseServer("{ listen 8080; shutdown_timeout 5; }", &parser));
+  EXPECT_EQ(parser.GetServerConfigs()[0].GetShutdownTimeout(), 5);
+}
+
+TEST(ConfigParser, ParseShutdownTimeout_ZeroClosesImmediately) {
+  ConfigParser parser;
+  EXPECT_NO_THROW(
+      callParseServer("{ listen 8080; shutdown_timeout 0; }", &parser));
+  EXPECT_EQ(parser.GetServerConfigs()[0].GetShutdownTimeout(), 0);
+}
+
+// ==================== error cases ====================
+TEST(ConfigParser, ParseShutdownTimeout_Invalid_Throws) {
+  ConfigParser p1;
+  EXPECT_THROW(callParseServer("{ shutdown_timeout 5s; }", &p1),
+               std::runtime_error);
+  ConfigParser p2;
+  EXPECT_THROW(callParseServer("{ shutdown_timeout 3601; }", &p2),
+               std::runtime_error);
+  ConfigParser p3;
+  EXPECT_THROW(callParseServer("{ shutdown_timeout -1; }", &p3),
+               std::runtime_error);
+  ConfigParser p4;
+  EXPECT_THROW(callParseServer("{ shutdown_timeout 5 }", &p4),
+               std::runtime_error);
+}
+
+TEST(ConfigParser, ParseShutdownTimeout_Duplicate_Throws) {
+  ConfigParser parser;
+  EXPECT_THROW(callParseServer(
+                   "{ shutdown_timeout 5; shutdown_timeout 6; }", &parser),
+               std::runtime_error);
+}
@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "ConfigParser.hpp"
+
+static void callParseServer(const std::string& input, ConfigParser* parser) {
+  parser->content = input;
+  parser->ParseServer();
+}
+
+// ==================== happy path ====================
+TEST(ConfigParser, ParseStubStatus_DefaultsToText) {
+  ConfigParser parser;
+  EXPECT_NO_THROW(callParseServer(
+      "{ listen 8080; location /status { stub_status; } }", &parser));
+  const Location& loc = parser.GetServerConfigs()[0].GetLocations()[0];
+  EXPECT_TRUE(loc.HasStubStatus());
+  EXPECT_EQ(loc.GetStubStatus(), "text");
+}
+
+TEST(ConfigParser, ParseStubStatus_Prometheus) {
+  ConfigParser parser;
+  EXPECT_NO_THROW(callParseServer(
+      "{ listen 8080; location /metrics { stub_status prometheus; } }",
+      &parser));
+  const Location& loc = parser.GetServerConfigs()[0].GetLocations()[0];
+  EXPECT_EQ(loc.GetStubStatus(), "prometheus");
+}
+
+TEST(ConfigParser, ParseStubStatus_UnsetByDefault) {
+  ConfigParser parser;
+  EXPECT_NO_THROW(callParseServer(
+      "{ listen 8080; location / { root /tmp; } }", &parser));
+  EXPECT_FALSE(
+      parser.GetServerConfigs()[0].GetLocations()[0].HasStubStatus());
+}
+
+// ==================== error cases ====================
+TEST(ConfigParser, ParseStubStatus_InvalidValue_Throws) {
+  ConfigParser parser;
+  EXPECT_THROW(callParseServer(
+                   "{ listen 8080; location /s { stub_status json; } }",
+                   &parser),
+               std::runtime_error);
+}
+
+TEST(ConfigParser, ParseStubStatus_Duplicate_Throws) {
+  ConfigParser parser;
+  EXPECT_THROW(
+      callParseServer(
+          "{ listen 8080; location /s { stub_status; stub_status; } }",
+          &parser),
+      std::runtime_error);
+}
@@ -0,0 +1,249 @@
+#include "event/Poller.hpp"
+
+#include <arpa/inet.h>
+#include <gtest/gtest.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+class PollerTest : public ::testing::TestWithParam<event::Backend> {
+ protected:
+  virtual void SetUp() {
+    poller_ = event::Poller::Create(GetParam());
+    fds_[0] = -1;
+    fds_[1] = -1;
+    if (poller_->GetBackend() != GetParam()) {
+      GTEST_SKIP() << "io_uring is not available here";
+    }
+    ASSERT_EQ(pipe(fds_), 0);
+  }
+
+  virtual void TearDown() {
+    delete poller_;
+    if (fds_[0] != -1) close(fds_[0]);
+    if (fds_[1] != -1) close(fds_[1]);
+  }
+
+  int Wait(int timeout_ms) {
+    return poller_->Wait(events_, 4, timeout_ms);
+  }
+
+  event::Poller* poller_;
+  int fds_[2];
+  event::Event events_[4];
+};
+
+TEST_P(PollerTest, ReportsReadableUntilDrained) {
+  int marker = 0;
+  ASSERT_EQ(poller_->Add(fds_[0], event::kReadable, &marker), 0);
+  EXPECT_EQ(Wait(0), 0);
+
+  ASSERT_EQ(write(fds_[1], "x", 1), 1);
+  ASSERT_EQ(Wait(1000), 1);
+  EXPECT_EQ(events_[0].data, &marker);
+  EXPECT_TRUE(events_[0].events & event::kReadable);
+  // level-triggered: reported again while the byte is unread
+  ASSERT_EQ(Wait(1000), 1);
+  EXPECT_EQ(events_[0].data, &marker);
+
+  char c;
+  ASSERT_EQ(read(fds_[0], &c, 1), 1);
+  EXPECT_EQ(Wait(0), 0);
+}
+
+TEST_P(PollerTest, ModifyChangesInterestAndData) {
+  int first = 0;
+  int second = 0;
+  ASSERT_EQ(poller_->Add(fds_[1], event::kReadable, &first), 0);
+  EXPECT_EQ(Wait(0), 0);  // a write end never becomes readable
+
+  ASSERT_EQ(poller_->Modify(fds_[1], event::kWritable, &second), 0);
+  ASSERT_EQ(Wait(1000), 1);
+  EXPECT_EQ(events_[0].data, &second);
+  EXPECT_TRUE(events_[0].events & event::kWritable);
+}
+
+TEST_P(PollerTest, RemoveStopsReports) {
+  int marker = 0;
+  ASSERT_EQ(poller_->Add(fds_[0], event::kReadable, &marker), 0);
+  EXPECT_EQ(Wait(0), 0);
+  ASSERT_EQ(write(fds_[1], "x", 1), 1);
+  ASSERT_EQ(poller_->Remove(fds_[0]), 0);
+  EXPECT_EQ(Wait(50), 0);
+
+  EXPECT_EQ(poller_->Remove(fds_[0]), -1);
+  EXPECT_EQ(errno, ENOENT);
+  ASSERT_EQ(poller_->Add(fds_[0], event::kReadable, &marker), 0);
+  EXPECT_EQ(Wait(1000), 1);
+}
+
+TEST_P(PollerTest, AddTwiceFails) {
+  ASSERT_EQ(poller_->Add(fds_[0], event::kReadable, NULL), 0);
+  EXPECT_EQ(poller_->Add(fds_[0], event::kReadable, NULL), -1);
+  EXPECT_EQ(errno, EEXIST);
+}
+
+TEST_P(PollerTest, ReportsHangupOfPeer) {
+  ASSERT_EQ(poller_->Add(fds_[0], event::kReadable, NULL), 0);
+  close(fds_[1]);
+  fds_[1] = -1;
+  ASSERT_EQ(Wait(1000), 1);
+  EXPECT_TRUE(events_[0].events & event::kHangup);
+}
+
+static void MakeSocketPair(int fds[2]) {
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds), 0);
+}
+
+// a Receive() per report, like ClientSocket; "" when nothing was reported
+static std::string ReceiveOnce(event::Poller* poller, int fd, int timeout_ms) {
+  event::Event events[4];
+  if (poller->Wait(events, 4, timeout_ms) != 1) return "";
+  char buf[64];
+  ssize_t n = poller->Receive(fd, buf, sizeof(buf));
+  return n > 0 ? std::string(buf, n) : std::string(n == 0 ? "<eof>" : "<err>");
+}
+
+TEST_P(PollerTest, ReceiveDeliversDataInOrderThenEnd) {
+  int sv[2];
+  MakeSocketPair(sv);
+  ASSERT_EQ(poller_->Add(sv[0], event::kReadable, &sv), 0);
+  ASSERT_EQ(write(sv[1], "hello", 5), 5);
+  EXPECT_EQ(ReceiveOnce(poller_, sv[0], 1000), "hello");
+  // io_uring: received by the multishot recv from here on
+  ASSERT_EQ(write(sv[1], "world", 5), 5);
+  EXPECT_EQ(ReceiveOnce(poller_, sv[0], 1000), "world");
+  EXPECT_EQ(Wait(0), 0);
+  shutdown(sv[1], SHUT_WR);
+  EXPECT_EQ(ReceiveOnce(poller_, sv[0], 1000), "<eof>");
+  poller_->Remove(sv[0]);
+  close(sv[0]);
+  close(sv[1]);
+}
+
+TEST_P(PollerTest, ReceivedDataWaitsForReadableInterest) {
+  int sv[2];
+  MakeSocketPair(sv);
+  ASSERT_EQ(poller_->Add(sv[0], event::kReadable, &sv), 0);
+  ASSERT_EQ(write(sv[1], "a", 1), 1);
+  EXPECT_EQ(ReceiveOnce(poller_, sv[0], 1000), "a");
+  EXPECT_EQ(Wait(0), 0);
+  ASSERT_EQ(poller_->Modify(sv[0], event::kPeerClosed, &sv), 0);
+  ASSERT_EQ(write(sv[1], "b", 1), 1);
+  EXPECT_EQ(Wait(50), 0);
+  ASSERT_EQ(poller_->Modify(sv[0], event::kReadable, &sv), 0);
+  EXPECT_EQ(ReceiveOnce(poller_, sv[0], 1000), "b");
+  poller_->Remove(sv[0]);
+  close(sv[0]);
+  close(sv[1]);
+}
+
+// more than the poller holds for a socket that falls behind
+TEST_P(PollerTest, ReceiveKeepsUpWithALargeTransfer) {
+  int sv[2];
+  MakeSocketPair(sv);
+  ASSERT_EQ(poller_->Add(sv[0], event::kReadable, &sv), 0);
+  const size_t total = 1024 * 1024;
+  std::string sent;
+  for (size_t i = 0; i < total; ++i) sent += static_cast<char>(i % 251);
+  size_t written = 0;
+  std::string received;
+  for (int round = 0; round < 10000 && received.size() < total; ++round) {
+    if (written < total) {
+      ssize_t n = write(sv[1], sent.data() + written, total - written);
+      if (n > 0) written += n;
+    }
+    event::Event events[4];
+    if (poller_->Wait(events, 4, 100) != 1) continue;
+    char buf[1024];  // ClientSocket's size: several rounds per completion
+    ssize_t n = poller_->Receive(sv[0], buf, sizeof(buf));
+    ASSERT_GT(n, 0);
+    received.append(buf, n);
+  }
+  EXPECT_TRUE(received == sent);
+  poller_->Remove(sv[0]);
+  close(sv[0]);
+  close(sv[1]);
+}
+
+// the descriptor is closed right after Remove(): nothing in the poller may
+// keep the connection open
+TEST_P(PollerTest, RemoveReleasesTheSocketAtOnce) {
+  int sv[2];
+  MakeSocketPair(sv);
+  ASSERT_EQ(poller_->Add(sv[0], event::kReadable, &sv), 0);
+  ASSERT_EQ(write(sv[1], "x", 1), 1);
+  EXPECT_EQ(ReceiveOnce(poller_, sv[0], 1000), "x");
+  EXPECT_EQ(Wait(0), 0);  // io_uring: the multishot recv is in the kernel
+  ASSERT_EQ(poller_->Remove(sv[0]), 0);
+  close(sv[0]);
+  char c;
+  EXPECT_EQ(recv(sv[1], &c, 1, MSG_DONTWAIT), 0);
+  close(sv[1]);
+}
+
+TEST_P(PollerTest, AcceptHandsOverEveryConnection) {
+  int listener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  ASSERT_NE(listener, -1);
+  sockaddr_in addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t len = sizeof(addr);
+  ASSERT_EQ(bind(listener, (sockaddr*)&addr, sizeof(addr)), 0);
+  ASSERT_EQ(listen(listener, 16), 0);
+  ASSERT_EQ(getsockname(listener, (sockaddr*)&addr, &len), 0);
+  ASSERT_EQ(poller_->Add(listener, event::kReadable, &listener), 0);
+
+  std::set<int> client_ports;
+  int clients[3];
+  for (int i = 0; i < 3; ++i) {
+    clients[i] = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    ASSERT_EQ(connect(clients[i], (sockaddr*)&addr, sizeof(addr)), 0);
+    sockaddr_in local;
+    socklen_t local_len = sizeof(local);
+    getsockname(clients[i], (sockaddr*)&local, &local_len);
+    client_ports.insert(ntohs(local.sin_port));
+    // io_uring: the second and third come from the multishot accept
+    if (i == 0) EXPECT_EQ(Wait(1000), 1);
+    if (i == 0) {
+      sockaddr_in peer;
+      socklen_t peer_len = sizeof(peer);
+      int fd = poller_->Accept(listener, (sockaddr*)&peer, &peer_len);
+      ASSERT_NE(fd, -1);
+      EXPECT_TRUE(client_ports.erase(ntohs(peer.sin_port)));
+      close(fd);
+    }
+  }
+  for (int round = 0; round < 10 && !client_ports.empty(); ++round) {
+    if (Wait(1000) != 1) continue;
+    sockaddr_in peer;
+    socklen_t peer_len = sizeof(peer);
+    int fd = poller_->Accept(listener, (sockaddr*)&peer, &peer_len);
+    ASSERT_NE(fd, -1);
+    EXPECT_TRUE(client_ports.erase(ntohs(peer.sin_port)));
+    close(fd);
+  }
+  EXPECT_TRUE(client_ports.empty());
+  EXPECT_EQ(Wait(50), 0);
+  poller_->Remove(listener);
+  close(listener);
+  for (int i = 0; i < 3; ++i) close(clients[i]);
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, PollerTest,
+                         ::testing::Values(event::kBackendEpoll,
+                                           event::kBackendIoUring));
+
+TEST(PollerBackendTest, ParsesNames) {
+  EXPECT_EQ(event::ParseBackend("epoll"), event::kBackendEpoll);
+  EXPECT_EQ(event::ParseBackend("io_uring"), event::kBackendIoUring);
+  EXPECT_THROW(event::ParseBackend("uring"), std::runtime_error);
+  EXPECT_STREQ(event::BackendToString(event::kBackendIoUring), "io_uring");
+}
@@ -29,8 +29,8 @@ TEST_F(HttpRequestAdvanceBody, AdvanceBody_ContentLength_SizeThenData) {
   req.SetBufferForTest("Hello");
   req.SetContentLengthForTest(11);
   EXPECT_FALSE(req.AdvanceBody());
-  EXPECT_EQ(req.GetBody(), "");
-  EXPECT_EQ(req.GetBufferForTest(), "Hello"); // still waiting for more data
+  EXPECT_EQ(req.GetBody(), "Hello"); // handed over as it arrives
+  EXPECT_EQ(req.GetBufferForTest(), ""); // still waiting for more data
   // next, the rest of the data arrives
   req.AppendToBufferForTest(" World");
   EXPECT_TRUE(req.AdvanceBody());
@@ -91,8 +91,8 @@ TEST_F(HttpRequestAdvanceBody, AdvanceBody_ContentLength_NeedMoreData) {
   req.SetContentLengthForTest(12);
 
   EXPECT_FALSE(req.AdvanceBody());
-  EXPECT_EQ(req.GetBody(), "");
-  EXPECT_EQ(req.GetBufferForTest(), "Hello");
+  EXPECT_EQ(req.GetBody(), "Hello");
+  EXPECT_EQ(req.GetBufferForTest(), "");
   // EXPECT_EQ(req.GetState(), HttpRequest::kBody);
 }
 
@@ -101,8 +101,9 @@ TEST_F(HttpRequestAdvanceBody, AdvanceBody_Chunked_NeedMoreData) {
   req.SetContentLengthForTest(-1); // chunked
 
   EXPECT_FALSE(req.AdvanceBody());
-  EXPECT_EQ(req.GetBody(), "hello");
-  EXPECT_EQ(req.GetBufferForTest(), "5\r\nhello\r\n8\r\nworld12");
+  // the partial chunk is already part of the body
+  EXPECT_EQ(req.GetBody(), "helloworld12");
+  EXPECT_EQ(req.GetBufferForTest(), "");
   // EXPECT_EQ(req.GetState(), HttpRequest::kBody);
 }
 
@@ -130,7 +131,7 @@ TEST_F(HttpRequestAdvanceBody, AdvanceBody_Chunked_Malformed_NoFinalCRLF) {
 
   EXPECT_FALSE(req.AdvanceBody());
   EXPECT_EQ(req.GetBody(), "hello");
-  EXPECT_EQ(req.GetBufferForTest(), "5\r\nhello\r\n0\r\n");
+  EXPECT_EQ(req.GetBufferForTest(), "");
   // EXPECT_EQ(req.GetState(), HttpRequest::kBody);
 }
 
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <stdexcept>
 #include <string>
 
@@ -54,7 +55,7 @@ TEST_F(HttpRequestParseRequest, ParseRequest_IncrementalParsing_WithBodyContent)
   const char* data2 = "Hello ";
   req.Parse(data2, strlen(data2));
   EXPECT_EQ(req.GetState(), HttpRequest::kBody);  // still not enough
-  EXPECT_EQ(req.GetBody(), ""); // body not yet advanced at this point
+  EXPECT_EQ(req.GetBody(), "Hello "); // handed over as it arrives
   // complete body in the third call
   const char* data3 = "World";
   req.Parse(data3, strlen(data3));
@@ -146,3 +147,46 @@ TEST_F(HttpRequestParseRequest, ParseRequest_Error_ExceedMaxHeaderSize) {
   largeHeader += std::string(HttpRequest::kMaxHeaderSize, 'A') + ": value\r\n\r\n";
   EXPECT_THROW(req.Parse(largeHeader.c_str(), strlen(largeHeader.c_str())), lib::exception::ResponseStatusException);
 }
+
+// a header block that never ends is refused instead of buffered forever
+TEST_F(HttpRequestParseRequest, ParseRequest_Error_UnterminatedHeaderBlock) {
+  const std::string line = "X-Filler: " + std::string(100, 'a') + "\r\n";
+  std::string data = "GET / HTTP/1.1\r\nHost: example.com\r\n";
+  try {
+    req.Parse(data.c_str(), data.size());
+    for (int i = 0; i < 200; ++i) req.Parse(line.c_str(), line.size());
+    FAIL() << "Expected ResponseStatusException";
+  } catch (const lib::exception::ResponseStatusException& e) {
+    EXPECT_EQ(lib::http::kRequestHeaderFieldsTooLarge, e.GetStatus());
+  }
+}
+
+// =============== Memory: large chunked upload ===============
+// the parser keeps at most one read of input; the body spills to a file
+TEST_F(HttpRequestParseRequest, ParseRequest_ChunkedUpload_BufferStaysBounded) {
+  const size_t kBody = 4 * 1024 * 1024;
+  const size_t kRead = 16 * 1024;
+  req.SetMaxBodySizeLimit(kBody);
+  const char* head =
+      "POST /upload HTTP/1.1\r\n"
+      "Host: example.com\r\n"
+      "Transfer-Encoding: chunked\r\n"
+      "\r\n";
+  req.Parse(head, strlen(head));
+
+  // 1 MB chunks, so most reads end in the middle of a chunk
+  std::string wire;
+  for (size_t sent = 0; sent < kBody; sent += 1024 * 1024) {
+    wire += "100000\r\n" + std::string(1024 * 1024, 'z') + "\r\n";
+  }
+  wire += "0\r\n\r\n";
+  for (size_t pos = 0; pos < wire.size(); pos += kRead) {
+    const size_t n = std::min(kRead, wire.size() - pos);
+    req.Parse(wire.data() + pos, n);
+    ASSERT_LE(req.GetBufferForTest().size(), kRead);
+  }
+  ASSERT_EQ(req.GetState(), HttpRequest::kDone);
+  EXPECT_EQ(req.GetBodyBuffer().Size(), kBody);
+  EXPECT_TRUE(req.GetBodyBuffer().IsSpilled());
+  EXPECT_EQ(req.GetBody(), std::string(kBody, 'z'));
+}
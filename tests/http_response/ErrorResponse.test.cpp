@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "ConfigParser.hpp"
+#include "ErrorResponse.hpp"
+#include "HttpRequest.hpp"
+#include "HttpResponse.hpp"
+#include "RequestHandler.hpp"
+#include "ServerConfig.hpp"
+#include "lib/http/Status.hpp"
+
+class ErrorResponseTest : public ::testing::Test {
+ protected:
+  std::string tmp_;
+  ServerConfig config_;
+
+  void SetUp() override {
+    char tmpl[] = "/tmp/webserv_error_page_test.XXXXXX";
+    char* p = mkdtemp(tmpl);
+    ASSERT_TRUE(p != NULL);
+    tmp_ = p;
+    std::ofstream(std::string(tmp_ + "/404.html").c_str()) << "custom 404";
+  }
+
+  void TearDown() override {
+    unlink((tmp_ + "/404.html").c_str());
+    rmdir(tmp_.c_str());
+  }
+
+  void Parse(const std::string& error_pages) {
+    ConfigParser parser;
+    parser.content =
+        "{ listen 8086; " + error_pages +
+        " location / { root " + tmp_ + "; allowed_methods GET; } }";
+    ASSERT_NO_THROW(parser.ParseServer());
+    config_ = parser.GetServerConfigs()[0];
+  }
+};
+
+TEST_F(ErrorResponseTest, NoErrorPage_UsesSharedDefault) {
+  Parse("");
+  config_.LoadErrorPages();
+  HttpResponse res(lib::http::kNotFound);
+  error_response::ApplyErrorPage(config_, res);
+  EXPECT_NE(res.GetBody().find("404 Not Found"), std::string::npos);
+  EXPECT_EQ(res.GetHeader("content-type").ValueOr(""), "text/html");
+  EXPECT_EQ(HttpResponse::DefaultErrorPage(lib::http::kNotFound).Get(),
+            HttpResponse::DefaultErrorPage(lib::http::kNotFound).Get());
+}
+
+TEST_F(ErrorResponseTest, SuccessStatus_Untouched) {
+  Parse("error_page 404 /404.html;");
+  config_.LoadErrorPages();
+  HttpResponse res(lib::http::kOk);
+  error_response::ApplyErrorPage(config_, res);
+  EXPECT_EQ(res.GetBodySize(), 0u);
+}
+
+TEST_F(ErrorResponseTest, LoadedPage_ReplacesBody) {
+  Parse("error_page 404 /404.html;");
+  config_.LoadErrorPages();
+  HttpResponse res(lib::http::kNotFound);
+  res.SetBody("Not Found");
+  error_response::ApplyErrorPage(config_, res);
+  EXPECT_EQ(res.GetStatus(), lib::http::kNotFound);
+  EXPECT_EQ(res.GetBody(), "custom 404");
+  EXPECT_EQ(res.GetHeader("content-type").ValueOr(""), "text/html");
+}
+
+TEST_F(ErrorResponseTest, PageIsReadOnceAtLoad) {
+  Parse("error_page 404 /404.html;");
+  config_.LoadErrorPages();
+  unlink((tmp_ + "/404.html").c_str());
+  HttpResponse res(lib::http::kNotFound);
+  error_response::ApplyErrorPage(config_, res);
+  EXPECT_EQ(res.GetBody(), "custom 404");
+}
+
+TEST_F(ErrorResponseTest, ExternalUrl_Redirects) {
+  Parse("error_page 500 http://example.com/500.html;");
+  config_.LoadErrorPages();
+  HttpResponse res(lib::http::kInternalServerError);
+  error_response::ApplyErrorPage(config_, res);
+  EXPECT_EQ(res.GetStatus(), lib::http::kFound);
+  EXPECT_EQ(res.GetHeader("location").ValueOr(""),
+            "http://example.com/500.html");
+}
+
+TEST_F(ErrorResponseTest, MissingPage_FailsToLoad) {
+  Parse("error_page 403 /missing.html;");
+  EXPECT_THROW(config_.LoadErrorPages(), std::runtime_error);
+  EXPECT_TRUE(config_.FindErrorPage(lib::http::kForbidden) == NULL);
+}
+
+TEST_F(ErrorResponseTest, RequestHandler_ServesLoadedPage) {
+  Parse("error_page 404 /404.html;");
+  config_.LoadErrorPages();
+  HttpRequest req;
+  req.SetMethod(lib::http::kGet);
+  req.SetUri("/nope.html");
+  RequestHandler handler(config_, req);
+  ExecResult r = handler.Run();
+  EXPECT_EQ(r.response.GetStatus(), lib::http::kNotFound);
+  EXPECT_EQ(r.response.GetBody(), "custom 404");
+}
@@ -78,3 +78,39 @@ TEST(HttpResponseTest, FullResponse) {
   EXPECT_NE(output.find("content-length: " + std::to_string(body.length()) + "\r\n"), std::string::npos);
   EXPECT_NE(output.find("\r\n\r\n" + body), std::string::npos);
 }
+
+TEST(HttpResponseTest, WriteTo_MatchesToHttpString) {
+  HttpResponse response(lib::http::kOk);
+  response.AddHeader("Content-Type", "text/plain");
+  response.SetBody("payload");
+
+  lib::io::OutputQueue out;
+  response.WriteTo(out);
+
+  EXPECT_EQ(out.ToString(), response.ToHttpString());
+  EXPECT_EQ(response.GetBodySize(), 7u);
+}
+
+namespace {
+
+class EmptyProducer : public lib::io::BodyProducer {
+ public:
+  virtual bool Produce(lib::io::OutputQueue& out) {
+    (void)out;
+    return true;
+  }
+};
+
+}  // namespace
+
+// the length of a produced body is unknown when the headers go out
+TEST(HttpResponseTest, BodyProducer_NoDerivedContentLength) {
+  HttpResponse response(lib::http::kOk);
+  response.SetBodyProducer(
+      lib::type::SharedPtr<lib::io::BodyProducer>(new EmptyProducer()));
+  EXPECT_EQ(response.ToHttpString().find("content-length"), std::string::npos);
+
+  response.AddHeader("Content-Length", "42");
+  EXPECT_NE(response.ToHttpString().find("content-length: 42\r\n"),
+            std::string::npos);
+}
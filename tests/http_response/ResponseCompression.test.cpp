@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "ConfigParser.hpp"
+#include "HttpRequest.hpp"
+#include "HttpResponse.hpp"
+#include "ResponseCompression.hpp"
+#include "ServerConfig.hpp"
+#include "lib/http/Status.hpp"
+#include "lib/io/OutputQueue.hpp"
+
+class ResponseCompressionTest : public ::testing::Test {
+ protected:
+  ServerConfig config_;
+
+  void SetUp() override {
+    ConfigParser parser;
+    parser.content =
+        "{ listen 8085; gzip on; gzip_types text/plain; "
+        "gzip_min_length 100; }";
+    ASSERT_NO_THROW(parser.ParseServer());
+    config_ = parser.GetServerConfigs()[0];
+  }
+
+  static HttpRequest MakeRequest(const std::string& headers,
+                                 const std::string& version = "HTTP/1.1") {
+    HttpRequest req;
+    std::string raw = "GET / " + version + "\r\nHost: localhost\r\n" +
+                      headers + "\r\n";
+    req.Parse(raw.c_str(), raw.size());
+    return req;
+  }
+
+  static HttpResponse MakeResponse(const std::string& type, size_t size) {
+    HttpResponse res;
+    res.AddHeader("Content-Type", type);
+    res.SetBody(std::string(size, 'a'));
+    return res;
+  }
+};
+
+TEST_F(ResponseCompressionTest, SmallBody_EncodedInPlace) {
+  HttpRequest req = MakeRequest("Accept-Encoding: gzip\r\n");
+  HttpResponse res = MakeResponse("text/plain", 1000);
+  std::unique_ptr<lib::io::BodyProducer> producer(
+      compression::EncodeResponse(config_, req, res));
+  EXPECT_EQ(producer.get(), static_cast<lib::io::BodyProducer*>(NULL));
+  EXPECT_EQ(res.GetHeader("content-encoding").ValueOr(""), "gzip");
+  EXPECT_EQ(res.GetHeader("vary").ValueOr(""), "Accept-Encoding");
+  EXPECT_LT(res.GetBodySize(), 1000u);
+  EXPECT_NE(res.ToHttpString().find("content-length: "), std::string::npos);
+}
+
+TEST_F(ResponseCompressionTest, LargeBody_IsStreamedChunked) {
+  HttpRequest req = MakeRequest("Accept-Encoding: deflate\r\n");
+  HttpResponse res = MakeResponse("text/plain", compression::kDeflateBudget * 3);
+  res.AddHeader("Content-Length", "196608");
+  res.AddHeader("ETag", "\"abc\"");
+  std::unique_ptr<lib::io::BodyProducer> producer(
+      compression::EncodeResponse(config_, req, res));
+  ASSERT_NE(producer.get(), static_cast<lib::io::BodyProducer*>(NULL));
+  EXPECT_EQ(res.GetBodySize(), 0u);
+  EXPECT_EQ(res.GetHeader("content-encoding").ValueOr(""), "deflate");
+  EXPECT_EQ(res.GetHeader("transfer-encoding").ValueOr(""), "chunked");
+  EXPECT_EQ(res.GetHeader("etag").ValueOr(""), "W/\"abc\"");
+  EXPECT_FALSE(res.HasHeader("content-length"));
+
+  lib::io::OutputQueue out;
+  int calls = 1;
+  while (!producer->Produce(out)) ++calls;
+  EXPECT_EQ(calls, 3);
+  const std::string body = out.ToString();
+  EXPECT_EQ(body.substr(body.size() - 5), "0\r\n\r\n");
+}
+
+TEST_F(ResponseCompressionTest, LargeBody_Http10_LeftAsIs) {
+  HttpRequest req = MakeRequest("Accept-Encoding: gzip\r\n", "HTTP/1.0");
+  HttpResponse res = MakeResponse("text/plain", compression::kDeflateBudget * 2);
+  EXPECT_EQ(compression::EncodeResponse(config_, req, res),
+            static_cast<lib::io::BodyProducer*>(NULL));
+  EXPECT_FALSE(res.HasHeader("content-encoding"));
+  EXPECT_EQ(res.GetBodySize(), compression::kDeflateBudget * 2);
+}
+
+TEST_F(ResponseCompressionTest, NotAccepted_AddsVaryOnly) {
+  HttpRequest req = MakeRequest("Accept-Encoding: gzip;q=0\r\n");
+  HttpResponse res = MakeResponse("text/plain", 1000);
+  EXPECT_EQ(compression::EncodeResponse(config_, req, res),
+            static_cast<lib::io::BodyProducer*>(NULL));
+  EXPECT_FALSE(res.HasHeader("content-encoding"));
+  EXPECT_EQ(res.GetHeader("vary").ValueOr(""), "Accept-Encoding");
+  EXPECT_EQ(res.GetBodySize(), 1000u);
+}
+
+TEST_F(ResponseCompressionTest, Skips_UnlistedTypeShortBodyAndRanges) {
+  HttpRequest req = MakeRequest("Accept-Encoding: gzip\r\n");
+
+  HttpResponse image = MakeResponse("image/png", 1000);
+  EXPECT_EQ(compression::EncodeResponse(config_, req, image),
+            static_cast<lib::io::BodyProducer*>(NULL));
+  EXPECT_FALSE(image.HasHeader("content-encoding"));
+  EXPECT_FALSE(image.HasHeader("vary"));
+
+  HttpResponse tiny = MakeResponse("text/plain", 99);
+  compression::EncodeResponse(config_, req, tiny);
+  EXPECT_FALSE(tiny.HasHeader("content-encoding"));
+
+  HttpResponse partial = MakeResponse("text/plain", 1000);
+  partial.SetStatus(lib::http::kPartialContent);
+  compression::EncodeResponse(config_, req, partial);
+  EXPECT_FALSE(partial.HasHeader("content-encoding"));
+}
+
+TEST_F(ResponseCompressionTest, GzipOff_Untouched) {
+  ServerConfig off;
+  HttpRequest req = MakeRequest("Accept-Encoding: gzip\r\n");
+  HttpResponse res = MakeResponse("text/html", 1000);
+  EXPECT_EQ(compression::EncodeResponse(off, req, res),
+            static_cast<lib::io::BodyProducer*>(NULL));
+  EXPECT_FALSE(res.HasHeader("content-encoding"));
+  EXPECT_FALSE(res.HasHeader("vary"));
+}
+
+// CGI output: decided on the headers before any body byte is known
+TEST_F(ResponseCompressionTest, Streamed_EncodesChunked) {
+  HttpRequest req = MakeRequest("Accept-Encoding: gzip\r\n");
+  HttpResponse res;
+  res.AddHeader("Content-Type", "text/plain");
+  EXPECT_EQ(compression::EncodeStreamedResponse(config_, req, res),
+            lib::http::kCodingGzip);
+  EXPECT_EQ(res.GetHeader("content-encoding").ValueOr(""), "gzip");
+  EXPECT_EQ(res.GetHeader("transfer-encoding").ValueOr(""), "chunked");
+  EXPECT_EQ(res.GetHeader("vary").ValueOr(""), "Accept-Encoding");
+}
+
+TEST_F(ResponseCompressionTest, Streamed_DeclaredShortLengthOrHttp10) {
+  HttpRequest req = MakeRequest("Accept-Encoding: gzip\r\n");
+  HttpResponse tiny;
+  tiny.AddHeader("Content-Type", "text/plain");
+  tiny.AddHeader("Content-Length", "99");
+  EXPECT_EQ(compression::EncodeStreamedResponse(config_, req, tiny),
+            lib::http::kCodingIdentity);
+  EXPECT_EQ(tiny.GetHeader("content-length").ValueOr(""), "99");
+  EXPECT_FALSE(tiny.HasHeader("transfer-encoding"));
+
+  HttpRequest old = MakeRequest("Accept-Encoding: gzip\r\n", "HTTP/1.0");
+  HttpResponse res;
+  res.AddHeader("Content-Type", "text/plain");
+  EXPECT_EQ(compression::EncodeStreamedResponse(config_, old, res),
+            lib::http::kCodingIdentity);
+  EXPECT_FALSE(res.HasHeader("content-encoding"));
+}
@@ -32,7 +32,8 @@ TEST_F(WebservConfigTest, InitServersFromConfigs_UniquePorts) {
 
   EXPECT_NO_THROW(ws.InitServersFromConfigs(configs));
 
-  const std::map<unsigned short, ServerConfig>& m = ws.GetPortConfigs();
+  const std::map<unsigned short, ServerConfigSnapshot>& m =
+      ws.GetPortConfigs();
   ASSERT_EQ(m.size(), 2u);
   EXPECT_NE(m.find(8080), m.end());
   EXPECT_NE(m.find(8000), m.end());
@@ -82,7 +83,8 @@ TEST_F(WebservConfigTest, GetPortConfigs_ReturnsCurrentMap) {
   );
   ws.InitServersFromConfigs(configs);
 
-  const std::map<unsigned short, ServerConfig>& m = ws.GetPortConfigs();
+  const std::map<unsigned short, ServerConfigSnapshot>& m =
+      ws.GetPortConfigs();
   EXPECT_EQ(m.size(), 2u);
   EXPECT_NE(m.find(8080), m.end());
   EXPECT_NE(m.find(8000), m.end());
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include "Webserv.hpp"
+
+class WebservReloadTest : public ::testing::Test {
+ protected:
+  std::string path_;
+
+  void SetUp() override {
+    char tmpl[] = "/tmp/webserv_reload_test.XXXXXX";
+    int fd = mkstemp(tmpl);
+    ASSERT_NE(fd, -1);
+    close(fd);
+    path_ = tmpl;
+  }
+
+  void TearDown() override {
+    unlink(path_.c_str());
+  }
+
+  void WriteConfig(const std::string& text) {
+    std::ofstream(path_.c_str()) << text;
+  }
+};
+
+TEST_F(WebservReloadTest, Reload_SwapsSnapshotsAndListeners) {
+  WriteConfig(
+      "server { listen 18471; server_name old; location / { root /tmp; } }");
+  Webserv ws(path_);
+  ServerConfigSnapshot before = ws.GetPortConfigs().find(18471)->second;
+
+  WriteConfig(
+      "server { listen 18471; server_name new; location / { root /tmp; } }\n"
+      "server { listen 18472; location / { root /tmp; } }");
+  ws.Reload();
+  ASSERT_EQ(ws.GetPortConfigs().size(), 2u);
+  EXPECT_EQ(ws.FindServerConfigByPort(18471)->GetServerName(), "new");
+  // holders of the previous snapshot are unaffected
+  EXPECT_EQ(before->GetServerName(), "old");
+
+  WriteConfig(
+      "server { listen 18472; location / { root /tmp; } }");
+  ws.Reload();
+  EXPECT_EQ(ws.GetPortConfigs().size(), 1u);
+  EXPECT_EQ(ws.FindServerConfigByPort(18471), (const ServerConfig*)NULL);
+}
+
+TEST_F(WebservReloadTest, Reload_InvalidConfig_KeepsCurrent) {
+  WriteConfig(
+      "server { listen 18473; server_name keep; location / { root /tmp; } }");
+  Webserv ws(path_);
+
+  WriteConfig("server { listen 18473; server_name broken; location / {");
+  ws.Reload();
+  ASSERT_NE(ws.FindServerConfigByPort(18473), (const ServerConfig*)NULL);
+  EXPECT_EQ(ws.FindServerConfigByPort(18473)->GetServerName(), "keep");
+
+  WriteConfig(
+      "server { listen 18473; error_page 404 /missing.html; "
+      "location / { root /tmp/webserv_reload_no_such_dir; } }");
+  ws.Reload();
+  EXPECT_EQ(ws.FindServerConfigByPort(18473)->GetServerName(), "keep");
+}
+
+// the scripts a location runs when the reload comes still count
+TEST_F(WebservReloadTest, Reload_KeepsCgiLimiterCount) {
+  WriteConfig(
+      "server { listen 18475; location /cgi { root /tmp; "
+      "cgi_max_concurrent 1; } }");
+  Webserv ws(path_);
+  lib::type::SharedPtr<cgi::CgiLimiter> before =
+      ws.FindServerConfigByPort(18475)->GetLocations()[0].GetCgiLimiter();
+  ASSERT_FALSE(before.IsNull());
+  ASSERT_TRUE(before->TryAcquire());
+
+  WriteConfig(
+      "server { listen 18475; location /cgi/ { root /tmp; "
+      "cgi_max_concurrent 2; } }");
+  ws.Reload();
+  lib::type::SharedPtr<cgi::CgiLimiter> after =
+      ws.FindServerConfigByPort(18475)->GetLocations()[0].GetCgiLimiter();
+  ASSERT_EQ(after.Get(), before.Get());
+  EXPECT_EQ(after->Running(), 1u);
+  EXPECT_TRUE(after->TryAcquire());
+  EXPECT_FALSE(after->TryAcquire());
+  after->Release();
+  after->Release();
+}
+
+// SIGHUP path: parsed on a helper thread, applied by PollReload()
+TEST_F(WebservReloadTest, StartReload_AppliesOncePolled) {
+  WriteConfig(
+      "server { listen 18474; server_name old; location / { root /tmp; } }");
+  Webserv ws(path_);
+  EXPECT_FALSE(ws.PollReload());
+
+  WriteConfig(
+      "server { listen 18474; server_name new; location / { root /tmp; } }");
+  ws.StartReload();
+  bool applied = false;
+  for (int i = 0; i < 500 && !applied; ++i) {
+    applied = ws.PollReload();
+    if (!applied) usleep(10000);
+  }
+  ASSERT_TRUE(applied);
+  EXPECT_EQ(ws.FindServerConfigByPort(18474)->GetServerName(), "new");
+  EXPECT_FALSE(ws.PollReload());
+}
@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <string>
+
+#include "ConfigParser.hpp"
+#include "Webserv.hpp"
+
+class WebservShutdownTest : public ::testing::Test {
+ protected:
+  std::string path_;
+
+  void SetUp() override {
+    char tmpl[] = "/tmp/webserv_shutdown_test.XXXXXX";
+    int fd = mkstemp(tmpl);
+    ASSERT_NE(fd, -1);
+    close(fd);
+    path_ = tmpl;
+    std::ofstream(path_.c_str())
+        << "server { listen 18476; shutdown_timeout 5; "
+           "location / { root /tmp; } }\n"
+           "server { listen 18477; shutdown_timeout 2; "
+           "location / { root /tmp; } }";
+  }
+
+  void TearDown() override {
+    unlink(path_.c_str());
+  }
+};
+
+TEST_F(WebservShutdownTest, UsesLargestTimeout) {
+  Webserv ws(path_);
+  EXPECT_EQ(ws.GetShutdownTimeout(), 5);
+}
+
+TEST_F(WebservShutdownTest, DefaultTimeoutWithoutServers) {
+  Webserv ws;
+  EXPECT_EQ(ws.GetShutdownTimeout(), ServerConfig::kDefaultShutdownTimeout);
+}
+
+// nothing in flight: Run() returns right away instead of serving
+TEST_F(WebservShutdownTest, RunReturnsOnceDrained) {
+  Webserv ws(path_);
+  ws.Shutdown();
+  const time_t start = std::time(NULL);
+  ws.Run();
+  EXPECT_LE(std::time(NULL) - start, 1);
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "Webserv.hpp"
+#include "lib/utils/string_utils.hpp"
+
+class WebservUpgradeTest : public ::testing::Test {
+ protected:
+  std::string path_;
+
+  void SetUp() override {
+    char tmpl[] = "/tmp/webserv_upgrade_test.XXXXXX";
+    int fd = mkstemp(tmpl);
+    ASSERT_NE(fd, -1);
+    close(fd);
+    path_ = tmpl;
+    std::ofstream(path_.c_str())
+        << "server { listen 18475; location / { root /tmp; } }";
+  }
+
+  void TearDown() override {
+    unlink(path_.c_str());
+    unsetenv("WEBSERV_LISTEN_FDS");
+    unsetenv("WEBSERV_READY_FD");
+  }
+
+  static int ListenOn(unsigned short port) {
+    int fd = socket(PF_INET, SOCK_STREAM, 0);
+    int opt = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1 ||
+        listen(fd, 8) == -1) {
+      close(fd);
+      return -1;
+    }
+    return fd;
+  }
+};
+
+// binding again would fail with EADDRINUSE while fd is listening
+TEST_F(WebservUpgradeTest, AdoptsInheritedListenerAndReportsReady) {
+  int listener = ListenOn(18475);
+  ASSERT_NE(listener, -1);
+  int ready[2];
+  ASSERT_EQ(pipe(ready), 0);
+  setenv("WEBSERV_LISTEN_FDS",
+         ("18475:" + lib::utils::ToString(listener)).c_str(), 1);
+  setenv("WEBSERV_READY_FD", lib::utils::ToString(ready[1]).c_str(), 1);
+
+  {
+    Webserv ws(path_);  // owns listener from here on
+    EXPECT_NE(ws.FindServerConfigByPort(18475), (const ServerConfig*)NULL);
+  }
+  char byte = 0;
+  EXPECT_EQ(read(ready[0], &byte, 1), 1);
+  EXPECT_EQ(byte, '1');
+  close(ready[0]);
+  EXPECT_EQ(std::getenv("WEBSERV_LISTEN_FDS"), (char*)NULL);
+  EXPECT_EQ(std::getenv("WEBSERV_READY_FD"), (char*)NULL);
+}
+
+TEST_F(WebservUpgradeTest, InheritedFdMustBeListening) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  close(fds[1]);
+  setenv("WEBSERV_LISTEN_FDS",
+         ("18475:" + lib::utils::ToString(fds[0])).c_str(), 1);
+  EXPECT_THROW(Webserv ws(path_), std::runtime_error);
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+#include <cstring>
+#include <string>
+
+#include "lib/http/CompressedBodyProducer.hpp"
+#include "lib/io/OutputQueue.hpp"
+
+// windowBits 15 + 32 lets inflate detect gzip and zlib headers
+static std::string Inflate(const std::string& in) {
+  z_stream zs;
+  std::memset(&zs, 0, sizeof(zs));
+  EXPECT_EQ(inflateInit2(&zs, 15 + 32), Z_OK);
+  zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+  zs.avail_in = in.size();
+  std::string out;
+  char buf[4096];
+  int ret;
+  do {
+    zs.next_out = reinterpret_cast<Bytef*>(buf);
+    zs.avail_out = sizeof(buf);
+    ret = inflate(&zs, Z_NO_FLUSH);
+    out.append(buf, sizeof(buf) - zs.avail_out);
+  } while (ret == Z_OK);
+  EXPECT_EQ(ret, Z_STREAM_END);
+  inflateEnd(&zs);
+  return out;
+}
+
+// strips chunked framing; fails the test on malformed input
+static std::string Dechunk(const std::string& in) {
+  std::string out;
+  size_t pos = 0;
+  while (true) {
+    size_t eol = in.find("\r\n", pos);
+    if (eol == std::string::npos) {
+      ADD_FAILURE() << "missing chunk size line";
+      return out;
+    }
+    size_t len = std::strtoul(in.substr(pos, eol - pos).c_str(), NULL, 16);
+    pos = eol + 2;
+    if (len == 0) {
+      EXPECT_EQ(in.substr(pos), "\r\n");
+      return out;
+    }
+    out.append(in, pos, len);
+    pos += len;
+    EXPECT_EQ(in.compare(pos, 2, "\r\n"), 0);
+    pos += 2;
+  }
+}
+
+static std::string MakeText(size_t size) {
+  std::string s;
+  while (s.size() < size) s += "the quick brown fox jumps over the lazy dog ";
+  s.resize(size);
+  return s;
+}
+
+TEST(CompressedBodyProducerTest, Gzip_SingleCall_RoundTrips) {
+  const std::string text = MakeText(5000);
+  lib::io::OutputQueue source;
+  source.Append(text);
+  lib::http::CompressedBodyProducer producer(source, lib::http::kCodingGzip, 6,
+                                             false, 1 << 20);
+  EXPECT_TRUE(source.Empty());
+
+  lib::io::OutputQueue out;
+  EXPECT_TRUE(producer.Produce(out));
+  const std::string encoded = out.ToString();
+  ASSERT_GE(encoded.size(), 2u);
+  EXPECT_EQ(static_cast<unsigned char>(encoded[0]), 0x1f);  // gzip magic
+  EXPECT_LT(encoded.size(), text.size());
+  EXPECT_EQ(Inflate(encoded), text);
+}
+
+TEST(CompressedBodyProducerTest, Deflate_UsesZlibFormat) {
+  const std::string text = MakeText(1000);
+  lib::io::OutputQueue source;
+  source.Append(text);
+  lib::http::CompressedBodyProducer producer(
+      source, lib::http::kCodingDeflate, 1, false, 1 << 20);
+  lib::io::OutputQueue out;
+  EXPECT_TRUE(producer.Produce(out));
+  const std::string encoded = out.ToString();
+  EXPECT_EQ(static_cast<unsigned char>(encoded[0]) & 0x0f, 8);  // CM=deflate
+  EXPECT_EQ(Inflate(encoded), text);
+}
+
+// a small budget spreads the work over several calls, each chunk framed
+TEST(CompressedBodyProducerTest, Chunked_RespectsBudget) {
+  const std::string text = MakeText(100000);
+  lib::io::OutputQueue source;
+  source.Append(text.substr(0, 30000));
+  source.Append(text.substr(30000));
+  lib::http::CompressedBodyProducer producer(source, lib::http::kCodingGzip, 1,
+                                             true, 8192);
+  lib::io::OutputQueue out;
+  int calls = 0;
+  while (!producer.Produce(out)) {
+    ++calls;
+    ASSERT_LT(calls, 100);
+  }
+  EXPECT_EQ(calls, 12);  // ceil(100000 / 8192) - 1 unfinished calls
+  EXPECT_TRUE(producer.Produce(out));  // idempotent once done
+  EXPECT_EQ(Inflate(Dechunk(out.ToString())), text);
+}
+
+TEST(CompressedBodyProducerTest, EmptySource_FinishesImmediately) {
+  lib::io::OutputQueue source;
+  lib::http::CompressedBodyProducer producer(source, lib::http::kCodingGzip, 1,
+                                             true, 8192);
+  lib::io::OutputQueue out;
+  EXPECT_TRUE(producer.Produce(out));
+  EXPECT_EQ(Inflate(Dechunk(out.ToString())), "");
+}
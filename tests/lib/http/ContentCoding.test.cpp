@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include "lib/http/ContentCoding.hpp"
+
+using lib::http::SelectContentCoding;
+
+TEST(ContentCodingTest, Select_AbsentOrUnknown_Identity) {
+  EXPECT_EQ(SelectContentCoding(""), lib::http::kCodingIdentity);
+  EXPECT_EQ(SelectContentCoding("br, identity"), lib::http::kCodingIdentity);
+}
+
+TEST(ContentCodingTest, Select_PrefersGzipOnTie) {
+  EXPECT_EQ(SelectContentCoding("deflate, gzip"), lib::http::kCodingGzip);
+  EXPECT_EQ(SelectContentCoding("GZIP"), lib::http::kCodingGzip);
+  EXPECT_EQ(SelectContentCoding("x-gzip"), lib::http::kCodingGzip);
+}
+
+TEST(ContentCodingTest, Select_HonorsQvalues) {
+  EXPECT_EQ(SelectContentCoding("gzip;q=0.5, deflate;q=0.8"),
+            lib::http::kCodingDeflate);
+  EXPECT_EQ(SelectContentCoding("gzip ; q=0, deflate"),
+            lib::http::kCodingDeflate);
+  EXPECT_EQ(SelectContentCoding("gzip;q=0, deflate;q=0.000"),
+            lib::http::kCodingIdentity);
+}
+
+TEST(ContentCodingTest, Select_Wildcard) {
+  EXPECT_EQ(SelectContentCoding("*"), lib::http::kCodingGzip);
+  EXPECT_EQ(SelectContentCoding("*;q=0"), lib::http::kCodingIdentity);
+  EXPECT_EQ(SelectContentCoding("gzip;q=0, *"), lib::http::kCodingDeflate);
+}
+
+TEST(ContentCodingTest, Select_MalformedQvalue_IsUnacceptable) {
+  EXPECT_EQ(SelectContentCoding("gzip;q=1.5"), lib::http::kCodingIdentity);
+  EXPECT_EQ(SelectContentCoding("gzip;q=abc"), lib::http::kCodingIdentity);
+}
+
+TEST(ContentCodingTest, Qvalue_PerCoding) {
+  const std::string header = "br;q=0.8, gzip, *;q=0.1";
+  EXPECT_EQ(lib::http::AcceptEncodingQvalue(header, lib::http::kCodingBrotli),
+            800);
+  EXPECT_EQ(lib::http::AcceptEncodingQvalue(header, lib::http::kCodingGzip),
+            1000);
+  EXPECT_EQ(lib::http::AcceptEncodingQvalue(header, lib::http::kCodingDeflate),
+            100);
+  EXPECT_EQ(lib::http::AcceptEncodingQvalue("", lib::http::kCodingGzip), 0);
+  EXPECT_EQ(lib::http::AcceptEncodingQvalue("br", lib::http::kCodingIdentity),
+            0);
+}
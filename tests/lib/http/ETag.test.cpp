@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+
+#include <cstring>
+
+#include "lib/http/ETag.hpp"
+
+static struct stat MakeStat(ino_t ino, off_t size, time_t sec, long nsec) {
+  struct stat st;
+  std::memset(&st, 0, sizeof(st));
+  st.st_ino = ino;
+  st.st_size = size;
+  st.st_mtim.tv_sec = sec;
+  st.st_mtim.tv_nsec = nsec;
+  return st;
+}
+
+TEST(ETagTest, MakeWeakETag_EncodesInodeSizeMtime) {
+  EXPECT_EQ(lib::http::MakeWeakETag(MakeStat(0x1a, 0x10, 0x20, 0x3)),
+            "W/\"1a-10-20.3\"");
+}
+
+TEST(ETagTest, MakeWeakETag_ChangesWithMtime) {
+  EXPECT_NE(lib::http::MakeWeakETag(MakeStat(1, 2, 3, 4)),
+            lib::http::MakeWeakETag(MakeStat(1, 2, 3, 5)));
+}
+
+TEST(ETagTest, IfNoneMatch_WeakComparison) {
+  const std::string etag = "W/\"abc\"";
+  EXPECT_TRUE(lib::http::IfNoneMatchMatches("W/\"abc\"", etag));
+  EXPECT_TRUE(lib::http::IfNoneMatchMatches("\"abc\"", etag));
+  EXPECT_FALSE(lib::http::IfNoneMatchMatches("\"abd\"", etag));
+}
+
+TEST(ETagTest, IfNoneMatch_ListAndStar) {
+  const std::string etag = "W/\"abc\"";
+  EXPECT_TRUE(lib::http::IfNoneMatchMatches("\"x\", W/\"y\" ,\"abc\"", etag));
+  EXPECT_FALSE(lib::http::IfNoneMatchMatches("\"x\", \"y\"", etag));
+  EXPECT_TRUE(lib::http::IfNoneMatchMatches("*", etag));
+}
+
+TEST(ETagTest, IfNoneMatch_MalformedNeverMatches) {
+  const std::string etag = "W/\"abc\"";
+  EXPECT_FALSE(lib::http::IfNoneMatchMatches("abc", etag));
+  EXPECT_FALSE(lib::http::IfNoneMatchMatches("\"abc", etag));
+  EXPECT_FALSE(lib::http::IfNoneMatchMatches("", etag));
+}
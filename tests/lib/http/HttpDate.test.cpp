@@ -0,0 +1,37 @@
+#include <gtest/gtest.h>
+
+#include "lib/http/HttpDate.hpp"
+
+TEST(HttpDateTest, Format_ImfFixdate) {
+  EXPECT_EQ(lib::http::FormatHttpDate(784111777),
+            "Sun, 06 Nov 1994 08:49:37 GMT");
+}
+
+TEST(HttpDateTest, Parse_RoundTrip) {
+  lib::type::Optional<time_t> t =
+      lib::http::ParseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT");
+  ASSERT_TRUE(t.HasValue());
+  EXPECT_EQ(t.Value(), 784111777);
+  EXPECT_EQ(lib::http::ParseHttpDate(lib::http::FormatHttpDate(0)).Value(), 0);
+}
+
+TEST(HttpDateTest, Parse_RejectsObsoleteAndMalformed) {
+  EXPECT_FALSE(
+      lib::http::ParseHttpDate("Sunday, 06-Nov-94 08:49:37 GMT").HasValue());
+  EXPECT_FALSE(
+      lib::http::ParseHttpDate("Sun Nov  6 08:49:37 1994").HasValue());
+  EXPECT_FALSE(
+      lib::http::ParseHttpDate("Sun, 06 Foo 1994 08:49:37 GMT").HasValue());
+  EXPECT_FALSE(
+      lib::http::ParseHttpDate("Sun, 06 Nov 1994 25:49:37 GMT").HasValue());
+  EXPECT_FALSE(lib::http::ParseHttpDate("").HasValue());
+}
+
+TEST(HttpDateTest, CurrentHttpDate_TracksClock) {
+  const time_t before = std::time(NULL);
+  lib::type::Optional<time_t> parsed =
+      lib::http::ParseHttpDate(lib::http::CurrentHttpDate());
+  ASSERT_TRUE(parsed.HasValue());
+  EXPECT_GE(parsed.Value(), before);
+  EXPECT_LE(parsed.Value(), std::time(NULL));
+}
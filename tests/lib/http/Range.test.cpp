@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "lib/http/Range.hpp"
+
+using lib::http::ByteRange;
+using lib::http::ParseRangeHeader;
+
+class RangeTest : public ::testing::Test {
+ protected:
+  std::vector<ByteRange> ranges;
+
+  lib::http::RangeResult Parse(const std::string& value, size_t size = 1000) {
+    return ParseRangeHeader(value, size, &ranges);
+  }
+};
+
+TEST_F(RangeTest, FirstLast) {
+  ASSERT_EQ(Parse("bytes=0-499"), lib::http::kRangeSatisfiable);
+  ASSERT_EQ(ranges.size(), 1u);
+  EXPECT_EQ(ranges[0].first, 0u);
+  EXPECT_EQ(ranges[0].last, 499u);
+  EXPECT_EQ(ranges[0].Length(), 500u);
+}
+
+TEST_F(RangeTest, OpenEnded_ClampsToSize) {
+  ASSERT_EQ(Parse("bytes=900-"), lib::http::kRangeSatisfiable);
+  EXPECT_EQ(ranges[0].first, 900u);
+  EXPECT_EQ(ranges[0].last, 999u);
+}
+
+TEST_F(RangeTest, LastBeyondSize_IsClamped) {
+  ASSERT_EQ(Parse("bytes=990-5000"), lib::http::kRangeSatisfiable);
+  EXPECT_EQ(ranges[0].last, 999u);
+}
+
+TEST_F(RangeTest, Suffix) {
+  ASSERT_EQ(Parse("bytes=-100"), lib::http::kRangeSatisfiable);
+  EXPECT_EQ(ranges[0].first, 900u);
+  EXPECT_EQ(ranges[0].last, 999u);
+}
+
+TEST_F(RangeTest, SuffixLargerThanFile_SelectsWholeFile) {
+  ASSERT_EQ(Parse("bytes=-5000"), lib::http::kRangeSatisfiable);
+  EXPECT_EQ(ranges[0].first, 0u);
+  EXPECT_EQ(ranges[0].last, 999u);
+}
+
+TEST_F(RangeTest, MultipleRanges_SortedAndKept) {
+  ASSERT_EQ(Parse("bytes=500-599, 0-9"), lib::http::kRangeSatisfiable);
+  ASSERT_EQ(ranges.size(), 2u);
+  EXPECT_EQ(ranges[0].first, 0u);
+  EXPECT_EQ(ranges[1].first, 500u);
+}
+
+TEST_F(RangeTest, OverlappingAndAdjacentRanges_AreCoalesced) {
+  ASSERT_EQ(Parse("bytes=0-99,50-149,150-199"), lib::http::kRangeSatisfiable);
+  ASSERT_EQ(ranges.size(), 1u);
+  EXPECT_EQ(ranges[0].first, 0u);
+  EXPECT_EQ(ranges[0].last, 199u);
+}
+
+TEST_F(RangeTest, StartPastEnd_IsUnsatisfiable) {
+  EXPECT_EQ(Parse("bytes=1000-"), lib::http::kRangeUnsatisfiable);
+  EXPECT_EQ(Parse("bytes=-0"), lib::http::kRangeUnsatisfiable);
+  EXPECT_TRUE(ranges.empty());
+}
+
+TEST_F(RangeTest, OneSatisfiableRangeIsEnough) {
+  ASSERT_EQ(Parse("bytes=2000-3000,0-0"), lib::http::kRangeSatisfiable);
+  ASSERT_EQ(ranges.size(), 1u);
+  EXPECT_EQ(ranges[0].last, 0u);
+}
+
+TEST_F(RangeTest, InvalidSyntax_IsIgnored) {
+  EXPECT_EQ(Parse("items=0-1"), lib::http::kRangeIgnored);
+  EXPECT_EQ(Parse("bytes="), lib::http::kRangeIgnored);
+  EXPECT_EQ(Parse("bytes=5-1"), lib::http::kRangeIgnored);
+  EXPECT_EQ(Parse("bytes=a-b"), lib::http::kRangeIgnored);
+  EXPECT_EQ(Parse("bytes=1"), lib::http::kRangeIgnored);
+  EXPECT_EQ(Parse("bytes=-"), lib::http::kRangeIgnored);
+}
+
+TEST_F(RangeTest, TooManyRanges_AreIgnored) {
+  std::string value = "bytes=";
+  for (size_t i = 0; i <= lib::http::kMaxRanges; ++i) {
+    if (i) value += ",";
+    value += "0-0";
+  }
+  EXPECT_EQ(Parse(value), lib::http::kRangeIgnored);
+}
+
+TEST_F(RangeTest, HugePosition_DoesNotOverflow) {
+  EXPECT_EQ(Parse("bytes=99999999999999999999999-"),
+            lib::http::kRangeUnsatisfiable);
+  ASSERT_EQ(Parse("bytes=0-99999999999999999999999"),
+            lib::http::kRangeSatisfiable);
+  EXPECT_EQ(ranges[0].last, 999u);
+}
+
+TEST(ContentRangeTest, Format) {
+  ByteRange r;
+  r.first = 0;
+  r.last = 499;
+  EXPECT_EQ(lib::http::ContentRangeValue(r, 1234), "bytes 0-499/1234");
+}
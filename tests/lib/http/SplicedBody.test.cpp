@@ -0,0 +1,101 @@
+#include "lib/http/SplicedBody.hpp"
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <string>
+
+#include "lib/io/OutputQueue.hpp"
+
+// the body goes from source_[1] through the pipe to sink_[0]; the framing
+// is written to sink_[0] too, so sink_[1] reads the response body as sent
+class SplicedBodyTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, source_), 0);
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sink_), 0);
+    fcntl(source_[1], F_SETFL, O_NONBLOCK);
+    fcntl(sink_[1], F_SETFL, O_NONBLOCK);
+  }
+
+  virtual void TearDown() {
+    close(source_[0]);
+    close(source_[1]);
+    close(sink_[0]);
+    close(sink_[1]);
+  }
+
+  void Send(const std::string& data) {
+    ASSERT_EQ(write(source_[0], data.data(), data.size()),
+              static_cast<ssize_t>(data.size()));
+  }
+
+  // fills once, then produces and splices until nothing moves; true once
+  // the body is complete
+  bool Relay(lib::http::SplicedBody& body) {
+    body.Fill(source_[1]);
+    for (;;) {
+      lib::io::OutputQueue framing;
+      const bool done = body.Produce(framing);
+      EXPECT_GE(framing.WriteTo(sink_[0]), 0);
+      if (done) return true;
+      if (body.SpliceTo(sink_[0]) <= 0) return false;
+    }
+  }
+
+  std::string Received() {
+    std::string out;
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(sink_[1], buf, sizeof(buf))) > 0) out.append(buf, n);
+    return out;
+  }
+
+  int source_[2];
+  int sink_[2];
+};
+
+TEST_F(SplicedBodyTest, Chunked_FramesEachPipeLoad) {
+  lib::http::SplicedBody body(true);
+  Send("hello");
+  EXPECT_FALSE(Relay(body));
+  EXPECT_EQ(Received(), "5\r\nhello");
+
+  Send("world!");
+  EXPECT_FALSE(Relay(body));
+  body.Finish();
+  EXPECT_TRUE(Relay(body));
+  EXPECT_EQ(Received(), "\r\n6\r\nworld!\r\n0\r\n\r\n");
+  EXPECT_EQ(body.Pending(), 0u);
+}
+
+TEST_F(SplicedBodyTest, Chunked_AbortLeavesBodyUnterminated) {
+  lib::http::SplicedBody body(true);
+  Send("abc");
+  EXPECT_FALSE(Relay(body));
+  body.Abort();
+  EXPECT_TRUE(Relay(body));
+  EXPECT_EQ(Received(), "3\r\nabc");
+}
+
+TEST_F(SplicedBodyTest, Raw_PassesBytesWithoutFraming) {
+  lib::http::SplicedBody body(false);
+  Send("abc");
+  EXPECT_FALSE(Relay(body));
+  Send("def");
+  body.Finish();
+  EXPECT_TRUE(Relay(body));  // "def" is relayed before the end
+  EXPECT_EQ(Received(), "abcdef");
+}
+
+TEST_F(SplicedBodyTest, FillReportsEofAndEmptySource) {
+  lib::http::SplicedBody body(false);
+  EXPECT_EQ(body.Fill(source_[1]), -1);
+  EXPECT_EQ(errno, EAGAIN);
+  EXPECT_FALSE(body.IsFull());
+  shutdown(source_[0], SHUT_WR);
+  EXPECT_EQ(body.Fill(source_[1]), 0);
+}
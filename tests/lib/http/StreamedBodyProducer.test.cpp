@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "lib/http/StreamedBodyProducer.hpp"
+#include "lib/io/OutputQueue.hpp"
+
+// windowBits 15 + 32 lets inflate detect gzip and zlib headers; a stream
+// cut at a sync flush point decodes up to there
+static std::string Inflate(const std::string& in, bool complete) {
+  z_stream zs;
+  std::memset(&zs, 0, sizeof(zs));
+  EXPECT_EQ(inflateInit2(&zs, 15 + 32), Z_OK);
+  zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+  zs.avail_in = in.size();
+  std::string out;
+  char buf[4096];
+  int ret;
+  do {
+    zs.next_out = reinterpret_cast<Bytef*>(buf);
+    zs.avail_out = sizeof(buf);
+    ret = inflate(&zs, Z_SYNC_FLUSH);
+    out.append(buf, sizeof(buf) - zs.avail_out);
+  } while (ret == Z_OK && (zs.avail_in > 0 || zs.avail_out == 0));
+  if (complete) EXPECT_EQ(ret, Z_STREAM_END);
+  inflateEnd(&zs);
+  return out;
+}
+
+// strips chunked framing; *terminated tells whether the last-chunk was seen
+static std::string Dechunk(const std::string& in, bool* terminated) {
+  std::string out;
+  size_t pos = 0;
+  *terminated = false;
+  while (pos < in.size()) {
+    size_t eol = in.find("\r\n", pos);
+    if (eol == std::string::npos) {
+      ADD_FAILURE() << "missing chunk size line";
+      return out;
+    }
+    size_t len = std::strtoul(in.substr(pos, eol - pos).c_str(), NULL, 16);
+    pos = eol + 2;
+    if (len == 0) {
+      EXPECT_EQ(in.substr(pos), "\r\n");
+      *terminated = true;
+      return out;
+    }
+    out.append(in, pos, len);
+    pos += len;
+    EXPECT_EQ(in.compare(pos, 2, "\r\n"), 0);
+    pos += 2;
+  }
+  return out;
+}
+
+TEST(StreamedBodyProducerTest, Raw_PassesBytesThroughUntilFinished) {
+  lib::http::StreamedBodyProducer producer(false, 1024);
+  lib::io::OutputQueue out;
+  EXPECT_TRUE(producer.IsStarved());
+  EXPECT_FALSE(producer.Produce(out));
+  EXPECT_TRUE(out.Empty());
+
+  producer.Feed("hello ", 6);
+  EXPECT_FALSE(producer.IsStarved());
+  EXPECT_FALSE(producer.Produce(out));
+  producer.Feed("world", 5);
+  producer.Finish();
+  EXPECT_TRUE(producer.Produce(out));
+  EXPECT_EQ(out.ToString(), "hello world");
+  EXPECT_TRUE(producer.Produce(out));  // idempotent once done
+}
+
+TEST(StreamedBodyProducerTest, Chunked_OneChunkPerCallWithinLimit) {
+  lib::http::StreamedBodyProducer producer(true, 4);
+  producer.Feed("0123456789", 10);
+  producer.Finish();
+  lib::io::OutputQueue out;
+  EXPECT_FALSE(producer.Produce(out));
+  EXPECT_EQ(out.ToString(), "4\r\n0123\r\n");
+  EXPECT_EQ(producer.Pending(), 6u);
+
+  producer.SetChunkLimit(100);
+  EXPECT_TRUE(producer.Produce(out));
+  EXPECT_EQ(out.ToString(), "4\r\n0123\r\n6\r\n456789\r\n0\r\n\r\n");
+}
+
+TEST(StreamedBodyProducerTest, Abort_LeavesBodyUnterminated) {
+  lib::http::StreamedBodyProducer producer(true, 1024);
+  lib::io::OutputQueue out;
+  producer.Feed("partial", 7);
+  EXPECT_FALSE(producer.Produce(out));
+  producer.Feed("+queued", 7);
+  producer.Abort();
+  producer.Feed("ignored", 7);
+  EXPECT_TRUE(producer.Produce(out));
+
+  bool terminated;
+  EXPECT_EQ(Dechunk(out.ToString(), &terminated), "partial+queued");
+  EXPECT_FALSE(terminated);
+}
+
+// each batch of fed bytes is decodable once produced, before the source ends
+TEST(StreamedBodyProducerTest, Gzip_FlushesWhenSourceRunsDry) {
+  lib::http::StreamedBodyProducer producer(true, 1 << 16,
+                                           lib::http::kCodingGzip, 6);
+  lib::io::OutputQueue out;
+  const std::string first(3000, 'a');
+  producer.Feed(first.data(), first.size());
+  EXPECT_FALSE(producer.Produce(out));
+
+  bool terminated;
+  EXPECT_EQ(Inflate(Dechunk(out.ToString(), &terminated), false), first);
+  EXPECT_FALSE(terminated);
+
+  const std::string second = "tail";
+  producer.Feed(second.data(), second.size());
+  producer.Finish();
+  EXPECT_TRUE(producer.Produce(out));
+  EXPECT_EQ(Inflate(Dechunk(out.ToString(), &terminated), true),
+            first + second);
+  EXPECT_TRUE(terminated);
+}
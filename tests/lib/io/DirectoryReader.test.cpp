@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "lib/exception/ResponseStatusException.hpp"
+#include "lib/http/Status.hpp"
+#include "lib/io/DirectoryReader.hpp"
+
+namespace {
+
+bool ByName(const lib::io::DirEntry& a, const lib::io::DirEntry& b) {
+  return a.name < b.name;
+}
+
+}  // namespace
+
+TEST(DirectoryReaderTest, ListsNamesAndTypes_SkipsHidden) {
+  char tmpl[] = "/tmp/webserv_dirreader_test.XXXXXX";
+  ASSERT_NE(mkdtemp(tmpl), static_cast<char*>(NULL));
+  const std::string dir = tmpl;
+  { std::ofstream ofs((dir + "/b.txt").c_str()); }
+  { std::ofstream ofs((dir + "/.hidden").c_str()); }
+  mkdir((dir + "/a_dir").c_str(), 0755);
+
+  std::vector<lib::io::DirEntry> entries;
+  lib::io::ReadDirectoryOrThrow(dir, &entries);
+  std::sort(entries.begin(), entries.end(), ByName);
+  ASSERT_EQ(entries.size(), 2u);
+  EXPECT_EQ(entries[0].name, "a_dir");
+  EXPECT_TRUE(entries[0].is_dir);
+  EXPECT_EQ(entries[1].name, "b.txt");
+  EXPECT_FALSE(entries[1].is_dir);
+
+  unlink((dir + "/b.txt").c_str());
+  unlink((dir + "/.hidden").c_str());
+  rmdir((dir + "/a_dir").c_str());
+  rmdir(dir.c_str());
+}
+
+// several getdents64 calls for one directory
+TEST(DirectoryReaderTest, ListsLargeDirectory) {
+  char tmpl[] = "/tmp/webserv_dirreader_test.XXXXXX";
+  ASSERT_NE(mkdtemp(tmpl), static_cast<char*>(NULL));
+  const std::string dir = tmpl;
+  const int kFiles = 5000;
+  for (int i = 0; i < kFiles; ++i) {
+    std::ofstream ofs((dir + "/file_with_a_long_name_" +
+                       std::to_string(i)).c_str());
+  }
+  std::vector<lib::io::DirEntry> entries;
+  lib::io::ReadDirectoryOrThrow(dir, &entries);
+  EXPECT_EQ(entries.size(), static_cast<size_t>(kFiles));
+  for (int i = 0; i < kFiles; ++i) {
+    unlink((dir + "/file_with_a_long_name_" + std::to_string(i)).c_str());
+  }
+  rmdir(dir.c_str());
+}
+
+TEST(DirectoryReaderTest, Missing_Throws404) {
+  std::vector<lib::io::DirEntry> entries;
+  try {
+    lib::io::ReadDirectoryOrThrow("/nonexistent/webserv/dir", &entries);
+    FAIL() << "expected ResponseStatusException";
+  } catch (const lib::exception::ResponseStatusException& e) {
+    EXPECT_EQ(e.GetStatus(), lib::http::kNotFound);
+  }
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include "lib/exception/ResponseStatusException.hpp"
+#include "lib/io/MappedFile.hpp"
+
+class MappedFileTest : public ::testing::Test {
+ protected:
+  std::string dir_;
+  std::string path_;
+
+  void SetUp() override {
+    char tmpl[] = "/tmp/webserv_mmap_test.XXXXXX";
+    char* p = mkdtemp(tmpl);
+    ASSERT_NE(p, (char*)NULL);
+    dir_ = p;
+    path_ = dir_ + "/big.bin";
+    Write(std::string(100000, 'a'));
+  }
+
+  void TearDown() override {
+    unlink(path_.c_str());
+    rmdir(dir_.c_str());
+  }
+
+  void Write(const std::string& content) {
+    std::ofstream ofs(path_.c_str(), std::ios::binary | std::ios::trunc);
+    ofs << content;
+  }
+
+  struct stat Stat() {
+    struct stat st;
+    stat(path_.c_str(), &st);
+    return st;
+  }
+};
+
+TEST_F(MappedFileTest, Open_MapsWholeFile) {
+  lib::io::MappedFile f = lib::io::MappedFile::Open(path_, Stat());
+  ASSERT_TRUE(f.IsValid());
+  EXPECT_EQ(f.Size(), 100000u);
+  EXPECT_EQ(std::string(f.Data(), 3), "aaa");
+}
+
+TEST_F(MappedFileTest, ConcurrentOpens_ShareOneMapping) {
+  size_t before = lib::io::MappedFile::LiveMappingCount();
+  lib::io::MappedFile a = lib::io::MappedFile::Open(path_, Stat());
+  lib::io::MappedFile b = lib::io::MappedFile::Open(path_, Stat());
+  EXPECT_EQ(a.Data(), b.Data());
+  EXPECT_EQ(lib::io::MappedFile::LiveMappingCount(), before + 1);
+}
+
+TEST_F(MappedFileTest, LastHandleReleased_Unmaps) {
+  size_t before = lib::io::MappedFile::LiveMappingCount();
+  {
+    lib::io::MappedFile a = lib::io::MappedFile::Open(path_, Stat());
+    lib::io::MappedFile copy(a);
+    EXPECT_EQ(lib::io::MappedFile::LiveMappingCount(), before + 1);
+  }
+  EXPECT_EQ(lib::io::MappedFile::LiveMappingCount(), before);
+}
+
+TEST_F(MappedFileTest, ChangedFile_GetsFreshMapping_OldHandleStaysValid) {
+  lib::io::MappedFile old_map = lib::io::MappedFile::Open(path_, Stat());
+  // a different size is enough to invalidate the cache entry
+  unlink(path_.c_str());
+  Write(std::string(120000, 'b'));
+  lib::io::MappedFile new_map = lib::io::MappedFile::Open(path_, Stat());
+  EXPECT_EQ(new_map.Size(), 120000u);
+  EXPECT_EQ(new_map.Data()[0], 'b');
+  EXPECT_EQ(old_map.Size(), 100000u);
+  EXPECT_EQ(old_map.Data()[0], 'a');
+}
+
+TEST_F(MappedFileTest, EmptyFile_Throws) {
+  Write("");
+  EXPECT_THROW(lib::io::MappedFile::Open(path_, Stat()),
+               lib::exception::ResponseStatusException);
+}
+
+TEST_F(MappedFileTest, Populate_LeavesRangeResident) {
+  lib::io::MappedFile f = lib::io::MappedFile::Open(path_, Stat());
+  EXPECT_TRUE(f.Populate(4096, 50000));
+  EXPECT_TRUE(f.IsResident(4096, 50000));
+  EXPECT_TRUE(f.IsResident(200000, 10));  // past the end: nothing to wait for
+}
+
+// pages past a truncated end are reported, never touched (SIGBUS)
+TEST_F(MappedFileTest, Populate_FailsPastTruncatedEnd) {
+  lib::io::MappedFile f = lib::io::MappedFile::Open(path_, Stat());
+  ASSERT_EQ(truncate(path_.c_str(), 10), 0);
+  EXPECT_TRUE(f.Populate(0, 10));
+  EXPECT_FALSE(f.Populate(50000, 10000));
+}
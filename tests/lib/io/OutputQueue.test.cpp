@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "lib/io/MappedFile.hpp"
+#include "lib/io/OutputQueue.hpp"
+
+static std::string ReadAvailable(int fd) {
+  std::string out;
+  char buf[65536];
+  ssize_t n;
+  while ((n = read(fd, buf, sizeof(buf))) > 0) out.append(buf, n);
+  return out;
+}
+
+TEST(OutputQueueTest, Append_TracksSizeAndContent) {
+  lib::io::OutputQueue q;
+  EXPECT_TRUE(q.Empty());
+  q.Append("hello ");
+  q.Append(std::string("world"));
+  EXPECT_EQ(q.Size(), 11u);
+  EXPECT_EQ(q.ToString(), "hello world");
+  q.Clear();
+  EXPECT_TRUE(q.Empty());
+  EXPECT_EQ(q.ToString(), "");
+}
+
+TEST(OutputQueueTest, WriteTo_DrainsIntoFd) {
+  int sv[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sv), 0);
+  lib::io::OutputQueue q;
+  q.Append("abc");
+  q.Append("def");
+  EXPECT_EQ(q.WriteTo(sv[0]), 6);
+  EXPECT_TRUE(q.Empty());
+  fcntl(sv[1], F_SETFL, O_NONBLOCK);
+  EXPECT_EQ(ReadAvailable(sv[1]), "abcdef");
+  close(sv[0]);
+  close(sv[1]);
+}
+
+TEST(OutputQueueTest, WriteTo_PartialWriteKeepsRemainder) {
+  int sv[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sv), 0);
+  int small = 4096;
+  setsockopt(sv[0], SOL_SOCKET, SO_SNDBUF, &small, sizeof(small));
+  fcntl(sv[0], F_SETFL, O_NONBLOCK);
+  fcntl(sv[1], F_SETFL, O_NONBLOCK);
+
+  const std::string payload(1 << 20, 'x');
+  lib::io::OutputQueue q;
+  q.Append("head:");
+  q.Append(payload);
+  ssize_t n = q.WriteTo(sv[0]);
+  ASSERT_GT(n, 0);
+  ASSERT_LT(static_cast<size_t>(n), payload.size() + 5);
+  EXPECT_EQ(q.Size(), payload.size() + 5 - n);
+
+  std::string received = ReadAvailable(sv[1]);
+  while (!q.Empty()) {
+    if (q.WriteTo(sv[0]) < 0) ASSERT_EQ(errno, EAGAIN);
+    received += ReadAvailable(sv[1]);
+  }
+  received += ReadAvailable(sv[1]);
+  EXPECT_EQ(received, "head:" + payload);
+  close(sv[0]);
+  close(sv[1]);
+}
+
+TEST(OutputQueueTest, MappedSlice_IsWrittenWithoutCopy) {
+  char tmpl[] = "/tmp/webserv_queue_test.XXXXXX";
+  int fd = mkstemp(tmpl);
+  ASSERT_NE(fd, -1);
+  close(fd);
+  {
+    std::ofstream ofs(tmpl, std::ios::binary);
+    ofs << "0123456789";
+  }
+  struct stat st;
+  stat(tmpl, &st);
+  lib::io::MappedFile file = lib::io::MappedFile::Open(tmpl, st);
+
+  lib::io::OutputQueue q;
+  q.Append("[");
+  q.Append(file, 2, 5);
+  q.Append("]");
+  EXPECT_EQ(q.Size(), 7u);
+  EXPECT_EQ(q.ToString(), "[23456]");
+
+  lib::io::OutputQueue copy;
+  copy.Append(q);
+  EXPECT_EQ(copy.ToString(), "[23456]");
+  unlink(tmpl);
+}
+
+// the slice is pread() from the file: truncating it must not raise SIGBUS
+TEST(OutputQueueTest, CopyOut_ReadsMappedSliceAndDetectsTruncation) {
+  char tmpl[] = "/tmp/webserv_queue_test.XXXXXX";
+  int fd = mkstemp(tmpl);
+  ASSERT_NE(fd, -1);
+  ASSERT_EQ(write(fd, "0123456789", 10), 10);
+  struct stat st;
+  fstat(fd, &st);
+  lib::io::MappedFile file = lib::io::MappedFile::Open(tmpl, st);
+
+  lib::io::OutputQueue q;
+  q.Append("[");
+  q.Append(file, 2, 5);
+  char buf[16];
+  ASSERT_EQ(q.CopyOut(buf, sizeof(buf)), 6u);
+  EXPECT_EQ(std::string(buf, 6), "[23456");
+  EXPECT_EQ(q.Size(), 6u);  // nothing consumed
+
+  ASSERT_EQ(ftruncate(fd, 3), 0);
+  EXPECT_THROW(q.CopyOut(buf, sizeof(buf)), std::runtime_error);
+  close(fd);
+  unlink(tmpl);
+}
+
+TEST(OutputQueueTest, FirstMappedSlice_SkipsOwnedSegments) {
+  char tmpl[] = "/tmp/webserv_queue_test.XXXXXX";
+  int fd = mkstemp(tmpl);
+  ASSERT_NE(fd, -1);
+  ASSERT_EQ(write(fd, "0123456789", 10), 10);
+  struct stat st;
+  fstat(fd, &st);
+  lib::io::MappedFile file = lib::io::MappedFile::Open(tmpl, st);
+
+  lib::io::OutputQueue q;
+  lib::io::MappedFile found;
+  size_t offset = 0;
+  size_t length = 0;
+  q.Append("head");
+  EXPECT_FALSE(q.FirstMappedSlice(&found, &offset, &length));
+  q.Append(file, 2, 5);
+  q.Append(file, 8, 2);
+  ASSERT_TRUE(q.FirstMappedSlice(&found, &offset, &length));
+  EXPECT_EQ(found.Data(), file.Data());
+  EXPECT_EQ(offset, 2u);
+  EXPECT_EQ(length, 5u);
+  q.Consume(6);  // "head" and two bytes of the slice
+  ASSERT_TRUE(q.FirstMappedSlice(&found, &offset, &length));
+  EXPECT_EQ(offset, 4u);
+  EXPECT_EQ(length, 3u);
+  close(fd);
+  unlink(tmpl);
+}
+
+TEST(OutputQueueTest, MappedSlice_OutOfRange_Throws) {
+  lib::io::OutputQueue q;
+  lib::io::MappedFile invalid;
+  EXPECT_THROW(q.Append(invalid, 0, 1), std::out_of_range);
+}
+
+TEST(OutputQueueTest, SharedBuffer_IsReferencedNotCopied) {
+  lib::type::SharedPtr<const std::string> buf(new std::string("shared"));
+  lib::io::OutputQueue q;
+  q.Append(buf);
+  q.Append("!");
+  EXPECT_EQ(buf.UseCount(), 2);
+  EXPECT_EQ(q.ToString(), "shared!");
+
+  const char* data;
+  EXPECT_EQ(q.Peek(&data), 6u);
+  EXPECT_EQ(data, buf->data());
+  q.Consume(7);
+  EXPECT_TRUE(q.Empty());
+  EXPECT_EQ(buf.UseCount(), 1);
+}
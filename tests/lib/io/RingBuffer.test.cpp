@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "lib/io/RingBuffer.hpp"
+
+static std::string ReadAvailable(int fd) {
+  std::string out;
+  char buf[4096];
+  ssize_t n;
+  while ((n = read(fd, buf, sizeof(buf))) > 0) out.append(buf, n);
+  return out;
+}
+
+TEST(RingBufferTest, Append_IsAllOrNothing) {
+  lib::io::RingBuffer ring(8);
+  EXPECT_TRUE(ring.Empty());
+  EXPECT_TRUE(ring.Append("hello", 5));
+  EXPECT_EQ(ring.Size(), 5u);
+  EXPECT_EQ(ring.Available(), 3u);
+  EXPECT_FALSE(ring.Append("world", 5));
+  EXPECT_EQ(ring.Size(), 5u);
+  EXPECT_TRUE(ring.Append("abc", 3));
+  EXPECT_EQ(ring.Available(), 0u);
+  ring.Clear();
+  EXPECT_TRUE(ring.Empty());
+  EXPECT_EQ(ring.Capacity(), 8u);
+}
+
+TEST(RingBufferTest, WriteTo_HandlesWrapAround) {
+  int sv[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sv), 0);
+  fcntl(sv[1], F_SETFL, O_NONBLOCK);
+
+  lib::io::RingBuffer ring(8);
+  ASSERT_TRUE(ring.Append("012345", 6));
+  EXPECT_EQ(ring.WriteTo(sv[0]), 6);
+  EXPECT_EQ(ReadAvailable(sv[1]), "012345");
+
+  // head is at 6: "abcdef" wraps after two bytes
+  ASSERT_TRUE(ring.Append("abcdef", 6));
+  EXPECT_EQ(ring.WriteTo(sv[0]), 6);
+  EXPECT_TRUE(ring.Empty());
+  EXPECT_EQ(ReadAvailable(sv[1]), "abcdef");
+
+  close(sv[0]);
+  close(sv[1]);
+}
+
+TEST(RingBufferTest, WriteTo_KeepsUnwrittenBytes) {
+  lib::io::RingBuffer ring(4);
+  ASSERT_TRUE(ring.Append("abcd", 4));
+  EXPECT_EQ(ring.WriteTo(-1), -1);
+  EXPECT_EQ(ring.Size(), 4u);
+}
+
+TEST(RingBufferTest, MoveTo_AppendsAndEmpties) {
+  lib::io::RingBuffer ring(8);
+  ASSERT_TRUE(ring.Append("012345", 6));
+  std::string out = ">";
+  ring.MoveTo(&out);
+  EXPECT_EQ(out, ">012345");
+  EXPECT_TRUE(ring.Empty());
+
+  ASSERT_TRUE(ring.Append("abcdefgh", 8));
+  ring.MoveTo(&out);
+  EXPECT_EQ(out, ">012345abcdefgh");
+  EXPECT_EQ(ring.Available(), 8u);
+}
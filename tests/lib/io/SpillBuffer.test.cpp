@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <sstream>
+#include <string>
+
+#include "lib/io/SpillBuffer.hpp"
+
+TEST(SpillBufferTest, StaysInMemoryUpToLimit) {
+  lib::io::SpillBuffer buf(8);
+  EXPECT_TRUE(buf.Empty());
+  buf.Append("hello", 5);
+  buf.Append("abc");
+  EXPECT_EQ(buf.Size(), 8u);
+  EXPECT_FALSE(buf.IsSpilled());
+  EXPECT_EQ(buf.FileFd(), -1);
+  EXPECT_EQ(buf.ToString(), "helloabc");
+}
+
+TEST(SpillBufferTest, SpillsPastLimitAndKeepsEveryByte) {
+  lib::io::SpillBuffer buf(8);
+  buf.Append("hello", 5);
+  buf.Append(" spilled world");
+  ASSERT_TRUE(buf.IsSpilled());
+  EXPECT_EQ(buf.Size(), 19u);
+  EXPECT_EQ(buf.ToString(), "hello spilled world");
+
+  char head[5];
+  ASSERT_EQ(pread(buf.FileFd(), head, sizeof(head), 0), 5);
+  EXPECT_EQ(std::string(head, 5), "hello");
+
+  std::ostringstream out;
+  buf.WriteTo(out);
+  EXPECT_EQ(out.str(), "hello spilled world");
+}
+
+TEST(SpillBufferTest, WriteTo_CopiesLargeFilesInBlocks) {
+  lib::io::SpillBuffer buf(16);
+  std::string expected;
+  for (int i = 0; i < 300; ++i) {
+    const std::string piece(1000, static_cast<char>('a' + i % 26));
+    buf.Append(piece);
+    expected += piece;
+  }
+  ASSERT_TRUE(buf.IsSpilled());
+  std::ostringstream out;
+  buf.WriteTo(out);
+  EXPECT_EQ(out.str(), expected);
+}
+
+TEST(SpillBufferTest, WriteToFd_CopiesMemoryAndFile) {
+  char tmpl[] = "/tmp/webserv_spill_out.XXXXXX";
+  const int fd = mkstemp(tmpl);
+  ASSERT_NE(fd, -1);
+  unlink(tmpl);
+  lib::io::SpillBuffer small(64);
+  small.Append("head:");
+  small.WriteTo(fd);
+  lib::io::SpillBuffer big(16);
+  const std::string payload(100000, 'x');
+  big.Append(payload);
+  ASSERT_TRUE(big.IsSpilled());
+  big.WriteTo(fd);
+
+  std::string written(5 + payload.size(), '\0');
+  ASSERT_EQ(pread(fd, &written[0], written.size(), 0),
+            static_cast<ssize_t>(written.size()));
+  EXPECT_EQ(written, "head:" + payload);
+  close(fd);
+}
+
+TEST(SpillBufferTest, Copy_AppendDoesNotChangeTheOriginal) {
+  lib::io::SpillBuffer original(4);
+  original.Append("0123456789");
+  ASSERT_TRUE(original.IsSpilled());
+
+  lib::io::SpillBuffer copy(original);
+  EXPECT_EQ(copy.FileFd(), original.FileFd());
+  copy.Append("ab");
+  EXPECT_NE(copy.FileFd(), original.FileFd());
+  EXPECT_EQ(copy.ToString(), "0123456789ab");
+
+  original.Append("XY");
+  EXPECT_EQ(original.ToString(), "0123456789XY");
+  EXPECT_EQ(copy.ToString(), "0123456789ab");
+}
+
+TEST(SpillBufferTest, Clear_DropsTheFile) {
+  lib::io::SpillBuffer buf(4);
+  buf.Append("0123456789");
+  buf.Clear();
+  EXPECT_TRUE(buf.Empty());
+  EXPECT_FALSE(buf.IsSpilled());
+  buf.Append("ok");
+  EXPECT_EQ(buf.ToString(), "ok");
+}
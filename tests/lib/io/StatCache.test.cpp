@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include "lib/io/StatCache.hpp"
+
+class StatCacheTest : public ::testing::Test {
+ protected:
+  std::string path_;
+
+  void SetUp() override {
+    char tmpl[] = "/tmp/webserv_statcache_test.XXXXXX";
+    int fd = mkstemp(tmpl);
+    ASSERT_NE(fd, -1);
+    close(fd);
+    path_ = tmpl;
+    lib::io::StatCache::Clear();
+  }
+
+  void TearDown() override {
+    unlink(path_.c_str());
+    lib::io::StatCache::Clear();
+  }
+};
+
+TEST_F(StatCacheTest, Lookup_ExistingFile) {
+  struct stat st;
+  ASSERT_TRUE(lib::io::StatCache::Lookup(path_, &st));
+  EXPECT_TRUE(S_ISREG(st.st_mode));
+  EXPECT_EQ(lib::io::StatCache::Size(), 1u);
+}
+
+// a cached miss is reused until it expires, even if the file appears
+TEST_F(StatCacheTest, Lookup_NegativeEntryIsCached) {
+  const std::string missing = path_ + ".gz";
+  struct stat st;
+  EXPECT_FALSE(lib::io::StatCache::Lookup(missing, &st));
+  { std::ofstream ofs(missing.c_str()); }
+  EXPECT_FALSE(lib::io::StatCache::Lookup(missing, &st));
+
+  lib::io::StatCache::Clear();
+  EXPECT_TRUE(lib::io::StatCache::Lookup(missing, &st));
+  unlink(missing.c_str());
+}
+
+TEST_F(StatCacheTest, Lookup_PositiveEntryIsCached) {
+  struct stat first;
+  ASSERT_TRUE(lib::io::StatCache::Lookup(path_, &first));
+  unlink(path_.c_str());
+  struct stat second;
+  EXPECT_TRUE(lib::io::StatCache::Lookup(path_, &second));
+  EXPECT_EQ(first.st_ino, second.st_ino);
+}
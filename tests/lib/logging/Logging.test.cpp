@@ -0,0 +1,35 @@
+#include "lib/logging/Logging.hpp"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+namespace {
+
+int Touch(int* calls) {
+  ++*calls;
+  return 0;
+}
+
+}  // namespace
+
+TEST(LoggingTest, ParseLevel) {
+  EXPECT_EQ(lib::logging::ParseLevel("debug"), lib::logging::kDebug);
+  EXPECT_EQ(lib::logging::ParseLevel("info"), lib::logging::kInfo);
+  EXPECT_EQ(lib::logging::ParseLevel("warn"), lib::logging::kWarn);
+  EXPECT_EQ(lib::logging::ParseLevel("error"), lib::logging::kError);
+  EXPECT_THROW(lib::logging::ParseLevel("verbose"), std::runtime_error);
+  EXPECT_THROW(lib::logging::ParseLevel("DEBUG"), std::runtime_error);
+}
+
+TEST(LoggingTest, DisabledLevelSkipsOperands) {
+  const lib::logging::Level saved = lib::logging::GetLevel();
+  lib::logging::SetLevel(lib::logging::kWarn);
+  EXPECT_FALSE(lib::logging::IsEnabled(lib::logging::kInfo));
+  EXPECT_TRUE(lib::logging::IsEnabled(lib::logging::kError));
+
+  int calls = 0;
+  WEBSERV_LOG(kDebug) << Touch(&calls);
+  EXPECT_EQ(calls, 0);
+  lib::logging::SetLevel(saved);
+}
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "lib/type/SharedPtr.hpp"
+
+namespace {
+
+struct Tracked {
+  static int alive;
+  Tracked() {
+    ++alive;
+  }
+  ~Tracked() {
+    --alive;
+  }
+};
+
+int Tracked::alive = 0;
+
+}  // namespace
+
+TEST(SharedPtrTest, DefaultIsNull) {
+  lib::type::SharedPtr<int> p;
+  EXPECT_TRUE(p.IsNull());
+  EXPECT_EQ(p.UseCount(), 0);
+}
+
+TEST(SharedPtrTest, CopiesShareOwnership) {
+  {
+    lib::type::SharedPtr<Tracked> a(new Tracked());
+    EXPECT_EQ(Tracked::alive, 1);
+    {
+      lib::type::SharedPtr<Tracked> b(a);
+      lib::type::SharedPtr<Tracked> c;
+      c = b;
+      EXPECT_EQ(a.UseCount(), 3);
+      EXPECT_EQ(c.Get(), a.Get());
+    }
+    EXPECT_EQ(a.UseCount(), 1);
+    EXPECT_EQ(Tracked::alive, 1);
+  }
+  EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(SharedPtrTest, ResetAndReassignReleases) {
+  lib::type::SharedPtr<Tracked> a(new Tracked());
+  a = a;  // self-assignment keeps the object
+  EXPECT_EQ(Tracked::alive, 1);
+  a = lib::type::SharedPtr<Tracked>(new Tracked());
+  EXPECT_EQ(Tracked::alive, 1);
+  a.Reset();
+  EXPECT_TRUE(a.IsNull());
+  EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(SharedPtrTest, ConvertsToConst) {
+  lib::type::SharedPtr<std::string> s(new std::string("x"));
+  lib::type::SharedPtr<const std::string> cs(s);
+  EXPECT_EQ(*cs, "x");
+  EXPECT_EQ(s.UseCount(), 2);
+}
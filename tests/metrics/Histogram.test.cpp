@@ -0,0 +1,72 @@
+#include "metrics/Histogram.hpp"
+
+#include <gtest/gtest.h>
+
+using metrics::Histogram;
+
+TEST(Histogram, SmallValuesGetABucketEach) {
+  EXPECT_EQ(Histogram::BucketIndex(0), 0u);
+  EXPECT_EQ(Histogram::BucketIndex(1), 1u);
+  EXPECT_EQ(Histogram::BucketUpperBound(0), 1u);
+  EXPECT_EQ(Histogram::BucketUpperBound(1), 2u);
+}
+
+TEST(Histogram, PowersOfTwoAreSplitIntoSubBuckets) {
+  // [2,3) [3,4) [4,6) [6,8) [8,12) ...
+  EXPECT_EQ(Histogram::BucketIndex(2), 2u);
+  EXPECT_EQ(Histogram::BucketIndex(3), 3u);
+  EXPECT_EQ(Histogram::BucketIndex(4), 4u);
+  EXPECT_EQ(Histogram::BucketIndex(5), 4u);
+  EXPECT_EQ(Histogram::BucketIndex(6), 5u);
+  EXPECT_EQ(Histogram::BucketIndex(8), 6u);
+  EXPECT_EQ(Histogram::BucketUpperBound(4), 6u);
+  EXPECT_EQ(Histogram::BucketUpperBound(5), 8u);
+  EXPECT_EQ(Histogram::BucketUpperBound(6), 12u);
+}
+
+TEST(Histogram, EveryValueFallsBelowItsBucketBound) {
+  for (uint64_t v = 0; v < 100000; v += 7) {
+    const size_t index = Histogram::BucketIndex(v);
+    EXPECT_LT(v, Histogram::BucketUpperBound(index)) << v;
+    if (index > 0) {
+      EXPECT_GE(v, Histogram::BucketUpperBound(index - 1)) << v;
+    }
+  }
+}
+
+TEST(Histogram, LargeValuesLandInTheLastBucket) {
+  const uint64_t huge = static_cast<uint64_t>(1) << 40;
+  EXPECT_EQ(Histogram::BucketIndex(huge), Histogram::kBucketCount - 1);
+}
+
+TEST(Histogram, RecordCountsAndSums) {
+  Histogram h;
+  h.Record(5);
+  h.Record(5);
+  h.Record(100);
+  EXPECT_EQ(h.Count(), 3u);
+  EXPECT_EQ(h.Sum(), 110u);
+  EXPECT_EQ(h.BucketValue(Histogram::BucketIndex(5)), 2u);
+}
+
+TEST(Histogram, MergeAddsBuckets) {
+  Histogram a;
+  Histogram b;
+  a.Record(10);
+  b.Record(10);
+  b.Record(1000);
+  a.Merge(b);
+  EXPECT_EQ(a.Count(), 3u);
+  EXPECT_EQ(a.Sum(), 1020u);
+  EXPECT_EQ(a.BucketValue(Histogram::BucketIndex(10)), 2u);
+}
+
+TEST(Histogram, ValueAtQuantileReturnsBucketBound) {
+  Histogram h;
+  EXPECT_EQ(h.ValueAtQuantile(0.5), 0u);
+  for (int i = 0; i < 99; ++i) h.Record(10);
+  h.Record(5000);
+  EXPECT_EQ(h.ValueAtQuantile(0.5), 12u);
+  EXPECT_EQ(h.ValueAtQuantile(0.99), 12u);
+  EXPECT_EQ(h.ValueAtQuantile(1.0), 6144u);
+}
@@ -0,0 +1,115 @@
+#include "metrics/Metrics.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "Worker.hpp"
+
+class MetricsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    metrics::Reset();
+  }
+
+  void TearDown() override {
+    worker::Bind(0);
+    metrics::Reset();
+  }
+};
+
+TEST_F(MetricsTest, CollectSumsWorkerSlots) {
+  metrics::Increment(metrics::kConnectionsAccepted);
+  metrics::Add(metrics::kBytesSent, 100);
+  worker::Bind(3);
+  metrics::Increment(metrics::kConnectionsAccepted);
+  metrics::Add(metrics::kBytesSent, 50);
+
+  const metrics::Snapshot s = metrics::Collect();
+  EXPECT_EQ(s.counters[metrics::kConnectionsAccepted], 2u);
+  EXPECT_EQ(s.counters[metrics::kBytesSent], 150u);
+}
+
+TEST_F(MetricsTest, ActiveConnectionsAreHandledMinusClosed) {
+  metrics::Increment(metrics::kConnectionsHandled);
+  metrics::Increment(metrics::kConnectionsHandled);
+  metrics::Increment(metrics::kConnectionsClosed);
+  EXPECT_EQ(metrics::Collect().ActiveConnections(), 1u);
+}
+
+TEST_F(MetricsTest, RequestsAreCountedByStatusAndLocation) {
+  const metrics::LocationId id = metrics::RegisterLocation("/metrics_test");
+  metrics::RecordRequest(id, 200, 100);
+  metrics::RecordRequest(id, 200, 300);
+  metrics::RecordRequest(metrics::kUnmatchedLocation, 404, 10);
+
+  const metrics::Snapshot s = metrics::Collect();
+  EXPECT_EQ(s.Requests(), 3u);
+  EXPECT_EQ(s.requests_by_status.find(200)->second, 2u);
+  EXPECT_EQ(s.requests_by_status.find(404)->second, 1u);
+  bool found = false;
+  for (size_t i = 0; i < s.request_duration.size(); ++i) {
+    if (s.request_duration[i].first == "/metrics_test") {
+      found = true;
+      EXPECT_EQ(s.request_duration[i].second.Count(), 2u);
+      EXPECT_EQ(s.request_duration[i].second.Sum(), 400u);
+    }
+  }
+  EXPECT_TRUE(found);
+}
+
+TEST_F(MetricsTest, RecordTraceFillsPhaseHistograms) {
+  trace::Trace t;
+  t.MarkAt(trace::kFirstByte, 100);
+  t.MarkAt(trace::kHeadersParsed, 160);
+  metrics::RecordTrace(t);
+
+  const metrics::Snapshot s = metrics::Collect();
+  EXPECT_EQ(s.phase_duration[trace::kSpanHeaders].Count(), 1u);
+  EXPECT_EQ(s.phase_duration[trace::kSpanHeaders].Sum(), 60u);
+  EXPECT_EQ(s.phase_duration[trace::kSpanTotal].Count(), 0u);
+  EXPECT_NE(metrics::RenderPrometheus(s).find(
+                "webserv_request_phase_duration_seconds_count"
+                "{phase=\"headers\"} 1\n"),
+            std::string::npos);
+}
+
+TEST_F(MetricsTest, RegisterLocationInternsNames) {
+  const metrics::LocationId a = metrics::RegisterLocation("/intern_a");
+  const metrics::LocationId b = metrics::RegisterLocation("/intern_b");
+  EXPECT_NE(a, b);
+  EXPECT_NE(a, metrics::kUnmatchedLocation);
+  EXPECT_EQ(metrics::RegisterLocation("/intern_a"), a);
+}
+
+TEST_F(MetricsTest, RenderStubStatusUsesNginxLayout) {
+  metrics::Increment(metrics::kConnectionsAccepted);
+  metrics::Increment(metrics::kConnectionsHandled);
+  metrics::RecordRequest(metrics::kUnmatchedLocation, 200, 1);
+  EXPECT_EQ(metrics::RenderStubStatus(metrics::Collect()),
+            "Active connections: 1 \n"
+            "server accepts handled requests\n"
+            " 1 1 1 \n");
+}
+
+TEST_F(MetricsTest, RenderPrometheusExposesSeries) {
+  metrics::Increment(metrics::kCgiSpawned);
+  metrics::RecordCgiDuration(2500);
+  metrics::RecordRequest(metrics::RegisterLocation("/prom"), 503, 1000);
+
+  const std::string text = metrics::RenderPrometheus(metrics::Collect());
+  EXPECT_NE(text.find("# TYPE webserv_requests_total counter\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("webserv_requests_total{code=\"503\"} 1\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("webserv_cgi_spawned_total 1\n"), std::string::npos);
+  EXPECT_NE(text.find("webserv_cgi_duration_seconds_bucket{le=\"+Inf\"} 1\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("webserv_cgi_duration_seconds_sum 0.0025\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("webserv_request_duration_seconds_bucket{location="
+                      "\"/prom\",le=\"0.001024\"} 1\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("webserv_cache_hit_ratio{cache=\"stat\"}"),
+            std::string::npos);
+}
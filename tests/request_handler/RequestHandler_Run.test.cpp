@@ -1,4 +1,10 @@
 #include <gtest/gtest.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
 
 #include "ServerConfig.hpp"
 #include "Location.hpp"
@@ -26,3 +32,106 @@ TEST(RequestHandler, Run_NoMatchingLocation_Returns404) {
   EXPECT_EQ(result.new_socket, (ASocket*)NULL);
   EXPECT_EQ(result.response.GetStatus(), lib::http::kNotFound);
 }
+
+TEST(RequestHandler, Run_StubStatusLocation_ServesCounters) {
+  ServerConfig config;
+  Location status;
+  status.SetName("/status");
+  status.SetStubStatus("text");
+  config.AddLocation(status);
+
+  HttpRequest req;
+  req.SetMethod(lib::http::kGet);
+  req.SetUri("/status");
+
+  RequestHandler handler(config, req);
+  ExecResult result = handler.Run();
+  EXPECT_EQ(result.response.GetStatus(), lib::http::kOk);
+  EXPECT_EQ(result.response.GetHeader("content-type").ValueOr(""), "text/plain");
+  EXPECT_EQ(result.response.GetBody().find("Active connections: "), 0u);
+  EXPECT_EQ(result.location, &config.GetLocations()[0]);
+}
+
+TEST(RequestHandler, Run_StubStatusLocation_RejectsOtherMethods) {
+  ServerConfig config;
+  Location status;
+  status.SetName("/status");
+  status.SetStubStatus("prometheus");
+  config.AddLocation(status);
+
+  HttpRequest req;
+  req.SetMethod(lib::http::kDelete);
+  req.SetUri("/status");
+
+  RequestHandler handler(config, req);
+  ExecResult result = handler.Run();
+  EXPECT_EQ(result.response.GetStatus(), lib::http::kMethodNotAllowed);
+  EXPECT_EQ(result.response.GetHeader("allow").ValueOr(""), "GET");
+}
+
+namespace {
+
+// an internal location over a directory holding one small file
+class InternalRedirectTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    char dir[] = "/tmp/webserv_internal_XXXXXX";
+    ASSERT_NE(mkdtemp(dir), static_cast<char*>(NULL));
+    dir_ = dir;
+    std::ofstream((dir_ + "/file.txt").c_str()) << "file body";
+    Location files;
+    files.SetName("/files");
+    files.SetRoot(dir_);
+    files.SetInternal();
+    config_.AddLocation(files);
+    Location open;
+    open.SetName("/open");
+    open.SetRoot(dir_);
+    config_.AddLocation(open);
+    req_.SetMethod(lib::http::kGet);
+    req_.SetUri("/cgi/download.py");
+  }
+
+  virtual void TearDown() {
+    std::remove((dir_ + "/file.txt").c_str());
+    rmdir(dir_.c_str());
+  }
+
+  std::string dir_;
+  ServerConfig config_;
+  HttpRequest req_;
+};
+
+}  // namespace
+
+TEST_F(InternalRedirectTest, DirectRequestIsNotFound) {
+  req_.SetUri("/files/file.txt");
+  RequestHandler handler(config_, req_);
+  EXPECT_EQ(handler.Run().response.GetStatus(), lib::http::kNotFound);
+}
+
+TEST_F(InternalRedirectTest, ServesTheFileWithTheScriptHeaders) {
+  HttpResponse script_res;
+  script_res.AddHeader("Content-Disposition", "attachment");
+  script_res.AddHeader("Content-Type", "text/x-ignored");
+  RequestHandler handler(config_, req_);
+  handler.SetInternalRedirect("/files/file.txt", script_res);
+  ExecResult result = handler.Run();
+  EXPECT_EQ(result.response.GetStatus(), lib::http::kOk);
+  EXPECT_EQ(result.response.GetBody(), "file body");
+  EXPECT_EQ(result.response.GetHeader("content-disposition").ValueOr(""),
+            "attachment");
+  EXPECT_EQ(result.response.GetHeader("content-type").ValueOr(""),
+            "text/plain");
+  EXPECT_EQ(result.location, &config_.GetLocations()[0]);
+}
+
+TEST_F(InternalRedirectTest, TargetsOutsideInternalLocationsFail) {
+  RequestHandler to_open(config_, req_);
+  to_open.SetInternalRedirect("/open/file.txt", HttpResponse());
+  EXPECT_EQ(to_open.Run().response.GetStatus(), lib::http::kBadGateway);
+
+  RequestHandler missing(config_, req_);
+  missing.SetInternalRedirect("/files/missing.txt", HttpResponse());
+  EXPECT_EQ(missing.Run().response.GetStatus(), lib::http::kNotFound);
+}
@@ -0,0 +1,460 @@
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include "ConfigParser.hpp"
+#include "HttpRequest.hpp"
+#include "RequestHandler.hpp"
+#include "ServerConfig.hpp"
+#include "autoindex/ListingCache.hpp"
+#include "lib/http/HttpDate.hpp"
+#include "lib/http/Method.hpp"
+#include "lib/http/Status.hpp"
+#include "lib/io/StatCache.hpp"
+#include "lib/type/Optional.hpp"
+
+static void WriteFile(const std::string& path, const std::string& body) {
+  std::ofstream ofs(path.c_str(), std::ios::binary);
+  ofs << body;
+}
+
+static std::string MakeTempDir() {
+  char tmpl[] = "/tmp/webserv_get_test.XXXXXX";
+  char* p = mkdtemp(tmpl);
+  if (!p) return "";
+  return std::string(p);
+}
+
+class RequestHandlerGetTest : public ::testing::Test {
+ protected:
+  std::string tmp_;
+  ServerConfig config_;
+
+  void SetUp() override {
+    tmp_ = MakeTempDir();
+    ASSERT_FALSE(tmp_.empty());
+
+    ConfigParser parser;
+    parser.content =
+        "{ "
+        "listen 0.0.0.0:8084; "
+        "location /files { "
+        "  root " + tmp_ + "; "
+        "  index index.html; "
+        "  allowed_methods GET; "
+        "} "
+        "}";
+    ASSERT_NO_THROW(parser.ParseServer());
+    config_ = parser.GetServerConfigs()[0];
+  }
+
+  void TearDown() override {
+    unlink((tmp_ + "/small.txt").c_str());
+    unlink((tmp_ + "/large.bin").c_str());
+    unlink((tmp_ + "/digits.txt").c_str());
+    unlink((tmp_ + "/app.js").c_str());
+    unlink((tmp_ + "/app.js.gz").c_str());
+    unlink((tmp_ + "/app.js.br").c_str());
+    rmdir(tmp_.c_str());
+  }
+
+  // headers are given as raw "Key: value\r\n" lines
+  ExecResult RunGet(const std::string& uri,
+                    const std::string& headers = "") {
+    HttpRequest req;
+    std::string raw = "GET " + uri + " HTTP/1.1\r\nHost: localhost\r\n" +
+                      headers + "\r\n";
+    req.Parse(raw.c_str(), raw.size());
+    RequestHandler handler(config_, req);
+    return handler.Run();
+  }
+};
+
+TEST_F(RequestHandlerGetTest, StaticGet_SmallFile_Returns200WithBody) {
+  WriteFile(tmp_ + "/small.txt", "hello");
+  ExecResult r = RunGet("/files/small.txt");
+  EXPECT_EQ(r.response.GetStatus(), lib::http::kOk);
+  EXPECT_EQ(r.response.GetBody(), "hello");
+  lib::type::Optional<std::string> ct = r.response.GetHeader("content-type");
+  ASSERT_TRUE(ct.HasValue());
+  EXPECT_EQ(ct.Value(), "text/plain");
+}
+
+TEST_F(RequestHandlerGetTest, StaticGet_LargeFile_IsServedFromMapping) {
+  std::string content(200000, 'z');
+  content[199999] = '!';
+  WriteFile(tmp_ + "/large.bin", content);
+  ExecResult r = RunGet("/files/large.bin");
+  EXPECT_EQ(r.response.GetStatus(), lib::http::kOk);
+  EXPECT_EQ(r.response.GetBodySize(), content.size());
+  EXPECT_EQ(r.response.GetBody(), content);
+  EXPECT_NE(r.response.ToHttpString().find("content-length: 200000\r\n"),
+            std::string::npos);
+}
+
+TEST_F(RequestHandlerGetTest, StaticGet_MissingFile_Returns404) {
+  ExecResult r = RunGet("/files/none.txt");
+  EXPECT_EQ(r.response.GetStatus(), lib::http::kNotFound);
+}
+
+// ======================== Range ========================
+
+class RequestHandlerRangeTest : public RequestHandlerGetTest {
+ protected:
+  std::string last_modified_;
+
+  void SetUp() override {
+    RequestHandlerGetTest::SetUp();
+    WriteFile(tmp_ + "/digits.txt", "0123456789");
+    struct stat st;
+    stat((tmp_ + "/digits.txt").c_str(), &st);
+    last_modified_ = lib::http::FormatHttpDate(st.st_mtime);
+  }
+
+  std::string Header(const ExecResult& r, const std::string& key) {
+    HttpResponse res = r.response;
+    return res.GetHeader(key).ValueOr("");
+  }
+};
+
+TEST_F(RequestHandlerRangeTest, FullResponse_AdvertisesRanges) {
+  ExecResult r = RunGet("/files/digits.txt");
+  EXPECT_EQ(r.response.GetStatus(), lib::http::kOk);
+  EXPECT_EQ(Header(r, "accept-ranges"), "bytes");
+  EXPECT_EQ(Header(r, "last-modified"), last_modified_);
+}
+
+TEST_F(RequestHandlerRangeTest, SingleRange_Returns206) {
+  ExecResult r = RunGet("/files/digits.txt", "Range: bytes=2-4\r\n");
+  EXPECT_EQ(r.response.GetStatus(), lib::http::kPartialContent);
+  EXPECT_EQ(r.response.GetBody(), "234");
+  EXPECT_EQ(Header(r, "content-range"), "bytes 2-4/10");
+  EXPECT_EQ(Header(r, "content-type"), "text/plain");
+}
+
+TEST_F(RequestHandlerRangeTest, SuffixRange_Returns206) {
+  ExecResult r = RunGet("/files/digits.txt", "Range: bytes=-3\r\n");
+  EXPECT_EQ(r.response.GetStatus(), lib::http::kPartialContent);
+  EXPECT_EQ(r.response.GetBody(), "789");
+}
+
+TEST_F(RequestHandlerRangeTest, MultiRange_ReturnsMultipartByteranges) {
+  ExecResult r = RunGet("/files/digits.txt", "Range: bytes=0-1,8-9\r\n");
+  EXPECT_EQ(r.response.GetStatus(), lib::http::kPartialContent);
+  const std::string ct = Header(r, "content-type");
+  const std::string prefix = "multipart/byteranges; boundary=";
+  ASSERT_EQ(ct.compare(0, prefix.size(), prefix), 0);
+  const std::string boundary = ct.substr(prefix.size());
+  const std::string expected =
+      "\r\n--" + boundary +
+      "\r\nContent-Type: text/plain\r\nContent-Range: bytes 0-1/10\r\n\r\n01"
+      "\r\n--" + boundary +
+      "\r\nContent-Type: text/plain\r\nContent-Range: bytes 8-9/10\r\n\r\n89"
+      "\r\n--" + boundary + "--\r\n";
+  EXPECT_EQ(r.response.GetBody(), expected);
+}
+
+TEST_F(RequestHandlerRangeTest, Unsatisfiable_Returns416) {
+  ExecResult r = RunGet("/files/digits.txt", "Range: bytes=10-\r\n");
+  EXPECT_EQ(r.response.GetStatus(), lib::http::kRangeNotSatisfiable);
+  EXPECT_EQ(Header(r, "content-range"), "bytes */10");
+}
+
+TEST_F(RequestHandlerRangeTest, InvalidRange_IsIgnored) {
+  ExecResult r = RunGet("/files/digits.txt", "Range: bytes=4-2\r\n");
+  EXPECT_EQ(r.response.GetStatus(), lib::http::kOk);
+  EXPECT_EQ(r.response.GetBody(), "0123456789");
+}
+
+TEST_F(RequestHandlerRangeTest, IfRangeMatchingDate_Returns206) {
+  ExecResult r = RunGet("/files/digits.txt", "Range: bytes=0-0\r\nIf-Range: " +
+                                                 last_modified_ + "\r\n");
+  EXPECT_EQ(r.response.GetStatus(), lib::http::kPartialContent);
+  EXPECT_EQ(r.response.GetBody(), "0");
+}
+
+TEST_F(RequestHandlerRangeTest, IfRangeStaleDate_ReturnsFull200) {
+  ExecResult r = RunGet("/files/digits.txt",
+                        "Range: bytes=0-0\r\n"
+                        "If-Range: Sun, 06 Nov 1994 08:49:37 GMT\r\n");
+  EXPECT_EQ(r.response.GetStatus(), lib::http::kOk);
+  EXPECT_EQ(r.response.GetBody(), "0123456789");
+}
+
+TEST_F(RequestHandlerRangeTest, IfRangeEntityTag_ReturnsFull200) {
+  ExecResult r = RunGet("/files/digits.txt",
+                        "Range: bytes=0-0\r\nIf-Range: \"abc\"\r\n");
+  EXPECT_EQ(r.response.GetStatus(), lib::http::kOk);
+}
+
+// conditional GET reuses the digits.txt fixture
+typedef RequestHandlerRangeTest RequestHandlerConditionalTest;
+
+TEST_F(RequestHandlerConditionalTest, FullResponse_CarriesWeakETag) {
+  ExecResult r = RunGet("/files/digits.txt");
+  EXPECT_EQ(r.response.GetStatus(), lib::http::kOk);
+  EXPECT_EQ(Header(r, "etag").compare(0, 3, "W/\""), 0);
+}
+
+TEST_F(RequestHandlerConditionalTest, IfNoneMatch_Matching_Returns304) {
+  const std::string etag = Header(RunGet("/files/digits.txt"), "etag");
+  ExecResult r = RunGet("/files/digits.txt",
+                        "If-None-Match: \"x\", " + etag + "\r\n");
+  EXPECT_EQ(r.response.GetStatus(), lib::http::kNotModified);
+  EXPECT_EQ(Header(r, "etag"), etag);
+  EXPECT_EQ(Header(r, "last-modified"), last_modified_);
+  EXPECT_EQ(r.response.GetBodySize(), 0u);
+  const std::string raw = r.response.ToHttpString();
+  EXPECT_EQ(raw.find("Content-Length"), std::string::npos);
+}
+
+TEST_F(RequestHandlerConditionalTest, IfNoneMatch_Star_Returns304) {
+  ExecResult r = RunGet("/files/digits.txt", "If-None-Match: *\r\n");
+  EXPECT_EQ(r.response.GetStatus(), lib::http::kNotModified);
+}
+
+TEST_F(RequestHandlerConditionalTest, IfNoneMatch_Mismatch_Returns200) {
+  ExecResult r = RunGet("/files/digits.txt", "If-None-Match: W/\"nope\"\r\n");
+  EXPECT_EQ(r.response.GetStatus(), lib::http::kOk);
+  EXPECT_EQ(r.response.GetBody(), "0123456789");
+}
+
+// If-None-Match takes precedence over a matching If-Modified-Since
+TEST_F(RequestHandlerConditionalTest, IfNoneMatch_OverridesIfModifiedSince) {
+  ExecResult r = RunGet("/files/digits.txt",
+                        "If-None-Match: \"nope\"\r\nIf-Modified-Since: " +
+                            last_modified_ + "\r\n");
+  EXPECT_EQ(r.response.GetStatus(), lib::http::kOk);
+}
+
+TEST_F(RequestHandlerConditionalTest, IfModifiedSince_NotNewer_Returns304) {
+  ExecResult r = RunGet("/files/digits.txt",
+                        "If-Modified-Since: " + last_modified_ + "\r\n");
+  EXPECT_EQ(r.response.GetStatus(), lib::http::kNotModified);
+}
+
+TEST_F(RequestHandlerConditionalTest, IfModifiedSince_Older_Returns200) {
+  ExecResult r = RunGet("/files/digits.txt",
+                        "If-Modified-Since: Sun, 06 Nov 1994 08:49:37 GMT\r\n");
+  EXPECT_EQ(r.response.GetStatus(), lib::http::kOk);
+}
+
+TEST_F(RequestHandlerConditionalTest, IfModifiedSince_Malformed_IsIgnored) {
+  ExecResult r = RunGet("/files/digits.txt", "If-Modified-Since: yesterday\r\n");
+  EXPECT_EQ(r.response.GetStatus(), lib::http::kOk);
+}
+
+// gzip_static / brotli_static: app.js with deploy-time .gz and .br siblings
+class RequestHandlerStaticVariantTest : public RequestHandlerRangeTest {
+ protected:
+  void SetUp() override {
+    RequestHandlerRangeTest::SetUp();
+    ConfigParser parser;
+    parser.content =
+        "{ "
+        "location /files { "
+        "  root " + tmp_ + "; "
+        "  allowed_methods GET; "
+        "  gzip_static on; "
+        "  brotli_static on; "
+        "} "
+        "}";
+    ASSERT_NO_THROW(parser.ParseServer());
+    config_ = parser.GetServerConfigs()[0];
+    WriteFile(tmp_ + "/app.js", "console.log('identity');");
+    WriteFile(tmp_ + "/app.js.gz", "GZ-BYTES");
+    WriteFile(tmp_ + "/app.js.br", "BR-BYTES");
+    lib::io::StatCache::Clear();
+  }
+};
+
+TEST_F(RequestHandlerStaticVariantTest, PrefersBrotliWhenAccepted) {
+  ExecResult r = RunGet("/files/app.js", "Accept-Encoding: gzip, br\r\n");
+  EXPECT_EQ(r.response.GetStatus(), lib::http::kOk);
+  EXPECT_EQ(r.response.GetBody(), "BR-BYTES");
+  EXPECT_EQ(Header(r, "content-encoding"), "br");
+  EXPECT_EQ(Header(r, "content-type"), "application/javascript");
+  EXPECT_EQ(Header(r, "vary"), "Accept-Encoding");
+}
+
+TEST_F(RequestHandlerStaticVariantTest, HonorsQvalues) {
+  ExecResult r =
+      RunGet("/files/app.js", "Accept-Encoding: br;q=0.5, gzip\r\n");
+  EXPECT_EQ(r.response.GetBody(), "GZ-BYTES");
+  EXPECT_EQ(Header(r, "content-encoding"), "gzip");
+}
+
+TEST_F(RequestHandlerStaticVariantTest, MissingVariant_FallsBack) {
+  unlink((tmp_ + "/app.js.br").c_str());
+  lib::io::StatCache::Clear();
+  ExecResult r = RunGet("/files/app.js", "Accept-Encoding: br\r\n");
+  EXPECT_EQ(r.response.GetBody(), "console.log('identity');");
+  EXPECT_EQ(Header(r, "content-encoding"), "");
+  EXPECT_EQ(Header(r, "vary"), "Accept-Encoding");
+}
+
+// StatCache still remembers the old variants: what is served must not
+TEST_F(RequestHandlerStaticVariantTest, VariantChangedWhileCached) {
+  const std::string old_etag =
+      Header(RunGet("/files/app.js", "Accept-Encoding: gzip, br\r\n"), "etag");
+  WriteFile(tmp_ + "/app.js.br", "NEW-BR-BYTES");
+  unlink((tmp_ + "/app.js.gz").c_str());
+
+  ExecResult br = RunGet("/files/app.js", "Accept-Encoding: br\r\n");
+  EXPECT_EQ(br.response.GetBody(), "NEW-BR-BYTES");
+  EXPECT_NE(Header(br, "etag"), old_etag);
+  ExecResult gz = RunGet("/files/app.js", "Accept-Encoding: gzip\r\n");
+  EXPECT_EQ(gz.response.GetBody(), "console.log('identity');");
+  EXPECT_EQ(Header(gz, "content-encoding"), "");
+}
+
+TEST_F(RequestHandlerStaticVariantTest, NoAcceptEncoding_ServesIdentity) {
+  ExecResult r = RunGet("/files/app.js");
+  EXPECT_EQ(r.response.GetBody(), "console.log('identity');");
+  EXPECT_EQ(Header(r, "content-encoding"), "");
+}
+
+// validators and ranges refer to the encoded file
+TEST_F(RequestHandlerStaticVariantTest, VariantHasOwnETagAndRanges) {
+  const std::string identity_etag = Header(RunGet("/files/app.js"), "etag");
+  ExecResult gz = RunGet("/files/app.js", "Accept-Encoding: gzip\r\n");
+  const std::string gz_etag = Header(gz, "etag");
+  EXPECT_NE(gz_etag, identity_etag);
+
+  ExecResult cached = RunGet(
+      "/files/app.js", "Accept-Encoding: gzip\r\nIf-None-Match: " + gz_etag +
+                           "\r\n");
+  EXPECT_EQ(cached.response.GetStatus(), lib::http::kNotModified);
+  EXPECT_EQ(Header(cached, "content-encoding"), "gzip");
+
+  ExecResult range =
+      RunGet("/files/app.js", "Accept-Encoding: gzip\r\nRange: bytes=0-1\r\n");
+  EXPECT_EQ(range.response.GetStatus(), lib::http::kPartialContent);
+  EXPECT_EQ(range.response.GetBody(), "GZ");
+  EXPECT_EQ(Header(range, "content-range"), "bytes 0-1/8");
+}
+
+// autoindex: /list maps to tmp_/list, which has no index.html
+class RequestHandlerAutoindexTest : public RequestHandlerGetTest {
+ protected:
+  std::string dir_;
+
+  void SetUp() override {
+    RequestHandlerGetTest::SetUp();
+    dir_ = tmp_ + "/list";
+    mkdir(dir_.c_str(), 0755);
+    mkdir((dir_ + "/sub").c_str(), 0755);
+    WriteFile(dir_ + "/b.txt", "b");
+    WriteFile(dir_ + "/a.txt", "a");
+    UseConfig("html");
+    autoindex::ListingCache::Clear();
+  }
+
+  void TearDown() override {
+    unlink((dir_ + "/a.txt").c_str());
+    unlink((dir_ + "/b.txt").c_str());
+    unlink((dir_ + "/index.html").c_str());
+    for (int i = 0; i < 1500; ++i) {
+      unlink((dir_ + "/f" + std::to_string(i)).c_str());
+    }
+    rmdir((dir_ + "/sub").c_str());
+    rmdir(dir_.c_str());
+    autoindex::ListingCache::Clear();
+    RequestHandlerGetTest::TearDown();
+  }
+
+  void UseConfig(const std::string& format) {
+    ConfigParser parser;
+    parser.content =
+        "{ "
+        "location /list { "
+        "  root " + dir_ + "; "
+        "  index index.html; "
+        "  allowed_methods GET; "
+        "  autoindex on; "
+        "  autoindex_format " + format + "; "
+        "} "
+        "}";
+    ASSERT_NO_THROW(parser.ParseServer());
+    config_ = parser.GetServerConfigs()[0];
+  }
+
+  // listings of recently modified directories are not cached
+  void AgeDirectory() {
+    struct timeval times[2];
+    times[0].tv_sec = times[1].tv_sec = time(NULL) - 60;
+    times[0].tv_usec = times[1].tv_usec = 0;
+    utimes(dir_.c_str(), times);
+  }
+};
+
+TEST_F(RequestHandlerAutoindexTest, Html_DirectoriesFirst) {
+  ExecResult r = RunGet("/list/");
+  EXPECT_EQ(r.response.GetStatus(), lib::http::kOk);
+  EXPECT_EQ(r.response.GetHeader("content-type").ValueOr(""), "text/html");
+  const std::string body = r.response.GetBody();
+  size_t sub = body.find("<a href=\"/list/sub/\">sub/</a>");
+  size_t a = body.find("<a href=\"/list/a.txt\">a.txt</a>");
+  size_t b = body.find("<a href=\"/list/b.txt\">b.txt</a>");
+  ASSERT_NE(sub, std::string::npos);
+  ASSERT_NE(a, std::string::npos);
+  ASSERT_NE(b, std::string::npos);
+  EXPECT_LT(sub, a);
+  EXPECT_LT(a, b);
+}
+
+TEST_F(RequestHandlerAutoindexTest, Json_SortedByNameDescending) {
+  UseConfig("json");
+  HttpRequest req;
+  std::string raw =
+      "GET /list?sort=name&order=desc HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  req.Parse(raw.c_str(), raw.size());
+  RequestHandler handler(config_, req);
+  ExecResult r = handler.Run();
+  EXPECT_EQ(r.response.GetHeader("content-type").ValueOr(""),
+            "application/json");
+  EXPECT_EQ(r.response.GetBody(),
+            "[\n{\"name\":\"sub\",\"type\":\"directory\"},"
+            "\n{\"name\":\"b.txt\",\"type\":\"file\"},"
+            "\n{\"name\":\"a.txt\",\"type\":\"file\"}\n]\n");
+}
+
+TEST_F(RequestHandlerAutoindexTest, IndexFileWins) {
+  WriteFile(dir_ + "/index.html", "index");
+  ExecResult r = RunGet("/list/");
+  EXPECT_EQ(r.response.GetBody(), "index");
+}
+
+TEST_F(RequestHandlerAutoindexTest, CachedUntilDirectoryChanges) {
+  AgeDirectory();
+  RunGet("/list/");
+  EXPECT_EQ(autoindex::ListingCache::Size(), 1u);
+  unlink((dir_ + "/a.txt").c_str());  // bumps the directory mtime
+  ExecResult r = RunGet("/list/");
+  EXPECT_EQ(r.response.GetBody().find("a.txt"), std::string::npos);
+}
+
+TEST_F(RequestHandlerAutoindexTest, LargeDirectory_IsStreamed) {
+  for (int i = 0; i < 1500; ++i) {
+    WriteFile(dir_ + "/f" + std::to_string(i), "");
+  }
+  ExecResult r = RunGet("/list/");
+  EXPECT_EQ(r.response.GetStatus(), lib::http::kOk);
+  EXPECT_EQ(r.response.GetHeader("transfer-encoding").ValueOr(""), "chunked");
+  EXPECT_EQ(r.response.GetBodySize(), 0u);
+  ASSERT_FALSE(r.response.GetBodyProducer().IsNull());
+  lib::io::OutputQueue out;
+  while (!r.response.GetBodyProducer()->Produce(out)) {
+  }
+  EXPECT_NE(out.ToString().find("/list/f1499"), std::string::npos);
+}
+
+TEST_F(RequestHandlerGetTest, Directory_AutoindexOff_KeepsErrorStatus) {
+  ExecResult r = RunGet("/files/");
+  EXPECT_NE(r.response.GetStatus(), lib::http::kOk);
+}
@@ -0,0 +1,68 @@
+#include "trace/Trace.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "HttpRequest.hpp"
+#include "access_log/LogFormat.hpp"
+
+TEST(TraceTest, FirstMarkWins) {
+  trace::Trace t;
+  EXPECT_FALSE(t.Has(trace::kFirstByte));
+  t.MarkAt(trace::kFirstByte, 100);
+  t.MarkAt(trace::kFirstByte, 200);
+  t.Mark(trace::kFirstByte);
+  EXPECT_EQ(t.At(trace::kFirstByte), 100u);
+}
+
+TEST(TraceTest, DurationNeedsBothEnds) {
+  trace::Trace t;
+  uint64_t micros = 0;
+  t.MarkAt(trace::kFirstByte, 100);
+  EXPECT_FALSE(t.Duration(trace::kSpanHeaders, &micros));
+  t.MarkAt(trace::kHeadersParsed, 130);
+  ASSERT_TRUE(t.Duration(trace::kSpanHeaders, &micros));
+  EXPECT_EQ(micros, 30u);
+  EXPECT_FALSE(t.Duration(trace::kSpanCgi, &micros));
+}
+
+TEST(TraceTest, SampleEveryNth) {
+  EXPECT_FALSE(trace::Sample(0));
+  int picked = 0;
+  for (int i = 0; i < 9; ++i) {
+    if (trace::Sample(3)) ++picked;
+  }
+  EXPECT_EQ(picked, 3);
+}
+
+TEST(TraceTest, RenderJsonListsReachedSpans) {
+  HttpRequest req;
+  req.SetMethod(lib::http::kGet);
+  req.SetUri("/a\"b");
+  req.SetClientIp("10.0.0.1");
+  access_log::Entry entry;
+  entry.request = &req;
+  entry.status = 404;
+  entry.bytes_sent = 10;
+  entry.request_time_us = 50;
+  entry.time = 1000;
+
+  trace::Trace t;
+  t.MarkAt(trace::kAccept, 1);
+  t.MarkAt(trace::kFirstByte, 11);
+  t.MarkAt(trace::kHeadersParsed, 15);
+
+  std::string line;
+  trace::RenderJson(t, entry, false, &line);
+  EXPECT_EQ(line,
+            "{\"time\":1000,\"remote_addr\":\"10.0.0.1\","
+            "\"request\":\"GET /a\\\"b \",\"status\":404,\"bytes_sent\":10,"
+            "\"request_time_us\":50,\"spans\":{\"wait\":10,\"headers\":4}}\n");
+
+  line.clear();
+  trace::RenderJson(t, entry, true, &line);
+  EXPECT_NE(line.find(",\"trace\":{\"accept\":0,\"first_byte\":10,"
+                      "\"headers_parsed\":14}}\n"),
+            std::string::npos);
+}